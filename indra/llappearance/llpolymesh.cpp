@@ -39,6 +39,9 @@
 #include "lldir.h"
 #include "llvolume.h"
 #include "llendianswizzle.h"
+#include "workqueue.h"
+
+#include <thread>
 
 
 #define HEADER_ASCII "Linden Mesh 1.0"
@@ -59,6 +62,10 @@ LLPolyMorphData *clone_morph_param_cleavage(const LLPolyMorphData *src_data,
 // Global table of loaded LLPolyMeshes
 //-----------------------------------------------------------------------------
 LLPolyMesh::LLPolyMeshSharedDataTable LLPolyMesh::sGlobalSharedMeshList;
+S32 LLPolyMesh::sMorphBatchDepth = 0;
+bool LLPolyMesh::sMorphBatchAsync = false;
+std::vector<LLPolyMesh*> LLPolyMesh::sBatchedMeshes;
+std::vector<LLPolyMesh*> LLPolyMesh::sDeferredMeshes;
 
 //-----------------------------------------------------------------------------
 // LLPolyMeshSharedData()
@@ -756,7 +763,6 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData *shared_data, LLPolyMesh *reference_
     mSharedData = shared_data;
     mReferenceMesh = reference_mesh;
     mAvatarp = NULL;
-    mVertexData = NULL;
 
     mCurVertexCount = 0;
     mFaceIndexCount = 0;
@@ -791,15 +797,16 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData *shared_data, LLPolyMesh *reference_
                     4); //scaled binormals
 
         //use 16 byte aligned vertex data to make LLPolyMesh SSE friendly
-        mVertexData = (F32*) ll_aligned_malloc_16(nfloats*4);
+        mVertexData.reset((F32*) ll_aligned_malloc_16(nfloats*4), [](F32* data) { ll_aligned_free_16(data); });
+        F32* vertex_data = mVertexData.get();
         S32 offset = 0;
-        mCoords             =   (LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-        mNormals            =   (LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-        mClothingWeights    =   (LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-        mTexCoords          =   (LLVector2*)(mVertexData + offset);  offset += 2*nverts;
-        mScaledNormals      =   (LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-        mBinormals          =   (LLVector4a*)(mVertexData + offset); offset += 4*nverts;
-        mScaledBinormals    =   (LLVector4a*)(mVertexData + offset); offset += 4*nverts;
+        mCoords             =   (LLVector4a*)(vertex_data + offset); offset += 4*nverts;
+        mNormals            =   (LLVector4a*)(vertex_data + offset); offset += 4*nverts;
+        mClothingWeights    =   (LLVector4a*)(vertex_data + offset); offset += 4*nverts;
+        mTexCoords          =   (LLVector2*)(vertex_data + offset);  offset += 2*nverts;
+        mScaledNormals      =   (LLVector4a*)(vertex_data + offset); offset += 4*nverts;
+        mBinormals          =   (LLVector4a*)(vertex_data + offset); offset += 4*nverts;
+        mScaledBinormals    =   (LLVector4a*)(vertex_data + offset); offset += 4*nverts;
         initializeForMorph();
     }
 }
@@ -810,8 +817,20 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData *shared_data, LLPolyMesh *reference_
 //-----------------------------------------------------------------------------
 LLPolyMesh::~LLPolyMesh()
 {
+    if (!mTouchedVertices.empty())
+    {
+        vector_replace_with_last(sBatchedMeshes, this);
+    }
+    if (!mPendingMorphs.empty())
+    {
+        vector_replace_with_last(sDeferredMeshes, this);
+    }
+    if (mMorphJob)
+    {
+        // a running job still holds the vertex data, its results are dropped
+        mMorphJob->mMesh = nullptr;
+    }
     delete_and_clear(mJointRenderData);
-    ll_aligned_free_16(mVertexData);
 }
 
 
@@ -989,6 +1008,341 @@ void LLPolyMesh::initializeForMorph()
     }
 }
 
+//-----------------------------------------------------------------------------
+// MorphBatch
+//-----------------------------------------------------------------------------
+LLPolyMesh::MorphBatch::MorphBatch(bool async)
+{
+    if (sMorphBatchDepth++ == 0)
+    {
+        sMorphBatchAsync = async;
+    }
+}
+
+LLPolyMesh::MorphBatch::~MorphBatch()
+{
+    if (--sMorphBatchDepth > 0)
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+    for (LLPolyMesh* mesh : sBatchedMeshes)
+    {
+        mesh->normalizeTouchedVertices();
+    }
+    sBatchedMeshes.clear();
+
+    for (LLPolyMesh* mesh : sDeferredMeshes)
+    {
+        // meshes with a job in flight pick up their queue when it finishes
+        if (!mesh->mMorphJob || !mesh->mMorphJob->mBusy)
+        {
+            mesh->startMorphJob(false);
+        }
+    }
+    sDeferredMeshes.clear();
+    sMorphBatchAsync = false;
+}
+
+//-----------------------------------------------------------------------------
+// touchVertex()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::touchVertex(U32 index)
+{
+    if (mVertexTouched.empty())
+    {
+        mVertexTouched.resize(mSharedData->mNumVertices, 0);
+    }
+    if (!mVertexTouched[index])
+    {
+        if (mTouchedVertices.empty())
+        {
+            sBatchedMeshes.push_back(this);
+        }
+        mVertexTouched[index] = 1;
+        mTouchedVertices.push_back(index);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// normalizeTouchedVertices()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::normalizeTouchedVertices()
+{
+    // Same math LLPolyMorphTarget::apply() does per morph; the result only
+    // depends on the final scaled normal and binormal.  Walk the vertices in
+    // memory order so the five arrays stream through the cache.
+    std::sort(mTouchedVertices.begin(), mTouchedVertices.end());
+    for (U32 index : mTouchedVertices)
+    {
+        LLVector4a norm = mScaledNormals[index];
+        norm.normalize3fast();
+        mNormals[index] = norm;
+
+        LLVector4a tangent;
+        tangent.setCross3(mScaledBinormals[index], norm);
+        LLVector4a& binormal = mBinormals[index];
+        binormal.setCross3(norm, tangent);
+        binormal.normalize3fast();
+
+        mVertexTouched[index] = 0;
+    }
+    mTouchedVertices.clear();
+}
+
+//-----------------------------------------------------------------------------
+// deferMorph()
+//-----------------------------------------------------------------------------
+bool LLPolyMesh::deferMorph(const LLPolyMorphData* morph_data, const F32* mask_weights, F32 delta_weight, bool is_clothing_morph)
+{
+    bool job_busy = mMorphJob && mMorphJob->mBusy;
+    if (!job_busy && !(sMorphBatchDepth > 0 && sMorphBatchAsync))
+    {
+        return false;
+    }
+
+    if (mPendingMorphs.empty())
+    {
+        if (sMorphBatchDepth > 0)
+        {
+            sDeferredMeshes.push_back(this);
+        }
+        else if (!job_busy)
+        {
+            return false;
+        }
+    }
+
+    // the mask can be regenerated before the job runs, keep the weights
+    // this application was made with
+    mPendingMorphs.emplace_back();
+    PendingMorph& morph = mPendingMorphs.back();
+    morph.mData = morph_data;
+    if (mask_weights)
+    {
+        morph.mMaskWeights.assign(mask_weights, mask_weights + morph_data->mNumIndices);
+    }
+    morph.mDeltaWeight = delta_weight;
+    morph.mIsClothingMorph = is_clothing_morph;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// startMorphJob()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::startMorphJob(bool run_inline)
+{
+    if (mPendingMorphs.empty())
+    {
+        return;
+    }
+
+    if (!mMorphJob)
+    {
+        mMorphJob = std::make_shared<MorphJob>();
+        mMorphJob->mMesh = this;
+        mMorphJob->mVertexData = mVertexData;
+        mMorphJob->mNumVertices = mSharedData->mNumVertices;
+        mMorphJob->mCoords = mCoords;
+        mMorphJob->mScaledNormals = mScaledNormals;
+        mMorphJob->mScaledBinormals = mScaledBinormals;
+        mMorphJob->mClothingWeights = mClothingWeights;
+        mMorphJob->mTexCoords = mTexCoords;
+    }
+
+    std::shared_ptr<MorphJob> job = mMorphJob;
+    llassert(!job->mBusy);
+    job->mMorphs.swap(mPendingMorphs);
+    mPendingMorphs.clear();
+    job->mBusy = true;
+    job->mState = MorphJob::QUEUED;
+
+    if (!run_inline)
+    {
+        LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        if (main_queue && general_queue)
+        {
+            bool posted = main_queue->postTo(
+                general_queue,
+                [job]() // worker thread
+                {
+                    job->run();
+                },
+                [job]() // main thread
+                {
+                    if (job->mMesh && job->mBusy && job->mState == MorphJob::DONE)
+                    {
+                        job->mMesh->finishMorphJob();
+                    }
+                });
+            if (posted)
+            {
+                return;
+            }
+        }
+    }
+
+    job->run();
+    finishMorphJob();
+}
+
+//-----------------------------------------------------------------------------
+// MorphJob::run()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::MorphJob::run()
+{
+    S32 expected = QUEUED;
+    if (!mState.compare_exchange_strong(expected, RUNNING))
+    {
+        // already claimed by waitForMorphs()
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+
+    mVertices.clear();
+    mOutCoords.clear();
+    mOutScaledNormals.clear();
+    mOutNormals.clear();
+    mOutScaledBinormals.clear();
+    mOutBinormals.clear();
+    mOutClothingWeights.clear();
+    mOutTexCoords.clear();
+
+    // slot of each touched vertex in the output arrays
+    std::vector<S32> slots(mNumVertices, -1);
+
+    for (const PendingMorph& morph : mMorphs)
+    {
+        const LLPolyMorphData* data = morph.mData;
+        const F32* mask_weights = morph.mMaskWeights.empty() ? NULL : morph.mMaskWeights.data();
+
+        for (U32 vert_index_morph = 0; vert_index_morph < data->mNumIndices; vert_index_morph++)
+        {
+            U32 vert_index_mesh = data->mVertexIndices[vert_index_morph];
+            S32& slot = slots[vert_index_mesh];
+            if (slot < 0)
+            {
+                slot = (S32)mVertices.size();
+                mVertices.push_back(vert_index_mesh);
+                mOutCoords.push_back(mCoords[vert_index_mesh]);
+                mOutScaledNormals.push_back(mScaledNormals[vert_index_mesh]);
+                mOutScaledBinormals.push_back(mScaledBinormals[vert_index_mesh]);
+                mOutClothingWeights.push_back(mClothingWeights[vert_index_mesh]);
+                mOutTexCoords.push_back(mTexCoords[vert_index_mesh]);
+            }
+
+            F32 weight = morph.mDeltaWeight * (mask_weights ? mask_weights[vert_index_morph] : 1.f);
+
+            // same deltas LLPolyMorphTarget::apply() adds
+            LLVector4a pos = data->mCoords[vert_index_morph];
+            pos.mul(weight);
+            mOutCoords[slot].add(pos);
+
+            if (morph.mIsClothingMorph)
+            {
+                LLVector4a& clothing_weight = mOutClothingWeights[slot];
+                clothing_weight.add(pos);
+                clothing_weight.getF32ptr()[VW] = mask_weights ? mask_weights[vert_index_morph] : 1.f;
+            }
+
+            LLVector4a norm = data->mNormals[vert_index_morph];
+            norm.mul(weight * NORMAL_SOFTEN_FACTOR);
+            mOutScaledNormals[slot].add(norm);
+
+            LLVector4a binorm = data->mBinormals[vert_index_morph];
+            if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
+            {
+                binorm.set(1,0,0,1);
+            }
+            binorm.mul(weight * NORMAL_SOFTEN_FACTOR);
+            mOutScaledBinormals[slot].add(binorm);
+
+            mOutTexCoords[slot] += data->mTexCoords[vert_index_morph] * weight;
+        }
+    }
+    mMorphs.clear();
+
+    const size_t count = mVertices.size();
+    mOutNormals.resize(count);
+    mOutBinormals.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        LLVector4a norm = mOutScaledNormals[i];
+        norm.normalize3fast();
+        mOutNormals[i] = norm;
+
+        LLVector4a tangent;
+        tangent.setCross3(mOutScaledBinormals[i], norm);
+        mOutBinormals[i].setCross3(norm, tangent);
+        mOutBinormals[i].normalize3fast();
+    }
+
+    mState = DONE;
+}
+
+//-----------------------------------------------------------------------------
+// finishMorphJob()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::finishMorphJob()
+{
+    LL_PROFILE_ZONE_SCOPED;
+    MorphJob* job = mMorphJob.get();
+    llassert(job && job->mBusy && job->mState == MorphJob::DONE);
+
+    for (size_t i = 0, count = job->mVertices.size(); i < count; ++i)
+    {
+        U32 index = job->mVertices[i];
+        mCoords[index] = job->mOutCoords[i];
+        mScaledNormals[index] = job->mOutScaledNormals[i];
+        mNormals[index] = job->mOutNormals[i];
+        mScaledBinormals[index] = job->mOutScaledBinormals[i];
+        mBinormals[index] = job->mOutBinormals[i];
+        mClothingWeights[index] = job->mOutClothingWeights[i];
+        mTexCoords[index] = job->mOutTexCoords[i];
+    }
+    job->mBusy = false;
+
+    if (mAvatarp)
+    {
+        mAvatarp->dirtyMesh();
+    }
+
+    // morphs that arrived while the job was running
+    if (!mPendingMorphs.empty() && !(sMorphBatchDepth > 0 && sMorphBatchAsync))
+    {
+        startMorphJob(false);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// waitForMorphs()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::waitForMorphs()
+{
+    while (mMorphJob && mMorphJob->mBusy)
+    {
+        MorphJob* job = mMorphJob.get();
+        // runs the job here unless a worker already started it
+        job->run();
+        while (job->mState != MorphJob::DONE)
+        {
+            std::this_thread::yield();
+        }
+        finishMorphJob();
+    }
+    if (!mPendingMorphs.empty())
+    {
+        if (sMorphBatchDepth > 0)
+        {
+            vector_replace_with_last(sDeferredMeshes, this);
+        }
+        startMorphJob(true);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // getMorphData()
 //-----------------------------------------------------------------------------
@@ -27,8 +27,10 @@
 #ifndef LL_LLPOLYMESHINTERFACE_H
 #define LL_LLPOLYMESHINTERFACE_H
 
-#include <string>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <string>
 #include "llstl.h"
 
 #include "v3math.h"
@@ -173,6 +175,38 @@ public:
     // references to these objects.  Generally, upon exit of the application.
     static void freeAllMeshes();
 
+    // While a MorphBatch is alive, morph targets only add their deltas to
+    // the mesh and remember which vertices they touched.  Normals and
+    // binormals of those vertices are rebuilt once, when the outermost
+    // batch goes away, instead of once per morph target.
+    //
+    // An async batch goes further: morph targets are only recorded, and
+    // each mesh they hit gets a job on the "General" thread pool that
+    // deforms a private copy of the touched vertices.  The main thread
+    // copies the finished vertices back in and dirties the avatar mesh.
+    // Meshes of different avatars never share vertex data, so their jobs
+    // run in parallel without locking.
+    class MorphBatch
+    {
+    public:
+        MorphBatch(bool async = false);
+        ~MorphBatch();
+    };
+
+    static bool isBatchingMorphs() { return sMorphBatchDepth > 0; }
+
+    // Flags a vertex whose scaled normal and binormal changed during a batch.
+    void touchVertex(U32 index);
+
+    // Queues a morph target application for a worker thread.  Returns false
+    // if the caller has to apply it right away.  Once a job is running on a
+    // mesh, every further morph is queued behind it so results stay in order.
+    bool deferMorph(const LLPolyMorphData* morph_data, const F32* mask_weights, F32 delta_weight, bool is_clothing_morph);
+
+    // Finishes any queued or running morph work on the calling (main)
+    // thread, for callers that are about to touch the vertices themselves.
+    void waitForMorphs();
+
     //--------------------------------------------------------------------
     // Transform Data Access
     //--------------------------------------------------------------------
@@ -329,16 +363,72 @@ public:
     U32             mFaceIndexCount;
     U32             mCurVertexCount;
 private:
+    struct PendingMorph
+    {
+        const LLPolyMorphData*  mData;
+        std::vector<F32>        mMaskWeights;
+        F32                     mDeltaWeight;
+        bool                    mIsClothingMorph;
+    };
+
+    struct MorphJob
+    {
+        enum EState
+        {
+            QUEUED,
+            RUNNING,
+            DONE
+        };
+
+        void run();
+
+        LLPolyMesh*             mMesh = nullptr;    // cleared when the mesh goes away
+        bool                    mBusy = false;      // main thread only
+        std::atomic<S32>        mState{ DONE };
+
+        // inputs, read only while the job runs
+        std::shared_ptr<F32>    mVertexData;        // keeps the arrays below alive
+        U32                     mNumVertices = 0;
+        const LLVector4a*       mCoords = nullptr;
+        const LLVector4a*       mScaledNormals = nullptr;
+        const LLVector4a*       mScaledBinormals = nullptr;
+        const LLVector4a*       mClothingWeights = nullptr;
+        const LLVector2*        mTexCoords = nullptr;
+        std::vector<PendingMorph> mMorphs;
+
+        // results, one entry per touched vertex
+        std::vector<U32>        mVertices;
+        std::vector<LLVector4a> mOutCoords;
+        std::vector<LLVector4a> mOutScaledNormals;
+        std::vector<LLVector4a> mOutNormals;
+        std::vector<LLVector4a> mOutScaledBinormals;
+        std::vector<LLVector4a> mOutBinormals;
+        std::vector<LLVector4a> mOutClothingWeights;
+        std::vector<LLVector2>  mOutTexCoords;
+    };
+
     void initializeForMorph();
 
+    // Hands the queued morphs to a new job; runs it inline if requested or
+    // if there is no thread pool to post it to.
+    void startMorphJob(bool run_inline);
+
+    // Main thread side of a finished job: copies the results in and starts
+    // the next job if more morphs were queued meanwhile.
+    void finishMorphJob();
+
+    // Rebuilds normals and binormals of the vertices touched in a batch.
+    void normalizeTouchedVertices();
+
     // Dumps diagnostic information about the global mesh table
     static void dumpDiagInfo();
 
 protected:
     // mesh data shared across all instances of a given mesh
     LLPolyMeshSharedData    *mSharedData;
-    // Single array of floats for allocation / deletion
-    F32                     *mVertexData;
+    // Single array of floats for allocation / deletion, shared with
+    // running morph jobs
+    std::shared_ptr<F32>    mVertexData;
     // deformed vertices (resulting from application of morph targets)
     LLVector4a              *mCoords;
     // deformed normals (resulting from application of morph targets)
@@ -356,6 +446,19 @@ protected:
 
     LLPolyMesh              *mReferenceMesh;
 
+    // vertices waiting for normalization at the end of a morph batch
+    std::vector<U32>        mTouchedVertices;
+    std::vector<U8>         mVertexTouched;
+
+    // morphs queued for, or being applied by, a worker thread
+    std::vector<PendingMorph> mPendingMorphs;
+    std::shared_ptr<MorphJob> mMorphJob;
+
+    static S32 sMorphBatchDepth;
+    static bool sMorphBatchAsync;
+    static std::vector<LLPolyMesh*> sBatchedMeshes;
+    static std::vector<LLPolyMesh*> sDeferredMeshes;
+
     // global mesh list
     typedef std::map<std::string, LLPolyMeshSharedData*> LLPolyMeshSharedDataTable;
     static LLPolyMeshSharedDataTable sGlobalSharedMeshList;
@@ -39,8 +39,6 @@
 
 //#include "../tools/imdebug/imdebug.h"
 
-const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
-
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
 //-----------------------------------------------------------------------------
@@ -581,61 +579,76 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
 
         F32 *maskWeightArray = (mVertMask) ? mVertMask->getMorphMaskWeights() : NULL;
 
-        for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
-        {
-            S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
+        // inside a batch the mesh renormalizes each touched vertex once at the end
+        bool batched = LLPolyMesh::isBatchingMorphs();
 
-            F32 maskWeight = 1.f;
-            if (maskWeightArray)
+        if (!mMesh->deferMorph(mMorphData, maskWeightArray, delta_weight, getInfo()->mIsClothingMorph))
+        {
+            for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
             {
-                maskWeight = maskWeightArray[vert_index_morph];
-            }
+                S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
 
+                F32 maskWeight = 1.f;
+                if (maskWeightArray)
+                {
+                    maskWeight = maskWeightArray[vert_index_morph];
+                }
 
-            LLVector4a pos = mMorphData->mCoords[vert_index_morph];
-            pos.mul(delta_weight*maskWeight);
-            coords[vert_index_mesh].add(pos);
 
-            if (getInfo()->mIsClothingMorph && clothing_weights)
-            {
-                LLVector4a clothing_offset = mMorphData->mCoords[vert_index_morph];
-                clothing_offset.mul(delta_weight * maskWeight);
-                LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
-                clothing_weight->add(clothing_offset);
-                clothing_weight->getF32ptr()[VW] = maskWeight;
-            }
+                LLVector4a pos = mMorphData->mCoords[vert_index_morph];
+                pos.mul(delta_weight*maskWeight);
+                coords[vert_index_mesh].add(pos);
 
-            // calculate new normals based on half angles
-            LLVector4a norm = mMorphData->mNormals[vert_index_morph];
-            norm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-            scaled_normals[vert_index_mesh].add(norm);
-            norm = scaled_normals[vert_index_mesh];
+                if (getInfo()->mIsClothingMorph && clothing_weights)
+                {
+                    LLVector4a clothing_offset = mMorphData->mCoords[vert_index_morph];
+                    clothing_offset.mul(delta_weight * maskWeight);
+                    LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
+                    clothing_weight->add(clothing_offset);
+                    clothing_weight->getF32ptr()[VW] = maskWeight;
+                }
 
-            // guard against degenerate input data before we create NaNs below!
-            //
-            norm.normalize3fast();
-            normals[vert_index_mesh] = norm;
+                // calculate new normals based on half angles
+                LLVector4a norm = mMorphData->mNormals[vert_index_morph];
+                norm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
+                scaled_normals[vert_index_mesh].add(norm);
 
-            // calculate new binormals
-            LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
+                // calculate new binormals
+                LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
 
-            // guard against degenerate input data before we create NaNs below!
-            //
-            if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
-            {
-                binorm.set(1,0,0,1);
-            }
+                // guard against degenerate input data before we create NaNs below!
+                //
+                if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
+                {
+                    binorm.set(1,0,0,1);
+                }
+
+                binorm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
+                scaled_binormals[vert_index_mesh].add(binorm);
 
-            binorm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-            scaled_binormals[vert_index_mesh].add(binorm);
-            LLVector4a tangent;
-            tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
-            LLVector4a& normalized_binormal = binormals[vert_index_mesh];
+                if (batched)
+                {
+                    mMesh->touchVertex(vert_index_mesh);
+                }
+                else
+                {
+                    norm = scaled_normals[vert_index_mesh];
 
-            normalized_binormal.setCross3(norm, tangent);
-            normalized_binormal.normalize3fast();
+                    // guard against degenerate input data before we create NaNs below!
+                    //
+                    norm.normalize3fast();
+                    normals[vert_index_mesh] = norm;
 
-            tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
+                    LLVector4a tangent;
+                    tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
+                    LLVector4a& normalized_binormal = binormals[vert_index_mesh];
+
+                    normalized_binormal.setCross3(norm, tangent);
+                    normalized_binormal.normalize3fast();
+                }
+
+                tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
+            }
         }
 
         // now apply volume changes
@@ -661,6 +674,9 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
 //-----------------------------------------------------------------------------
 void    LLPolyMorphTarget::applyMask(const U8 *maskTextureData, S32 width, S32 height, S32 num_components, bool invert)
 {
+    // the vertices are modified in place below
+    mMesh->waitForMorphs();
+
     LLVector4a *clothing_weights = getInfo()->mIsClothingMorph ? mMesh->getWritableClothingWeights() : NULL;
 
     if (!mVertMask)
@@ -38,6 +38,9 @@ class LLVector2;
 class LLAvatarJointCollisionVolume;
 class LLWearable;
 
+// Scale applied to morph normal and binormal deltas
+const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
+
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
 //-----------------------------------------------------------------------------
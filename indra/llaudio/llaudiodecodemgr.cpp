@@ -28,14 +28,15 @@
 #include "llaudiodecodemgr.h"
 
 #include "llaudioengine.h"
-#include "lllfsthread.h"
+#include "llaudiopcmcache.h"
+#include "llfile.h"
 #include "llfilesystem.h"
 #include "llstring.h"
 #include "lldir.h"
 #include "llendianswizzle.h"
 #include "llassetstorage.h"
 #include "llrefcount.h"
-#include "threadpool.h"
+#include "lltrace.h"
 #include "workqueue.h"
 
 #include "llvorbisencode.h"
@@ -44,39 +45,40 @@
 #include "vorbis/vorbisfile.h"
 #include <iterator>
 #include <deque>
+#include <unordered_set>
 
 extern LLAudioEngine *gAudiop;
 
 static const S32 WAV_HEADER_SIZE = 44;
 
+static LLTrace::CountStatHandle<> sAudioDecodes("audiodecodes", "Sounds decoded from vorbis");
+
 
 //////////////////////////////////////////////////////////////////////////////
 
 
+//
+// Decodes one sound from start to finish on the calling thread. The
+// encoded data is read into memory in one go and vorbis reads it from
+// there.
+//
 class LLVorbisDecodeState : public LLThreadSafeRefCount
 {
 public:
-    class WriteResponder : public LLLFSThread::Responder
-    {
-    public:
-        WriteResponder(LLVorbisDecodeState* decoder) : mDecoder(decoder) {}
-        ~WriteResponder() {}
-        void completed(S32 bytes)
-        {
-            mDecoder->ioComplete(bytes);
-        }
-        LLPointer<LLVorbisDecodeState> mDecoder;
-    };
-
+    // out_filename may be empty, in which case the decoded sound is only
+    // kept in memory.
     LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename);
 
-    bool initDecode();
+    bool initDecode();                              // from the asset cache
+    bool initDecode(const std::string& filename);   // from a file on disk
     bool decodeSection(); // Return true if done.
     bool finishDecode();
 
     void flushBadFile();
 
-    void ioComplete(S32 bytes)          { mBytesRead = bytes; }
+    // Hands over the decoded samples once finishDecode() is done.
+    LLAudioPCMCache::pcm_ptr_t takePCM();
+
     bool isValid() const                { return mValid; }
     bool isDone() const                 { return mDone; }
     const LLUUID &getUUID() const       { return mUUID; }
@@ -84,94 +86,97 @@ public:
 protected:
     virtual ~LLVorbisDecodeState();
 
+    bool openStream();
+    bool writeFile();
+
+    static size_t memoryRead(void *ptr, size_t size, size_t nmemb, void *datasource);
+    static S32 memorySeek(void *datasource, ogg_int64_t offset, S32 whence);
+    static S32 memoryClose(void *datasource);
+    static long memoryTell(void *datasource);
+
     bool mValid;
     bool mDone;
-    LLAtomicS32 mBytesRead;
+    bool mFinished;
+    bool mStreamOpen;
     LLUUID mUUID;
 
     std::vector<U8> mWAVBuffer;
     std::string mOutFilename;
-    LLLFSThread::handle_t mFileHandle;
 
-    LLFileSystem *mInFilep;
+    std::vector<U8> mInBuffer;
+    size_t mInPos;
     OggVorbis_File mVF;
     S32 mCurrentSection;
 };
 
-size_t cache_read(void *ptr, size_t size, size_t nmemb, void *datasource)
+//static
+size_t LLVorbisDecodeState::memoryRead(void *ptr, size_t size, size_t nmemb, void *datasource)
 {
-    LLFileSystem *file = (LLFileSystem *)datasource;
-
-    if (file->read((U8*)ptr, (S32)(size * nmemb)))  /*Flawfinder: ignore*/
-    {
-        S32 read = file->getLastBytesRead();
-        return  read / size;    /*Flawfinder: ignore*/
-    }
-    else
+    LLVorbisDecodeState* self = (LLVorbisDecodeState*)datasource;
+    if (!size)
     {
         return 0;
     }
+    size_t count = llmin(nmemb, (self->mInBuffer.size() - self->mInPos) / size);
+    memcpy(ptr, self->mInBuffer.data() + self->mInPos, count * size);   /*Flawfinder: ignore*/
+    self->mInPos += count * size;
+    return count;
 }
 
-S32 cache_seek(void *datasource, ogg_int64_t offset, S32 whence)
+//static
+S32 LLVorbisDecodeState::memorySeek(void *datasource, ogg_int64_t offset, S32 whence)
 {
-    LLFileSystem *file = (LLFileSystem *)datasource;
+    LLVorbisDecodeState* self = (LLVorbisDecodeState*)datasource;
 
-    // cache has 31-bit files
-    if (offset > S32_MAX)
-    {
-        return -1;
-    }
-
-    S32 origin;
+    ogg_int64_t origin;
     switch (whence) {
     case SEEK_SET:
         origin = 0;
         break;
     case SEEK_END:
-        origin = file->getSize();
+        origin = (ogg_int64_t)self->mInBuffer.size();
         break;
     case SEEK_CUR:
-        origin = -1;
+        origin = (ogg_int64_t)self->mInPos;
         break;
     default:
-        LL_ERRS("AudioEngine") << "Invalid whence argument to cache_seek" << LL_ENDL;
+        LL_ERRS("AudioEngine") << "Invalid whence argument to memorySeek" << LL_ENDL;
         return -1;
     }
 
-    if (file->seek((S32)offset, origin))
-    {
-        return 0;
-    }
-    else
+    ogg_int64_t pos = origin + offset;
+    if (pos < 0 || pos > (ogg_int64_t)self->mInBuffer.size())
     {
         return -1;
     }
+    self->mInPos = (size_t)pos;
+    return 0;
 }
 
-S32 cache_close (void *datasource)
+//static
+S32 LLVorbisDecodeState::memoryClose(void *datasource)
 {
-    LLFileSystem *file = (LLFileSystem *)datasource;
-    delete file;
+    // The buffer belongs to the decode state
     return 0;
 }
 
-long cache_tell (void *datasource)
+//static
+long LLVorbisDecodeState::memoryTell(void *datasource)
 {
-    LLFileSystem *file = (LLFileSystem *)datasource;
-    return file->tell();
+    LLVorbisDecodeState* self = (LLVorbisDecodeState*)datasource;
+    return (long)self->mInPos;
 }
 
 LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename)
 {
     mDone = false;
+    mFinished = false;
+    mStreamOpen = false;
     mValid = false;
-    mBytesRead = -1;
     mUUID = uuid;
-    mInFilep = NULL;
+    mInPos = 0;
     mCurrentSection = 0;
     mOutFilename = out_filename;
-    mFileHandle = LLLFSThread::nullHandle();
 
     // No default value for mVF, it's an ogg structure?
     // Hey, let's zero it anyway, for predictability.
@@ -180,39 +185,72 @@ LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, const std::string &
 
 LLVorbisDecodeState::~LLVorbisDecodeState()
 {
-    if (!mDone)
+    if (mStreamOpen)
     {
-        delete mInFilep;
-        mInFilep = NULL;
+        ov_clear(&mVF);
     }
 }
 
 
 bool LLVorbisDecodeState::initDecode()
 {
-    ov_callbacks cache_callbacks;
-    cache_callbacks.read_func = cache_read;
-    cache_callbacks.seek_func = cache_seek;
-    cache_callbacks.close_func = cache_close;
-    cache_callbacks.tell_func = cache_tell;
-
     LL_DEBUGS("AudioEngine") << "Initing decode from vfile: " << mUUID << LL_ENDL;
 
-    mInFilep = new LLFileSystem(mUUID, LLAssetType::AT_SOUND);
-    if (!mInFilep || !mInFilep->getSize())
+    LLFileSystem in_file(mUUID, LLAssetType::AT_SOUND);
+    S32 size = in_file.getSize();
+    if (size <= 0)
     {
         LL_WARNS("AudioEngine") << "unable to open vorbis source vfile for reading" << LL_ENDL;
-        delete mInFilep;
-        mInFilep = NULL;
         return false;
     }
 
-    S32 r = ov_open_callbacks(mInFilep, &mVF, NULL, 0, cache_callbacks);
+    mInBuffer.resize(size);
+    if (!in_file.read(mInBuffer.data(), size) || in_file.getLastBytesRead() != size)
+    {
+        LL_WARNS("AudioEngine") << "unable to read vorbis source vfile: " << mUUID << LL_ENDL;
+        mInBuffer.clear();
+        return false;
+    }
+
+    return openStream();
+}
+
+bool LLVorbisDecodeState::initDecode(const std::string& filename)
+{
+    llifstream in_file(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!in_file.is_open())
+    {
+        LL_WARNS("AudioEngine") << "unable to open vorbis source file " << filename << LL_ENDL;
+        return false;
+    }
+
+    mInBuffer.assign(std::istreambuf_iterator<char>(in_file), std::istreambuf_iterator<char>());
+    if (mInBuffer.empty())
+    {
+        LL_WARNS("AudioEngine") << "empty vorbis source file " << filename << LL_ENDL;
+        return false;
+    }
+
+    return openStream();
+}
+
+bool LLVorbisDecodeState::openStream()
+{
+    ov_callbacks memory_callbacks;
+    memory_callbacks.read_func = memoryRead;
+    memory_callbacks.seek_func = memorySeek;
+    memory_callbacks.close_func = memoryClose;
+    memory_callbacks.tell_func = memoryTell;
+
+    mInPos = 0;
+    S32 r = ov_open_callbacks(this, &mVF, NULL, 0, memory_callbacks);
     if(r < 0)
     {
         LL_WARNS("AudioEngine") << r << " Input to vorbis decode does not appear to be an Ogg bitstream: " << mUUID << LL_ENDL;
+        mInBuffer.clear();
         return(false);
     }
+    mStreamOpen = true;
 
     S32 sample_count = (S32)ov_pcm_total(&mVF, -1);
     size_t size_guess = (size_t)sample_count;
@@ -258,8 +296,6 @@ bool LLVorbisDecodeState::initDecode()
         {
             LL_WARNS("AudioEngine") << "Bad asset encoded by: " << comment->vendor << LL_ENDL;
         }
-        delete mInFilep;
-        mInFilep = NULL;
         return false;
     }
 
@@ -271,8 +307,6 @@ bool LLVorbisDecodeState::initDecode()
     catch (std::bad_alloc&)
     {
         LL_WARNS("AudioEngine") << "Out of memory when trying to alloc buffer: " << size_guess << LL_ENDL;
-        delete mInFilep;
-        mInFilep = NULL;
         return false;
     }
 
@@ -365,7 +399,7 @@ bool LLVorbisDecodeState::initDecode()
 
 bool LLVorbisDecodeState::decodeSection()
 {
-    if (!mInFilep)
+    if (!mStreamOpen)
     {
         LL_WARNS("AudioEngine") << "No cache file to decode in vorbis!" << LL_ENDL;
         return true;
@@ -417,9 +451,16 @@ bool LLVorbisDecodeState::finishDecode()
         return true; // We've finished
     }
 
-    if (mFileHandle == LLLFSThread::nullHandle())
+    if (mFinished)
+    {
+        return true;
+    }
+
+    if (mStreamOpen)
     {
         ov_clear(&mVF);
+        mStreamOpen = false;
+        mInBuffer.clear();
 
         // write "data" chunk length, in little-endian format
         S32 data_length = static_cast<S32>(mWAVBuffer.size()) - WAV_HEADER_SIZE;
@@ -490,44 +531,69 @@ bool LLVorbisDecodeState::finishDecode()
             mValid = false;
             return true; // we've finished
         }
-        mBytesRead = -1;
-        mFileHandle = LLLFSThread::sLocal->write(mOutFilename, &mWAVBuffer[0], 0, static_cast<S32>(mWAVBuffer.size()),
-                             new WriteResponder(this));
-    }
-
-    if (mFileHandle != LLLFSThread::nullHandle())
-    {
-        if (mBytesRead >= 0)
-        {
-            if (mBytesRead == 0)
-            {
-                LL_WARNS("AudioEngine") << "Unable to write file in LLVorbisDecodeState::finishDecode" << LL_ENDL;
-                mValid = false;
-                return true; // we've finished
-            }
-        }
-        else
+        // The samples are kept in memory either way, so a failed write only
+        // costs a decode next session.
+        if (!mOutFilename.empty() && !writeFile())
         {
-            return false; // not done
+            LL_WARNS("AudioEngine") << "Unable to write file in LLVorbisDecodeState::finishDecode" << LL_ENDL;
         }
     }
 
     mDone = true;
+    mFinished = true;
 
     LL_DEBUGS("AudioEngine") << "Finished decode for " << getUUID() << LL_ENDL;
 
     return true;
 }
 
+bool LLVorbisDecodeState::writeFile()
+{
+    // Write under another name first, so that a partly written file is
+    // never taken for a decoded sound.
+    std::string temp_filename = mOutFilename + ".tmp";
+    LLFILE* fp = LLFile::fopen(temp_filename, "wb");    /* Flawfinder: ignore */
+    if (!fp)
+    {
+        return false;
+    }
+    size_t written = fwrite(mWAVBuffer.data(), 1, mWAVBuffer.size(), fp);
+    fclose(fp);
+
+    LLFile::remove(mOutFilename, ENOENT);
+    if (written != mWAVBuffer.size() || LLFile::rename(temp_filename, mOutFilename) != 0)
+    {
+        LLFile::remove(temp_filename);
+        return false;
+    }
+    return true;
+}
+
 void LLVorbisDecodeState::flushBadFile()
 {
-    if (mInFilep)
+    if (mUUID.notNull())
     {
         LL_WARNS("AudioEngine") << "Flushing bad vorbis file from cache for " << mUUID << LL_ENDL;
-        mInFilep->remove();
+        LLFileSystem::removeFile(mUUID, LLAssetType::AT_SOUND);
     }
 }
 
+LLAudioPCMCache::pcm_ptr_t LLVorbisDecodeState::takePCM()
+{
+    if (!mFinished || !mValid || mWAVBuffer.size() <= (size_t)WAV_HEADER_SIZE)
+    {
+        return LLAudioPCMCache::pcm_ptr_t();
+    }
+
+    // Same layout the header written above describes
+    std::shared_ptr<LLAudioPCM> pcm = std::make_shared<LLAudioPCM>();
+    pcm->mBuffer.swap(mWAVBuffer);
+    pcm->mOffset = WAV_HEADER_SIZE;
+    pcm->mChannels = 1;
+    pcm->mSampleRate = LLVORBIS_CLIP_SAMPLE_RATE;
+    return pcm;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 class LLAudioDecodeMgr::Impl
@@ -539,32 +605,26 @@ class LLAudioDecodeMgr::Impl
     void processQueue();
 
     void startMoreDecodes();
-    void enqueueFinishAudio(const LLUUID &decode_id, LLPointer<LLVorbisDecodeState>& decode_state);
-    void checkDecodesFinished();
+    void finishAudio(const LLUUID &decode_id, LLPointer<LLVorbisDecodeState>& decode_state);
 
   protected:
     std::deque<LLUUID> mDecodeQueue;
-    std::map<LLUUID, LLPointer<LLVorbisDecodeState>> mDecodes;
+    // Sounds with a decode task on the general queue
+    std::unordered_set<LLUUID> mDecodes;
 };
 
 LLAudioDecodeMgr::Impl::Impl()
 {
 }
 
-// Returns the in-progress decode_state, which may be an empty LLPointer if
-// there was an error and there is no more work to be done.
-LLPointer<LLVorbisDecodeState> beginDecodingAndWritingAudio(const LLUUID &decode_id);
-
-// Return true if finished
-bool tryFinishAudio(const LLUUID &decode_id, LLPointer<LLVorbisDecodeState> decode_state);
+// Decodes a whole sound on the calling thread, and writes it to the disk
+// cache if write_file is set. Returns an empty LLPointer on error.
+LLPointer<LLVorbisDecodeState> decodeAudio(const LLUUID &decode_id, bool write_file);
 
 void LLAudioDecodeMgr::Impl::processQueue()
 {
-    // First, check if any audio from in-progress decodes are ready to play. If
-    // so, mark them ready for playback (or errored, in case of error).
-    checkDecodesFinished();
-
-    // Second, start as many decodes from the queue as permitted
+    // Decodes report back through the main loop work queue, so all that is
+    // left to do here is start the new ones.
     startMoreDecodes();
 }
 
@@ -576,21 +636,15 @@ void LLAudioDecodeMgr::Impl::startMoreDecodes()
     // *NOTE: main_queue->postTo casts this refcounted smart pointer to a weak
     // pointer
     LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
-    const LL::ThreadPool::ptr_t general_thread_pool = LL::ThreadPool::getInstance("General");
     llassert_always(main_queue);
     llassert_always(general_queue);
-    llassert_always(general_thread_pool);
-    // Set max decodes to double the thread count of the general work queue.
-    // This ensures the general work queue is full, but prevents theoretical
-    // buildup of buffers in memory due to disk writes once the
-    // LLVorbisDecodeState leaves the worker thread (see
-    // LLLFSThread::sLocal->write). This is probably as fast as we can get it
-    // without modifying/removing LLVorbisDecodeState, at which point we should
-    // consider decoding the audio during the asset download process.
-    // -Cosmic,2022-05-11
-    const size_t max_decodes = general_thread_pool->getWidth() * 2;
-
-    while (!mDecodeQueue.empty() && mDecodes.size() < max_decodes)
+    const bool write_files = gAudiop->getWriteDecodedFiles();
+
+    // One task per sound, all posted at once: the general pool's threads
+    // bound how many run together, and a task holds nothing but the sound's
+    // id until it starts. A burst of short sounds (gestures, HUD clicks)
+    // decodes in parallel instead of a few at a time.
+    while (!mDecodeQueue.empty())
     {
         const LLUUID decode_id = mDecodeQueue.front();
         mDecodeQueue.pop_front();
@@ -606,21 +660,12 @@ void LLAudioDecodeMgr::Impl::startMoreDecodes()
         }
 
         // Kick off a decode
-        mDecodes[decode_id] = LLPointer<LLVorbisDecodeState>(NULL);
+        mDecodes.insert(decode_id);
         bool posted = main_queue->postTo(
             general_queue,
-            [decode_id]() // Work done on general queue
+            [decode_id, write_files]() // Work done on general queue
             {
-                LLPointer<LLVorbisDecodeState> decode_state = beginDecodingAndWritingAudio(decode_id);
-
-                if (!decode_state)
-                {
-                    // Audio decode has errored
-                    return decode_state;
-                }
-
-                // Disk write of decoded audio is now in progress off-thread
-                return decode_state;
+                return decodeAudio(decode_id, write_files);
             },
             [decode_id, this](LLPointer<LLVorbisDecodeState> decode_state) // Callback to main thread
             mutable {
@@ -635,7 +680,7 @@ void LLAudioDecodeMgr::Impl::startMoreDecodes()
                 // is valid because the lifetime of "this" is dependent upon
                 // the lifetime of gAudiop.
 
-                enqueueFinishAudio(decode_id, decode_state);
+                finishAudio(decode_id, decode_state);
             });
         if (! posted)
         {
@@ -643,17 +688,22 @@ void LLAudioDecodeMgr::Impl::startMoreDecodes()
             // Consider making processQueue() do a cleanup instead
             // of starting more decodes
             LL_WARNS() << "Tried to start decoding on shutdown" << LL_ENDL;
+            mDecodes.erase(decode_id);
         }
     }
 }
 
-LLPointer<LLVorbisDecodeState> beginDecodingAndWritingAudio(const LLUUID &decode_id)
+LLPointer<LLVorbisDecodeState> decodeAudio(const LLUUID &decode_id, bool write_file)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_MEDIA;
 
     LL_DEBUGS() << "Decoding " << decode_id << " from audio queue!" << LL_ENDL;
 
-    std::string                    d_path       = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, decode_id.asString()) + ".dsf";
+    std::string d_path;
+    if (write_file)
+    {
+        d_path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, decode_id.asString()) + ".dsf";
+    }
     LLPointer<LLVorbisDecodeState> decode_state = new LLVorbisDecodeState(decode_id, d_path);
 
     if (!decode_state->initDecode())
@@ -684,81 +734,74 @@ LLPointer<LLVorbisDecodeState> beginDecodingAndWritingAudio(const LLUUID &decode
         return NULL;
     }
 
-    // Kick off the writing of the decoded audio to the disk cache.
-    // The receiving thread can then cheaply call finishDecode() again to check
-    // if writing has finished. Someone has to hold on to the refcounted
-    // decode_state to prevent it from getting destroyed during write.
+    // Fix up the header and loop points, and write the disk cache file if
+    // wanted, while still off the main thread.
     decode_state->finishDecode();
 
     return decode_state;
 }
 
-void LLAudioDecodeMgr::Impl::enqueueFinishAudio(const LLUUID &decode_id, LLPointer<LLVorbisDecodeState>& decode_state)
+void LLAudioDecodeMgr::Impl::finishAudio(const LLUUID &decode_id, LLPointer<LLVorbisDecodeState>& decode_state)
 {
-    // Assumed fast
-    if (tryFinishAudio(decode_id, decode_state))
-    {
-        // Done early!
-        auto decode_iter = mDecodes.find(decode_id);
-        llassert(decode_iter != mDecodes.end());
-        mDecodes.erase(decode_iter);
-        return;
-    }
-
-    // Not done yet... enqueue it
-    mDecodes[decode_id] = decode_state;
-}
+    mDecodes.erase(decode_id);
 
-void LLAudioDecodeMgr::Impl::checkDecodesFinished()
-{
-    auto decode_iter = mDecodes.begin();
-    while (decode_iter != mDecodes.end())
+    bool valid = decode_state && decode_state->isValid();
+    LLAudioPCMCache::pcm_ptr_t uncached;
+    if (valid)
     {
-        const LLUUID& decode_id = decode_iter->first;
-        const LLPointer<LLVorbisDecodeState>& decode_state = decode_iter->second;
-        if (tryFinishAudio(decode_id, decode_state))
+        LLTrace::add(sAudioDecodes, 1);
+        LLAudioPCMCache::pcm_ptr_t pcm = decode_state->takePCM();
+        if (!gAudiop->getPCMCache().add(decode_id, pcm))
         {
-            decode_iter = mDecodes.erase(decode_iter);
+            // Larger than AudioDecodedCacheSize allows; without a disk file
+            // either, the sound would be decoded again on every load
+            uncached = pcm;
         }
-        else
-        {
-            ++decode_iter;
-        }
-    }
-}
-
-bool tryFinishAudio(const LLUUID &decode_id, LLPointer<LLVorbisDecodeState> decode_state)
-{
-    // decode_state is a file write in progress unless finished is true
-    bool finished = decode_state && decode_state->finishDecode();
-    if (!finished)
-    {
-        return false;
     }
 
-    llassert_always(gAudiop);
-
     LLAudioData *adp = gAudiop->getAudioData(decode_id);
     if (!adp)
     {
         LL_WARNS("AudioEngine") << "Missing LLAudioData for decode of " << decode_id << LL_ENDL;
-        return true;
+        return;
     }
+    adp->setUncachedPCM(uncached);
 
-    bool valid = decode_state && decode_state->isValid();
     // Mark current decode finished regardless of success or failure
     adp->setHasCompletedDecode(true);
     // Flip flags for decoded data
     adp->setHasDecodeFailed(!valid);
     adp->setHasDecodedData(valid);
-    // When finished decoding, there will also be a decoded wav file cached on
-    // disk with the .dsf extension
+    // When finished decoding, the samples are in the engine's PCM cache, and
+    // possibly also in a wav file cached on disk with the .dsf extension
     if (valid)
     {
         adp->setHasWAVLoadFailed(false);
     }
+}
 
-    return true;
+LLAudioPCMCache::pcm_ptr_t decode_vorbis_file(const std::string& filename)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_MEDIA;
+
+    LLPointer<LLVorbisDecodeState> decode_state = new LLVorbisDecodeState(LLUUID::null, std::string());
+    if (!decode_state->initDecode(filename))
+    {
+        return LLAudioPCMCache::pcm_ptr_t();
+    }
+
+    while (!decode_state->decodeSection())
+    {
+    }
+
+    if (!decode_state->isDone() || !decode_state->isValid())
+    {
+        LL_WARNS("AudioEngine") << filename << " has invalid vorbis data" << LL_ENDL;
+        return LLAudioPCMCache::pcm_ptr_t();
+    }
+
+    decode_state->finishDecode();
+    return decode_state->takePCM();
 }
 
 //////////////////////////////////////////////////////////////////////////////
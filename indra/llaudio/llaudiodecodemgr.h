@@ -33,6 +33,7 @@
 #include "llassettype.h"
 #include "llframetimer.h"
 #include "llsingleton.h"
+#include "llaudiopcmcache.h"
 
 template<class T> class LLPointer;
 class LLVorbisDecodeState;
@@ -51,4 +52,8 @@ protected:
     Impl* mImpl;
 };
 
+// Decodes a vorbis file on disk the way sound assets are decoded, on the
+// calling thread. For tools and tests; returns an empty pointer on error.
+LLAudioPCMCache::pcm_ptr_t decode_vorbis_file(const std::string& filename);
+
 #endif
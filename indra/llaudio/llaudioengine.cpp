@@ -98,6 +98,8 @@ void LLAudioEngine::setDefaults()
 
     mStreamingAudioImpl = NULL;
 
+    mWriteDecodedFiles = true;
+
     for (U32 i = 0; i < LLAudioEngine::AUDIO_TYPE_COUNT; i++)
         mSecondaryGain[i] = 1.0f;
 }
@@ -150,6 +152,8 @@ void LLAudioEngine::shutdown()
         delete mBuffers[i];
         mBuffers[i] = NULL;
     }
+
+    mPCMCache.clear();
 }
 
 
@@ -966,6 +970,18 @@ void LLAudioEngine::cleanupAudioSource(LLAudioSource *asp)
 
 bool LLAudioEngine::hasDecodedFile(const LLUUID &uuid)
 {
+    if (mPCMCache.has(uuid))
+    {
+        return true;
+    }
+
+    // too big for the cache, waiting to be loaded
+    data_map::iterator data_iter = mAllData.find(uuid);
+    if (data_iter != mAllData.end() && data_iter->second && data_iter->second->hasUncachedPCM())
+    {
+        return true;
+    }
+
     std::string uuid_str;
     uuid.toString(uuid_str);
 
@@ -1817,19 +1833,43 @@ bool LLAudioData::load()
         return true;
     }
 
-    std::string uuid_str;
-    std::string wav_path;
-    mID.toString(uuid_str);
-    wav_path= gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
+    // Prefer decoded data still in memory over the disk cache. Samples too
+    // big for the cache are used once, then left to the disk cache or a
+    // new decode.
+    bool cached = false;
+    LLAudioPCMCache::pcm_ptr_t pcm;
+    pcm.swap(mUncachedPCM);
+    if (!pcm)
+    {
+        pcm = gAudiop->getPCMCache().get(mID);
+        cached = true;
+    }
+    if (pcm)
+    {
+        mHasWAVLoadFailed = !mBufferp->loadPCM(*pcm);
+        if (mHasWAVLoadFailed && cached)
+        {
+            // Don't offer the bad data again
+            gAudiop->getPCMCache().remove(mID);
+        }
+    }
+    else
+    {
+        std::string uuid_str;
+        std::string wav_path;
+        mID.toString(uuid_str);
+        wav_path= gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
+
+        mHasWAVLoadFailed = !mBufferp->loadWAV(wav_path);
+    }
 
-    mHasWAVLoadFailed = !mBufferp->loadWAV(wav_path);
     if (mHasWAVLoadFailed)
     {
         // Hrm.  Right now, let's unset the buffer, since it's empty.
         gAudiop->cleanupBuffer(mBufferp);
         mBufferp = nullptr;
 
-        if (!gDirUtilp->fileExists(wav_path))
+        if (!gAudiop->hasDecodedFile(mID))
         {
             mHasLocalData = false;
             mHasDecodedData = false;
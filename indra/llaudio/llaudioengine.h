@@ -40,6 +40,8 @@
 #include "llassettype.h"
 #include "llextendedstatus.h"
 
+#include "llaudiopcmcache.h"
+
 #include "lllistener.h"
 
 const F32 LL_WIND_UPDATE_INTERVAL = 0.1f;
@@ -165,9 +167,16 @@ public:
     LLAudioChannel *getFreeChannel(const F32 priority); // Get a free channel or flush an existing one if your priority is higher
     void cleanupBuffer(LLAudioBuffer *bufferp);
 
+    // True if decoded data is in memory or on disk.
     bool hasDecodedFile(const LLUUID &uuid);
     bool hasLocalFile(const LLUUID &uuid);
 
+    // Decoded sounds are kept in memory; writing them to the disk cache as
+    // well is optional.
+    LLAudioPCMCache& getPCMCache()                  { return mPCMCache; }
+    void setWriteDecodedFiles(bool write)           { mWriteDecodedFiles = write; }
+    bool getWriteDecodedFiles() const               { return mWriteDecodedFiles; }
+
     bool updateBufferForData(LLAudioData *adp, const LLUUID &audio_uuid = LLUUID::null);
 
 
@@ -239,6 +248,9 @@ protected:
 
     LLFrameTimer mWindUpdateTimer;
 
+    LLAudioPCMCache mPCMCache;
+    bool mWriteDecodedFiles;
+
 private:
     void setDefaults();
     LLStreamingAudioInterface *mStreamingAudioImpl;
@@ -380,17 +392,23 @@ class LLAudioData
     void setHasDecodeFailed(const bool hdf) { mHasDecodeFailed = hdf; }
     void setHasWAVLoadFailed(const bool hwlf) { mHasWAVLoadFailed = hwlf; }
 
+    // Decoded samples the engine's PCM cache could not hold, kept until the
+    // next load() puts them in a buffer
+    bool hasUncachedPCM() const { return (bool)mUncachedPCM; }
+    void setUncachedPCM(const LLAudioPCMCache::pcm_ptr_t& pcm) { mUncachedPCM = pcm; }
+
     friend class LLAudioEngine;  // Severe laziness, bad.
 
   protected:
     LLUUID         mID;
     LLAudioBuffer *mBufferp;             // If this data is being used by the audio system, a pointer to the buffer will be set here.
     bool           mHasLocalData;        // Set true if the encoded sound asset file is available locally
-    bool           mHasDecodedData;      // Set true if the decoded sound file is available on disk
+    bool           mHasDecodedData;      // Set true if the decoded sound is available in memory or on disk
     bool           mHasCompletedDecode;  // Set true when the sound is decoded
     bool           mHasDecodeFailed;     // Set true if decoding failed, meaning the sound asset is bad
     bool mHasWAVLoadFailed;  // Set true if loading the decoded WAV file failed, meaning the sound asset should be decoded instead if
                              // possible
+    LLAudioPCMCache::pcm_ptr_t mUncachedPCM;
 };
 
 
@@ -447,6 +465,7 @@ class LLAudioBuffer
 public:
     virtual ~LLAudioBuffer() {};
     virtual bool loadWAV(const std::string& filename) = 0;
+    virtual bool loadPCM(const LLAudioPCM& pcm) = 0;
     virtual U32 getLength() = 0;
 
     friend class LLAudioEngine;
@@ -371,6 +371,37 @@ bool LLAudioBufferOpenAL::loadWAV(const std::string& filename)
     return true;
 }
 
+bool LLAudioBufferOpenAL::loadPCM(const LLAudioPCM& pcm)
+{
+    cleanup();
+    if (pcm.getSize() == 0 || pcm.mChannels < 1 || pcm.mChannels > 2)
+    {
+        return false;
+    }
+
+    alGetError(); /* clear error */
+    alGenBuffers(1, &mALBuffer);
+    ALenum error = alGetError();
+    if (error != AL_NO_ERROR)
+    {
+        LL_WARNS() << "LLAudioBufferOpenAL::loadPCM() Error creating buffer: " << error << LL_ENDL;
+        mALBuffer = AL_NONE;
+        return false;
+    }
+
+    alBufferData(mALBuffer, pcm.mChannels == 2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16,
+                 pcm.getData(), (ALsizei)pcm.getSize(), pcm.mSampleRate);
+    error = alGetError();
+    if (error != AL_NO_ERROR)
+    {
+        LL_WARNS() << "LLAudioBufferOpenAL::loadPCM() Error loading buffer: " << error << LL_ENDL;
+        cleanup();
+        return false;
+    }
+
+    return true;
+}
+
 U32 LLAudioBufferOpenAL::getLength()
 {
     if(mALBuffer == AL_NONE)
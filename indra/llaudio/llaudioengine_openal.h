@@ -95,6 +95,7 @@ class LLAudioBufferOpenAL : public LLAudioBuffer{
         virtual ~LLAudioBufferOpenAL();
 
         bool loadWAV(const std::string& filename);
+        bool loadPCM(const LLAudioPCM& pcm);
         U32 getLength();
 
         friend class LLAudioChannelOpenAL;
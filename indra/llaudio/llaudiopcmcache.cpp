@@ -0,0 +1,112 @@
+/**
+ * @file llaudiopcmcache.cpp
+ * @brief In memory cache of decoded sound data.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llaudiopcmcache.h"
+
+#include "lltrace.h"
+
+static LLTrace::CountStatHandle<> sPCMCacheHits("audiopcmcachehits", "Sounds loaded from decoded audio kept in memory");
+static LLTrace::CountStatHandle<> sPCMCacheMisses("audiopcmcachemisses", "Sounds not found in the in memory decoded audio cache");
+static LLTrace::SampleStatHandle<F64Kilobytes> sPCMCacheBytes("audiopcmcachebytes", "Decoded audio held in memory");
+
+static const size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+LLAudioPCMCache::LLAudioPCMCache()
+:   mBytes(0),
+    mMaxBytes(DEFAULT_MAX_BYTES)
+{
+}
+
+void LLAudioPCMCache::setMaxBytes(size_t max_bytes)
+{
+    mMaxBytes = max_bytes;
+    evict(mMaxBytes);
+}
+
+bool LLAudioPCMCache::add(const LLUUID& uuid, pcm_ptr_t pcm)
+{
+    remove(uuid);
+    if (!pcm || pcm->getSize() > mMaxBytes)
+    {
+        return false;
+    }
+
+    evict(mMaxBytes - pcm->getSize());
+    mLRU.emplace_front(uuid, pcm);
+    mEntries[uuid] = mLRU.begin();
+    mBytes += pcm->getSize();
+    sample(sPCMCacheBytes, F64Bytes((F64)mBytes));
+    return true;
+}
+
+LLAudioPCMCache::pcm_ptr_t LLAudioPCMCache::get(const LLUUID& uuid)
+{
+    auto found = mEntries.find(uuid);
+    if (found == mEntries.end())
+    {
+        LLTrace::add(sPCMCacheMisses, 1);
+        return pcm_ptr_t();
+    }
+
+    LLTrace::add(sPCMCacheHits, 1);
+    mLRU.splice(mLRU.begin(), mLRU, found->second);
+    return found->second->second;
+}
+
+void LLAudioPCMCache::remove(const LLUUID& uuid)
+{
+    auto found = mEntries.find(uuid);
+    if (found != mEntries.end())
+    {
+        mBytes -= found->second->second->getSize();
+        mLRU.erase(found->second);
+        mEntries.erase(found);
+        sample(sPCMCacheBytes, F64Bytes((F64)mBytes));
+    }
+}
+
+void LLAudioPCMCache::clear()
+{
+    mLRU.clear();
+    mEntries.clear();
+    mBytes = 0;
+    sample(sPCMCacheBytes, F64Bytes(0.0));
+}
+
+void LLAudioPCMCache::evict(size_t max_bytes)
+{
+    while (mBytes > max_bytes && !mLRU.empty())
+    {
+        const lru_list_t::value_type& coldest = mLRU.back();
+        LL_DEBUGS("AudioEngine") << "Evicting decoded audio for " << coldest.first << LL_ENDL;
+        mBytes -= coldest.second->getSize();
+        mEntries.erase(coldest.first);
+        mLRU.pop_back();
+    }
+    sample(sPCMCacheBytes, F64Bytes((F64)mBytes));
+}
@@ -0,0 +1,97 @@
+/**
+ * @file llaudiopcmcache.h
+ * @brief In memory cache of decoded sound data.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLAUDIOPCMCACHE_H
+#define LL_LLAUDIOPCMCACHE_H
+
+#include "stdtypes.h"
+#include "lluuid.h"
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+//
+// A decoded sound: 16 bit signed little endian samples, held in the buffer
+// the decoder built, after mOffset bytes of WAV header.
+//
+struct LLAudioPCM
+{
+    LLAudioPCM() : mOffset(0), mChannels(1), mSampleRate(0) {}
+
+    const U8* getData() const   { return mBuffer.data() + mOffset; }
+    size_t getSize() const      { return mBuffer.size() - mOffset; }
+
+    std::vector<U8> mBuffer;
+    size_t mOffset;
+    S32 mChannels;
+    S32 mSampleRate;
+};
+
+//
+// Least recently used cache of decoded sounds by asset id, bounded by the
+// number of sample bytes held. Main thread only.
+//
+class LLAudioPCMCache
+{
+public:
+    typedef std::shared_ptr<const LLAudioPCM> pcm_ptr_t;
+
+    LLAudioPCMCache();
+
+    void setMaxBytes(size_t max_bytes);
+    size_t getMaxBytes() const          { return mMaxBytes; }
+
+    // Replaces any existing entry, then evicts from the cold end until the
+    // cache is back under its limit. A sound larger than the limit is not
+    // kept, and false returned: the caller has to hand it on itself.
+    bool add(const LLUUID& uuid, pcm_ptr_t pcm);
+
+    // Returns the entry and marks it most recently used, or an empty
+    // pointer. Counts a hit or a miss.
+    pcm_ptr_t get(const LLUUID& uuid);
+
+    // Does not count as a use.
+    bool has(const LLUUID& uuid) const  { return mEntries.find(uuid) != mEntries.end(); }
+
+    void remove(const LLUUID& uuid);
+    void clear();
+
+    size_t getBytes() const             { return mBytes; }
+    size_t size() const                 { return mEntries.size(); }
+
+private:
+    void evict(size_t max_bytes);
+
+    typedef std::list<std::pair<LLUUID, pcm_ptr_t> > lru_list_t;
+    lru_list_t mLRU; // most recently used first
+    std::unordered_map<LLUUID, lru_list_t::iterator> mEntries;
+    size_t mBytes;
+    size_t mMaxBytes;
+};
+
+#endif // LL_LLAUDIOPCMCACHE_H
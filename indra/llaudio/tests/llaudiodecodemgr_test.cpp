@@ -0,0 +1,288 @@
+/**
+ * @file llaudiodecodemgr_test.cpp
+ * @brief Vorbis decoding, and decoding one sound per work queue task.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llaudiodecodemgr.h"
+
+#include "../test/lltut.h"
+
+#include "lldir.h"
+#include "lldiriterator.h"
+#include "llfile.h"
+#include "llmath.h"
+#include "lltimer.h"
+#include "llvorbisencode.h"
+#include "threadpool.h"
+#include "workqueue.h"
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace tut
+{
+    struct LLAudioDecodeMgrData
+    {
+        LLAudioDecodeMgrData()
+        {
+            mDir = std::string(LLFile::tmpdir()) + "llaudiodecodemgr_test";
+            LLFile::mkdir(mDir);
+        }
+
+        ~LLAudioDecodeMgrData()
+        {
+            for (const std::string& filename : mCreated)
+            {
+                LLFile::remove(filename);
+            }
+            LLFile::rmdir(mDir);
+        }
+
+        // A mono 44.1kHz 16 bit tone, in the only format sound uploads take.
+        void writeTone(const std::string& filename, F32 seconds, F32 frequency)
+        {
+            const S32 samples = (S32)(seconds * LLVORBIS_CLIP_SAMPLE_RATE);
+            const U32 data_length = samples * 2;
+            std::vector<U8> wav(44 + data_length);
+            auto put32 = [&wav](S32 offset, U32 value)
+            {
+                for (S32 i = 0; i < 4; i++)
+                {
+                    wav[offset + i] = (value >> (8 * i)) & 0xFF;
+                }
+            };
+            auto put16 = [&wav](S32 offset, U16 value)
+            {
+                wav[offset] = value & 0xFF;
+                wav[offset + 1] = (value >> 8) & 0xFF;
+            };
+            memcpy(&wav[0], "RIFF", 4);
+            put32(4, 36 + data_length);
+            memcpy(&wav[8], "WAVEfmt ", 8);
+            put32(16, 16);
+            put16(20, 1);       // PCM
+            put16(22, 1);       // mono
+            put32(24, LLVORBIS_CLIP_SAMPLE_RATE);
+            put32(28, LLVORBIS_CLIP_SAMPLE_RATE * 2);
+            put16(32, 2);
+            put16(34, 16);
+            memcpy(&wav[36], "data", 4);
+            put32(40, data_length);
+            for (S32 i = 0; i < samples; i++)
+            {
+                F32 t = (F32)i / LLVORBIS_CLIP_SAMPLE_RATE;
+                put16(44 + i * 2, (U16)(S16)(8000.f * sinf(2.f * F_PI * frequency * t)));
+            }
+
+            LLFILE* fp = LLFile::fopen(filename, "wb");
+            ensure("tone written", fp != NULL);
+            fwrite(wav.data(), 1, wav.size(), fp);
+            fclose(fp);
+            mCreated.push_back(filename);
+        }
+
+        // Sounds to decode: LL_AUDIO_DECODE_DIR if set, otherwise a batch of
+        // short encoded tones like gesture and UI sounds.
+        std::vector<std::string> getSounds()
+        {
+            std::vector<std::string> sounds;
+            const char* dir = getenv("LL_AUDIO_DECODE_DIR");
+            if (dir && *dir)
+            {
+                LLDirIterator iter(dir, "*.ogg");
+                std::string name;
+                while (iter.next(name))
+                {
+                    sounds.push_back(gDirUtilp->add(dir, name));
+                }
+                return sounds;
+            }
+
+            for (S32 i = 0; i < 32; i++)
+            {
+                std::string wav = gDirUtilp->add(mDir, llformat("tone%d.wav", i));
+                std::string ogg = gDirUtilp->add(mDir, llformat("tone%d.ogg", i));
+                writeTone(wav, 0.25f + 0.1f * (i % 10), 220.f + 20.f * i);
+                ensure_equals("tone encoded", encode_vorbis_file(wav, ogg), LLVORBISENC_NOERR);
+                mCreated.push_back(ogg);
+                sounds.push_back(ogg);
+            }
+            return sounds;
+        }
+
+        std::string mDir;
+        std::vector<std::string> mCreated;
+    };
+
+    typedef test_group<LLAudioDecodeMgrData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llaudiodecodemgr_test_factory("LLAudioDecodeMgr");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        // a decoded tone comes back as mono 16 bit samples of the right length
+        std::string wav = gDirUtilp->add(mDir, "second.wav");
+        std::string ogg = gDirUtilp->add(mDir, "second.ogg");
+        writeTone(wav, 1.f, 440.f);
+        ensure_equals("encoded", encode_vorbis_file(wav, ogg), LLVORBISENC_NOERR);
+        mCreated.push_back(ogg);
+
+        LLAudioPCMCache::pcm_ptr_t pcm = decode_vorbis_file(ogg);
+        ensure("decoded", pcm.get() != NULL);
+        ensure_equals("channels", pcm->mChannels, 1);
+        ensure_equals("rate", pcm->mSampleRate, (S32)LLVORBIS_CLIP_SAMPLE_RATE);
+        // allow a block either way for encoder padding and trimming
+        S32 samples = (S32)pcm->getSize() / 2;
+        ensure("one second of samples", llabs(samples - (S32)LLVORBIS_CLIP_SAMPLE_RATE) < 4096);
+
+        ensure("garbage is rejected", !decode_vorbis_file(wav));
+        ensure("missing file is rejected", !decode_vorbis_file(gDirUtilp->add(mDir, "missing.ogg")));
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        // Decoding on a pool, the way LLAudioDecodeMgr does: every sound is
+        // decoded off this thread and its result handed back on this
+        // thread, with the same samples as a serial decode. The timings
+        // are only logged, as a benchmark; they are not checked, since
+        // build machines give no dependable number of free cores.
+        std::vector<std::string> sounds = getSounds();
+        ensure("sounds to decode", !sounds.empty());
+
+        LLTimer timer;
+        size_t serial_bytes = 0;
+        std::vector<LLAudioPCMCache::pcm_ptr_t> serial(sounds.size());
+        for (size_t i = 0; i < sounds.size(); i++)
+        {
+            serial[i] = decode_vorbis_file(sounds[i]);
+            ensure("decoded inline", serial[i].get() != NULL);
+            serial_bytes += serial[i]->getSize();
+        }
+        F64 serial_time = timer.getElapsedTimeF64();
+
+        LL::WorkQueue main_queue("LLAudioDecodeMgrTestMain");
+        LL::ThreadPool pool("LLAudioDecodeMgrTest", 4);
+        pool.start();
+        LL::WorkQueue::ptr_t pool_ptr = LL::WorkQueue::getInstance("LLAudioDecodeMgrTest");
+
+        timer.reset();
+        const std::thread::id main_thread = std::this_thread::get_id();
+        std::atomic<size_t> decoded_here(0);
+        size_t finished_elsewhere = 0;
+        size_t finished = 0;
+        size_t same_samples = 0;
+        for (size_t i = 0; i < sounds.size(); i++)
+        {
+            const std::string& sound = sounds[i];
+            LLAudioPCMCache::pcm_ptr_t expected = serial[i];
+            bool posted = main_queue.postTo(pool_ptr,
+                [sound, main_thread, &decoded_here]()
+                {
+                    if (std::this_thread::get_id() == main_thread)
+                    {
+                        decoded_here++;
+                    }
+                    return decode_vorbis_file(sound);
+                },
+                [&finished, &finished_elsewhere, &same_samples, expected, main_thread](LLAudioPCMCache::pcm_ptr_t pcm)
+                {
+                    if (std::this_thread::get_id() != main_thread)
+                    {
+                        finished_elsewhere++;
+                    }
+                    // header and samples, byte for byte
+                    if (pcm && pcm->mOffset == expected->mOffset && pcm->mBuffer == expected->mBuffer)
+                    {
+                        same_samples++;
+                    }
+                    finished++;
+                });
+            ensure("decode posted", posted);
+        }
+        // a lost completion fails here rather than hanging the build
+        LLTimer deadline;
+        while (finished < sounds.size() && deadline.getElapsedTimeF64() < 120.0)
+        {
+            main_queue.runFor(std::chrono::milliseconds(1));
+        }
+        F64 parallel_time = timer.getElapsedTimeF64();
+        size_t threads = pool.getWidth();
+        pool.close();
+
+        ensure_equals("every sound finished", finished, sounds.size());
+        ensure_equals("decoded on the pool", decoded_here.load(), (size_t)0);
+        ensure_equals("finished on this thread", finished_elsewhere, (size_t)0);
+        ensure_equals("same samples both ways", same_samples, sounds.size());
+
+        F64 seconds_of_audio = (F64)serial_bytes / (2.0 * LLVORBIS_CLIP_SAMPLE_RATE);
+        LL_INFOS("AudioEngine") << sounds.size() << " sounds, " << seconds_of_audio << "s of audio: serial "
+            << serial_time * 1000.0 << "ms (" << seconds_of_audio / serial_time << "x realtime), "
+            << threads << " threads " << parallel_time * 1000.0 << "ms ("
+            << seconds_of_audio / parallel_time << "x realtime)" << LL_ENDL;
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        // A .ogg made by another encoder (libsndfile): a 440Hz mono tone at
+        // amplitude 8000, a quarter second at 44.1kHz. It must decode to
+        // that tone, give or take the encoder's loss and the crossfade
+        // finishDecode() puts on the ends.
+        const std::string ogg = gDirUtilp->add(gDirUtilp->getDirName(__FILE__), "llaudiodecodemgr_tone440.ogg");
+        ensure("fixture found", LLFile::isfile(ogg));
+
+        LLAudioPCMCache::pcm_ptr_t pcm = decode_vorbis_file(ogg);
+        ensure("decoded", pcm.get() != NULL);
+        ensure_equals("channels", pcm->mChannels, 1);
+        ensure_equals("rate", pcm->mSampleRate, (S32)LLVORBIS_CLIP_SAMPLE_RATE);
+        const S32 samples = (S32)pcm->getSize() / 2;
+        ensure_equals("every sample, no padding", samples, (S32)(LLVORBIS_CLIP_SAMPLE_RATE / 4));
+
+        const U8* data = pcm->getData();
+        auto sample_at = [data](S32 i) { return (S16)(data[i * 2] | (data[i * 2 + 1] << 8)); };
+        const S32 FADE = 128;
+        F64 error = 0.0;
+        for (S32 i = FADE; i < samples - FADE; i++)
+        {
+            F64 expected = 8000.0 * sin(2.0 * F_PI * 440.0 * i / LLVORBIS_CLIP_SAMPLE_RATE);
+            error += (sample_at(i) - expected) * (sample_at(i) - expected);
+        }
+        // well under 2% of the amplitude; libsndfile's own decode is at 0.7%
+        F64 rms_error = sqrt(error / (samples - 2 * FADE));
+        ensure("the tone", rms_error < 160.0);
+        ensure_equals("faded in", sample_at(0), (S16)0);
+    }
+}
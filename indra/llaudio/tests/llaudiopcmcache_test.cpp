@@ -0,0 +1,151 @@
+/**
+ * @file llaudiopcmcache_test.cpp
+ * @brief Tests for the in memory cache of decoded sound data.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llaudiopcmcache.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+    struct LLAudioPCMCacheData
+    {
+        // samples bytes of sound after a 44 byte WAV header
+        LLAudioPCMCache::pcm_ptr_t makePCM(size_t bytes)
+        {
+            std::shared_ptr<LLAudioPCM> pcm = std::make_shared<LLAudioPCM>();
+            pcm->mOffset = 44;
+            pcm->mBuffer.resize(pcm->mOffset + bytes);
+            pcm->mSampleRate = 44100;
+            return pcm;
+        }
+
+        LLUUID mIDs[4] = { LLUUID::generateNewID(), LLUUID::generateNewID(), LLUUID::generateNewID(), LLUUID::generateNewID() };
+    };
+
+    typedef test_group<LLAudioPCMCacheData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llaudiopcmcache_test_factory("LLAudioPCMCache");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        // the least recently used sound goes first, headers not counted
+        LLAudioPCMCache cache;
+        cache.setMaxBytes(3000);
+        ensure("added", cache.add(mIDs[0], makePCM(1000)));
+        ensure("added", cache.add(mIDs[1], makePCM(1000)));
+        ensure("added", cache.add(mIDs[2], makePCM(1000)));
+        ensure_equals("sample bytes", cache.getBytes(), (size_t)3000);
+
+        // a use makes the oldest the newest, has() does not
+        ensure("hit", (bool)cache.get(mIDs[0]));
+        ensure("has", cache.has(mIDs[1]));
+        ensure("added", cache.add(mIDs[3], makePCM(1000)));
+        ensure("coldest evicted", !cache.has(mIDs[1]));
+        ensure("used entry kept", cache.has(mIDs[0]));
+        ensure("others kept", cache.has(mIDs[2]) && cache.has(mIDs[3]));
+        ensure_equals("still full", cache.getBytes(), (size_t)3000);
+        ensure("miss", !cache.get(mIDs[1]));
+
+        // replacing an entry does not count it twice
+        ensure("replaced", cache.add(mIDs[2], makePCM(500)));
+        ensure_equals("replacement size", cache.getBytes(), (size_t)2500);
+        ensure_equals("entries", cache.size(), (size_t)3);
+
+        // a larger sound evicts as many as it takes, oldest first
+        ensure("added", cache.add(mIDs[1], makePCM(2000)));
+        ensure("mIDs[0] evicted", !cache.has(mIDs[0]));
+        ensure("mIDs[3] evicted", !cache.has(mIDs[3]));
+        ensure("newest kept", cache.has(mIDs[2]) && cache.has(mIDs[1]));
+        ensure_equals("bytes after eviction", cache.getBytes(), (size_t)2500);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        // a sound larger than the whole cache is refused without evicting
+        // anything, so the caller knows to keep it itself
+        LLAudioPCMCache cache;
+        cache.setMaxBytes(2000);
+        ensure("added", cache.add(mIDs[0], makePCM(1500)));
+        ensure("oversized refused", !cache.add(mIDs[1], makePCM(2001)));
+        ensure("not kept", !cache.has(mIDs[1]));
+        ensure("nothing evicted", cache.has(mIDs[0]));
+        ensure_equals("bytes unchanged", cache.getBytes(), (size_t)1500);
+        ensure("exactly the limit fits", cache.add(mIDs[2], makePCM(2000)));
+        ensure("evicted for it", !cache.has(mIDs[0]));
+
+        // a replacement too big for the cache drops the old entry
+        ensure("oversized replacement refused", !cache.add(mIDs[2], makePCM(4000)));
+        ensure("old entry gone", !cache.has(mIDs[2]));
+        ensure_equals("empty", cache.getBytes(), (size_t)0);
+        ensure("empty pointer refused", !cache.add(mIDs[3], LLAudioPCMCache::pcm_ptr_t()));
+
+        // AudioDecodedCacheSize 0 keeps nothing
+        cache.setMaxBytes(0);
+        ensure("nothing fits", !cache.add(mIDs[0], makePCM(1)));
+        ensure_equals("no entries", cache.size(), (size_t)0);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        // shrinking evicts down to the new limit, coldest first
+        LLAudioPCMCache cache;
+        cache.setMaxBytes(4000);
+        for (S32 i = 0; i < 4; i++)
+        {
+            ensure("added", cache.add(mIDs[i], makePCM(1000)));
+        }
+        cache.get(mIDs[0]);
+        cache.setMaxBytes(2500);
+        ensure_equals("limit", cache.getMaxBytes(), (size_t)2500);
+        ensure_equals("under the new limit", cache.getBytes(), (size_t)2000);
+        ensure("coldest gone", !cache.has(mIDs[1]) && !cache.has(mIDs[2]));
+        ensure("warmest kept", cache.has(mIDs[0]) && cache.has(mIDs[3]));
+
+        // growing evicts nothing and takes more
+        cache.setMaxBytes(5000);
+        ensure_equals("nothing evicted", cache.size(), (size_t)2);
+        ensure("added", cache.add(mIDs[1], makePCM(3000)));
+        ensure_equals("full", cache.getBytes(), (size_t)5000);
+
+        cache.remove(mIDs[0]);
+        ensure_equals("removed", cache.getBytes(), (size_t)4000);
+        cache.clear();
+        ensure_equals("cleared", cache.getBytes(), (size_t)0);
+        ensure("no entries", !cache.has(mIDs[1]) && !cache.has(mIDs[3]));
+    }
+}
@@ -170,7 +170,7 @@ void LLCharacter::requestStopMotion( LLMotion* motion)
 //-----------------------------------------------------------------------------
 // updateMotions()
 //-----------------------------------------------------------------------------
-void LLCharacter::updateMotions(e_update_t update_type)
+void LLCharacter::updateMotions(e_update_t update_type, F32 interp_time)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
     if (update_type == HIDDEN_UPDATE)
@@ -186,7 +186,7 @@ void LLCharacter::updateMotions(e_update_t update_type)
         }
         bool force_update = (update_type == FORCE_UPDATE);
         {
-            mMotionController.updateMotions(force_update);
+            mMotionController.updateMotions(force_update, interp_time);
         }
     }
 }
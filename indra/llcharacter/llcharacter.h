@@ -152,8 +152,10 @@ public:
     virtual void requestStopMotion( LLMotion* motion );
 
     // periodic update function, steps the motion controller
+    // interp_time, if set, eases the skeleton into the new pose, see
+    // LLMotionController::interpolateMotions()
     enum e_update_t { NORMAL_UPDATE, HIDDEN_UPDATE, FORCE_UPDATE };
-    void updateMotions(e_update_t update_type);
+    void updateMotions(e_update_t update_type, F32 interp_time = 0.f);
 
     LLAnimPauseRequest requestPause();
     bool areAnimationsPaused() const { return mMotionController.isPaused(); }
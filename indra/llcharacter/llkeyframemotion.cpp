@@ -39,6 +39,7 @@
 #include "llendianswizzle.h"
 #include "llkeyframemotion.h"
 #include "llquantize.h"
+#include "llvector4a.h"
 #include "m3math.h"
 #include "message.h"
 #include "llfilesystem.h"
@@ -47,6 +48,8 @@
 // Static Definitions
 //-----------------------------------------------------------------------------
 LLKeyframeDataCache::keyframe_data_map_t    LLKeyframeDataCache::sKeyframeDataMap;
+U64 LLKeyframeMotion::JointMotionList::sSamplesComputed = 0;
+U64 LLKeyframeMotion::JointMotionList::sSamplesShared = 0;
 
 //-----------------------------------------------------------------------------
 // Globals
@@ -73,7 +76,8 @@ LLKeyframeMotion::JointMotionList::JointMotionList()
       mEaseOutDuration(0.f),
       mBasePriority(LLJoint::LOW_PRIORITY),
       mHandPose(LLHandMotion::HAND_POSE_SPREAD),
-      mMaxPriority(LLJoint::LOW_PRIORITY)
+      mMaxPriority(LLJoint::LOW_PRIORITY),
+      mActiveInstances(0)
 {
 }
 
@@ -128,6 +132,70 @@ U32 LLKeyframeMotion::JointMotionList::dumpDiagInfo()
 //-----------------------------------------------------------------------------
 
 
+//-----------------------------------------------------------------------------
+// locate_keys()
+// Finds the keys around time in a sorted key time array, starting from where
+// the previous lookup through cursor ended. Returns true and the weight of
+// the later key if time falls between two keys, or false if the key at
+// before should be used as is (before the first key, after the last one or
+// exactly on a key). times must not be empty.
+//-----------------------------------------------------------------------------
+static bool locate_keys(const std::vector<F32>& times, F32 time, U32& cursor, U32& before, U32& after, F32& u)
+{
+    const U32 count = (U32)times.size();
+    U32 right = llmin(cursor, count);
+
+    // forward playback mostly stays between the same keys or moves on by one
+    for (U32 step = 0; step < 2 && right < count && times[right] < time; step++)
+    {
+        right++;
+    }
+    if ((right < count && times[right] < time) || (right > 0 && times[right - 1] >= time))
+    {
+        // jumped (scrubbing, looping back), search the whole curve
+        right = (U32)(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+    }
+    cursor = right;
+
+    if (right == count)
+    {
+        // Past last key
+        before = count - 1;
+        return false;
+    }
+    if (right == 0 || times[right] == time)
+    {
+        // Before first key or exactly on a key
+        before = right;
+        return false;
+    }
+    // Between two keys
+    before = right - 1;
+    after = right;
+    u = (time - times[before]) / (times[after] - times[before]);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// insert_key()
+// Adds a key to a sorted curve, a key at the same time replaces the old one.
+//-----------------------------------------------------------------------------
+template <typename T>
+static void insert_key(std::vector<F32>& times, std::vector<T>& values, F32 time, const T& value)
+{
+    std::vector<F32>::iterator found = std::lower_bound(times.begin(), times.end(), time);
+    const size_t index = found - times.begin();
+    if (found != times.end() && *found == time)
+    {
+        values[index] = value;
+    }
+    else
+    {
+        times.insert(found, time);
+        values.insert(values.begin() + index, value);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // ScaleCurve::ScaleCurve()
 //-----------------------------------------------------------------------------
@@ -142,7 +210,8 @@ LLKeyframeMotion::ScaleCurve::ScaleCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::ScaleCurve::~ScaleCurve()
 {
-    mKeys.clear();
+    mKeyTimes.clear();
+    mKeyScales.clear();
     mNumKeys = 0;
 }
 
@@ -151,63 +220,51 @@ LLKeyframeMotion::ScaleCurve::~ScaleCurve()
 //-----------------------------------------------------------------------------
 LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration)
 {
-    LLVector3 value;
+    U32 cursor = 0;
+    return getValue(time, duration, cursor);
+}
 
-    if (mKeys.empty())
+LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration, U32& cursor)
+{
+    if (mKeyTimes.empty())
     {
-        value.clearVec();
-        return value;
+        return LLVector3::zero;
     }
 
-    key_map_t::iterator right = mKeys.lower_bound(time);
-    if (right == mKeys.end())
-    {
-        // Past last key
-        --right;
-        value = right->second.mScale;
-    }
-    else if (right == mKeys.begin() || right->first == time)
-    {
-        // Before first key or exactly on a key
-        value = right->second.mScale;
-    }
-    else
+    U32 before, after;
+    F32 u;
+    if (!locate_keys(mKeyTimes, time, cursor, before, after, u))
     {
-        // Between two keys
-        key_map_t::iterator left = right; --left;
-        F32 index_before = left->first;
-        F32 index_after = right->first;
-        ScaleKey& scale_before = left->second;
-        ScaleKey& scale_after = right->second;
-        if (right == mKeys.end())
-        {
-            scale_after = mLoopInKey;
-            index_after = duration;
-        }
-
-        F32 u = (time - index_before) / (index_after - index_before);
-        value = interp(u, scale_before, scale_after);
+        return mKeyScales[before];
     }
-    return value;
+    return interp(u, mKeyScales[before], mKeyScales[after]);
 }
 
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, ScaleKey& before, ScaleKey& after)
+LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, const LLVector3& before, const LLVector3& after)
 {
     switch (mInterpolationType)
     {
     case IT_STEP:
-        return before.mScale;
+        return before;
 
     default:
     case IT_LINEAR:
     case IT_SPLINE:
-        return lerp(before.mScale, after.mScale, u);
+        return lerp(before, after, u);
     }
 }
 
+//-----------------------------------------------------------------------------
+// setKey()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::ScaleCurve::setKey(const ScaleKey& key)
+{
+    insert_key(mKeyTimes, mKeyScales, key.mTime, key.mScale);
+}
+
 //-----------------------------------------------------------------------------
 // RotationCurve::RotationCurve()
 //-----------------------------------------------------------------------------
@@ -222,7 +279,8 @@ LLKeyframeMotion::RotationCurve::RotationCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::RotationCurve::~RotationCurve()
 {
-    mKeys.clear();
+    mKeyTimes.clear();
+    mKeyRotations.clear();
     mNumKeys = 0;
 }
 
@@ -231,63 +289,51 @@ LLKeyframeMotion::RotationCurve::~RotationCurve()
 //-----------------------------------------------------------------------------
 LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
 {
-    LLQuaternion value;
+    U32 cursor = 0;
+    return getValue(time, duration, cursor);
+}
 
-    if (mKeys.empty())
+LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration, U32& cursor)
+{
+    if (mKeyTimes.empty())
     {
-        value = LLQuaternion::DEFAULT;
-        return value;
+        return LLQuaternion::DEFAULT;
     }
 
-    key_map_t::iterator right = mKeys.lower_bound(time);
-    if (right == mKeys.end())
+    U32 before, after;
+    F32 u;
+    if (!locate_keys(mKeyTimes, time, cursor, before, after, u))
     {
-        // Past last key
-        --right;
-        value = right->second.mRotation;
+        return mKeyRotations[before];
     }
-    else if (right == mKeys.begin() || right->first == time)
-    {
-        // Before first key or exactly on a key
-        value = right->second.mRotation;
-    }
-    else
-    {
-        // Between two keys
-        key_map_t::iterator left = right; --left;
-        F32 index_before = left->first;
-        F32 index_after = right->first;
-        RotationKey& rot_before = left->second;
-        RotationKey& rot_after = right->second;
-        if (right == mKeys.end())
-        {
-            rot_after = mLoopInKey;
-            index_after = duration;
-        }
-
-        F32 u = (time - index_before) / (index_after - index_before);
-        value = interp(u, rot_before, rot_after);
-    }
-    return value;
+    return interp(u, mKeyRotations[before], mKeyRotations[after]);
 }
 
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, RotationKey& before, RotationKey& after)
+LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, const LLQuaternion& before, const LLQuaternion& after)
 {
     switch (mInterpolationType)
     {
     case IT_STEP:
-        return before.mRotation;
+        return before;
 
     default:
     case IT_LINEAR:
     case IT_SPLINE:
-        return nlerp(u, before.mRotation, after.mRotation);
+        return nlerp(u, before, after);
     }
 }
 
+//-----------------------------------------------------------------------------
+// setKey()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::RotationCurve::setKey(const RotationKey& key)
+{
+    insert_key(mKeyTimes, mKeyRotations, key.mTime, key.mRotation);
+}
+
 
 //-----------------------------------------------------------------------------
 // PositionCurve::PositionCurve()
@@ -303,7 +349,8 @@ LLKeyframeMotion::PositionCurve::PositionCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::PositionCurve::~PositionCurve()
 {
-    mKeys.clear();
+    mKeyTimes.clear();
+    mKeyPositions.clear();
     mNumKeys = 0;
 }
 
@@ -312,42 +359,27 @@ LLKeyframeMotion::PositionCurve::~PositionCurve()
 //-----------------------------------------------------------------------------
 LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
 {
-    LLVector3 value;
+    U32 cursor = 0;
+    return getValue(time, duration, cursor);
+}
 
-    if (mKeys.empty())
+LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration, U32& cursor)
+{
+    if (mKeyTimes.empty())
     {
-        value.clearVec();
-        return value;
+        return LLVector3::zero;
     }
 
-    key_map_t::iterator right = mKeys.lower_bound(time);
-    if (right == mKeys.end())
-    {
-        // Past last key
-        --right;
-        value = right->second.mPosition;
-    }
-    else if (right == mKeys.begin() || right->first == time)
+    LLVector3 value;
+    U32 before, after;
+    F32 u;
+    if (!locate_keys(mKeyTimes, time, cursor, before, after, u))
     {
-        // Before first key or exactly on a key
-        value = right->second.mPosition;
+        value = mKeyPositions[before];
     }
     else
     {
-        // Between two keys
-        key_map_t::iterator left = right; --left;
-        F32 index_before = left->first;
-        F32 index_after = right->first;
-        PositionKey& pos_before = left->second;
-        PositionKey& pos_after = right->second;
-        if (right == mKeys.end())
-        {
-            pos_after = mLoopInKey;
-            index_after = duration;
-        }
-
-        F32 u = (time - index_before) / (index_after - index_before);
-        value = interp(u, pos_before, pos_after);
+        value = interp(u, mKeyPositions[before], mKeyPositions[after]);
     }
 
     llassert(value.isFinite());
@@ -358,19 +390,27 @@ LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, PositionKey& after)
+LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, const LLVector3& before, const LLVector3& after)
 {
     switch (mInterpolationType)
     {
     case IT_STEP:
-        return before.mPosition;
+        return before;
     default:
     case IT_LINEAR:
     case IT_SPLINE:
-        return lerp(before.mPosition, after.mPosition, u);
+        return lerp(before, after, u);
     }
 }
 
+//-----------------------------------------------------------------------------
+// setKey()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::PositionCurve::setKey(const PositionKey& key)
+{
+    insert_key(mKeyTimes, mKeyPositions, key.mTime, key.mPosition);
+}
+
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -418,6 +458,272 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 }
 
 
+//-----------------------------------------------------------------------------
+// nlerp_block()
+// RotationCurve::interp() for count pairs of keys at once. Four pairs at a
+// time are transposed so each register holds one component of four
+// quaternions, then lerped and renormalized together. Pairs in opposite
+// hemispheres take the scalar slerp like nlerp() does, as does the tail.
+//-----------------------------------------------------------------------------
+static void nlerp_block(U32 count, const LLVector4a* from, const LLVector4a* to, const F32* weight, LLQuaternion* result)
+{
+    U32 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        LLQuad f0 = from[i], f1 = from[i + 1], f2 = from[i + 2], f3 = from[i + 3];
+        LLQuad t0 = to[i], t1 = to[i + 1], t2 = to[i + 2], t3 = to[i + 3];
+        _MM_TRANSPOSE4_PS(f0, f1, f2, f3);
+        _MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+        const LLVector4a from_c[4] = { f0, f1, f2, f3 };
+        const LLVector4a to_c[4] = { t0, t1, t2, t3 };
+
+        LLVector4a w;
+        w.loadua(weight + i);
+
+        LLVector4a dot = LLVector4a::getZero();
+        LLVector4a len_sqrd = LLVector4a::getZero();
+        LLVector4a blend[4];
+        for (U32 c = 0; c < 4; c++)
+        {
+            LLVector4a term;
+            term.setMul(from_c[c], to_c[c]);
+            dot.add(term);
+
+            // from + w * (to - from), as LLVector4a::setLerp() does
+            blend[c].setSub(to_c[c], from_c[c]);
+            blend[c].mul(w);
+            blend[c].add(from_c[c]);
+            term.setMul(blend[c], blend[c]);
+            len_sqrd.add(term);
+        }
+
+        LLVector4a len;
+        len = _mm_sqrt_ps(len_sqrd);
+        LLQuad rows[4];
+        for (U32 c = 0; c < 4; c++)
+        {
+            LLVector4a normalized;
+            normalized.setDiv(blend[c], len);
+            rows[c] = normalized;
+        }
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+
+        const U32 opposite = dot.lessThan(LLVector4a::getZero()).getGatheredBits();
+        for (U32 k = 0; k < 4; k++)
+        {
+            if (opposite & (1 << k))
+            {
+                result[i + k] = slerp(weight[i + k], LLQuaternion(from[i + k].getF32ptr()), LLQuaternion(to[i + k].getF32ptr()));
+            }
+            else
+            {
+                LLVector4a row;
+                row = rows[k];
+                result[i + k] = LLQuaternion(row.getF32ptr());
+            }
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        if (from[i].dot4(to[i]).getF32() < 0.f)
+        {
+            result[i] = slerp(weight[i], LLQuaternion(from[i].getF32ptr()), LLQuaternion(to[i].getF32ptr()));
+        }
+        else
+        {
+            LLVector4a blend;
+            blend.setLerp(from[i], to[i], weight[i]);
+            blend.normalize4();
+            result[i] = LLQuaternion(blend.getF32ptr());
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// JointMotionList::sampleJoints()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::JointMotionList::sampleJoints(F32 time, const LLPointer<LLJointState>* joint_states, KeyCursor* cursors, U32& sample_slot)
+{
+    if (mActiveInstances < 2)
+    {
+        // nobody to share with, skip the copy
+        computeSample(time, cursors, joint_states, NULL);
+        return;
+    }
+
+    const Sample& sample = getSample(time, cursors, sample_slot);
+
+    const U32 count = getNumJointMotions();
+    for (U32 i = 0; i < count; i++)
+    {
+        LLJointState* joint_state = joint_states[i];
+        if (!joint_state)
+        {
+            continue;
+        }
+        const JointMotion* joint_motion = mJointMotionArray[i];
+        const U32 usage = joint_state->getUsage();
+
+        if ((usage & LLJointState::SCALE) && joint_motion->mScaleCurve.mNumKeys)
+        {
+            joint_state->setScale(sample.mScales[i]);
+        }
+        if ((usage & LLJointState::ROT) && joint_motion->mRotationCurve.mNumKeys)
+        {
+            joint_state->setRotation(sample.mRotations[i]);
+        }
+        if ((usage & LLJointState::POS) && joint_motion->mPositionCurve.mNumKeys)
+        {
+            joint_state->setPosition(sample.mPositions[i]);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// JointMotionList::getSample()
+//-----------------------------------------------------------------------------
+const LLKeyframeMotion::JointMotionList::Sample& LLKeyframeMotion::JointMotionList::getSample(F32 time, KeyCursor* cursors, U32& sample_slot)
+{
+    // the curves never change once loaded; a millisecond off is well below
+    // anything keyed at animation frame rates. Look from the caller's last
+    // slot on, where the instances it plays in step with have written.
+    for (U32 i = 0; i < SAMPLE_CACHE_SIZE; i++)
+    {
+        const U32 slot = (sample_slot + i) % SAMPLE_CACHE_SIZE;
+        if (mSamples[slot].mTime >= 0.f && fabsf(mSamples[slot].mTime - time) <= SAMPLE_TIME_TOLERANCE)
+        {
+            sample_slot = slot;
+            sSamplesShared++;
+            return mSamples[slot];
+        }
+    }
+
+    // the oldest sample this caller knows of
+    sample_slot = (sample_slot + 1) % SAMPLE_CACHE_SIZE;
+    Sample& sample = mSamples[sample_slot];
+    sample.mTime = time;
+    computeSample(time, cursors, NULL, &sample);
+    sSamplesComputed++;
+    return sample;
+}
+
+//-----------------------------------------------------------------------------
+// JointMotionList::computeSample()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::JointMotionList::computeSample(F32 time, KeyCursor* cursors, const LLPointer<LLJointState>* joint_states, Sample* sample) const
+{
+    const U32 BLOCK_SIZE = 16;
+    LLVector4a from[BLOCK_SIZE];
+    LLVector4a to[BLOCK_SIZE];
+    F32 weight[BLOCK_SIZE];
+    LLQuaternion blended[BLOCK_SIZE];
+    U32 targets[BLOCK_SIZE];
+    U32 pending = 0;
+
+    const U32 count = getNumJointMotions();
+    if (sample)
+    {
+        sample->mScales.resize(count);
+        sample->mRotations.resize(count);
+        sample->mPositions.resize(count);
+    }
+    auto set_rotation = [&](U32 i, const LLQuaternion& rot)
+    {
+        if (sample)
+        {
+            sample->mRotations[i] = rot;
+        }
+        else
+        {
+            LLJointState* joint_state = joint_states[i];
+            joint_state->setRotation(rot);
+        }
+    };
+
+    for (U32 i = 0; i < count; i++)
+    {
+        // a sample holds every channel, joint states only what they use
+        U32 usage = LLJointState::SCALE | LLJointState::ROT | LLJointState::POS;
+        LLJointState* joint_state = NULL;
+        if (!sample)
+        {
+            joint_state = joint_states[i];
+            if (!joint_state)
+            {
+                continue;
+            }
+            usage = joint_state->getUsage();
+        }
+        JointMotion* joint_motion = mJointMotionArray[i];
+        KeyCursor& cursor = cursors[i];
+
+        if ((usage & LLJointState::SCALE) && joint_motion->mScaleCurve.mNumKeys)
+        {
+            LLVector3 scale = joint_motion->mScaleCurve.getValue(time, mDuration, cursor.mScale);
+            if (sample)
+            {
+                sample->mScales[i] = scale;
+            }
+            else
+            {
+                joint_state->setScale(scale);
+            }
+        }
+
+        if ((usage & LLJointState::ROT) && joint_motion->mRotationCurve.mNumKeys)
+        {
+            const RotationCurve& curve = joint_motion->mRotationCurve;
+            U32 before, after;
+            F32 u;
+            if (curve.mKeyTimes.empty())
+            {
+                set_rotation(i, LLQuaternion::DEFAULT);
+            }
+            else if (!locate_keys(curve.mKeyTimes, time, cursor.mRotation, before, after, u)
+                     || curve.mInterpolationType == IT_STEP)
+            {
+                set_rotation(i, curve.mKeyRotations[before]);
+            }
+            else
+            {
+                from[pending].loadua(curve.mKeyRotations[before].mQ);
+                to[pending].loadua(curve.mKeyRotations[after].mQ);
+                weight[pending] = u;
+                targets[pending] = i;
+                if (++pending == BLOCK_SIZE)
+                {
+                    nlerp_block(pending, from, to, weight, blended);
+                    for (U32 j = 0; j < pending; j++)
+                    {
+                        set_rotation(targets[j], blended[j]);
+                    }
+                    pending = 0;
+                }
+            }
+        }
+
+        if ((usage & LLJointState::POS) && joint_motion->mPositionCurve.mNumKeys)
+        {
+            LLVector3 position = joint_motion->mPositionCurve.getValue(time, mDuration, cursor.mPosition);
+            if (sample)
+            {
+                sample->mPositions[i] = position;
+            }
+            else
+            {
+                joint_state->setPosition(position);
+            }
+        }
+    }
+
+    nlerp_block(pending, from, to, weight, blended);
+    for (U32 j = 0; j < pending; j++)
+    {
+        set_rotation(targets[j], blended[j]);
+    }
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 // LLKeyframeMotion class
@@ -431,12 +737,14 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 LLKeyframeMotion::LLKeyframeMotion(const LLUUID &id)
     : LLMotion(id),
         mJointMotionList(nullptr),
+        mSampleSlot(0),
         mPelvisp(nullptr),
         mCharacter(nullptr),
         mLastSkeletonSerialNum(0),
         mLastUpdateTime(0.f),
         mLastLoopedTime(0.f),
-        mAssetStatus(ASSET_UNDEFINED)
+        mAssetStatus(ASSET_UNDEFINED),
+        mCountedActive(false)
 {
 
 }
@@ -448,6 +756,13 @@ LLKeyframeMotion::LLKeyframeMotion(const LLUUID &id)
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::~LLKeyframeMotion()
 {
+    // LLMotionController::deleteAllMotions() deletes active motions without
+    // deactivating them. The list is still ours even if LLKeyframeDataCache
+    // was cleared first, as it is at shutdown before preview avatars go.
+    if (mCountedActive)
+    {
+        mJointMotionList->removeActiveInstance();
+    }
     for_each(mConstraints.begin(), mConstraints.end(), DeletePointer());
     mConstraints.clear();
 }
@@ -675,6 +990,13 @@ bool LLKeyframeMotion::onActivate()
 
     mLastLoopedTime = 0.f;
 
+    // reactivating an active motion restarts it, it is still one instance
+    if (!mCountedActive)
+    {
+        mJointMotionList->addActiveInstance();
+        mCountedActive = true;
+    }
+
     return true;
 }
 
@@ -736,12 +1058,11 @@ bool LLKeyframeMotion::onUpdate(F32 time, U8* joint_mask)
 void LLKeyframeMotion::applyKeyframes(F32 time)
 {
     llassert_always (mJointMotionList->getNumJointMotions() <= mJointStates.size());
-    for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
+    if (mKeyCursors.size() != mJointMotionList->getNumJointMotions())
     {
-        mJointMotionList->getJointMotion(i)->update(mJointStates[i],
-                                                      time,
-                                                      mJointMotionList->mDuration );
+        mKeyCursors.assign(mJointMotionList->getNumJointMotions(), KeyCursor());
     }
+    mJointMotionList->sampleJoints(time, mJointStates.data(), mKeyCursors.data(), mSampleSlot);
 
     LLJoint::JointPriority* pose_priority = (LLJoint::JointPriority* )mCharacter->getAnimationData("Hand Pose Priority");
     if (pose_priority)
@@ -792,6 +1113,12 @@ void LLKeyframeMotion::onDeactivate()
     {
         deactivateConstraint(constraintp);
     }
+
+    if (mCountedActive)
+    {
+        mJointMotionList->removeActiveInstance();
+        mCountedActive = false;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -1229,7 +1556,7 @@ void LLKeyframeMotion::applyConstraint(JointConstraint* constraint, F32 time, U8
 bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, bool allow_invalid_joints)
 {
     bool old_version = false;
-    std::unique_ptr<LLKeyframeMotion::JointMotionList> joint_motion_list(new LLKeyframeMotion::JointMotionList);
+    LLPointer<LLKeyframeMotion::JointMotionList> joint_motion_list = new LLKeyframeMotion::JointMotionList;
 
     //-------------------------------------------------------------------------
     // get base priority
@@ -1661,14 +1988,14 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
                 return false;
             }
 
-            rCurve->mKeys[time] = rot_key;
+            rCurve->setKey(rot_key);
         }
 
-        if (joint_motion->mRotationCurve.mNumKeys > joint_motion->mRotationCurve.mKeys.size())
+        if (joint_motion->mRotationCurve.mNumKeys > joint_motion->mRotationCurve.mKeyTimes.size())
         {
             rotation_duplicates++;
             LL_INFOS() << "Motion " << asset() << " had duplicated rotation keys that were removed: "
-                << joint_motion->mRotationCurve.mNumKeys << " > " << joint_motion->mRotationCurve.mKeys.size()
+                << joint_motion->mRotationCurve.mNumKeys << " > " << joint_motion->mRotationCurve.mKeyTimes.size()
                 << " (" << rotation_duplicates << ")" << LL_ENDL;
         }
 
@@ -1770,7 +2097,7 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
                 return false;
             }
 
-            pCurve->mKeys[pos_key.mTime] = pos_key;
+            pCurve->setKey(pos_key);
 
             if (is_pelvis)
             {
@@ -1778,11 +2105,11 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
             }
         }
 
-        if (joint_motion->mPositionCurve.mNumKeys > joint_motion->mPositionCurve.mKeys.size())
+        if (joint_motion->mPositionCurve.mNumKeys > joint_motion->mPositionCurve.mKeyTimes.size())
         {
             position_duplicates++;
             LL_INFOS() << "Motion " << asset() << " had duplicated position keys that were removed: "
-                << joint_motion->mPositionCurve.mNumKeys << " > " << joint_motion->mPositionCurve.mKeys.size()
+                << joint_motion->mPositionCurve.mNumKeys << " > " << joint_motion->mPositionCurve.mKeyTimes.size()
                 << " (" << position_duplicates << ")" << LL_ENDL;
         }
 
@@ -2031,7 +2358,13 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
     }
 
     // *FIX: support cleanup of old keyframe data
-    mJointMotionList = joint_motion_list.release(); // release from unique_ptr to member;
+    if (mCountedActive)
+    {
+        // still playing, now from the new list
+        mJointMotionList->removeActiveInstance();
+        joint_motion_list->addActiveInstance();
+    }
+    mJointMotionList = joint_motion_list;
     LLKeyframeDataCache::addKeyframeData(getID(),  mJointMotionList);
     mAssetStatus = ASSET_LOADED;
 
@@ -2080,19 +2413,20 @@ bool LLKeyframeMotion::serialize(LLDataPacker& dp) const
         JointMotion* joint_motionp = mJointMotionList->getJointMotion(i);
         success &= dp.packString(joint_motionp->mJointName, "joint_name");
         success &= dp.packS32(joint_motionp->mPriority, "joint_priority");
-        success &= dp.packS32(static_cast<S32>(joint_motionp->mRotationCurve.mKeys.size()), "num_rot_keys");
+        success &= dp.packS32(static_cast<S32>(joint_motionp->mRotationCurve.mKeyTimes.size()), "num_rot_keys");
 
         LL_DEBUGS("BVH") << "Joint " << i
             << " name: " << joint_motionp->mJointName
-            << " Rotation keys: " << joint_motionp->mRotationCurve.mKeys.size()
-            << " Position keys: " << joint_motionp->mPositionCurve.mKeys.size() << LL_ENDL;
-        for (RotationCurve::key_map_t::value_type& rot_pair : joint_motionp->mRotationCurve.mKeys)
+            << " Rotation keys: " << joint_motionp->mRotationCurve.mKeyTimes.size()
+            << " Position keys: " << joint_motionp->mPositionCurve.mKeyTimes.size() << LL_ENDL;
+        RotationCurve& rot_curve = joint_motionp->mRotationCurve;
+        for (size_t k = 0; k < rot_curve.mKeyTimes.size(); k++)
         {
-            RotationKey& rot_key = rot_pair.second;
-            U16 time_short = F32_to_U16(rot_key.mTime, 0.f, mJointMotionList->mDuration);
+            F32 key_time = rot_curve.mKeyTimes[k];
+            U16 time_short = F32_to_U16(key_time, 0.f, mJointMotionList->mDuration);
             success &= dp.packU16(time_short, "time");
 
-            LLVector3 rot_angles = rot_key.mRotation.packToVector3();
+            LLVector3 rot_angles = rot_curve.mKeyRotations[k].packToVector3();
 
             U16 x, y, z;
             rot_angles.quantize16(-1.f, 1.f, -1.f, 1.f);
@@ -2103,26 +2437,28 @@ bool LLKeyframeMotion::serialize(LLDataPacker& dp) const
             success &= dp.packU16(y, "rot_angle_y");
             success &= dp.packU16(z, "rot_angle_z");
 
-            LL_DEBUGS("BVH") << "  rot: t " << rot_key.mTime << " angles " << rot_angles.mV[VX] <<","<< rot_angles.mV[VY] <<","<< rot_angles.mV[VZ] << LL_ENDL;
+            LL_DEBUGS("BVH") << "  rot: t " << key_time << " angles " << rot_angles.mV[VX] <<","<< rot_angles.mV[VY] <<","<< rot_angles.mV[VZ] << LL_ENDL;
         }
 
-        success &= dp.packS32(static_cast<S32>(joint_motionp->mPositionCurve.mKeys.size()), "num_pos_keys");
-        for (PositionCurve::key_map_t::value_type& pos_pair : joint_motionp->mPositionCurve.mKeys)
+        success &= dp.packS32(static_cast<S32>(joint_motionp->mPositionCurve.mKeyTimes.size()), "num_pos_keys");
+        PositionCurve& pos_curve = joint_motionp->mPositionCurve;
+        for (size_t k = 0; k < pos_curve.mKeyTimes.size(); k++)
         {
-            PositionKey& pos_key = pos_pair.second;
-            U16 time_short = F32_to_U16(pos_key.mTime, 0.f, mJointMotionList->mDuration);
+            F32 key_time = pos_curve.mKeyTimes[k];
+            LLVector3& position = pos_curve.mKeyPositions[k];
+            U16 time_short = F32_to_U16(key_time, 0.f, mJointMotionList->mDuration);
             success &= dp.packU16(time_short, "time");
 
             U16 x, y, z;
-            pos_key.mPosition.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-            x = F32_to_U16(pos_key.mPosition.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-            y = F32_to_U16(pos_key.mPosition.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-            z = F32_to_U16(pos_key.mPosition.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+            position.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+            x = F32_to_U16(position.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+            y = F32_to_U16(position.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+            z = F32_to_U16(position.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
             success &= dp.packU16(x, "pos_x");
             success &= dp.packU16(y, "pos_y");
             success &= dp.packU16(z, "pos_z");
 
-            LL_DEBUGS("BVH") << "  pos: t " << pos_key.mTime << " pos " << pos_key.mPosition.mV[VX] <<","<< pos_key.mPosition.mV[VY] <<","<< pos_key.mPosition.mV[VZ] << LL_ENDL;
+            LL_DEBUGS("BVH") << "  pos: t " << key_time << " pos " << position.mV[VX] <<","<< position.mV[VY] <<","<< position.mV[VZ] << LL_ENDL;
         }
     }
 
@@ -2533,7 +2869,7 @@ void LLKeyframeDataCache::removeKeyframeData(const LLUUID& id)
     keyframe_data_map_t::iterator found_data = sKeyframeDataMap.find(id);
     if (found_data != sKeyframeDataMap.end())
     {
-        delete found_data->second;
+        // motions still using it keep their reference
         sKeyframeDataMap.erase(found_data);
     }
 }
@@ -2564,7 +2900,7 @@ LLKeyframeDataCache::~LLKeyframeDataCache()
 //-----------------------------------------------------------------------------
 void LLKeyframeDataCache::clear()
 {
-    for_each(sKeyframeDataMap.begin(), sKeyframeDataMap.end(), DeletePairedPointer());
+    // motions still using a list keep their reference
     sKeyframeDataMap.clear();
 }
 
@@ -317,6 +317,22 @@ public:
         LLVector3   mPosition;
     };
 
+    //-------------------------------------------------------------------------
+    // KeyCursor
+    // Where a motion instance last found itself in the curves of one joint.
+    // Curves are shared between instances through LLKeyframeDataCache, so
+    // each instance keeps its own cursors.
+    //-------------------------------------------------------------------------
+    class KeyCursor
+    {
+    public:
+        KeyCursor() : mScale(0), mRotation(0), mPosition(0) {}
+
+        U32 mScale;
+        U32 mRotation;
+        U32 mPosition;
+    };
+
     //-------------------------------------------------------------------------
     // ScaleCurve
     //-------------------------------------------------------------------------
@@ -326,12 +342,15 @@ public:
         ScaleCurve();
         ~ScaleCurve();
         LLVector3 getValue(F32 time, F32 duration);
-        LLVector3 interp(F32 u, ScaleKey& before, ScaleKey& after);
+        LLVector3 getValue(F32 time, F32 duration, U32& cursor);
+        LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after);
+        void setKey(const ScaleKey& key);
 
         InterpolationType   mInterpolationType;
         S32                 mNumKeys;
-        typedef std::map<F32, ScaleKey> key_map_t;
-        key_map_t           mKeys;
+        // keys sorted by time, with the times apart for searching
+        std::vector<F32>        mKeyTimes;
+        std::vector<LLVector3>  mKeyScales;
         ScaleKey            mLoopInKey;
         ScaleKey            mLoopOutKey;
     };
@@ -345,12 +364,15 @@ public:
         RotationCurve();
         ~RotationCurve();
         LLQuaternion getValue(F32 time, F32 duration);
-        LLQuaternion interp(F32 u, RotationKey& before, RotationKey& after);
+        LLQuaternion getValue(F32 time, F32 duration, U32& cursor);
+        LLQuaternion interp(F32 u, const LLQuaternion& before, const LLQuaternion& after);
+        void setKey(const RotationKey& key);
 
         InterpolationType   mInterpolationType;
         S32                 mNumKeys;
-        typedef std::map<F32, RotationKey> key_map_t;
-        key_map_t       mKeys;
+        // keys sorted by time, with the times apart for searching
+        std::vector<F32>            mKeyTimes;
+        std::vector<LLQuaternion>   mKeyRotations;
         RotationKey     mLoopInKey;
         RotationKey     mLoopOutKey;
     };
@@ -364,12 +386,15 @@ public:
         PositionCurve();
         ~PositionCurve();
         LLVector3 getValue(F32 time, F32 duration);
-        LLVector3 interp(F32 u, PositionKey& before, PositionKey& after);
+        LLVector3 getValue(F32 time, F32 duration, U32& cursor);
+        LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after);
+        void setKey(const PositionKey& key);
 
         InterpolationType   mInterpolationType;
         S32                 mNumKeys;
-        typedef std::map<F32, PositionKey> key_map_t;
-        key_map_t       mKeys;
+        // keys sorted by time, with the times apart for searching
+        std::vector<F32>        mKeyTimes;
+        std::vector<LLVector3>  mKeyPositions;
         PositionKey     mLoopInKey;
         PositionKey     mLoopOutKey;
     };
@@ -393,7 +418,10 @@ public:
     //-------------------------------------------------------------------------
     // JointMotionList
     //-------------------------------------------------------------------------
-    class JointMotionList
+    // Shared by every instance of an animation through LLKeyframeDataCache;
+    // each instance holds a reference, so the list outlives the cache entry
+    // for motions still around when it is cleared.
+    class JointMotionList : public LLRefCount
     {
     public:
         std::vector<JointMotion*> mJointMotionArray;
@@ -415,17 +443,70 @@ public:
         std::string             mEmoteName;
         LLUUID                  mEmoteID;
 
+    protected:
+        ~JointMotionList();
+
     public:
         JointMotionList();
-        ~JointMotionList();
         U32 dumpDiagInfo();
         JointMotion* getJointMotion(U32 index) const { llassert(index < mJointMotionArray.size()); return mJointMotionArray[index]; }
         U32 getNumJointMotions() const { return static_cast<U32>(mJointMotionArray.size()); }
+
+        // Sample the curves of every joint motion at time into the matching
+        // joint states, with one KeyCursor per joint motion. sample_slot is
+        // the caller's own index of the shared sample it used last.
+        void sampleJoints(F32 time, const LLPointer<LLJointState>* joint_states, KeyCursor* cursors, U32& sample_slot);
+
+        // Active LLKeyframeMotion instances playing this list. Samples are
+        // only shared while there is more than one.
+        void addActiveInstance() { mActiveInstances++; }
+        void removeActiveInstance() { llassert(mActiveInstances); mActiveInstances--; }
+        U32 getActiveInstances() const { return mActiveInstances; }
+
+        //---------------------------------------------------------------------
+        // Sample
+        // Every channel with keys, sampled at one time. Lists are shared by
+        // all instances of an animation through LLKeyframeDataCache, so
+        // instances playing it in step (a crowd started together by a dance
+        // HUD, say) evaluate the curves once and copy the result.
+        //---------------------------------------------------------------------
+        struct Sample
+        {
+            Sample() : mTime(-1.f) {}
+
+            F32                         mTime;
+            std::vector<LLVector3>      mScales;
+            std::vector<LLQuaternion>   mRotations;
+            std::vector<LLVector3>      mPositions;
+        };
+
+        // The sample within SAMPLE_TIME_TOLERANCE of time, from the recent
+        // samples of this list or evaluated into the one after sample_slot.
+        // Every avatar runs its own motion clock, so instances started on
+        // the same frame reach a given frame at times that differ by float
+        // rounding and update order, never exactly. Not thread safe, like
+        // the rest of motion updates.
+        const Sample& getSample(F32 time, KeyCursor* cursors, U32& sample_slot);
+
+        static const U32 SAMPLE_CACHE_SIZE = 4;
+        static constexpr F32 SAMPLE_TIME_TOLERANCE = 0.001f;
+        static U64 sSamplesComputed;
+        static U64 sSamplesShared;
+
+    private:
+        // Evaluates the curves at time into joint_states when given, or
+        // into every channel of sample otherwise.
+        void computeSample(F32 time, KeyCursor* cursors, const LLPointer<LLJointState>* joint_states, Sample* sample) const;
+
+        U32             mActiveInstances;
+        Sample          mSamples[SAMPLE_CACHE_SIZE];
     };
 
 protected:
-    JointMotionList*                mJointMotionList;
+    LLPointer<JointMotionList>      mJointMotionList;
     std::vector<LLPointer<LLJointState> > mJointStates;
+    std::vector<KeyCursor>          mKeyCursors;
+    U32                             mSampleSlot;    // in mJointMotionList's shared samples
     LLJoint*                        mPelvisp;
     LLCharacter*                    mCharacter;
     typedef std::list<JointConstraint*> constraint_list_t;
@@ -434,6 +515,7 @@ protected:
     F32                             mLastUpdateTime;
     F32                             mLastLoopedTime;
     AssetStatus                     mAssetStatus;
+    bool                            mCountedActive; // in mJointMotionList's active instances
 
 public:
     void setCharacter(LLCharacter* character) { mCharacter = character; }
@@ -446,7 +528,7 @@ public:
     LLKeyframeDataCache(){};
     ~LLKeyframeDataCache();
 
-    typedef std::map<LLUUID, class LLKeyframeMotion::JointMotionList*> keyframe_data_map_t;
+    typedef std::map<LLUUID, LLPointer<LLKeyframeMotion::JointMotionList> > keyframe_data_map_t;
     static keyframe_data_map_t sKeyframeDataMap;
 
     static void addKeyframeData(const LLUUID& id, LLKeyframeMotion::JointMotionList*);
@@ -139,6 +139,10 @@ LLMotionController::LLMotionController()
       mTimeStep(0.f),
       mTimeStepCount(0),
       mLastInterp(0.f),
+      mInterpolating(false),
+      mInterpStartTime(0.f),
+      mInterpTime(0.f),
+      mInterpProgress(0.f),
       mIsSelf(false),
       mLastCountAfterPurge(0)
 {
@@ -808,7 +812,7 @@ void LLMotionController::updateLoadingMotions()
 //-----------------------------------------------------------------------------
 // updateMotion()
 //-----------------------------------------------------------------------------
-void LLMotionController::updateMotions(bool force_update)
+void LLMotionController::updateMotions(bool force_update, F32 interp_time)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
     // SL-763: "Distant animated objects run at super fast speed"
@@ -875,6 +879,10 @@ void LLMotionController::updateMotions(bool force_update)
     }
     else
     {
+        // the last interpolated pose has to be reached before the blenders
+        // are refilled
+        finishInterpolation();
+
         // update additive motions
         updateAdditiveMotions();
 
@@ -887,6 +895,14 @@ void LLMotionController::updateMotions(bool force_update)
         {
             mPoseBlender.blendAndCache(true);
         }
+        else if (interp_time > 0.f)
+        {
+            mPoseBlender.blendAndCache(true);
+            mInterpolating = true;
+            mInterpStartTime = cur_time;
+            mInterpTime = interp_time;
+            mInterpProgress = 0.f;
+        }
         else
         {
             mPoseBlender.blendAndApply();
@@ -916,6 +932,43 @@ void LLMotionController::updateMotionsMinimal()
     mHasRunOnce = true;
 }
 
+//-----------------------------------------------------------------------------
+// interpolateMotions()
+//-----------------------------------------------------------------------------
+void LLMotionController::interpolateMotions()
+{
+    if (!mInterpolating || mPaused || mInterpProgress >= 1.f)
+    {
+        return;
+    }
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+
+    F32 progress = llclamp((mTimer.getElapsedTimeF32() - mInterpStartTime) / mInterpTime, 0.f, 1.f);
+    if (progress > mInterpProgress)
+    {
+        // the joints are already mInterpProgress of the way there, so
+        // cover the matching share of what is left
+        mPoseBlender.interpolate((progress - mInterpProgress) / (1.f - mInterpProgress));
+        mInterpProgress = progress;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// finishInterpolation()
+//-----------------------------------------------------------------------------
+void LLMotionController::finishInterpolation()
+{
+    if (mInterpolating)
+    {
+        if (mInterpProgress < 1.f)
+        {
+            mPoseBlender.interpolate(1.f);
+        }
+        mPoseBlender.clearBlenders();
+        mInterpolating = false;
+    }
+}
+
 //-----------------------------------------------------------------------------
 // activateMotionInstance()
 //-----------------------------------------------------------------------------
@@ -1076,6 +1129,7 @@ void LLMotionController::dumpMotions()
 //-----------------------------------------------------------------------------
 void LLMotionController::deactivateAllMotions()
 {
+    finishInterpolation();
     for (motion_map_t::value_type& motion_pair : mAllMotions)
     {
         LLMotion* motionp = motion_pair.second;
@@ -1089,6 +1143,8 @@ void LLMotionController::deactivateAllMotions()
 //-----------------------------------------------------------------------------
 void LLMotionController::flushAllMotions()
 {
+    finishInterpolation();
+
     std::vector<std::pair<LLUUID,F32> > active_motions;
     active_motions.reserve(mActiveMotions.size());
     for (motion_list_t::iterator iter = mActiveMotions.begin();
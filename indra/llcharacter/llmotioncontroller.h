@@ -130,11 +130,19 @@ public:
     // invokes the update handlers for each active motion
     // activates sequenced motions
     // deactivates terminated motions`
-    void updateMotions(bool force_update = false);
+    // If interp_time is not zero the resulting pose is not applied at
+    // once; the skeleton moves towards it over interp_time seconds through
+    // interpolateMotions(), for characters that are not updated every frame.
+    void updateMotions(bool force_update = false, F32 interp_time = 0.f);
 
     // minimal update (e.g. while hidden)
     void updateMotionsMinimal();
 
+    // Move the skeleton along towards the pose of the last interpolated
+    // updateMotions(). Cheap enough for the frames in between updates.
+    void interpolateMotions();
+    bool isInterpolating() const { return mInterpolating; }
+
     void clearBlenders() { mPoseBlender.clearBlenders(); }
 
     // flush motions
@@ -191,6 +199,7 @@ protected:
     void updateIdleActiveMotions();
     void purgeExcessMotions();
     void deactivateStoppedMotions();
+    void finishInterpolation();
 
 protected:
     F32                 mTimeFactor;            // 1.f for normal speed
@@ -226,6 +235,10 @@ protected:
     F32                 mTimeStep;
     S32                 mTimeStepCount;
     F32                 mLastInterp;
+    bool                mInterpolating;
+    F32                 mInterpStartTime;
+    F32                 mInterpTime;
+    F32                 mInterpProgress;
 
     U8                  mJointSignature[2][LL_CHARACTER_MAX_ANIMATED_JOINTS];
 private:
@@ -0,0 +1,479 @@
+/**
+ * @file llkeyframemotion_test.cpp
+ * @brief Tests and benchmark for the LLKeyframeMotion curves.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llkeyframemotion.h"
+#include "../test/lltut.h"
+
+#include "llrand.h"
+#include "lltimer.h"
+
+#include <map>
+
+namespace tut
+{
+    struct LLKeyframeCurveData
+    {
+        typedef LLKeyframeMotion::JointMotionList JointMotionList;
+        typedef LLKeyframeMotion::JointMotion JointMotion;
+
+        LLQuaternion randomRotation()
+        {
+            LLQuaternion rot(ll_frand(F_PI), LLVector3(ll_frand() - 0.5f, ll_frand() - 0.5f, ll_frand() - 0.5f));
+            rot.normalize();
+            return rot;
+        }
+
+        // Shaped like an uploaded .anim: a bento sized skeleton, rotation
+        // keys at irregular times, positions on a few joints only.
+        JointMotionList* makeMotion(U32 joints, F32 duration, F32 keys_per_second)
+        {
+            JointMotionList* list = new JointMotionList();
+            list->mDuration = duration;
+            for (U32 j = 0; j < joints; j++)
+            {
+                JointMotion* joint_motion = new JointMotion();
+                joint_motion->mJointName = "joint" + std::to_string(j);
+                const U32 keys = llmax(1, (S32)(duration * keys_per_second * (0.25f + ll_frand())));
+                LLQuaternion rot = randomRotation();
+                for (U32 k = 0; k < keys; k++)
+                {
+                    // small steps, with the odd flip into the other hemisphere
+                    rot = rot * LLQuaternion(ll_frand(0.3f), LLVector3(ll_frand(), ll_frand(), ll_frand()));
+                    rot.normalize();
+                    LLQuaternion stored = ll_rand(20) ? rot : -rot;
+                    joint_motion->mRotationCurve.setKey(LLKeyframeMotion::RotationKey(ll_frand(duration), stored));
+                }
+                joint_motion->mRotationCurve.mNumKeys = (S32)joint_motion->mRotationCurve.mKeyTimes.size();
+                if (j % 8 == 0)
+                {
+                    for (U32 k = 0; k < keys; k++)
+                    {
+                        LLVector3 pos(ll_frand() - 0.5f, ll_frand() - 0.5f, ll_frand() - 0.5f);
+                        joint_motion->mPositionCurve.setKey(LLKeyframeMotion::PositionKey(ll_frand(duration), pos));
+                    }
+                    joint_motion->mPositionCurve.mNumKeys = (S32)joint_motion->mPositionCurve.mKeyTimes.size();
+                }
+                list->mJointMotionArray.push_back(joint_motion);
+            }
+            mLists.push_back(list);
+            return list;
+        }
+
+        std::vector<LLPointer<LLJointState> > makeJointStates(const JointMotionList* list)
+        {
+            std::vector<LLPointer<LLJointState> > joint_states;
+            for (U32 j = 0; j < list->getNumJointMotions(); j++)
+            {
+                LLPointer<LLJointState> joint_state = new LLJointState();
+                U32 usage = 0;
+                if (list->getJointMotion(j)->mRotationCurve.mNumKeys)
+                {
+                    usage |= LLJointState::ROT;
+                }
+                if (list->getJointMotion(j)->mPositionCurve.mNumKeys)
+                {
+                    usage |= LLJointState::POS;
+                }
+                joint_state->setUsage(usage);
+                joint_states.push_back(joint_state);
+            }
+            return joint_states;
+        }
+
+        // The curves as they used to be stored, searched from the top each time.
+        struct MapCurve
+        {
+            std::map<F32, LLQuaternion> mRotations;
+            std::map<F32, LLVector3> mPositions;
+
+            template <typename T>
+            static bool sample(const std::map<F32, T>& keys, F32 time, T& value)
+            {
+                if (keys.empty())
+                {
+                    return false;
+                }
+                typename std::map<F32, T>::const_iterator right = keys.lower_bound(time);
+                if (right == keys.end())
+                {
+                    value = (--right)->second;
+                }
+                else if (right == keys.begin() || right->first == time)
+                {
+                    value = right->second;
+                }
+                else
+                {
+                    typename std::map<F32, T>::const_iterator left = right;
+                    --left;
+                    F32 u = (time - left->first) / (right->first - left->first);
+                    value = blend(u, left->second, right->second);
+                }
+                return true;
+            }
+            static LLQuaternion blend(F32 u, const LLQuaternion& a, const LLQuaternion& b) { return nlerp(u, a, b); }
+            static LLVector3 blend(F32 u, const LLVector3& a, const LLVector3& b) { return lerp(a, b, u); }
+        };
+
+        std::vector<MapCurve> makeMapCurves(const JointMotionList* list)
+        {
+            std::vector<MapCurve> curves(list->getNumJointMotions());
+            for (U32 j = 0; j < list->getNumJointMotions(); j++)
+            {
+                const JointMotion* joint_motion = list->getJointMotion(j);
+                for (size_t k = 0; k < joint_motion->mRotationCurve.mKeyTimes.size(); k++)
+                {
+                    curves[j].mRotations[joint_motion->mRotationCurve.mKeyTimes[k]] = joint_motion->mRotationCurve.mKeyRotations[k];
+                }
+                for (size_t k = 0; k < joint_motion->mPositionCurve.mKeyTimes.size(); k++)
+                {
+                    curves[j].mPositions[joint_motion->mPositionCurve.mKeyTimes[k]] = joint_motion->mPositionCurve.mKeyPositions[k];
+                }
+            }
+            return curves;
+        }
+
+        static bool closeEnough(const LLQuaternion& a, const LLQuaternion& b)
+        {
+            return fabsf(a.mQ[VX] - b.mQ[VX]) < 1.0e-5f && fabsf(a.mQ[VY] - b.mQ[VY]) < 1.0e-5f
+                && fabsf(a.mQ[VZ] - b.mQ[VZ]) < 1.0e-5f && fabsf(a.mQ[VW] - b.mQ[VW]) < 1.0e-5f;
+        }
+
+        std::vector<LLPointer<JointMotionList> > mLists;
+    };
+
+    typedef test_group<LLKeyframeCurveData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llkeyframemotion_test_factory("LLKeyframeMotion");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        // flat curves with cursors answer what the key maps did
+        LLKeyframeMotion::RotationCurve curve;
+        ensure("empty curve is identity", curve.getValue(1.f, 2.f) == LLQuaternion::DEFAULT);
+
+        LLQuaternion a = randomRotation();
+        LLQuaternion b = randomRotation();
+        curve.setKey(LLKeyframeMotion::RotationKey(1.f, b));
+        curve.setKey(LLKeyframeMotion::RotationKey(0.5f, a));
+        curve.setKey(LLKeyframeMotion::RotationKey(1.f, a));
+        ensure_equals("duplicate time replaces the key", curve.mKeyTimes.size(), (size_t)2);
+        ensure("keys sorted", curve.mKeyTimes[0] < curve.mKeyTimes[1]);
+        ensure("later duplicate wins", curve.mKeyRotations[1] == a);
+
+        JointMotionList* list = makeMotion(40, 5.f, 12.f);
+        std::vector<MapCurve> maps = makeMapCurves(list);
+        for (U32 j = 0; j < list->getNumJointMotions(); j++)
+        {
+            JointMotion* joint_motion = list->getJointMotion(j);
+            U32 rot_cursor = 0;
+            U32 pos_cursor = 0;
+            // forward playback, a loop back to the start, and scrubbing
+            for (U32 frame = 0; frame < 600; frame++)
+            {
+                F32 time = frame < 400 ? fmodf(frame * 0.0222f, list->mDuration) : ll_frand(list->mDuration + 0.5f) - 0.25f;
+                if (frame == 300)
+                {
+                    // exactly on a key
+                    time = joint_motion->mRotationCurve.mKeyTimes.back();
+                }
+                LLQuaternion expected_rot;
+                MapCurve::sample(maps[j].mRotations, time, expected_rot);
+                ensure("rotation matches", joint_motion->mRotationCurve.getValue(time, list->mDuration, rot_cursor) == expected_rot);
+
+                LLVector3 expected_pos;
+                if (MapCurve::sample(maps[j].mPositions, time, expected_pos))
+                {
+                    ensure("position matches", joint_motion->mPositionCurve.getValue(time, list->mDuration, pos_cursor) == expected_pos);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        // batch sampling matches per joint evaluation
+        JointMotionList* list = makeMotion(133, 4.f, 20.f);
+        std::vector<LLPointer<LLJointState> > joint_states = makeJointStates(list);
+        std::vector<LLKeyframeMotion::KeyCursor> cursors(list->getNumJointMotions());
+        U32 sample_slot = 0;
+        for (U32 frame = 0; frame < 300; frame++)
+        {
+            F32 time = fmodf(frame * 0.0167f, list->mDuration);
+            list->sampleJoints(time, joint_states.data(), cursors.data(), sample_slot);
+            for (U32 j = 0; j < list->getNumJointMotions(); j++)
+            {
+                JointMotion* joint_motion = list->getJointMotion(j);
+                ensure("batched rotation", closeEnough(joint_states[j]->getRotation(), joint_motion->mRotationCurve.getValue(time, list->mDuration)));
+                if (joint_motion->mPositionCurve.mNumKeys)
+                {
+                    ensure("batched position", joint_states[j]->getPosition() == joint_motion->mPositionCurve.getValue(time, list->mDuration));
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        // headless benchmark: a crowd playing a bank of animations
+        const U32 MOTIONS = 64;
+        const U32 AVATARS = 200;
+        const U32 FRAMES = 120;
+        std::vector<std::vector<MapCurve> > maps;
+        for (U32 m = 0; m < MOTIONS; m++)
+        {
+            JointMotionList* list = makeMotion(60 + ll_rand(80), 2.f + ll_frand(8.f), 15.f + ll_frand(30.f));
+            maps.push_back(makeMapCurves(list));
+        }
+
+        struct Player
+        {
+            U32 mMotion;
+            F32 mOffset;
+            std::vector<LLPointer<LLJointState> > mJointStates;
+            std::vector<LLKeyframeMotion::KeyCursor> mCursors;
+            U32 mSampleSlot = 0;
+        };
+        std::vector<Player> players(AVATARS);
+        U64 samples = 0;
+        for (Player& player : players)
+        {
+            player.mMotion = ll_rand(MOTIONS);
+            player.mOffset = ll_frand(10.f);
+            player.mJointStates = makeJointStates(mLists[player.mMotion]);
+            player.mCursors.resize(mLists[player.mMotion]->getNumJointMotions());
+            samples += player.mJointStates.size();
+        }
+
+        LLTimer timer;
+        for (U32 frame = 0; frame < FRAMES; frame++)
+        {
+            for (Player& player : players)
+            {
+                const JointMotionList* list = mLists[player.mMotion];
+                F32 time = fmodf(player.mOffset + frame / 45.f, list->mDuration);
+                const std::vector<MapCurve>& curves = maps[player.mMotion];
+                for (U32 j = 0; j < curves.size(); j++)
+                {
+                    LLJointState* joint_state = player.mJointStates[j];
+                    LLQuaternion rot;
+                    if (MapCurve::sample(curves[j].mRotations, time, rot))
+                    {
+                        joint_state->setRotation(rot);
+                    }
+                    LLVector3 pos;
+                    if (MapCurve::sample(curves[j].mPositions, time, pos))
+                    {
+                        joint_state->setPosition(pos);
+                    }
+                }
+            }
+        }
+        F64 map_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        for (U32 frame = 0; frame < FRAMES; frame++)
+        {
+            for (Player& player : players)
+            {
+                JointMotionList* list = mLists[player.mMotion];
+                F32 time = fmodf(player.mOffset + frame / 45.f, list->mDuration);
+                list->sampleJoints(time, player.mJointStates.data(), player.mCursors.data(), player.mSampleSlot);
+            }
+        }
+        F64 flat_time = timer.getElapsedTimeF64();
+
+        LL_INFOS() << AVATARS << " avatars playing " << MOTIONS << " animations, " << samples * FRAMES
+            << " joint samples: key maps " << map_time * 1000.0 << "ms, flat curves with cursors "
+            << flat_time * 1000.0 << "ms" << LL_ENDL;
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        // instances in step share one sample and still see their own usage
+        JointMotionList* list = makeMotion(80, 3.f, 20.f);
+        std::vector<LLPointer<LLJointState> > first = makeJointStates(list);
+        std::vector<LLPointer<LLJointState> > second = makeJointStates(list);
+        second[1]->setUsage(0);
+        std::vector<LLKeyframeMotion::KeyCursor> first_cursors(list->getNumJointMotions());
+        std::vector<LLKeyframeMotion::KeyCursor> second_cursors(list->getNumJointMotions());
+        U32 first_slot = 0;
+        U32 second_slot = 0;
+        list->addActiveInstance();
+        list->addActiveInstance();
+
+        const U64 computed = JointMotionList::sSamplesComputed;
+        const U64 shared = JointMotionList::sSamplesShared;
+        for (U32 frame = 0; frame < 100; frame++)
+        {
+            F32 time = fmodf(frame * 0.0333f, list->mDuration);
+            list->sampleJoints(time, first.data(), first_cursors.data(), first_slot);
+            list->sampleJoints(time + JointMotionList::SAMPLE_TIME_TOLERANCE * 0.5f, second.data(), second_cursors.data(), second_slot);
+            for (U32 j = 0; j < list->getNumJointMotions(); j++)
+            {
+                const LLQuaternion expected = list->getJointMotion(j)->mRotationCurve.getValue(time, list->mDuration);
+                ensure("first instance sampled", closeEnough(first[j]->getRotation(), expected));
+                if (j != 1)
+                {
+                    ensure("second instance shares the sample", first[j]->getRotation() == second[j]->getRotation());
+                    ensure("positions shared", first[j]->getPosition() == second[j]->getPosition());
+                }
+            }
+        }
+        ensure("unused joint left alone", second[1]->getRotation() == LLQuaternion::DEFAULT);
+        ensure_equals("one evaluation per time", JointMotionList::sSamplesComputed - computed, (U64)100);
+        ensure_equals("every second instance shared", JointMotionList::sSamplesShared - shared, (U64)100);
+
+        // a lone instance samples straight into its joint states
+        list->removeActiveInstance();
+        const U64 computed_alone = JointMotionList::sSamplesComputed;
+        const U64 shared_alone = JointMotionList::sSamplesShared;
+        list->sampleJoints(0.5f, first.data(), first_cursors.data(), first_slot);
+        list->sampleJoints(0.5f, first.data(), first_cursors.data(), first_slot);
+        ensure_equals("no sample kept", JointMotionList::sSamplesComputed, computed_alone);
+        ensure_equals("nothing shared", JointMotionList::sSamplesShared, shared_alone);
+        ensure("still sampled", closeEnough(first[0]->getRotation(),
+            list->getJointMotion(0)->mRotationCurve.getValue(0.5f, list->mDuration)));
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        // A crowd started on the same frame by a dance HUD. Every avatar
+        // runs its own LLMotionController clock: it was created at another
+        // time, accumulates its own frame deltas in F32, and is updated at
+        // its own point in the frame. Their motion times agree to well
+        // under a millisecond but hardly ever exactly.
+        const U32 AVATARS = 40;
+        const U32 FRAMES = 600;
+        JointMotionList* list = makeMotion(80, 8.f, 20.f);
+
+        struct Dancer
+        {
+            F32 mAnimTime;
+            F32 mActivationTime;
+            F64 mLastUpdate;
+            std::vector<LLPointer<LLJointState> > mJointStates;
+            std::vector<LLKeyframeMotion::KeyCursor> mCursors;
+            U32 mSampleSlot;
+        };
+        std::vector<Dancer> dancers(AVATARS);
+        F64 frame_start = 0.0;
+        for (U32 i = 0; i < AVATARS; i++)
+        {
+            // rezzed some time in the last ten minutes
+            Dancer& dancer = dancers[i];
+            dancer.mAnimTime = ll_frand(600.f);
+            dancer.mActivationTime = dancer.mAnimTime;
+            dancer.mLastUpdate = frame_start + i * 0.0001;
+            dancer.mJointStates = makeJointStates(list);
+            dancer.mCursors.resize(list->getNumJointMotions());
+            dancer.mSampleSlot = 0;
+            list->addActiveInstance();
+        }
+
+        const U64 computed = JointMotionList::sSamplesComputed;
+        const U64 shared = JointMotionList::sSamplesShared;
+        U32 exact_matches = 0;
+        LLTimer timer;
+        for (U32 frame = 0; frame < FRAMES; frame++)
+        {
+            frame_start += 0.0167 + ll_frand(0.004f);
+            F32 first_time = -1.f;
+            for (U32 i = 0; i < AVATARS; i++)
+            {
+                // like LLMotionController::updateMotions(), the time since
+                // this avatar's last update, taken a little later in the
+                // frame for each avatar and with some jitter
+                Dancer& dancer = dancers[i];
+                const F64 now = frame_start + i * 0.0001 + ll_frand(0.0002f);
+                dancer.mAnimTime += (F32)(now - dancer.mLastUpdate);
+                dancer.mLastUpdate = now;
+                F32 time = fmodf(dancer.mAnimTime - dancer.mActivationTime, list->mDuration);
+                list->sampleJoints(time, dancer.mJointStates.data(), dancer.mCursors.data(), dancer.mSampleSlot);
+                if (first_time < 0.f)
+                {
+                    first_time = time;
+                }
+                else if (time == first_time)
+                {
+                    exact_matches++;
+                }
+            }
+        }
+        F64 shared_time = timer.getElapsedTimeF64();
+
+        const U64 evaluations = JointMotionList::sSamplesComputed - computed;
+        const U64 hits = JointMotionList::sSamplesShared - shared;
+        LL_INFOS() << AVATARS << " avatars in step for " << FRAMES << " frames: " << evaluations << " evaluations, "
+            << hits << " shared, " << exact_matches << " exact time matches, " << shared_time * 1000.0 << "ms" << LL_ENDL;
+        ensure_equals("every update sampled", evaluations + hits, (U64)(AVATARS * FRAMES));
+        // allow for F32 clock rounding splitting the crowd now and then
+        ensure("most updates shared", hits >= (U64)(AVATARS - 1) * FRAMES * 9 / 10);
+        ensure("exact time matches are rare", exact_matches < (AVATARS - 1) * FRAMES / 10);
+
+        for (U32 i = 0; i < AVATARS; i++)
+        {
+            list->removeActiveInstance();
+        }
+    }
+
+    template<> template<>
+    void object::test<6>()
+    {
+        // a motion's list outlives the cache entry, as the preview avatars'
+        // active motions need at shutdown
+        const LLUUID id("4f7cb2e7-1b2f-4a8e-9d33-0d3e5c7b9a11");
+        LLPointer<JointMotionList> list = makeMotion(10, 1.f, 10.f);
+        LLKeyframeDataCache::addKeyframeData(id, list);
+        ensure("cached", LLKeyframeDataCache::getKeyframeData(id) == list.get());
+        list->addActiveInstance();
+
+        LLKeyframeDataCache::clear();
+        ensure("gone from the cache", LLKeyframeDataCache::getKeyframeData(id) == NULL);
+        mLists.clear();
+        ensure_equals("only the motion's reference left", list->getNumRefs(), 1);
+        list->removeActiveInstance();
+        ensure_equals("still counted", list->getActiveInstances(), (U32)0);
+
+        LLKeyframeDataCache::addKeyframeData(id, list);
+        LLKeyframeDataCache::removeKeyframeData(id);
+        ensure_equals("removal drops only the cache's reference", list->getNumRefs(), 1);
+    }
+}
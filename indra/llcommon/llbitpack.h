@@ -141,7 +141,6 @@ public:
     U32 bitUnpack(U8 *total_retval, U32 total_dsize)
     {
         U32 dsize;
-        U8  *retval;
 
         while (total_dsize > 0)
         {
@@ -156,30 +155,38 @@ public:
                 total_dsize = 0;
             }
 
-            retval = total_retval++;
-            *retval = 0x00;
-            while (dsize > 0)
+            *total_retval++ = (U8)unpackBits(dsize);
+        }
+        return mBufferSize;
+    }
+
+    // Next dsize bits (at most 32) of the stream, first bit most
+    // significant. Takes what it needs from the loaded byte in one go
+    // rather than a bit at a time.
+    U32 unpackBits(U32 dsize)
+    {
+        U32 retval = 0;
+        while (dsize > 0)
+        {
+            if (mLoadSize == 0)
             {
-                if (mLoadSize == 0)
-                {
 #ifdef _DEBUG
-                    if (mBufferSize > mMaxSize)
-                    {
-                        LL_ERRS() << "mBufferSize exceeding mMaxSize" << LL_ENDL;
-                        LL_ERRS() << mBufferSize << " > " << mMaxSize << LL_ENDL;
-                    }
-#endif
-                    mLoad = *(mBuffer + mBufferSize++);
-                    mLoadSize = MAX_DATA_BITS;
+                if (mBufferSize > mMaxSize)
+                {
+                    LL_ERRS() << "mBufferSize exceeding mMaxSize" << LL_ENDL;
+                    LL_ERRS() << mBufferSize << " > " << mMaxSize << LL_ENDL;
                 }
-                *retval <<= 1;
-                *retval |= (mLoad >> (MAX_DATA_BITS - 1));
-                mLoadSize--;
-                mLoad <<= 1;
-                dsize--;
+#endif
+                mLoad = *(mBuffer + mBufferSize++);
+                mLoadSize = MAX_DATA_BITS;
             }
+            U32 count = dsize < mLoadSize ? dsize : mLoadSize;
+            retval = (retval << count) | (mLoad >> (MAX_DATA_BITS - count));
+            mLoad = (U8)(mLoad << count);
+            mLoadSize -= count;
+            dsize -= count;
         }
-        return mBufferSize;
+        return retval;
     }
 
     U32 flushBitPack()
@@ -31,7 +31,9 @@
 #include "llerrorcontrol.h"
 #include "llsdutil.h"
 
+#include <atomic>
 #include <cctype>
+#include <condition_variable>
 #ifdef __GNUC__
 # include <cxxabi.h>
 #endif // __GNUC__
@@ -43,6 +45,8 @@
 #else
 # include <io.h>
 #endif // !LL_WINDOWS
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "string.h"
 
@@ -127,11 +131,117 @@ namespace {
     };
 #endif
 
+    // Single producer, single consumer queue of formatted log lines. Each
+    // thread that logs through an asynchronous RecordToFile owns one; the
+    // recorder's writer thread is the only consumer. When the ring is full,
+    // lines spill into a mutex protected overflow list rather than being
+    // dropped, and keep going there until the writer has caught up so that
+    // each thread's lines stay in order. When its thread exits the ring is
+    // retired, and the writer drops it once it has drained it.
+    class LogRing
+    {
+    public:
+        LogRing() : mHead(0), mTail(0), mHasOverflow(false), mRetired(false) {}
+
+        // producer side, after its last push
+        void retire() { mRetired.store(true, std::memory_order_release); }
+
+        // consumer side; check before drain() so that every line pushed before
+        // retire() is drained
+        bool isRetired() const { return mRetired.load(std::memory_order_acquire); }
+
+        // producer side
+        void push(std::string& line)
+        {
+            if (!mHasOverflow.load(std::memory_order_relaxed))
+            {
+                size_t tail = mTail.load(std::memory_order_relaxed);
+                if (tail - mHead.load(std::memory_order_acquire) < CAPACITY)
+                {
+                    mSlots[tail & (CAPACITY - 1)].swap(line);
+                    mTail.store(tail + 1, std::memory_order_release);
+                    return;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mOverflowMutex);
+            mOverflow.push_back(std::move(line));
+            mHasOverflow.store(true, std::memory_order_release);
+        }
+
+        // consumer side, appends each pending line to out
+        void drain(std::string& out)
+        {
+            drainSlots(out);
+            if (mHasOverflow.load(std::memory_order_acquire))
+            {
+                std::lock_guard<std::mutex> lock(mOverflowMutex);
+                // anything still in the ring predates the overflow
+                drainSlots(out);
+                for (const std::string& line : mOverflow)
+                {
+                    out += line;
+                    out += '\n';
+                }
+                mOverflow.clear();
+                mHasOverflow.store(false, std::memory_order_release);
+            }
+        }
+
+    private:
+        void drainSlots(std::string& out)
+        {
+            size_t head = mHead.load(std::memory_order_relaxed);
+            size_t tail = mTail.load(std::memory_order_acquire);
+            for (; head != tail; ++head)
+            {
+                std::string& slot = mSlots[head & (CAPACITY - 1)];
+                out += slot;
+                out += '\n';
+                slot.clear();
+            }
+            mHead.store(head, std::memory_order_release);
+        }
+
+        static constexpr size_t CAPACITY = 1024; // must be a power of two
+
+        std::string mSlots[CAPACITY];
+        alignas(64) std::atomic<size_t> mHead;
+        alignas(64) std::atomic<size_t> mTail;
+        std::atomic<bool> mHasOverflow;
+        std::atomic<bool> mRetired;
+        std::mutex mOverflowMutex;
+        std::vector<std::string> mOverflow;
+    };
+
+    // This thread's ring for the asynchronous recorder it last logged to.
+    // The ring is shared with the recorder so that either may go away first.
+    struct ThreadLogRing
+    {
+        ~ThreadLogRing() { release(); }
+
+        void release()
+        {
+            if (mRing)
+            {
+                mRing->retire();
+                mRing.reset();
+            }
+        }
+
+        U64 mSerial = 0;
+        std::shared_ptr<LogRing> mRing;
+    };
+
     class RecordToFile : public LLError::Recorder
     {
     public:
-        RecordToFile(const std::string& filename):
-            mName(filename)
+        RecordToFile(const std::string& filename, bool async = false):
+            mName(filename),
+            mAsync(async),
+            mSerial(++sNextSerial),
+            mPending(false),
+            mStopping(false)
         {
             mFile.open(filename.c_str(), std::ios_base::out | std::ios_base::app);
             if (!mFile)
@@ -140,15 +250,28 @@ namespace {
             }
             else
             {
-                if (!LLError::getAlwaysFlush())
+                if (!LLError::getAlwaysFlush() || mAsync)
                 {
                     mFile.sync_with_stdio(false);
                 }
+                if (mAsync)
+                {
+                    mWriter = std::thread([this]() { writerLoop(); });
+                }
             }
         }
 
         ~RecordToFile()
         {
+            if (mWriter.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mWakeMutex);
+                    mStopping = true;
+                }
+                mWake.notify_one();
+                mWriter.join();
+            }
             mFile.close();
         }
 
@@ -163,13 +286,20 @@ namespace {
 
         bool okay() const { return mFile.good(); }
 
+        bool isAsync() const { return mAsync; }
+
         std::string getFilename() const { return mName; }
 
         virtual void recordMessage(LLError::ELevel level,
                                     const std::string& message) override
         {
             LL_PROFILE_ZONE_SCOPED_CATEGORY_LOGGING;
-            if (LLError::getAlwaysFlush())
+            if (mAsync)
+            {
+                std::string line(message);
+                queueLine(line, level);
+            }
+            else if (LLError::getAlwaysFlush())
             {
                 mFile << message << std::endl;
             }
@@ -179,11 +309,113 @@ namespace {
             }
         }
 
+        // Asynchronous mode only: hand a formatted line to the writer thread.
+        // Never touches the file unless level is LEVEL_ERROR, in which case the
+        // queue is written out before returning since the process is about to
+        // go down.
+        void queueLine(std::string& line, LLError::ELevel level)
+        {
+            getThreadRing().push(line);
+
+            if (level == LLError::LEVEL_ERROR)
+            {
+                writePending();
+            }
+            else if (!mPending.exchange(true))
+            {
+                std::lock_guard<std::mutex> lock(mWakeMutex);
+                mWake.notify_one();
+            }
+        }
+
     private:
+        LogRing& getThreadRing()
+        {
+            // cache this thread's ring, keyed by recorder serial so a ring
+            // belonging to a since-destroyed recorder is never reused
+            thread_local ThreadLogRing t_ring;
+            if (t_ring.mSerial != mSerial)
+            {
+                t_ring.release();
+                std::shared_ptr<LogRing> ring = std::make_shared<LogRing>();
+                {
+                    std::lock_guard<std::mutex> lock(mRingsMutex);
+                    mRings.push_back(ring);
+                }
+                t_ring.mRing = ring;
+                t_ring.mSerial = mSerial;
+            }
+            return *t_ring.mRing;
+        }
+
+        // Gather everything queued by every thread and write it with a single
+        // stream write.
+        void writePending()
+        {
+            std::lock_guard<std::mutex> write_lock(mWriteMutex);
+            mBatch.clear();
+            {
+                std::lock_guard<std::mutex> lock(mRingsMutex);
+                for (auto it = mRings.begin(); it != mRings.end(); )
+                {
+                    bool retired = (*it)->isRetired();
+                    (*it)->drain(mBatch);
+                    if (retired)
+                    {
+                        // its thread has exited, so nothing more can arrive
+                        it = mRings.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+            if (!mBatch.empty())
+            {
+                mFile.write(mBatch.data(), mBatch.size());
+                mFile.flush();
+            }
+        }
+
+        void writerLoop()
+        {
+            LL_PROFILER_SET_THREAD_NAME("LogWriter");
+            bool stopping = false;
+            while (!stopping)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mWakeMutex);
+                    mWake.wait_for(lock, std::chrono::milliseconds(100),
+                                   [this]() { return mStopping || mPending.load(); });
+                    stopping = mStopping;
+                }
+                mPending = false;
+                writePending();
+            }
+        }
+
         const std::string mName;
         llofstream mFile;
+
+        const bool mAsync;
+        const U64 mSerial;
+        static std::atomic<U64> sNextSerial;
+
+        std::mutex mRingsMutex;
+        std::vector<std::shared_ptr<LogRing> > mRings;
+        std::mutex mWriteMutex;
+        std::string mBatch;
+
+        std::thread mWriter;
+        std::mutex mWakeMutex;
+        std::condition_variable mWake;
+        std::atomic<bool> mPending;
+        bool mStopping;
     };
 
+    std::atomic<U64> RecordToFile::sNextSerial(0);
+
 
     class RecordToStderr : public LLError::Recorder
     {
@@ -494,6 +726,7 @@ namespace
         LLError::ELevel                     mDefaultLevel;
 
         bool                                mLogAlwaysFlush;
+        bool                                mLogAsync;
 
         U32                                 mEnabledLogTypesMask;
 
@@ -509,6 +742,11 @@ namespace
         Recorders                           mRecorders;
         LL_PROFILE_MUTEX_NAMED(LLCoros::RMutex, mRecorderMutex, "Log Recorders");
 
+        // the current file recorder when it is asynchronous, reachable without
+        // the log mutex so that contended messages need not be dropped
+        std::shared_ptr<RecordToFile>       mAsyncFileRecorder;
+        std::mutex                          mAsyncFileRecorderMutex;
+
         int                                 mShouldLogCallCounter;
 
     private:
@@ -521,6 +759,7 @@ namespace
         : LLRefCount(),
         mDefaultLevel(LLError::LEVEL_DEBUG),
         mLogAlwaysFlush(true),
+        mLogAsync(false),
         mEnabledLogTypesMask(255),
         mFunctionLevelMap(),
         mClassLevelMap(),
@@ -829,6 +1068,29 @@ namespace LLError
         return s->mLogAlwaysFlush;
     }
 
+    void setAsyncLogging(bool async)
+    {
+        SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
+        if (s->mLogAsync == async)
+        {
+            return;
+        }
+        s->mLogAsync = async;
+
+        // reopen the current log file, if any, in the new mode
+        std::string file_name = logFileName();
+        if (!file_name.empty())
+        {
+            logToFile(file_name);
+        }
+    }
+
+    bool getAsyncLogging()
+    {
+        SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
+        return s->mLogAsync;
+    }
+
     void setEnabledLogTypesMask(U32 mask)
     {
         SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
@@ -929,6 +1191,10 @@ namespace LLError
         {
             setAlwaysFlush(config["log-always-flush"]);
         }
+        if (config.has("log-async"))
+        {
+            setAsyncLogging(config["log-async"]);
+        }
         if (config.has("enabled-log-types-mask"))
         {
             setEnabledLogTypesMask(config["enabled-log-types-mask"].asInteger());
@@ -1129,15 +1395,26 @@ namespace LLError
 {
     void logToFile(const std::string& file_name)
     {
+        SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
+        {
+            std::lock_guard<std::mutex> lock(s->mAsyncFileRecorderMutex);
+            s->mAsyncFileRecorder.reset();
+        }
+
         // remove any previous Recorder filling this role
         removeRecorder<RecordToFile>();
 
         if (!file_name.empty())
         {
-            std::shared_ptr<RecordToFile> recordToFile(new RecordToFile(file_name));
+            std::shared_ptr<RecordToFile> recordToFile(new RecordToFile(file_name, s->mLogAsync));
             if (recordToFile->okay())
             {
                 addRecorder(recordToFile);
+                if (recordToFile->isAsync())
+                {
+                    std::lock_guard<std::mutex> lock(s->mAsyncFileRecorderMutex);
+                    s->mAsyncFileRecorder = recordToFile;
+                }
             }
         }
     }
@@ -1213,6 +1490,57 @@ namespace
         return out.str();
     }
 
+    std::string formatForRecorder(LLError::Recorder& r, const SettingsConfigPtr& s, const LLError::CallSite& site,
+                                  const std::string& message, std::string& escaped_message)
+    {
+        std::ostringstream message_stream;
+
+        if (r.wantsTime() && s->mTimeFunction != NULL)
+        {
+            message_stream << s->mTimeFunction();
+        }
+        message_stream << " ";
+
+        if (r.wantsLevel())
+        {
+            message_stream << site.mLevelString;
+        }
+        message_stream << " ";
+
+        if (r.wantsTags())
+        {
+            message_stream << site.mTagString;
+        }
+        message_stream << " ";
+
+        if (r.wantsLocation() || site.mLevel == LLError::LEVEL_ERROR)
+        {
+            message_stream << site.mLocationString;
+        }
+        message_stream << " ";
+
+        if (r.wantsFunctionName())
+        {
+            message_stream << site.mFunctionString;
+        }
+        message_stream << " : ";
+
+        if (r.wantsMultiline())
+        {
+            message_stream << message;
+        }
+        else
+        {
+            if (escaped_message.empty())
+            {
+                escaped_message = escapedMessageLines(message);
+            }
+            message_stream << escaped_message;
+        }
+
+        return message_stream.str();
+    }
+
     void writeToRecorders(const LLError::CallSite& site, const std::string& message)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LOGGING;
@@ -1229,53 +1557,30 @@ namespace
                 continue;
             }
 
-            std::ostringstream message_stream;
-
-            if (r->wantsTime() && s->mTimeFunction != NULL)
-            {
-                message_stream << s->mTimeFunction();
-            }
-            message_stream << " ";
-
-            if (r->wantsLevel())
-            {
-                message_stream << site.mLevelString;
-            }
-            message_stream << " ";
-
-            if (r->wantsTags())
-            {
-                message_stream << site.mTagString;
-            }
-            message_stream << " ";
-
-            if (r->wantsLocation() || level == LLError::LEVEL_ERROR)
-            {
-                message_stream << site.mLocationString;
-            }
-            message_stream << " ";
-
-            if (r->wantsFunctionName())
-            {
-                message_stream << site.mFunctionString;
-            }
-            message_stream << " : ";
-
-            if (r->wantsMultiline())
-            {
-                message_stream << message;
-            }
-            else
-            {
-                if (escaped_message.empty())
-                {
-                    escaped_message = escapedMessageLines(message);
-                }
-                message_stream << escaped_message;
-            }
+            r->recordMessage(level, formatForRecorder(*r, s, site, message, escaped_message));
+        }
+    }
 
-            r->recordMessage(level, message_stream.str());
+    // Called instead of dropping a message when another thread holds the log
+    // mutex: if the file recorder is asynchronous, queue the message for it
+    // directly. Returns false if there is no such recorder.
+    bool writeToAsyncFileRecorder(const LLError::CallSite& site, const std::string& message)
+    {
+        SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
+        std::shared_ptr<RecordToFile> recorder;
+        {
+            std::lock_guard<std::mutex> lock(s->mAsyncFileRecorderMutex);
+            recorder = s->mAsyncFileRecorder;
+        }
+        if (!recorder || !recorder->enabled())
+        {
+            return false;
         }
+
+        std::string escaped_message;
+        std::string line = formatForRecorder(*recorder, s, site, message, escaped_message);
+        recorder->queueLine(line, site.mLevel);
+        return true;
     }
 }
 
@@ -1392,6 +1697,12 @@ namespace LLError
         std::unique_lock lock(*getLogMutex(), std::try_to_lock); LL_PROFILE_MUTEX_LOCK(*getLogMutex());
         if (!lock)
         {
+            // Print-once bookkeeping needs the lock, so those are still
+            // skipped, but everything else can go to an asynchronous log file.
+            if (!site.mPrintOnce)
+            {
+                writeToAsyncFileRecorder(site, out.str());
+            }
             return;
         }
 
@@ -75,6 +75,14 @@ namespace LLError
     LL_COMMON_API ELevel getDefaultLevel();
     LL_COMMON_API void setAlwaysFlush(bool flush);
     LL_COMMON_API bool getAlwaysFlush();
+    LL_COMMON_API void setAsyncLogging(bool async);
+    LL_COMMON_API bool getAsyncLogging();
+        // In async mode the log file recorder queues formatted lines in
+        // per-thread lock-free buffers which a dedicated thread writes to disk
+        // in batches, so logging threads never wait on file I/O. Messages that
+        // would otherwise be dropped because another thread holds the log lock
+        // are queued for the file as well. Reopens the current log file, if
+        // any. Also set by "log-async" in the logging configuration.
     LL_COMMON_API void setEnabledLogTypesMask(U32 mask);
     LL_COMMON_API U32 getEnabledLogTypesMask();
     LL_COMMON_API void setFunctionLevel(const std::string& function_name, LLError::ELevel);
@@ -37,6 +37,7 @@
 #include "llsdserialize.h"
 #include "stringize.h"
 
+#include <atomic>
 #include <limits>
 
 // Defend against a caller forcibly passing a negative number into an unsigned
@@ -435,12 +436,25 @@ namespace
 
         DataMap mData;
 
+        // Optional open addressing (linear probing) hash index over mData,
+        // empty until the map reaches LLSD::MAP_HASH_INDEX_THRESHOLD entries.
+        // Slots point at mData nodes, which std::map never relocates.
+        struct IndexSlot
+        {
+            size_t              mHash;
+            DataMap::iterator   mIter;
+            bool                mUsed = false;
+        };
+        std::vector<IndexSlot> mIndex;
+
     protected:
-        ImplMap(const DataMap& data) : mData(data) { }
+        ImplMap(const DataMap& data) : mData(data) { maybeBuildIndex(); }
 
     public:
         ImplMap() { }
 
+        static std::atomic<bool> sHashIndexEnabled;
+
         virtual ImplMap& makeMap(LLSD::Impl*&);
 
         virtual LLSD::Type type() const { return LLSD::TypeMap; }
@@ -481,8 +495,127 @@ namespace
 
         virtual void dumpStats() const;
         virtual void calcStats(S32 type_counts[], S32 share_counts[]) const;
+
+    private:
+        static size_t hashKey(std::string_view k) { return std::hash<std::string_view>()(k); }
+
+        DataMap::const_iterator find(std::string_view k) const;
+        size_t findSlot(std::string_view k, size_t hash) const;
+        void maybeBuildIndex();
+        void rebuildIndex(size_t capacity);
+        void indexAdd(DataMap::iterator it);
+        void indexRemove(size_t slot);
     };
 
+    std::atomic<bool> ImplMap::sHashIndexEnabled(true);
+
+    // Returns the slot holding k, or the empty slot that ends its probe sequence.
+    size_t ImplMap::findSlot(std::string_view k, size_t hash) const
+    {
+        const size_t mask = mIndex.size() - 1;
+        size_t i = hash & mask;
+        while (mIndex[i].mUsed)
+        {
+            if (mIndex[i].mHash == hash && mIndex[i].mIter->first == k)
+            {
+                break;
+            }
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    ImplMap::DataMap::const_iterator ImplMap::find(std::string_view k) const
+    {
+        if (mIndex.empty())
+        {
+            return mData.find(k);
+        }
+
+        const IndexSlot& slot = mIndex[findSlot(k, hashKey(k))];
+        return slot.mUsed ? DataMap::const_iterator(slot.mIter) : mData.end();
+    }
+
+    void ImplMap::maybeBuildIndex()
+    {
+        if (mIndex.empty()
+            && mData.size() >= LLSD::MAP_HASH_INDEX_THRESHOLD
+            && sHashIndexEnabled.load(std::memory_order_relaxed))
+        {
+            rebuildIndex(mData.size() * 2);
+        }
+    }
+
+    void ImplMap::rebuildIndex(size_t capacity)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+        size_t size = 32;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        mIndex.clear();
+        mIndex.resize(size);
+        const size_t mask = size - 1;
+        for (DataMap::iterator it = mData.begin(); it != mData.end(); ++it)
+        {
+            size_t hash = hashKey(it->first);
+            size_t i = hash & mask;
+            while (mIndex[i].mUsed)
+            {
+                i = (i + 1) & mask;
+            }
+            mIndex[i].mHash = hash;
+            mIndex[i].mIter = it;
+            mIndex[i].mUsed = true;
+        }
+    }
+
+    // it has just been added to mData
+    void ImplMap::indexAdd(DataMap::iterator it)
+    {
+        if (mIndex.empty())
+        {
+            maybeBuildIndex();
+            return;
+        }
+
+        // keep the load factor at or below one half
+        if (mData.size() * 2 > mIndex.size())
+        {
+            rebuildIndex(mIndex.size() * 2);
+            return;
+        }
+
+        size_t hash = hashKey(it->first);
+        IndexSlot& slot = mIndex[findSlot(it->first, hash)];
+        slot.mHash = hash;
+        slot.mIter = it;
+        slot.mUsed = true;
+    }
+
+    // Backward shift deletion: pull later members of the probe run into the
+    // hole so that lookups never need tombstones.
+    void ImplMap::indexRemove(size_t hole)
+    {
+        const size_t mask = mIndex.size() - 1;
+        size_t i = (hole + 1) & mask;
+        while (mIndex[i].mUsed)
+        {
+            size_t home = mIndex[i].mHash & mask;
+            // move slot i into the hole unless its home lies cyclically in (hole, i]
+            bool stays = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+            if (!stays)
+            {
+                mIndex[hole] = mIndex[i];
+                hole = i;
+            }
+            i = (i + 1) & mask;
+        }
+        mIndex[hole].mUsed = false;
+    }
+
     ImplMap& ImplMap::makeMap(LLSD::Impl*& var)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
@@ -501,14 +634,14 @@ namespace
     bool ImplMap::has(const std::string_view k) const
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-        DataMap::const_iterator i = mData.find(k);
+        DataMap::const_iterator i = find(k);
         return i != mData.end();
     }
 
     LLSD ImplMap::get(const std::string_view k) const
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-        DataMap::const_iterator i = mData.find(k);
+        DataMap::const_iterator i = find(k);
         return (i != mData.end()) ? i->second : LLSD();
     }
 
@@ -528,21 +661,50 @@ namespace
     void ImplMap::insert(std::string_view k, const LLSD& v)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-        mData.emplace(k, v);
+        auto result = mData.emplace(k, v);
+        if (result.second)
+        {
+            indexAdd(result.first);
+        }
     }
 
     void ImplMap::erase(const LLSD::String& k)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-        mData.erase(k);
+        if (mIndex.empty())
+        {
+            mData.erase(k);
+            return;
+        }
+
+        size_t slot = findSlot(k, hashKey(k));
+        if (mIndex[slot].mUsed)
+        {
+            DataMap::iterator it = mIndex[slot].mIter;
+            indexRemove(slot);
+            mData.erase(it);
+        }
     }
 
     LLSD& ImplMap::ref(std::string_view k)
     {
+        if (!mIndex.empty())
+        {
+            const IndexSlot& slot = mIndex[findSlot(k, hashKey(k))];
+            if (slot.mUsed)
+            {
+                return slot.mIter->second;
+            }
+            DataMap::iterator it = mData.emplace(k, LLSD()).first;
+            indexAdd(it);
+            return it->second;
+        }
+
         DataMap::iterator i = mData.lower_bound(k);
         if (i == mData.end() || mData.key_comp()(k, i->first))
         {
-            return mData.emplace_hint(i, std::make_pair(k, LLSD()))->second;
+            i = mData.emplace_hint(i, std::make_pair(k, LLSD()));
+            indexAdd(i);
         }
 
         return i->second;
@@ -550,8 +712,8 @@ namespace
 
     const LLSD& ImplMap::ref(std::string_view k) const
     {
-        DataMap::const_iterator i = mData.lower_bound(k);
-        if (i == mData.end() || mData.key_comp()(k, i->first))
+        DataMap::const_iterator i = find(k);
+        if (i == mData.end())
         {
             return undef();
         }
@@ -1034,6 +1196,16 @@ LLSD LLSD::emptyMap()
     return v;
 }
 
+void LLSD::setMapHashIndexEnabled(bool enable)
+{
+    ImplMap::sHashIndexEnabled.store(enable, std::memory_order_relaxed);
+}
+
+bool LLSD::getMapHashIndexEnabled()
+{
+    return ImplMap::sHashIndexEnabled.load(std::memory_order_relaxed);
+}
+
 bool LLSD::has(const std::string_view k) const  { return safe(impl).has(k); }
 LLSD LLSD::get(const std::string_view k) const  { return safe(impl).get(k); }
 LLSD LLSD::getKeys() const              { return safe(impl).getKeys(); }
@@ -335,6 +335,15 @@ public:
         {
             return c ? (*this)[std::string_view(c)] : *this;
         }
+
+        /// Maps with at least MAP_HASH_INDEX_THRESHOLD entries keep an open
+        /// addressing hash index of their keys alongside the sorted map, so
+        /// key lookups cost one hash instead of a chain of string compares.
+        /// Iteration order (and therefore serialization) is unchanged.
+        /// Disabling only affects maps that grow past the threshold afterwards.
+        static void setMapHashIndexEnabled(bool enable);
+        static bool getMapHashIndexEnabled();
+        static constexpr size_t MAP_HASH_INDEX_THRESHOLD = 16;
     //@}
 
     /** @name Array Values */
@@ -403,6 +403,46 @@ S32 LLSDParser::parseLines(std::istream& istr, LLSD& data)
     return doParse(istr, data);
 }
 
+S32 LLSDParser::parse(std::istream& istr, LLSDSAXHandler& handler, llssize max_bytes, S32 max_depth)
+{
+    mCheckLimits = LLSDSerialize::SIZE_UNLIMITED != max_bytes;
+    mMaxBytesLeft = max_bytes;
+    return doParseEvents(istr, handler, max_depth);
+}
+
+S32 LLSDParser::parse(const char* buf, llssize len, LLSDSAXHandler& handler, S32 max_depth)
+{
+    boost::iostreams::stream<boost::iostreams::array_source> istr(buf, len);
+    return parse(istr, handler, len, max_depth);
+}
+
+// virtual
+S32 LLSDParser::doParseEvents(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const
+{
+    LLSD data;
+    S32 parse_count = doParse(istr, data, max_depth);
+    if (parse_count > 0 && !handler.replay(data))
+    {
+        return PARSE_STOPPED;
+    }
+    return parse_count;
+}
+
+S32 LLSDParser::parseFromEvents(std::istream& istr, LLSD& data, S32 max_depth) const
+{
+    LLSDSAXBuilder builder;
+    S32 parse_count = doParseEvents(istr, builder, max_depth);
+    if(parse_count > 0)
+    {
+        data = builder.getLLSD();
+    }
+    else if(PARSE_FAILURE == parse_count)
+    {
+        data.clear();
+    }
+    return parse_count;
+}
+
 
 int LLSDParser::get(std::istream& istr) const
 {
@@ -474,6 +514,99 @@ LLSDNotationParser::~LLSDNotationParser()
 
 // virtual
 S32 LLSDNotationParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) const
+{
+    return parseFromEvents(istr, data, max_depth);
+}
+
+bool LLSDNotationParser::parseBinary(std::istream& istr, LLSD::Binary& value) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    // binary: b##"ff3120ab1"
+    // or: b(len)"..."
+
+    // I want to manually control those values here to make sure the
+    // parser doesn't break when someone changes a constant somewhere
+    // else.
+    const U32 BINARY_BUFFER_SIZE = 256;
+    const U32 STREAM_GET_COUNT = 255;
+
+    // need to read the base out.
+    char buf[BINARY_BUFFER_SIZE];       /* Flawfinder: ignore */
+    get(istr, buf, STREAM_GET_COUNT, '"');
+    char c = get(istr);
+    if(c != '"') return false;
+    if(0 == strncmp("b(", buf, 2))
+    {
+        // We probably have a valid raw binary stream. determine
+        // the size, and read it.
+        auto len = strtol(buf + 2, NULL, 0);
+        if(mCheckLimits && (len > mMaxBytesLeft)) return false;
+        value.clear();
+        if(len)
+        {
+            value.resize(len);
+            account(fullread(istr, (char *)&value[0], len));
+        }
+        c = get(istr); // strip off the trailing double-quote
+    }
+    else if(0 == strncmp("b64", buf, 3))
+    {
+        // *FIX: A bit inefficient, but works for now. To make the
+        // format better, I would need to add a hint into the
+        // serialization format that indicated how long it was.
+        std::stringstream coded_stream;
+        get(istr, *(coded_stream.rdbuf()), '\"');
+        c = get(istr);
+        std::string encoded(coded_stream.str());
+        S32 len = apr_base64_decode_len(encoded.c_str());
+        value.clear();
+        if(len)
+        {
+            value.resize(len);
+            len = apr_base64_decode_binary(&value[0], encoded.c_str());
+            value.resize(len);
+        }
+    }
+    else if(0 == strncmp("b16", buf, 3))
+    {
+        // yay, base 16. We pop the next character which is either a
+        // double quote or base 16 data. If it's a double quote, we're
+        // done parsing. If it's not, put the data back, and read the
+        // stream until the next double quote.
+        char* read;  /*Flawfinder: ignore*/
+        U8 byte;
+        U8 byte_buffer[BINARY_BUFFER_SIZE];
+        U8* write;
+        value.clear();
+        c = get(istr);
+        while(c != '"')
+        {
+            putback(istr, c);
+            read = buf;
+            write = byte_buffer;
+            get(istr, buf, STREAM_GET_COUNT, '"');
+            c = get(istr);
+            while(*read != '\0')     /*Flawfinder: ignore*/
+            {
+                byte = hex_as_nybble(*read++);
+                byte = byte << 4;
+                byte |= hex_as_nybble(*read++);
+                *write++ = byte;
+            }
+            // copy the data out of the byte buffer
+            value.insert(value.end(), byte_buffer, write);
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+// virtual
+S32 LLSDNotationParser::doParseEvents(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
     // map: { string:object, string:object }
@@ -505,19 +638,17 @@ S32 LLSDNotationParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) c
         return 0;
     }
     S32 parse_count = 1;
+    bool keep_going = true;
     switch(c)
     {
     case '{':
     {
-        S32 child_count = parseMap(istr, data, max_depth - 1);
-        if((child_count == PARSE_FAILURE) || data.isUndefined())
-        {
-            parse_count = PARSE_FAILURE;
-        }
-        else
+        S32 child_count = parseMap(istr, handler, max_depth - 1);
+        if(child_count < 0)
         {
-            parse_count += child_count;
+            return child_count;
         }
+        parse_count += child_count;
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading map." << LL_ENDL;
@@ -528,15 +659,12 @@ S32 LLSDNotationParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) c
 
     case '[':
     {
-        S32 child_count = parseArray(istr, data, max_depth - 1);
-        if((child_count == PARSE_FAILURE) || data.isUndefined())
-        {
-            parse_count = PARSE_FAILURE;
-        }
-        else
+        S32 child_count = parseArray(istr, handler, max_depth - 1);
+        if(child_count < 0)
         {
-            parse_count += child_count;
+            return child_count;
         }
+        parse_count += child_count;
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading array." << LL_ENDL;
@@ -547,76 +675,64 @@ S32 LLSDNotationParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) c
 
     case '!':
         c = get(istr);
-        data.clear();
+        keep_going = handler.undefValue();
         break;
 
     case '0':
         c = get(istr);
-        data = false;
+        keep_going = handler.booleanValue(false);
+        break;
+
+    case '1':
+        c = get(istr);
+        keep_going = handler.booleanValue(true);
         break;
 
     case 'F':
     case 'f':
+    case 'T':
+    case 't':
+    {
+        bool value = (c == 'T') || (c == 't');
         ignore(istr);
         c = istr.peek();
         if(isalpha(c))
         {
+            LLSD data;
             auto cnt = deserialize_boolean(
                 istr,
                 data,
-                NOTATION_FALSE_SERIAL,
-                false);
+                value ? NOTATION_TRUE_SERIAL : NOTATION_FALSE_SERIAL,
+                value);
             if(PARSE_FAILURE == cnt) parse_count = (S32)cnt;
             else account(cnt);
         }
-        else
-        {
-            data = false;
-        }
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading boolean." << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
-        break;
-
-    case '1':
-        c = get(istr);
-        data = true;
-        break;
-
-    case 'T':
-    case 't':
-        ignore(istr);
-        c = istr.peek();
-        if(isalpha(c))
-        {
-            auto cnt = deserialize_boolean(istr,data,NOTATION_TRUE_SERIAL,true);
-            if(PARSE_FAILURE == cnt) parse_count = (S32)cnt;
-            else account(cnt);
-        }
-        else
-        {
-            data = true;
-        }
-        if(istr.fail())
+        else if(parse_count > 0)
         {
-            LL_INFOS() << "STREAM FAILURE reading boolean." << LL_ENDL;
-            parse_count = PARSE_FAILURE;
+            keep_going = handler.booleanValue(value);
         }
         break;
+    }
 
     case 'i':
     {
         c = get(istr);
         S32 integer = 0;
         istr >> integer;
-        data = integer;
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading integer." << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
+        else
+        {
+            keep_going = handler.integerValue(integer);
+        }
         break;
     }
 
@@ -625,12 +741,15 @@ S32 LLSDNotationParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) c
         c = get(istr);
         F64 real = 0.0;
         istr >> real;
-        data = real;
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading real." << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
+        else
+        {
+            keep_going = handler.realValue(real);
+        }
         break;
     }
 
@@ -639,86 +758,72 @@ S32 LLSDNotationParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) c
         c = get(istr);
         LLUUID id;
         istr >> id;
-        data = id;
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading uuid." << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
+        else
+        {
+            keep_going = handler.uuidValue(id);
+        }
         break;
     }
 
     case '\"':
     case '\'':
     case 's':
-        if(!parseString(istr, data))
-        {
-            parse_count = PARSE_FAILURE;
-        }
-        if(istr.fail())
-        {
-            LL_INFOS() << "STREAM FAILURE reading string." << LL_ENDL;
-            parse_count = PARSE_FAILURE;
-        }
-        break;
-
-    case 'l':
     {
-        c = get(istr); // pop the 'l'
-        c = get(istr); // pop the delimiter
-        std::string str;
-        auto cnt = deserialize_string_delim(istr, str, c);
-        if(PARSE_FAILURE == cnt)
+        std::string value;
+        auto cnt = deserialize_string(istr, value, mMaxBytesLeft);
+        if((PARSE_FAILURE == cnt) || istr.fail())
         {
+            LL_INFOS() << "STREAM FAILURE reading string." << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
         else
         {
-            data = LLURI(str);
             account(cnt);
-        }
-        if(istr.fail())
-        {
-            LL_INFOS() << "STREAM FAILURE reading link." << LL_ENDL;
-            parse_count = PARSE_FAILURE;
+            keep_going = handler.stringValue(value);
         }
         break;
     }
 
+    case 'l':
     case 'd':
     {
-        c = get(istr); // pop the 'd'
+        bool is_link = (c == 'l');
+        c = get(istr); // pop the 'l' or 'd'
         c = get(istr); // pop the delimiter
         std::string str;
         auto cnt = deserialize_string_delim(istr, str, c);
-        if(PARSE_FAILURE == cnt)
+        if((PARSE_FAILURE == cnt) || istr.fail())
         {
+            LL_INFOS() << "STREAM FAILURE reading " << (is_link ? "link." : "date.") << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
         else
         {
-            data = LLDate(str);
             account(cnt);
-        }
-        if(istr.fail())
-        {
-            LL_INFOS() << "STREAM FAILURE reading date." << LL_ENDL;
-            parse_count = PARSE_FAILURE;
+            keep_going = is_link ? handler.uriValue(LLURI(str)) : handler.dateValue(LLDate(str));
         }
         break;
     }
 
     case 'b':
-        if(!parseBinary(istr, data))
+    {
+        LLSD::Binary value;
+        if(!parseBinary(istr, value) || istr.fail())
         {
+            LL_INFOS() << "STREAM FAILURE reading data." << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
-        if(istr.fail())
+        else
         {
-            LL_INFOS() << "STREAM FAILURE reading data." << LL_ENDL;
-            parse_count = PARSE_FAILURE;
+            keep_going = handler.binaryValue(value);
         }
         break;
+    }
 
     default:
         parse_count = PARSE_FAILURE;
@@ -726,215 +831,114 @@ S32 LLSDNotationParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) c
             << ")" << LL_ENDL;
         break;
     }
-    if(PARSE_FAILURE == parse_count)
-    {
-        data.clear();
-    }
-    return parse_count;
+    return keep_going ? parse_count : PARSE_STOPPED;
 }
 
-S32 LLSDNotationParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) const
+S32 LLSDNotationParser::parseMap(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
     // map: { string:object, string:object }
-    map = LLSD::emptyMap();
     S32 parse_count = 0;
     char c = get(istr);
-    if(c == '{')
+    if(c != '{')
     {
-        // eat commas, white
-        bool found_name = false;
-        std::string name;
-        c = get(istr);
-        while(c != '}' && istr.good())
+        return PARSE_FAILURE;
+    }
+    if(!handler.mapBegin())
+    {
+        return PARSE_STOPPED;
+    }
+    // eat commas, white
+    bool found_name = false;
+    std::string name;
+    c = get(istr);
+    while(c != '}' && istr.good())
+    {
+        if(!found_name)
         {
-            if(!found_name)
-            {
-                if((c == '\"') || (c == '\'') || (c == 's'))
-                {
-                    putback(istr, c);
-                    found_name = true;
-                    auto count = deserialize_string(istr, name, mMaxBytesLeft);
-                    if(PARSE_FAILURE == count) return PARSE_FAILURE;
-                    account(count);
-                }
-                c = get(istr);
-            }
-            else
+            if((c == '\"') || (c == '\'') || (c == 's'))
             {
-                if(isspace(c) || (c == ':'))
-                {
-                    c = get(istr);
-                    continue;
-                }
                 putback(istr, c);
-                LLSD child;
-                S32 count = doParse(istr, child, max_depth);
-                if(count > 0)
-                {
-                    // There must be a value for every key, thus
-                    // child_count must be greater than 0.
-                    parse_count += count;
-                    map.insert(name, child);
-                }
-                else
-                {
-                    return PARSE_FAILURE;
-                }
-                found_name = false;
-                c = get(istr);
+                found_name = true;
+                auto count = deserialize_string(istr, name, mMaxBytesLeft);
+                if(PARSE_FAILURE == count) return PARSE_FAILURE;
+                account(count);
             }
+            c = get(istr);
         }
-        if(c != '}')
-        {
-            map.clear();
-            return PARSE_FAILURE;
-        }
-    }
-    return parse_count;
-}
-
-S32 LLSDNotationParser::parseArray(std::istream& istr, LLSD& array, S32 max_depth) const
-{
-    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-    // array: [ object, object, object ]
-    array = LLSD::emptyArray();
-    S32 parse_count = 0;
-    char c = get(istr);
-    if(c == '[')
-    {
-        // eat commas, white
-        c = get(istr);
-        while((c != ']') && istr.good())
+        else
         {
-            LLSD child;
-            if(isspace(c) || (c == ','))
+            if(isspace(c) || (c == ':'))
             {
                 c = get(istr);
                 continue;
             }
             putback(istr, c);
-            S32 count = doParse(istr, child, max_depth);
-            if(PARSE_FAILURE == count)
+            if(!handler.mapKey(name))
             {
-                return PARSE_FAILURE;
+                return PARSE_STOPPED;
             }
-            else
+            S32 count = doParseEvents(istr, handler, max_depth);
+            if(count < 0)
             {
-                parse_count += count;
-                array.append(child);
+                return count;
             }
+            if(count == 0)
+            {
+                // There must be a value for every key.
+                return PARSE_FAILURE;
+            }
+            parse_count += count;
+            found_name = false;
             c = get(istr);
         }
-        if(c != ']')
-        {
-            return PARSE_FAILURE;
-        }
     }
-    return parse_count;
-}
-
-bool LLSDNotationParser::parseString(std::istream& istr, LLSD& data) const
-{
-    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-    std::string value;
-    auto count = deserialize_string(istr, value, mMaxBytesLeft);
-    if(PARSE_FAILURE == count) return false;
-    account(count);
-    data = value;
-    return true;
+    if(c != '}')
+    {
+        return PARSE_FAILURE;
+    }
+    return handler.mapEnd() ? parse_count : PARSE_STOPPED;
 }
 
-bool LLSDNotationParser::parseBinary(std::istream& istr, LLSD& data) const
+S32 LLSDNotationParser::parseArray(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
-    // binary: b##"ff3120ab1"
-    // or: b(len)"..."
-
-    // I want to manually control those values here to make sure the
-    // parser doesn't break when someone changes a constant somewhere
-    // else.
-    const U32 BINARY_BUFFER_SIZE = 256;
-    const U32 STREAM_GET_COUNT = 255;
-
-    // need to read the base out.
-    char buf[BINARY_BUFFER_SIZE];       /* Flawfinder: ignore */
-    get(istr, buf, STREAM_GET_COUNT, '"');
+    // array: [ object, object, object ]
+    S32 parse_count = 0;
     char c = get(istr);
-    if(c != '"') return false;
-    if(0 == strncmp("b(", buf, 2))
+    if(c != '[')
     {
-        // We probably have a valid raw binary stream. determine
-        // the size, and read it.
-        auto len = strtol(buf + 2, NULL, 0);
-        if(mCheckLimits && (len > mMaxBytesLeft)) return false;
-        std::vector<U8> value;
-        if(len)
-        {
-            value.resize(len);
-            account(fullread(istr, (char *)&value[0], len));
-        }
-        c = get(istr); // strip off the trailing double-quote
-        data = value;
+        return PARSE_FAILURE;
     }
-    else if(0 == strncmp("b64", buf, 3))
+    if(!handler.arrayBegin())
     {
-        // *FIX: A bit inefficient, but works for now. To make the
-        // format better, I would need to add a hint into the
-        // serialization format that indicated how long it was.
-        std::stringstream coded_stream;
-        get(istr, *(coded_stream.rdbuf()), '\"');
-        c = get(istr);
-        std::string encoded(coded_stream.str());
-        S32 len = apr_base64_decode_len(encoded.c_str());
-        std::vector<U8> value;
-        if(len)
-        {
-            value.resize(len);
-            len = apr_base64_decode_binary(&value[0], encoded.c_str());
-            value.resize(len);
-        }
-        data = value;
+        return PARSE_STOPPED;
     }
-    else if(0 == strncmp("b16", buf, 3))
+    // eat commas, white
+    c = get(istr);
+    while((c != ']') && istr.good())
     {
-        // yay, base 16. We pop the next character which is either a
-        // double quote or base 16 data. If it's a double quote, we're
-        // done parsing. If it's not, put the data back, and read the
-        // stream until the next double quote.
-        char* read;  /*Flawfinder: ignore*/
-        U8 byte;
-        U8 byte_buffer[BINARY_BUFFER_SIZE];
-        U8* write;
-        std::vector<U8> value;
-        c = get(istr);
-        while(c != '"')
+        if(isspace(c) || (c == ','))
         {
-            putback(istr, c);
-            read = buf;
-            write = byte_buffer;
-            get(istr, buf, STREAM_GET_COUNT, '"');
             c = get(istr);
-            while(*read != '\0')     /*Flawfinder: ignore*/
-            {
-                byte = hex_as_nybble(*read++);
-                byte = byte << 4;
-                byte |= hex_as_nybble(*read++);
-                *write++ = byte;
-            }
-            // copy the data out of the byte buffer
-            value.insert(value.end(), byte_buffer, write);
+            continue;
         }
-        data = value;
+        putback(istr, c);
+        S32 count = doParseEvents(istr, handler, max_depth);
+        if(count < 0)
+        {
+            return count;
+        }
+        parse_count += count;
+        c = get(istr);
     }
-    else
+    if(c != ']')
     {
-        return false;
+        return PARSE_FAILURE;
     }
-    return true;
+    return handler.arrayEnd() ? parse_count : PARSE_STOPPED;
 }
 
-
 /**
  * LLSDBinaryParser
  */
@@ -949,6 +953,33 @@ LLSDBinaryParser::~LLSDBinaryParser()
 
 // virtual
 S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) const
+{
+    return parseFromEvents(istr, data, max_depth);
+}
+
+bool LLSDBinaryParser::parseString(
+    std::istream& istr,
+    std::string& value) const
+{
+    // *FIX: This is memory inefficient.
+    U32 value_nbo = 0;
+    read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
+    S32 size = (S32)ntohl(value_nbo);
+    if(mCheckLimits && (size > mMaxBytesLeft)) return false;
+    if(size < 0) return false;
+    std::vector<char> buf;
+    if(size)
+    {
+        buf.resize(size);
+        account(fullread(istr, &buf[0], size));
+        value.assign(buf.begin(), buf.end());
+    }
+    return true;
+}
+
+
+// virtual
+S32 LLSDBinaryParser::doParseEvents(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
 /**
@@ -978,19 +1009,17 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
         return PARSE_FAILURE;
     }
     S32 parse_count = 1;
+    bool keep_going = true;
     switch(c)
     {
     case '{':
     {
-        S32 child_count = parseMap(istr, data, max_depth - 1);
-        if((child_count == PARSE_FAILURE) || data.isUndefined())
-        {
-            parse_count = PARSE_FAILURE;
-        }
-        else
+        S32 child_count = parseMap(istr, handler, max_depth - 1);
+        if(child_count < 0)
         {
-            parse_count += child_count;
+            return child_count;
         }
+        parse_count += child_count;
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading binary map." << LL_ENDL;
@@ -1001,15 +1030,12 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
 
     case '[':
     {
-        S32 child_count = parseArray(istr, data, max_depth - 1);
-        if((child_count == PARSE_FAILURE) || data.isUndefined())
+        S32 child_count = parseArray(istr, handler, max_depth - 1);
+        if(child_count < 0)
         {
-            parse_count = PARSE_FAILURE;
-        }
-        else
-        {
-            parse_count += child_count;
+            return child_count;
         }
+        parse_count += child_count;
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading binary array." << LL_ENDL;
@@ -1019,26 +1045,26 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
     }
 
     case '!':
-        data.clear();
+        keep_going = handler.undefValue();
         break;
 
     case '0':
-        data = false;
+        keep_going = handler.booleanValue(false);
         break;
 
     case '1':
-        data = true;
+        keep_going = handler.booleanValue(true);
         break;
 
     case 'i':
     {
         U32 value_nbo = 0;
         read(istr, (char*)&value_nbo, sizeof(U32));  /*Flawfinder: ignore*/
-        data = (S32)ntohl(value_nbo);
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading binary integer." << LL_ENDL;
         }
+        keep_going = handler.integerValue((S32)ntohl(value_nbo));
         break;
     }
 
@@ -1046,11 +1072,11 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
     {
         F64 real_nbo = 0.0;
         read(istr, (char*)&real_nbo, sizeof(F64));   /*Flawfinder: ignore*/
-        data = ll_ntohd(real_nbo);
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading binary real." << LL_ENDL;
         }
+        keep_going = handler.realValue(ll_ntohd(real_nbo));
         break;
     }
 
@@ -1058,11 +1084,11 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
     {
         LLUUID id;
         read(istr, (char*)(&id.mData), UUID_BYTES);  /*Flawfinder: ignore*/
-        data = id;
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading binary uuid." << LL_ENDL;
         }
+        keep_going = handler.uuidValue(id);
         break;
     }
 
@@ -1071,58 +1097,36 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
     {
         std::string value;
         auto cnt = deserialize_string_delim(istr, value, c);
-        if(PARSE_FAILURE == cnt)
+        if((PARSE_FAILURE == cnt) || istr.fail())
         {
+            LL_INFOS() << "STREAM FAILURE reading binary (notation-style) string."
+                << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
         else
         {
-            data = value;
             account(cnt);
-        }
-        if(istr.fail())
-        {
-            LL_INFOS() << "STREAM FAILURE reading binary (notation-style) string."
-                << LL_ENDL;
-            parse_count = PARSE_FAILURE;
+            keep_going = handler.stringValue(value);
         }
         break;
     }
 
     case 's':
+    case 'l':
     {
         std::string value;
-        if(parseString(istr, value))
-        {
-            data = value;
-        }
-        else
+        if(!parseString(istr, value) || istr.fail())
         {
+            LL_INFOS() << "STREAM FAILURE reading binary " << (c == 's' ? "string." : "link.") << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
-        if(istr.fail())
+        else if(c == 's')
         {
-            LL_INFOS() << "STREAM FAILURE reading binary string." << LL_ENDL;
-            parse_count = PARSE_FAILURE;
-        }
-        break;
-    }
-
-    case 'l':
-    {
-        std::string value;
-        if(parseString(istr, value))
-        {
-            data = LLURI(value);
+            keep_going = handler.stringValue(value);
         }
         else
         {
-            parse_count = PARSE_FAILURE;
-        }
-        if(istr.fail())
-        {
-            LL_INFOS() << "STREAM FAILURE reading binary link." << LL_ENDL;
-            parse_count = PARSE_FAILURE;
+            keep_going = handler.uriValue(LLURI(value));
         }
         break;
     }
@@ -1131,41 +1135,42 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
     {
         F64 real = 0.0;
         read(istr, (char*)&real, sizeof(F64));   /*Flawfinder: ignore*/
-        data = LLDate(real);
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading binary date." << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
+        else
+        {
+            keep_going = handler.dateValue(LLDate(real));
+        }
         break;
     }
 
     case 'b':
     {
-        // We probably have a valid raw binary stream. determine
-        // the size, and read it.
         U32 size_nbo = 0;
         read(istr, (char*)&size_nbo, sizeof(U32));  /*Flawfinder: ignore*/
         S32 size = (S32)ntohl(size_nbo);
+        LLSD::Binary value;
         if(mCheckLimits && (size > mMaxBytesLeft))
         {
             parse_count = PARSE_FAILURE;
         }
-        else
+        else if(size > 0)
         {
-            std::vector<U8> value;
-            if(size > 0)
-            {
-                value.resize(size);
-                account(fullread(istr, (char*)&value[0], size));
-            }
-            data = value;
+            value.resize(size);
+            account(fullread(istr, (char*)&value[0], size));
         }
         if(istr.fail())
         {
             LL_INFOS() << "STREAM FAILURE reading binary." << LL_ENDL;
             parse_count = PARSE_FAILURE;
         }
+        else if(parse_count > 0)
+        {
+            keep_going = handler.binaryValue(value);
+        }
         break;
     }
 
@@ -1175,25 +1180,25 @@ S32 LLSDBinaryParser::doParse(std::istream& istr, LLSD& data, S32 max_depth) con
             << ")" << LL_ENDL;
         break;
     }
-    if(PARSE_FAILURE == parse_count)
-    {
-        data.clear();
-    }
-    return parse_count;
+    return keep_going ? parse_count : PARSE_STOPPED;
 }
 
-S32 LLSDBinaryParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) const
+S32 LLSDBinaryParser::parseMap(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const
 {
-    map = LLSD::emptyMap();
     U32 value_nbo = 0;
     read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
     S32 size = (S32)ntohl(value_nbo);
+    if(!handler.mapBegin())
+    {
+        return PARSE_STOPPED;
+    }
     S32 parse_count = 0;
     S32 count = 0;
+    std::string name;
     char c = get(istr);
     while(c != '}' && (count < size) && istr.good())
     {
-        std::string name;
+        name.clear();
         switch(c)
         {
         case 'k':
@@ -1211,19 +1216,21 @@ S32 LLSDBinaryParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) con
             break;
         }
         }
-        LLSD child;
-        S32 child_count = doParse(istr, child, max_depth);
-        if(child_count > 0)
+        if(!handler.mapKey(name))
         {
-            // There must be a value for every key, thus child_count
-            // must be greater than 0.
-            parse_count += child_count;
-            map.insert(name, child);
+            return PARSE_STOPPED;
         }
-        else
+        S32 child_count = doParseEvents(istr, handler, max_depth);
+        if(child_count < 0)
+        {
+            return child_count;
+        }
+        if(child_count == 0)
         {
+            // There must be a value for every key.
             return PARSE_FAILURE;
         }
+        parse_count += child_count;
         ++count;
         c = get(istr);
     }
@@ -1233,35 +1240,29 @@ S32 LLSDBinaryParser::parseMap(std::istream& istr, LLSD& map, S32 max_depth) con
         // as were said to be there.
         return PARSE_FAILURE;
     }
-    return parse_count;
+    return handler.mapEnd() ? parse_count : PARSE_STOPPED;
 }
 
-S32 LLSDBinaryParser::parseArray(std::istream& istr, LLSD& array, S32 max_depth) const
+S32 LLSDBinaryParser::parseArray(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const
 {
-    array = LLSD::emptyArray();
     U32 value_nbo = 0;
     read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
     S32 size = (S32)ntohl(value_nbo);
-
-    // *FIX: This would be a good place to reserve some space in the
-    // array...
-
+    if(!handler.arrayBegin())
+    {
+        return PARSE_STOPPED;
+    }
     S32 parse_count = 0;
     S32 count = 0;
     char c = istr.peek();
     while((c != ']') && (count < size) && istr.good())
     {
-        LLSD child;
-        S32 child_count = doParse(istr, child, max_depth);
-        if(PARSE_FAILURE == child_count)
+        S32 child_count = doParseEvents(istr, handler, max_depth);
+        if(child_count < 0)
         {
-            return PARSE_FAILURE;
-        }
-        if(child_count)
-        {
-            parse_count += child_count;
-            array.append(child);
+            return child_count;
         }
+        parse_count += child_count;
         ++count;
         c = istr.peek();
     }
@@ -1272,26 +1273,209 @@ S32 LLSDBinaryParser::parseArray(std::istream& istr, LLSD& array, S32 max_depth)
         // as were said to be there.
         return PARSE_FAILURE;
     }
-    return parse_count;
+    return handler.arrayEnd() ? parse_count : PARSE_STOPPED;
 }
 
-bool LLSDBinaryParser::parseString(
-    std::istream& istr,
-    std::string& value) const
+
+/**
+ * LLSDSAXHandler
+ */
+bool LLSDSAXHandler::replay(const LLSD& sd)
 {
-    // *FIX: This is memory inefficient.
-    U32 value_nbo = 0;
-    read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
-    S32 size = (S32)ntohl(value_nbo);
-    if(mCheckLimits && (size > mMaxBytesLeft)) return false;
-    if(size < 0) return false;
-    std::vector<char> buf;
-    if(size)
+    switch(sd.type())
     {
-        buf.resize(size);
-        account(fullread(istr, &buf[0], size));
-        value.assign(buf.begin(), buf.end());
+    case LLSD::TypeMap:
+        if(!mapBegin())
+        {
+            return false;
+        }
+        for(LLSD::map_const_iterator it = sd.beginMap(); it != sd.endMap(); ++it)
+        {
+            if(!mapKey(it->first) || !replay(it->second))
+            {
+                return false;
+            }
+        }
+        return mapEnd();
+
+    case LLSD::TypeArray:
+        if(!arrayBegin())
+        {
+            return false;
+        }
+        for(LLSD::array_const_iterator it = sd.beginArray(); it != sd.endArray(); ++it)
+        {
+            if(!replay(*it))
+            {
+                return false;
+            }
+        }
+        return arrayEnd();
+
+    case LLSD::TypeBoolean:
+        return booleanValue(sd.asBoolean());
+    case LLSD::TypeInteger:
+        return integerValue(sd.asInteger());
+    case LLSD::TypeReal:
+        return realValue(sd.asReal());
+    case LLSD::TypeString:
+    {
+        LLSD::String value(sd.asString());
+        return stringValue(value);
+    }
+    case LLSD::TypeUUID:
+        return uuidValue(sd.asUUID());
+    case LLSD::TypeDate:
+        return dateValue(sd.asDate());
+    case LLSD::TypeURI:
+        return uriValue(sd.asURI());
+    case LLSD::TypeBinary:
+    {
+        LLSD::Binary value(sd.asBinary());
+        return binaryValue(value);
+    }
+    default:
+        return undefValue();
+    }
+}
+
+
+/**
+ * LLSDSAXBuilder
+ */
+LLSDSAXBuilder::LLSDSAXBuilder()
+    : mComplete(false)
+{
+}
+
+void LLSDSAXBuilder::reset()
+{
+    mResult.clear();
+    mStack.clear();
+    mKey.clear();
+    mComplete = false;
+}
+
+LLSD& LLSDSAXBuilder::newValue()
+{
+    if(mStack.empty())
+    {
+        mComplete = true;
+        return mResult;
+    }
+    LLSD* container = mStack.back();
+    if(container->isArray())
+    {
+        return container->append(LLSD());
     }
+    size_t size = container->size();
+    LLSD& slot = (*container)[mKey];
+    if(container->size() == size)
+    {
+        // first value wins, like LLSD::insert(); build the duplicate
+        // into a scratch value that is thrown away
+        mDropped.clear();
+        return mDropped;
+    }
+    return slot;
+}
+
+void LLSDSAXBuilder::closeContainer()
+{
+    if(!mStack.empty())
+    {
+        mStack.pop_back();
+    }
+    mComplete = mStack.empty();
+}
+
+bool LLSDSAXBuilder::mapBegin()
+{
+    LLSD& slot = newValue();
+    slot = LLSD::emptyMap();
+    mStack.push_back(&slot);
+    mComplete = false;
+    return true;
+}
+
+bool LLSDSAXBuilder::mapKey(const std::string& key)
+{
+    mKey = key;
+    return true;
+}
+
+bool LLSDSAXBuilder::mapEnd()
+{
+    closeContainer();
+    return true;
+}
+
+bool LLSDSAXBuilder::arrayBegin()
+{
+    LLSD& slot = newValue();
+    slot = LLSD::emptyArray();
+    mStack.push_back(&slot);
+    mComplete = false;
+    return true;
+}
+
+bool LLSDSAXBuilder::arrayEnd()
+{
+    closeContainer();
+    return true;
+}
+
+bool LLSDSAXBuilder::undefValue()
+{
+    newValue().clear();
+    return true;
+}
+
+bool LLSDSAXBuilder::booleanValue(LLSD::Boolean value)
+{
+    newValue() = value;
+    return true;
+}
+
+bool LLSDSAXBuilder::integerValue(LLSD::Integer value)
+{
+    newValue() = value;
+    return true;
+}
+
+bool LLSDSAXBuilder::realValue(LLSD::Real value)
+{
+    newValue() = value;
+    return true;
+}
+
+bool LLSDSAXBuilder::stringValue(LLSD::String& value)
+{
+    newValue() = std::move(value);
+    return true;
+}
+
+bool LLSDSAXBuilder::uuidValue(const LLSD::UUID& value)
+{
+    newValue() = value;
+    return true;
+}
+
+bool LLSDSAXBuilder::dateValue(const LLSD::Date& value)
+{
+    newValue() = value;
+    return true;
+}
+
+bool LLSDSAXBuilder::uriValue(const LLSD::URI& value)
+{
+    newValue() = value;
+    return true;
+}
+
+bool LLSDSAXBuilder::binaryValue(LLSD::Binary& value)
+{
+    newValue() = std::move(value);
     return true;
 }
 
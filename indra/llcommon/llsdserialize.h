@@ -34,6 +34,93 @@
 #include "llrefcount.h"
 #include "llsd.h"
 
+/**
+ * @class LLSDSAXHandler
+ * @brief Receives the events of an LLSDParser event parse.
+ *
+ * Instead of building an LLSD tree, LLSDParser::parse() with a handler
+ * reports structure and values in document order. Inside a map, every
+ * value is preceded by a mapKey() call. Each callback returns false to
+ * stop the parse early. String and binary values may be moved from.
+ */
+class LL_COMMON_API LLSDSAXHandler
+{
+public:
+    virtual ~LLSDSAXHandler() = default;
+
+    virtual bool mapBegin() = 0;
+    virtual bool mapKey(const std::string& key) = 0;
+    virtual bool mapEnd() = 0;
+    virtual bool arrayBegin() = 0;
+    virtual bool arrayEnd() = 0;
+
+    virtual bool undefValue() = 0;
+    virtual bool booleanValue(LLSD::Boolean value) = 0;
+    virtual bool integerValue(LLSD::Integer value) = 0;
+    virtual bool realValue(LLSD::Real value) = 0;
+    virtual bool stringValue(LLSD::String& value) = 0;
+    virtual bool uuidValue(const LLSD::UUID& value) = 0;
+    virtual bool dateValue(const LLSD::Date& value) = 0;
+    virtual bool uriValue(const LLSD::URI& value) = 0;
+    virtual bool binaryValue(LLSD::Binary& value) = 0;
+
+    /**
+     * @brief Report an existing LLSD value as events, as if it were parsed.
+     *
+     * @return Returns false if one of the callbacks stopped the walk.
+     */
+    bool replay(const LLSD& sd);
+};
+
+/**
+ * @class LLSDSAXBuilder
+ * @brief LLSDSAXHandler which assembles the events back into an LLSD.
+ *
+ * Handy for capturing just a subtree of an event parse: forward the
+ * events of the interesting value to a builder and take getLLSD() once
+ * it is complete. Duplicate map keys keep the first value, as the tree
+ * parsers do.
+ */
+class LL_COMMON_API LLSDSAXBuilder : public LLSDSAXHandler
+{
+public:
+    LLSDSAXBuilder();
+
+    /// Forget the current value and any open containers.
+    void reset();
+
+    /// True once a complete value has been received.
+    bool isComplete() const { return mComplete; }
+    LLSD& getLLSD() { return mResult; }
+
+    bool mapBegin() override;
+    bool mapKey(const std::string& key) override;
+    bool mapEnd() override;
+    bool arrayBegin() override;
+    bool arrayEnd() override;
+
+    bool undefValue() override;
+    bool booleanValue(LLSD::Boolean value) override;
+    bool integerValue(LLSD::Integer value) override;
+    bool realValue(LLSD::Real value) override;
+    bool stringValue(LLSD::String& value) override;
+    bool uuidValue(const LLSD::UUID& value) override;
+    bool dateValue(const LLSD::Date& value) override;
+    bool uriValue(const LLSD::URI& value) override;
+    bool binaryValue(LLSD::Binary& value) override;
+
+private:
+    // Slot that receives the next value.
+    LLSD& newValue();
+    void closeContainer();
+
+    LLSD mResult;
+    LLSD mDropped;
+    std::vector<LLSD*> mStack;
+    std::string mKey;
+    bool mComplete;
+};
+
 /**
  * @class LLSDParser
  * @brief Abstract base class for LLSD parsers.
@@ -52,7 +139,8 @@ public:
      */
     enum
     {
-        PARSE_FAILURE = -1
+        PARSE_FAILURE = -1,
+        PARSE_STOPPED = -2
     };
 
     /**
@@ -85,6 +173,26 @@ public:
      */
     S32 parseLines(std::istream& istr, LLSD& data);
 
+    /**
+     * @brief Event driven version of parse().
+     *
+     * Reports one data object to handler as it is read instead of
+     * building an LLSD, so callers that only walk the result once need
+     * not materialize it. Otherwise behaves like parse().
+     * @param istr The input stream.
+     * @param handler Receives the parse events.
+     * @param max_bytes The maximum number of bytes that will be in
+     * the stream, or LLSDSerialize::SIZE_UNLIMITED.
+     * @return Returns the number of LLSD objects reported, PARSE_FAILURE
+     * on parse failure or PARSE_STOPPED if the handler stopped early.
+     */
+    S32 parse(std::istream& istr, LLSDSAXHandler& handler, llssize max_bytes, S32 max_depth = -1);
+
+    /**
+     * @brief Event driven parse of a raw buffer holding one data object.
+     */
+    S32 parse(const char* buf, llssize len, LLSDSAXHandler& handler, S32 max_depth = -1);
+
     /**
      * @brief Resets the parser so parse() or parseLines() can be called again for another <llsd> chunk.
      */
@@ -110,6 +218,26 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const = 0;
 
+    /**
+     * @brief Virtual base for doing an event driven parse.
+     *
+     * The default implementation parses into an LLSD with doParse() and
+     * replays it, so every parser supports the event API. Parsers that
+     * can stream override it.
+     * @return Returns the number of LLSD objects reported, PARSE_FAILURE
+     * or PARSE_STOPPED.
+     */
+    virtual S32 doParseEvents(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const;
+
+    /**
+     * @brief Build data from doParseEvents() through an LLSDSAXBuilder.
+     *
+     * Lets a parser whose grammar lives in doParseEvents() implement
+     * doParse() without a second copy of it. Leaves data untouched when
+     * nothing was parsed and undefined on failure.
+     */
+    S32 parseFromEvents(std::istream& istr, LLSD& data, S32 max_depth) const;
+
     /**
      * @brief Virtual default function for resetting the parser
      */
@@ -250,44 +378,45 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const;
 
-private:
     /**
-     * @brief Parse a map from the istream
+     * @brief Streaming event parse, see LLSDParser::doParseEvents().
      *
-     * @param istr The input stream.
-     * @param map The map to add the parsed data.
-     * @param max_depth Allowed parsing depth.
-     * @return Returns The number of LLSD objects parsed into data.
+     * This is the only implementation of the grammar; doParse() builds
+     * its result from these events.
      */
-    S32 parseMap(std::istream& istr, LLSD& map, S32 max_depth) const;
+    virtual S32 doParseEvents(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const;
 
+private:
     /**
-     * @brief Parse an array from the istream.
+     * @brief Parse a map from the istream
      *
      * @param istr The input stream.
-     * @param array The array to append the parsed data.
+     * @param handler Receives the map's events.
      * @param max_depth Allowed parsing depth.
-     * @return Returns The number of LLSD objects parsed into data.
+     * @return Returns The number of LLSD objects parsed, PARSE_FAILURE
+     * or PARSE_STOPPED.
      */
-    S32 parseArray(std::istream& istr, LLSD& array, S32 max_depth) const;
+    S32 parseMap(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const;
 
     /**
-     * @brief Parse a string from the istream and assign it to data.
+     * @brief Parse an array from the istream.
      *
      * @param istr The input stream.
-     * @param data[out] The data to assign.
-     * @return Retuns true if a complete string was parsed.
+     * @param handler Receives the array's events.
+     * @param max_depth Allowed parsing depth.
+     * @return Returns The number of LLSD objects parsed, PARSE_FAILURE
+     * or PARSE_STOPPED.
      */
-    bool parseString(std::istream& istr, LLSD& data) const;
+    S32 parseArray(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const;
 
     /**
      * @brief Parse binary data from the stream.
      *
      * @param istr The input stream.
-     * @param data[out] The data to assign.
+     * @param value[out] The data to assign.
      * @return Retuns true if a complete blob was parsed.
      */
-    bool parseBinary(std::istream& istr, LLSD& data) const;
+    bool parseBinary(std::istream& istr, LLSD::Binary& value) const;
 };
 
 /**
@@ -377,26 +506,36 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const;
 
+    /**
+     * @brief Streaming event parse, see LLSDParser::doParseEvents().
+     *
+     * This is the only implementation of the grammar; doParse() builds
+     * its result from these events.
+     */
+    virtual S32 doParseEvents(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const;
+
 private:
     /**
      * @brief Parse a map from the istream
      *
      * @param istr The input stream.
-     * @param map The map to add the parsed data.
+     * @param handler Receives the map's events.
      * @param max_depth Allowed parsing depth.
-     * @return Returns The number of LLSD objects parsed into data.
+     * @return Returns The number of LLSD objects parsed, PARSE_FAILURE
+     * or PARSE_STOPPED.
      */
-    S32 parseMap(std::istream& istr, LLSD& map, S32 max_depth) const;
+    S32 parseMap(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const;
 
     /**
      * @brief Parse an array from the istream.
      *
      * @param istr The input stream.
-     * @param array The array to append the parsed data.
+     * @param handler Receives the array's events.
      * @param max_depth Allowed parsing depth.
-     * @return Returns The number of LLSD objects parsed into data.
+     * @return Returns The number of LLSD objects parsed, PARSE_FAILURE
+     * or PARSE_STOPPED.
      */
-    S32 parseArray(std::istream& istr, LLSD& array, S32 max_depth) const;
+    S32 parseArray(std::istream& istr, LLSDSAXHandler& handler, S32 max_depth) const;
 
     /**
      * @brief Parse a string from the istream and assign it to data.
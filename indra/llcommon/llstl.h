@@ -243,8 +243,8 @@ inline typename T::mapped_type get_ptr_in_map(const T& inmap, typename T::key_ty
 };
 
 // helper function which returns true if key is in inmap.
-template <typename K, typename T>
-inline bool is_in_map(const std::map<K,T>& inmap, const K& key)
+template <typename T>
+inline bool is_in_map(const T& inmap, typename T::key_type const& key)
 {
     if(inmap.find(key) == inmap.end())
     {
@@ -115,4 +115,41 @@ namespace tut
         bitunpack.bitUnpack((U8*) &res, sizeof(res)*8);
         ensure("U32->bitPack->bitUnpack->U32 should be equal", num == res);
     }
+
+    // odd sized fields across byte boundaries
+    template<> template<>
+    void bit_pack_object_t::test<4>()
+    {
+        U8 packbuffer[255];
+        U8 byte;
+
+        LLBitPack bitpack(packbuffer, 255);
+        byte = 1;
+        bitpack.bitPack(&byte, 1);
+        byte = 0x15;
+        bitpack.bitPack(&byte, 5);
+        U32 num = 0x2d6b5;
+        bitpack.bitPack((U8*)&num, 18);
+        byte = 0x3;
+        bitpack.bitPack(&byte, 2);
+        S32 pack_bufsize = bitpack.flushBitPack();
+
+        // unpackBits() reads fields most significant bit first, bitUnpack()
+        // a byte at a time, so the two must agree on each whole byte
+        LLBitPack bitunpack(packbuffer, pack_bufsize*8);
+        ensure_equals("unpackBits: 1 bit", bitunpack.unpackBits(1), (U32)1);
+        ensure_equals("unpackBits: 5 bits", bitunpack.unpackBits(5), (U32)0x15);
+        U32 low = bitunpack.unpackBits(8);
+        U32 mid = bitunpack.unpackBits(8);
+        U32 high = bitunpack.unpackBits(2);
+        ensure_equals("unpackBits: bytes of 18 bits", low | (mid << 8) | (high << 16), num);
+        ensure_equals("unpackBits: 2 bits", bitunpack.unpackBits(2), (U32)0x3);
+
+        LLBitPack bytewise(packbuffer, pack_bufsize*8);
+        LLBitPack wide(packbuffer, pack_bufsize*8);
+        U8 first[4] = { 0 };
+        bytewise.bitUnpack(first, 26);
+        U32 expected = (first[0] << 18) | (first[1] << 10) | (first[2] << 2) | first[3];
+        ensure_equals("unpackBits: 26 bits at once", wide.unpackBits(26), expected);
+    }
 }
@@ -25,6 +25,8 @@
  * $/LicenseInfo$
  */
 
+#include <iostream>
+#include <thread>
 #include <vector>
 #include <stdexcept>
 
@@ -33,7 +35,11 @@
 #include "../llerror.h"
 
 #include "../llerrorcontrol.h"
+#include "../llfile.h"
 #include "../llsd.h"
+#include "../lltimer.h"
+#include "../lluuid.h"
+#include "../stringize.h"
 
 #include "../test/lltut.h"
 
@@ -918,6 +924,129 @@ namespace tut
     }
 }
 
+namespace
+{
+    void logBenchLine(int thread, int line)
+    {
+        LL_INFOS("LogBench") << "thread " << thread << " line " << line << LL_ENDL;
+    }
+
+    // Log lines_per_thread lines from each of num_threads threads to a file and
+    // return calls/sec; lines_written receives how many lines reached the file.
+    F64 logFromThreads(const std::string& path, bool async, int num_threads, int lines_per_thread, size_t& lines_written)
+    {
+        LLError::setAsyncLogging(async);
+        LLError::logToFile(path);
+        // caches the call site so no thread's first line goes to shouldLog()
+        logBenchLine(-1, 0);
+
+        LLTimer timer;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back([t, lines_per_thread]()
+                {
+                    for (int i = 0; i < lines_per_thread; ++i)
+                    {
+                        logBenchLine(t, i);
+                    }
+                });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        F64 elapsed = timer.getElapsedTimeF64();
+
+        // closes the file, writing out anything still queued
+        LLError::logToFile("");
+
+        lines_written = 0;
+        llifstream file(path.c_str());
+        std::string line;
+        while (std::getline(file, line))
+        {
+            ++lines_written;
+        }
+        file.close();
+        LLFile::remove(path);
+
+        return (F64)(num_threads * lines_per_thread) / llmax(elapsed, 0.000001);
+    }
+}
+
+namespace tut
+{
+    template<> template<>
+    void ErrorTestObject::test<19>()
+        // asynchronous file logging loses nothing under contention; compare
+        // throughput with synchronous logging from 8 threads
+    {
+        const int NUM_THREADS = 8;
+        const int LINES_PER_THREAD = 20000;
+        const size_t EXPECTED = NUM_THREADS * LINES_PER_THREAD + 1;
+
+        // keep the in-memory test recorder out of the measurement
+        LLError::removeRecorder(mRecorder);
+        LLError::setDefaultLevel(LLError::LEVEL_INFO);
+        std::string path = STRINGIZE(LLFile::tmpdir() << "llerror-test-" << LLUUID::generateNewID() << ".log");
+
+        size_t sync_lines = 0;
+        F64 sync_rate = logFromThreads(path, false, NUM_THREADS, LINES_PER_THREAD, sync_lines);
+        size_t async_lines = 0;
+        F64 async_rate = logFromThreads(path, true, NUM_THREADS, LINES_PER_THREAD, async_lines);
+        LLError::setAsyncLogging(false);
+
+        std::cout << "\nlog calls/sec from " << NUM_THREADS << " threads: synchronous " << (U64)sync_rate
+                  << " (" << EXPECTED - sync_lines << " dropped), asynchronous " << (U64)async_rate
+                  << " (" << EXPECTED - async_lines << " dropped)" << std::endl;
+
+        ensure("synchronous lines written", sync_lines <= EXPECTED);
+        ensure_equals("asynchronous lines written", async_lines, EXPECTED);
+    }
+
+    template<> template<>
+    void ErrorTestObject::test<20>()
+        // lines from threads that exit before the writer drains their ring
+        // still reach the file
+    {
+        const int NUM_THREADS = 200;
+        const int LINES_PER_THREAD = 10;
+
+        LLError::removeRecorder(mRecorder);
+        LLError::setDefaultLevel(LLError::LEVEL_INFO);
+        LLError::setAsyncLogging(true);
+        std::string path = STRINGIZE(LLFile::tmpdir() << "llerror-test-" << LLUUID::generateNewID() << ".log");
+        LLError::logToFile(path);
+
+        for (int t = 0; t < NUM_THREADS; ++t)
+        {
+            std::thread([t]()
+                {
+                    for (int i = 0; i < LINES_PER_THREAD; ++i)
+                    {
+                        logBenchLine(t, i);
+                    }
+                }).join();
+        }
+
+        LLError::logToFile("");
+        LLError::setAsyncLogging(false);
+
+        size_t lines_written = 0;
+        llifstream file(path.c_str());
+        std::string line;
+        while (std::getline(file, line))
+        {
+            ++lines_written;
+        }
+        file.close();
+        LLFile::remove(path);
+
+        ensure_equals("lines written by short-lived threads", lines_written, (size_t)(NUM_THREADS * LINES_PER_THREAD));
+    }
+}
+
 /* Tests left:
     handling of classes without LOG_CLASS
 
@@ -51,6 +51,7 @@ typedef U32 uint32_t;
 #include "llsdutil.h"
 #include "llformat.h"
 #include "llmemorystream.h"
+#include "lltimer.h"
 
 #include "../test/hexdump.h"
 #include "../test/lltut.h"
@@ -2182,6 +2183,267 @@ namespace tut
                         { return LLSDSerialize::fromNotation(data, istr, max_bytes) > 0; });
     }
 
+    /**
+     * @class TestLLSDEventParsing
+     * @brief Checks LLSDParser::parse() with an LLSDSAXHandler against the
+     * tree parse of the same input.
+     */
+    class TestLLSDEventParsing
+    {
+    public:
+        TestLLSDEventParsing()
+        {
+            mSample["name"] = "shirt 'red' \"tee\"";
+            mSample["item_id"] = LLUUID::generateNewID();
+            mSample["created_at"] = 1700000000;
+            mSample["price"] = 12.5;
+            mSample["active"] = true;
+            mSample["nothing"] = LLSD();
+            mSample["when"] = LLDate(1234567.0);
+            mSample["link"] = LLURI("http://secondlife.com");
+            std::vector<U8> bytes(5, 0xab);
+            mSample["bytes"] = bytes;
+            LLSD perms = LLSD::emptyMap();
+            perms["owner_mask"] = 0x7fffffff;
+            perms["group_id"] = LLUUID::null;
+            mSample["permissions"] = perms;
+            LLSD list = LLSD::emptyArray();
+            list.append(1);
+            list.append("two");
+            list.append(LLSD::emptyMap());
+            list.append(LLSD::emptyArray());
+            mSample["list"] = list;
+        }
+
+        void ensureEvents(const std::string& msg, LLSDParser* parser, const std::string& str, S32 max_depth = -1)
+        {
+            LLSD tree;
+            std::istringstream istr(str);
+            S32 tree_count = parser->parse(istr, tree, str.size(), max_depth);
+            parser->reset();
+
+            LLSDSAXBuilder builder;
+            S32 event_count = parser->parse(str.data(), str.size(), builder, max_depth);
+            parser->reset();
+
+            ensure_equals(msg + " count", event_count, tree_count);
+            if (tree_count > 0)
+            {
+                ensure(msg + " complete", builder.isComplete());
+                ensure_equals(msg + " value", builder.getLLSD(), tree);
+            }
+            else
+            {
+                ensure(msg + " failed tree is undefined", tree.isUndefined());
+            }
+        }
+
+        // every prefix of str, as if the stream was cut short
+        void ensureTruncatedEvents(const std::string& msg, LLSDParser* parser, const std::string& str)
+        {
+            for (size_t len = 0; len < str.size(); ++len)
+            {
+                ensureEvents(STRINGIZE(msg << " cut at " << len), parser, str.substr(0, len));
+            }
+        }
+
+        LLSD mSample;
+    };
+
+    typedef tut::test_group<TestLLSDEventParsing> TestLLSDEventParsingGroup;
+    typedef TestLLSDEventParsingGroup::object TestLLSDEventParsingObject;
+    TestLLSDEventParsingGroup gTestLLSDEventParsingGroup("llsd event parsing");
+
+    // Counts events and stops after a given number of integers.
+    class IntegerCounter : public LLSDSAXBuilder
+    {
+    public:
+        IntegerCounter(S32 stop_after) : mCount(0), mStopAfter(stop_after) {}
+        bool integerValue(LLSD::Integer value) override
+        {
+            LLSDSAXBuilder::integerValue(value);
+            return ++mCount < mStopAfter;
+        }
+        S32 mCount;
+        S32 mStopAfter;
+    };
+
+    // Only counts values, to time the parse itself.
+    class ValueCounter : public LLSDSAXHandler
+    {
+    public:
+        ValueCounter() : mCount(0) {}
+        bool mapBegin() override                      { return true; }
+        bool mapKey(const std::string&) override      { return true; }
+        bool mapEnd() override                        { return true; }
+        bool arrayBegin() override                    { return true; }
+        bool arrayEnd() override                      { return true; }
+        bool undefValue() override                    { return ++mCount; }
+        bool booleanValue(LLSD::Boolean) override     { return ++mCount; }
+        bool integerValue(LLSD::Integer) override     { return ++mCount; }
+        bool realValue(LLSD::Real) override           { return ++mCount; }
+        bool stringValue(LLSD::String&) override      { return ++mCount; }
+        bool uuidValue(const LLSD::UUID&) override    { return ++mCount; }
+        bool dateValue(const LLSD::Date&) override    { return ++mCount; }
+        bool uriValue(const LLSD::URI&) override      { return ++mCount; }
+        bool binaryValue(LLSD::Binary&) override      { return ++mCount; }
+        S32 mCount;
+    };
+
+    template<> template<>
+    void TestLLSDEventParsingObject::test<1>()
+    {
+        set_test_name("events match the tree parse");
+        std::ostringstream notation, binary, xml;
+        LLSDSerialize::toNotation(mSample, notation);
+        LLSDSerialize::toBinary(mSample, binary);
+        LLSDSerialize::toXML(mSample, xml);
+
+        ensureEvents("notation", LLPointer<LLSDParser>(new LLSDNotationParser), notation.str());
+        ensureEvents("binary", LLPointer<LLSDParser>(new LLSDBinaryParser), binary.str());
+        // XML has no streaming parse and replays the tree
+        ensureEvents("xml", LLPointer<LLSDParser>(new LLSDXMLParser), xml.str());
+
+        ensureEvents("notation scalar", LLPointer<LLSDParser>(new LLSDNotationParser), "i42");
+        ensureEvents("notation bool", LLPointer<LLSDParser>(new LLSDNotationParser), "[true,f,1]");
+        ensureEvents("notation duplicate key", LLPointer<LLSDParser>(new LLSDNotationParser),
+                     "{'a':i1,'a':{'b':i2},'c':[i3]}");
+    }
+
+    template<> template<>
+    void TestLLSDEventParsingObject::test<2>()
+    {
+        set_test_name("handler can stop the parse; bad input fails");
+        std::string str("[i1,i2,i3,i4]");
+        LLPointer<LLSDParser> parser = new LLSDNotationParser;
+        IntegerCounter counter(2);
+        ensure_equals("stopped", parser->parse(str.data(), str.size(), counter), (S32)LLSDParser::PARSE_STOPPED);
+        ensure_equals("stopped after second", counter.mCount, 2);
+
+        std::string truncated("{'a':i1,'b':[i2");
+        LLSDSAXBuilder builder;
+        ensure_equals("truncated", parser->parse(truncated.data(), truncated.size(), builder),
+                      (S32)LLSDParser::PARSE_FAILURE);
+    }
+
+    template<> template<>
+    void TestLLSDEventParsingObject::test<3>()
+    {
+        set_test_name("tree vs event parse of an inventory shaped stream");
+        const S32 RECORDS = 20000;
+        std::ostringstream ostr;
+        for (S32 i = 0; i < RECORDS; ++i)
+        {
+            LLSD item = mSample;
+            item["created_at"] = i;
+            ostr << LLSDNotationStreamer(item) << "\n";
+        }
+        std::string str(ostr.str());
+        LLPointer<LLSDParser> parser = new LLSDNotationParser;
+
+        LLTimer timer;
+        S32 tree_records = 0;
+        {
+            std::istringstream istr(str);
+            LLSD record;
+            while (parser->parse(istr, record, LLSDSerialize::SIZE_UNLIMITED) > 0)
+            {
+                ++tree_records;
+            }
+        }
+        F64 tree_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        ValueCounter counter;
+        S32 event_records = 0;
+        {
+            std::istringstream istr(str);
+            while (parser->parse(istr, counter, LLSDSerialize::SIZE_UNLIMITED) > 0)
+            {
+                ++event_records;
+            }
+        }
+        F64 event_time = timer.getElapsedTimeF64();
+
+        ensure_equals("tree records", tree_records, RECORDS);
+        ensure_equals("event records", event_records, RECORDS);
+        ensure("values reported", counter.mCount > RECORDS);
+        std::cout << RECORDS << " records: tree parse " << tree_time * 1000.0
+                  << "ms, event parse " << event_time * 1000.0 << "ms" << std::endl;
+    }
+
+    template<> template<>
+    void TestLLSDEventParsingObject::test<4>()
+    {
+        set_test_name("malformed and deeply nested input fails the same way for tree and events");
+        LLPointer<LLSDParser> notation = new LLSDNotationParser;
+        LLPointer<LLSDParser> binary = new LLSDBinaryParser;
+
+        const char* bad_notation[] = {
+            "{'a':i1,'b':[i2",
+            "{'a':i1 'b'}",
+            "{'a'}",
+            "[i1,,i2",
+            "[i1,i2}",
+            "tru",
+            "fals",
+            "ix",
+            "r.",
+            "u12345",
+            "'unterminated",
+            "s(5)\"ab\"",
+            "l\"http://",
+            "b(99)\"abc\"",
+            "b64\"AAA",
+            "bxx\"00\"",
+            "?",
+        };
+        for (const char* str : bad_notation)
+        {
+            ensureEvents(STRINGIZE("notation '" << str << "'"), notation, str);
+        }
+
+        std::ostringstream notation_str, binary_str;
+        LLSDSerialize::toNotation(mSample, notation_str);
+        LLSDSerialize::toBinary(mSample, binary_str);
+        ensureTruncatedEvents("notation", notation, notation_str.str());
+        ensureTruncatedEvents("binary", binary, binary_str.str());
+
+        // map and array sizes that do not match their contents
+        std::string wrong_size(binary_str.str());
+        wrong_size[1] = (char)0x7f;
+        ensureEvents("binary map size", binary, wrong_size);
+        std::string bad_type(binary_str.str());
+        bad_type[0] = 'x';
+        ensureEvents("binary bad type", binary, bad_type);
+
+        const S32 DEPTH = 200;
+        LLSD nested(1);
+        for (S32 i = 0; i < DEPTH; ++i)
+        {
+            LLSD outer = (i % 2) ? LLSD::emptyArray() : LLSD::emptyMap();
+            if (outer.isArray())
+            {
+                outer.append(nested);
+            }
+            else
+            {
+                outer["k"] = nested;
+            }
+            nested = outer;
+        }
+        std::ostringstream nested_notation, nested_binary;
+        LLSDSerialize::toNotation(nested, nested_notation);
+        LLSDSerialize::toBinary(nested, nested_binary);
+        for (S32 max_depth : { -1, DEPTH + 1, DEPTH, DEPTH / 2, 1, 0 })
+        {
+            ensureEvents(STRINGIZE("nested notation, max_depth " << max_depth), notation, nested_notation.str(), max_depth);
+            ensureEvents(STRINGIZE("nested binary, max_depth " << max_depth), binary, nested_binary.str(), max_depth);
+        }
+        ensureTruncatedEvents("nested notation", notation, nested_notation.str());
+        ensureTruncatedEvents("nested binary", binary, nested_binary.str());
+    }
+
 /*==========================================================================*|
     template<> template<>
     void TestPythonCompatibleObject::test<13>()
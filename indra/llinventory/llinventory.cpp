@@ -165,6 +165,13 @@ void LLInventoryObject::rename(const std::string& n)
     }
 }
 
+void LLInventoryObject::importName(const std::string& name)
+{
+    mName = name;
+    LLStringUtil::replaceNonstandardASCII(mName, ' ');
+    LLStringUtil::replaceChar(mName, '|', ' ');
+}
+
 void LLInventoryObject::setParent(const LLUUID& new_parent)
 {
     mParentUUID = new_parent;
@@ -469,6 +476,12 @@ void LLInventoryItem::setDescription(const std::string& d)
     }
 }
 
+void LLInventoryItem::importDescription(const std::string& desc)
+{
+    mDescription = desc;
+    LLStringUtil::replaceNonstandardASCII(mDescription, ' ');
+}
+
 void LLInventoryItem::setPermissions(const LLPermissions& perm)
 {
     mPermissions = perm;
@@ -927,6 +940,25 @@ void LLInventoryItem::asLLSD( LLSD& sd ) const
 bool LLInventoryItem::fromLLSD(const LLSD& sd, bool is_new)
 {
     LL_PROFILE_ZONE_SCOPED;
+    fromLLSDBegin(is_new);
+
+    // iterate as map to avoid making unnecessary temp copies of everything
+    LLSD::map_const_iterator i, end;
+    end = sd.endMap();
+    for (i = sd.beginMap(); i != end; ++i)
+    {
+        if (!fromLLSDField(i->first, i->second))
+        {
+            return false;
+        }
+    }
+
+    fromLLSDEnd();
+    return true;
+}
+
+void LLInventoryItem::fromLLSDBegin(bool is_new)
+{
     if (is_new)
     {
         // If we're adding LLSD to an existing object, need avoid
@@ -937,171 +969,170 @@ bool LLInventoryItem::fromLLSD(const LLSD& sd, bool is_new)
 
     // TODO - figure out if this should be moved into the noclobber fields above
     mThumbnailUUID.setNull();
+}
 
-    // iterate as map to avoid making unnecessary temp copies of everything
-    LLSD::map_const_iterator i, end;
-    end = sd.endMap();
-    for (i = sd.beginMap(); i != end; ++i)
+bool LLInventoryItem::fromLLSDField(const std::string& key, const LLSD& value)
+{
+    if (key == INV_ITEM_ID_LABEL)
     {
-        if (i->first == INV_ITEM_ID_LABEL)
-        {
-            mUUID = i->second;
-            continue;
-        }
+        mUUID = value;
+        return true;
+    }
+
+    if (key == INV_PARENT_ID_LABEL)
+    {
+        mParentUUID = value;
+        return true;
+    }
 
-        if (i->first == INV_PARENT_ID_LABEL)
+    if (key == INV_THUMBNAIL_LABEL)
+    {
+        const LLSD &thumbnail_map = value;
+        const std::string w = INV_ASSET_ID_LABEL;
+        if (thumbnail_map.has(w))
         {
-            mParentUUID = i->second;
-            continue;
+            mThumbnailUUID = thumbnail_map[w];
         }
+        /* Example:
+            <key> asset_id </key>
+            <uuid> acc0ec86 - 17f2 - 4b92 - ab41 - 6718b1f755f7 </uuid>
+            <key> perms </key>
+            <integer> 8 </integer>
+            <key>service</key>
+            <integer> 3 </integer>
+            <key>version</key>
+            <integer> 1 </key>
+        */
+        return true;
+    }
 
-        if (i->first == INV_THUMBNAIL_LABEL)
-        {
-            const LLSD &thumbnail_map = i->second;
-            const std::string w = INV_ASSET_ID_LABEL;
-            if (thumbnail_map.has(w))
-            {
-                mThumbnailUUID = thumbnail_map[w];
-            }
-            /* Example:
-                <key> asset_id </key>
-                <uuid> acc0ec86 - 17f2 - 4b92 - ab41 - 6718b1f755f7 </uuid>
-                <key> perms </key>
-                <integer> 8 </integer>
-                <key>service</key>
-                <integer> 3 </integer>
-                <key>version</key>
-                <integer> 1 </key>
-            */
-          continue;
-      }
+    if (key == INV_THUMBNAIL_ID_LABEL)
+    {
+        mThumbnailUUID = value.asUUID();
+        return true;
+    }
 
-        if (i->first == INV_THUMBNAIL_ID_LABEL)
-        {
-            mThumbnailUUID = i->second.asUUID();
-            continue;
-        }
+    if (key == INV_PERMISSIONS_LABEL)
+    {
+        mPermissions = ll_permissions_from_sd(value);
+        return true;
+    }
 
-        if (i->first == INV_PERMISSIONS_LABEL)
+    if (key == INV_SALE_INFO_LABEL)
+    {
+        // Sale info used to contain next owner perm. It is now in
+        // the permissions. Thus, we read that out, and fix legacy
+        // objects. It's possible this op would fail, but it
+        // should pick up the vast majority of the tasks.
+        bool has_perm_mask = false;
+        U32  perm_mask     = 0;
+        if (!mSaleInfo.fromLLSD(value, has_perm_mask, perm_mask))
         {
-            mPermissions = ll_permissions_from_sd(i->second);
-            continue;
+            return false;
         }
-
-        if (i->first == INV_SALE_INFO_LABEL)
+        if (has_perm_mask)
         {
-            // Sale info used to contain next owner perm. It is now in
-            // the permissions. Thus, we read that out, and fix legacy
-            // objects. It's possible this op would fail, but it
-            // should pick up the vast majority of the tasks.
-            bool has_perm_mask = false;
-            U32  perm_mask     = 0;
-            if (!mSaleInfo.fromLLSD(i->second, has_perm_mask, perm_mask))
+            if (perm_mask == PERM_NONE)
             {
-                return false;
+                perm_mask = mPermissions.getMaskOwner();
             }
-            if (has_perm_mask)
+            // fair use fix.
+            if (!(perm_mask & PERM_COPY))
             {
-                if (perm_mask == PERM_NONE)
-                {
-                    perm_mask = mPermissions.getMaskOwner();
-                }
-                // fair use fix.
-                if (!(perm_mask & PERM_COPY))
-                {
-                    perm_mask |= PERM_TRANSFER;
-                }
-                mPermissions.setMaskNext(perm_mask);
+                perm_mask |= PERM_TRANSFER;
             }
-            continue;
+            mPermissions.setMaskNext(perm_mask);
         }
+        return true;
+    }
 
-        if (i->first == INV_SHADOW_ID_LABEL)
-        {
-            mAssetUUID = i->second;
-            LLXORCipher cipher(MAGIC_ID.mData, UUID_BYTES);
-            cipher.decrypt(mAssetUUID.mData, UUID_BYTES);
-            continue;
-        }
+    if (key == INV_SHADOW_ID_LABEL)
+    {
+        mAssetUUID = value;
+        LLXORCipher cipher(MAGIC_ID.mData, UUID_BYTES);
+        cipher.decrypt(mAssetUUID.mData, UUID_BYTES);
+        return true;
+    }
 
-        if (i->first == INV_ASSET_ID_LABEL)
-        {
-            mAssetUUID = i->second;
-            continue;
-        }
+    if (key == INV_ASSET_ID_LABEL)
+    {
+        mAssetUUID = value;
+        return true;
+    }
 
-        if (i->first == INV_LINKED_ID_LABEL)
-        {
-            mAssetUUID = i->second;
-            continue;
-        }
+    if (key == INV_LINKED_ID_LABEL)
+    {
+        mAssetUUID = value;
+        return true;
+    }
 
-        if (i->first == INV_ASSET_TYPE_LABEL)
+    if (key == INV_ASSET_TYPE_LABEL)
+    {
+        LLSD const &label = value;
+        if (label.isString())
         {
-            LLSD const &label = i->second;
-            if (label.isString())
-            {
-                mType = LLAssetType::lookup(label.asString().c_str());
-            }
-            else if (label.isInteger())
-            {
-                S8 type = (U8) label.asInteger();
-                mType   = static_cast<LLAssetType::EType>(type);
-            }
-            continue;
+            mType = LLAssetType::lookup(label.asString().c_str());
         }
-
-        if (i->first == INV_INVENTORY_TYPE_LABEL)
+        else if (label.isInteger())
         {
-            LLSD const &label = i->second;
-            if (label.isString())
-            {
-                mInventoryType = LLInventoryType::lookup(label.asString().c_str());
-            }
-            else if (label.isInteger())
-            {
-                S8 type        = (U8) label.asInteger();
-                mInventoryType = static_cast<LLInventoryType::EType>(type);
-            }
-            continue;
+            S8 type = (U8) label.asInteger();
+            mType   = static_cast<LLAssetType::EType>(type);
         }
+        return true;
+    }
 
-        if (i->first == INV_FLAGS_LABEL)
+    if (key == INV_INVENTORY_TYPE_LABEL)
+    {
+        LLSD const &label = value;
+        if (label.isString())
         {
-            LLSD const &label = i->second;
-            if (label.isBinary())
-            {
-                mFlags = ll_U32_from_sd(label);
-            }
-            else if (label.isInteger())
-            {
-                mFlags = label.asInteger();
-            }
-            continue;
+            mInventoryType = LLInventoryType::lookup(label.asString().c_str());
         }
-
-        if (i->first == INV_NAME_LABEL)
+        else if (label.isInteger())
         {
-            mName = i->second.asString();
-            LLStringUtil::replaceNonstandardASCII(mName, ' ');
-            LLStringUtil::replaceChar(mName, '|', ' ');
-            continue;
+            S8 type        = (U8) label.asInteger();
+            mInventoryType = static_cast<LLInventoryType::EType>(type);
         }
+        return true;
+    }
 
-        if (i->first == INV_DESC_LABEL)
+    if (key == INV_FLAGS_LABEL)
+    {
+        LLSD const &label = value;
+        if (label.isBinary())
         {
-            mDescription = i->second.asString();
-            LLStringUtil::replaceNonstandardASCII(mDescription, ' ');
-            continue;
+            mFlags = ll_U32_from_sd(label);
         }
-
-        if (i->first == INV_CREATION_DATE_LABEL)
+        else if (label.isInteger())
         {
-            mCreationDate = i->second.asInteger();
-            continue;
+            mFlags = label.asInteger();
         }
+        return true;
+    }
+
+    if (key == INV_NAME_LABEL)
+    {
+        importName(value.asString());
+        return true;
+    }
+
+    if (key == INV_DESC_LABEL)
+    {
+        importDescription(value.asString());
+        return true;
+    }
+
+    if (key == INV_CREATION_DATE_LABEL)
+    {
+        mCreationDate = value.asInteger();
+        return true;
     }
 
+    return true;
+}
+
+void LLInventoryItem::fromLLSDEnd()
+{
     // Need to convert 1.0 simstate files to a useful inventory type
     // and potentially deal with bad inventory tyes eg, a landmark
     // marked as a texture.
@@ -1113,8 +1144,6 @@ bool LLInventoryItem::fromLLSD(const LLSD& sd, bool is_new)
     }
 
     mPermissions.initMasks(mInventoryType);
-
-    return true;
 }
 
 ///----------------------------------------------------------------------------
@@ -1415,37 +1444,48 @@ LLSD LLInventoryCategory::exportLLSD() const
 
 bool LLInventoryCategory::importLLSD(const LLSD& cat_data)
 {
-    if (cat_data.has(INV_FOLDER_ID_LABEL))
+    for (LLSD::map_const_iterator it = cat_data.beginMap(); it != cat_data.endMap(); ++it)
     {
-        setUUID(cat_data[INV_FOLDER_ID_LABEL].asUUID());
+        importLLSDField(it->first, it->second);
     }
-    if (cat_data.has(INV_PARENT_ID_LABEL))
+
+    return true;
+}
+
+bool LLInventoryCategory::importLLSDField(const std::string& key, const LLSD& value)
+{
+    if (key == INV_FOLDER_ID_LABEL)
+    {
+        setUUID(value.asUUID());
+    }
+    else if (key == INV_PARENT_ID_LABEL)
     {
-        setParent(cat_data[INV_PARENT_ID_LABEL].asUUID());
+        setParent(value.asUUID());
     }
-    if (cat_data.has(INV_ASSET_TYPE_LABEL))
+    else if (key == INV_ASSET_TYPE_LABEL)
     {
-        setType(LLAssetType::lookup(cat_data[INV_ASSET_TYPE_LABEL].asString()));
+        setType(LLAssetType::lookup(value.asString()));
     }
-    if (cat_data.has(INV_PREFERRED_TYPE_LABEL))
+    else if (key == INV_PREFERRED_TYPE_LABEL)
     {
-        setPreferredType(LLFolderType::lookup(cat_data[INV_PREFERRED_TYPE_LABEL].asString()));
+        setPreferredType(LLFolderType::lookup(value.asString()));
     }
-    if (cat_data.has(INV_THUMBNAIL_LABEL))
+    else if (key == INV_THUMBNAIL_LABEL)
     {
         LLUUID thumbnail_uuid;
-        const LLSD &thumbnail_data = cat_data[INV_THUMBNAIL_LABEL];
-        if (thumbnail_data.has(INV_ASSET_ID_LABEL))
+        if (value.has(INV_ASSET_ID_LABEL))
         {
-            thumbnail_uuid = thumbnail_data[INV_ASSET_ID_LABEL].asUUID();
+            thumbnail_uuid = value[INV_ASSET_ID_LABEL].asUUID();
         }
         setThumbnailUUID(thumbnail_uuid);
     }
-    if (cat_data.has(INV_NAME_LABEL))
+    else if (key == INV_NAME_LABEL)
     {
-        mName = cat_data[INV_NAME_LABEL].asString();
-        LLStringUtil::replaceNonstandardASCII(mName, ' ');
-        LLStringUtil::replaceChar(mName, '|', ' ');
+        importName(value.asString());
+    }
+    else
+    {
+        return false;
     }
 
     return true;
@@ -92,6 +92,10 @@ public:
     // in place correction for inventory name string
     static void correctInventoryName(std::string& name);
 
+    // Name as stored in LLSD or the inventory cache. Unlike rename(), odd
+    // characters are replaced but the name is not trimmed or truncated.
+    void importName(const std::string& name);
+
     //--------------------------------------------------------------------
     // File Support
     //   Implemented here so that a minimal information set can be transmitted
@@ -176,6 +180,8 @@ public:
     void setAssetUUID(const LLUUID& asset_id);
     static void correctInventoryDescription(std::string& name);
     void setDescription(const std::string& new_desc);
+    // Description as stored in LLSD or the inventory cache.
+    void importDescription(const std::string& desc);
     void setSaleInfo(const LLSaleInfo& sale_info);
     void setPermissions(const LLPermissions& perm);
     void setInventoryType(LLInventoryType::EType inv_type);
@@ -210,6 +216,13 @@ public:
     void asLLSD( LLSD& sd ) const;
     bool fromLLSD(const LLSD& sd, bool is_new = true);
 
+    // fromLLSD() one top level field at a time, for callers that get the
+    // fields from an event parse: fromLLSDBegin(), fromLLSDField() for
+    // each key, then fromLLSDEnd().
+    void fromLLSDBegin(bool is_new = true);
+    bool fromLLSDField(const std::string& key, const LLSD& value);
+    void fromLLSDEnd();
+
     //--------------------------------------------------------------------
     // Member Variables
     //--------------------------------------------------------------------
@@ -272,6 +285,8 @@ public:
 
     LLSD exportLLSD() const;
     bool importLLSD(const LLSD& cat_data);
+    // importLLSD() for a single top level field, false if key is not one
+    bool importLLSDField(const std::string& key, const LLSD& value);
     //--------------------------------------------------------------------
     // Member Variables
     //--------------------------------------------------------------------
@@ -0,0 +1,177 @@
+/**
+ * @file llinventoryancestry.cpp
+ * @brief Implementation of LLInventoryAncestryIndex.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llinventoryancestry.h"
+
+// Room left at the end of every interval for leaf categories added later.
+// Each new leaf takes half of what is left, so a folder can take about
+// this many log2 levels of additions before the index must be rebuilt.
+static const U64 INTERVAL_ROOM = 1ULL << 24;
+
+LLInventoryAncestryIndex::LLInventoryAncestryIndex()
+:   mCursor(0),
+    mValid(false)
+{
+}
+
+void LLInventoryAncestryIndex::clear()
+{
+    mIntervals.clear();
+    mOrder.clear();
+    mCursor = 0;
+    mValid = false;
+}
+
+LLInventoryAncestryIndex::Interval& LLInventoryAncestryIndex::open(const LLUUID& id)
+{
+    Interval& interval = mIntervals[id];
+    interval.mBegin = mCursor++;
+    interval.mEnd = interval.mFree = interval.mBegin;
+    mOrder.emplace_hint(mOrder.end(), interval.mBegin, id);
+    return interval;
+}
+
+void LLInventoryAncestryIndex::close(Interval& interval)
+{
+    interval.mFree = mCursor;
+    mCursor += INTERVAL_ROOM;
+    interval.mEnd = mCursor++;
+}
+
+void LLInventoryAncestryIndex::rebuild(const uuid_vec_t& roots, const children_func_t& get_children)
+{
+    clear();
+    mIntervals.reserve(roots.size());
+
+    struct Frame
+    {
+        LLUUID mID;
+        uuid_vec_t mChildren;
+        size_t mNext;
+    };
+    // Explicit stack, inventories can be deep enough to make recursion a risk.
+    std::vector<Frame> stack;
+    for (const LLUUID& root_id : roots)
+    {
+        if (root_id.isNull() || mIntervals.count(root_id))
+        {
+            continue;
+        }
+        open(root_id);
+        stack.push_back({ root_id, uuid_vec_t(), 0 });
+        get_children(root_id, stack.back().mChildren);
+        while (!stack.empty())
+        {
+            Frame& top = stack.back();
+            if (top.mNext < top.mChildren.size())
+            {
+                LLUUID child_id = top.mChildren[top.mNext++];
+                if (child_id.isNull() || mIntervals.count(child_id))
+                {
+                    // parent loop or duplicate entry, leave it where it was first seen
+                    continue;
+                }
+                open(child_id);
+                stack.push_back({ child_id, uuid_vec_t(), 0 });
+                get_children(child_id, stack.back().mChildren);
+            }
+            else
+            {
+                close(mIntervals[top.mID]);
+                stack.pop_back();
+            }
+        }
+    }
+    mValid = true;
+}
+
+bool LLInventoryAncestryIndex::insertLeaf(const LLUUID& id, const LLUUID& parent_id)
+{
+    if (!mValid || id.isNull())
+    {
+        return false;
+    }
+    if (mIntervals.count(id))
+    {
+        // already numbered somewhere, this is a move rather than an add
+        invalidate();
+        return false;
+    }
+    if (parent_id.isNull())
+    {
+        close(open(id));
+        return true;
+    }
+
+    interval_map_t::iterator parent = mIntervals.find(parent_id);
+    if (parent == mIntervals.end())
+    {
+        return false;
+    }
+    Interval& room = parent->second;
+    const U64 size = (room.mEnd - room.mFree) / 2;
+    if (size < 3)
+    {
+        invalidate();
+        return false;
+    }
+    Interval& interval = mIntervals[id];
+    interval.mBegin = room.mFree;
+    interval.mFree = interval.mBegin + 1;
+    interval.mEnd = interval.mBegin + size;
+    room.mFree = interval.mEnd + 1;
+    mOrder.emplace(interval.mBegin, id);
+    return true;
+}
+
+void LLInventoryAncestryIndex::remove(const LLUUID& id)
+{
+    interval_map_t::iterator found = mIntervals.find(id);
+    if (found != mIntervals.end())
+    {
+        mOrder.erase(found->second.mBegin);
+        mIntervals.erase(found);
+    }
+}
+
+bool LLInventoryAncestryIndex::isIndexed(const LLUUID& id) const
+{
+    return mIntervals.find(id) != mIntervals.end();
+}
+
+bool LLInventoryAncestryIndex::isDescendentOf(const LLUUID& id, const LLUUID& ancestor_id) const
+{
+    interval_map_t::const_iterator object = mIntervals.find(id);
+    interval_map_t::const_iterator ancestor = mIntervals.find(ancestor_id);
+    if (object == mIntervals.end() || ancestor == mIntervals.end())
+    {
+        return false;
+    }
+    return object->second.mBegin >= ancestor->second.mBegin
+        && object->second.mBegin < ancestor->second.mEnd;
+}
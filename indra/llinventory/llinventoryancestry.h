@@ -0,0 +1,129 @@
+/**
+ * @file llinventoryancestry.h
+ * @brief Declaration of LLInventoryAncestryIndex.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYANCESTRY_H
+#define LL_LLINVENTORYANCESTRY_H
+
+#include "lluuid.h"
+
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventoryAncestryIndex
+//
+// Pre/post-order interval numbering of a category tree. Every indexed
+// category owns the interval [begin, end], and the intervals of its
+// descendents nest strictly inside it, so "is A an ancestor of B" is
+// two comparisons and all descendents of A are a contiguous range of the
+// ordered index.
+//
+// Each interval keeps some unused room at its end so that new leaf
+// categories can be added without renumbering. Anything else that
+// changes the shape of the tree (moving a category, running out of room)
+// invalidates the index, and the owner is expected to rebuild() it before
+// trusting it again. Categories that are not indexed (orphans, loops, or
+// added under an unindexed parent) are simply unknown to the index.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventoryAncestryIndex
+{
+public:
+    typedef std::function<void(const LLUUID& parent_id, uuid_vec_t& children)> children_func_t;
+
+    LLInventoryAncestryIndex();
+
+    // Renumber the whole forest below roots. get_children is called once
+    // per category and must append the ids of its child categories.
+    void rebuild(const uuid_vec_t& roots, const children_func_t& get_children);
+
+    void clear();
+    void invalidate()       { mValid = false; }
+    bool isValid() const    { return mValid; }
+    size_t size() const     { return mIntervals.size(); }
+
+    // Number a new childless category. A null parent makes it a new root.
+    // Returns false if the category could not be indexed; if that is
+    // because the parent ran out of room, the index is invalidated.
+    bool insertLeaf(const LLUUID& id, const LLUUID& parent_id);
+
+    // Forget one category. Its descendents, if any, keep their numbers.
+    void remove(const LLUUID& id);
+
+    bool isIndexed(const LLUUID& id) const;
+
+    // True if id is ancestor_id or lies below it. Both must be indexed.
+    bool isDescendentOf(const LLUUID& id, const LLUUID& ancestor_id) const;
+
+    // Walk all indexed descendents of ancestor_id in pre-order. Returning
+    // false from func skips the subtree below the category just visited.
+    template <typename FUNC>
+    void forEachDescendent(const LLUUID& ancestor_id, FUNC func) const;
+
+private:
+    struct Interval
+    {
+        U64 mBegin;
+        U64 mEnd;
+        U64 mFree;  // first unused number of the room left for new children
+    };
+
+    Interval& open(const LLUUID& id);
+    void close(Interval& interval);
+
+    typedef std::unordered_map<LLUUID, Interval> interval_map_t;
+    typedef std::map<U64, LLUUID> order_map_t;
+    interval_map_t mIntervals;
+    order_map_t mOrder;     // begin -> category, i.e. pre-order
+    U64 mCursor;
+    bool mValid;
+};
+
+template <typename FUNC>
+void LLInventoryAncestryIndex::forEachDescendent(const LLUUID& ancestor_id, FUNC func) const
+{
+    interval_map_t::const_iterator found = mIntervals.find(ancestor_id);
+    if (found == mIntervals.end())
+    {
+        return;
+    }
+    const U64 end = found->second.mEnd;
+    order_map_t::const_iterator it = mOrder.upper_bound(found->second.mBegin);
+    while (it != mOrder.end() && it->first < end)
+    {
+        const LLUUID& id = it->second;
+        if (func(id))
+        {
+            ++it;
+        }
+        else
+        {
+            it = mOrder.upper_bound(mIntervals.find(id)->second.mEnd);
+        }
+    }
+}
+
+#endif // LL_LLINVENTORYANCESTRY_H
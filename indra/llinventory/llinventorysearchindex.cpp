@@ -0,0 +1,273 @@
+/**
+ * @file llinventorysearchindex.cpp
+ * @brief Implementation of LLInventorySearchIndex.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llinventorysearchindex.h"
+
+#include <algorithm>
+
+// Don't bother compacting small indexes, a few stale entries are cheap.
+static const size_t MIN_STALE_POSTINGS_TO_COMPACT = 4096;
+
+static inline U32 trigram_at(const std::string& str, size_t pos)
+{
+    return ((U32)(U8)str[pos] << 16) | ((U32)(U8)str[pos + 1] << 8) | (U32)(U8)str[pos + 2];
+}
+
+// Distinct trigrams of str, in no particular order.
+static void get_trigrams(const std::string& str, std::vector<U32>& trigrams)
+{
+    trigrams.clear();
+    if (str.size() < LLInventorySearchIndex::MIN_SUBSTRING_LENGTH)
+    {
+        return;
+    }
+    for (size_t i = 0, count = str.size() - 2; i < count; i++)
+    {
+        trigrams.push_back(trigram_at(str, i));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+LLInventorySearchIndex::LLInventorySearchIndex()
+:   mLivePostings(0),
+    mStalePostings(0),
+    mGeneration(0)
+{
+}
+
+void LLInventorySearchIndex::clear()
+{
+    mEntries.clear();
+    mFreeSlots.clear();
+    mSlots.clear();
+    for (U32 field = 0; field < FIELD_COUNT; field++)
+    {
+        mPostings[field].clear();
+    }
+    mCreatorSlots.clear();
+    mLivePostings = 0;
+    mStalePostings = 0;
+    mGeneration++;
+}
+
+void LLInventorySearchIndex::setItem(const LLUUID& id, const std::string& name, const std::string& desc, const LLUUID& creator_id)
+{
+    if (id.isNull())
+    {
+        return;
+    }
+
+    std::unordered_map<LLUUID, U32>::iterator found = mSlots.find(id);
+    if (found != mSlots.end())
+    {
+        const Entry& entry = mEntries[found->second];
+        if (entry.mFields[FIELD_NAME] == name
+            && entry.mFields[FIELD_DESCRIPTION] == desc
+            && entry.mCreatorID == creator_id)
+        {
+            // the model reports many changes that don't touch searchable fields
+            return;
+        }
+        releaseSlot(found->second);
+        mSlots.erase(found);
+    }
+
+    U32 slot;
+    if (mFreeSlots.empty())
+    {
+        slot = (U32)mEntries.size();
+        mEntries.emplace_back();
+    }
+    else
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    Entry& entry = mEntries[slot];
+    entry.mID = id;
+    entry.mFields[FIELD_NAME] = name;
+    entry.mFields[FIELD_DESCRIPTION] = desc;
+    entry.mCreatorID = creator_id;
+    entry.mUsed = true;
+    mSlots[id] = slot;
+    addPostings(slot);
+    mGeneration++;
+
+    if (mStalePostings > MIN_STALE_POSTINGS_TO_COMPACT && mStalePostings > mLivePostings)
+    {
+        compact();
+    }
+}
+
+void LLInventorySearchIndex::removeItem(const LLUUID& id)
+{
+    std::unordered_map<LLUUID, U32>::iterator found = mSlots.find(id);
+    if (found == mSlots.end())
+    {
+        return;
+    }
+    releaseSlot(found->second);
+    mSlots.erase(found);
+    mGeneration++;
+
+    if (mSlots.empty())
+    {
+        clear();
+    }
+    else if (mStalePostings > MIN_STALE_POSTINGS_TO_COMPACT && mStalePostings > mLivePostings)
+    {
+        compact();
+    }
+}
+
+bool LLInventorySearchIndex::isIndexed(const LLUUID& id) const
+{
+    return mSlots.find(id) != mSlots.end();
+}
+
+void LLInventorySearchIndex::addPostings(U32 slot)
+{
+    const Entry& entry = mEntries[slot];
+    std::vector<U32> trigrams;
+    for (U32 field = 0; field < FIELD_COUNT; field++)
+    {
+        get_trigrams(entry.mFields[field], trigrams);
+        for (U32 trigram : trigrams)
+        {
+            mPostings[field][trigram].push_back(slot);
+        }
+        mLivePostings += trigrams.size();
+    }
+    if (entry.mCreatorID.notNull())
+    {
+        mCreatorSlots[entry.mCreatorID].push_back(slot);
+        mLivePostings++;
+    }
+}
+
+void LLInventorySearchIndex::releaseSlot(U32 slot)
+{
+    Entry& entry = mEntries[slot];
+    std::vector<U32> trigrams;
+    size_t postings = entry.mCreatorID.notNull() ? 1 : 0;
+    for (U32 field = 0; field < FIELD_COUNT; field++)
+    {
+        get_trigrams(entry.mFields[field], trigrams);
+        postings += trigrams.size();
+        entry.mFields[field].clear();
+    }
+    mLivePostings -= postings;
+    mStalePostings += postings;
+    entry.mID.setNull();
+    entry.mCreatorID.setNull();
+    entry.mUsed = false;
+    mFreeSlots.push_back(slot);
+}
+
+void LLInventorySearchIndex::compact()
+{
+    for (U32 field = 0; field < FIELD_COUNT; field++)
+    {
+        mPostings[field].clear();
+    }
+    mCreatorSlots.clear();
+    mLivePostings = 0;
+    mStalePostings = 0;
+    for (U32 slot = 0; slot < (U32)mEntries.size(); slot++)
+    {
+        if (mEntries[slot].mUsed)
+        {
+            addPostings(slot);
+        }
+    }
+}
+
+bool LLInventorySearchIndex::findSubString(EField field, const std::string& substring, match_set_t& matches) const
+{
+    if (field >= FIELD_COUNT || substring.size() < MIN_SUBSTRING_LENGTH)
+    {
+        return false;
+    }
+
+    // Walk the shortest posting list of the search string's trigrams and
+    // check each hit against the stored string.
+    std::vector<U32> trigrams;
+    get_trigrams(substring, trigrams);
+    const slot_list_t* shortest = nullptr;
+    for (U32 trigram : trigrams)
+    {
+        posting_map_t::const_iterator found = mPostings[field].find(trigram);
+        if (found == mPostings[field].end())
+        {
+            // no item has this trigram, so nothing can match
+            return true;
+        }
+        if (!shortest || found->second.size() < shortest->size())
+        {
+            shortest = &found->second;
+        }
+    }
+
+    for (U32 slot : *shortest)
+    {
+        const Entry& entry = mEntries[slot];
+        if (entry.mUsed && entry.mFields[field].find(substring) != std::string::npos)
+        {
+            matches.insert(entry.mID);
+        }
+    }
+    return true;
+}
+
+bool LLInventorySearchIndex::findCreator(const std::string& substring, const creator_name_func_t& get_name, match_set_t& matches) const
+{
+    if (substring.empty())
+    {
+        return false;
+    }
+
+    std::string name;
+    for (const auto& creator : mCreatorSlots)
+    {
+        name.clear();
+        if (get_name(creator.first, name) && name.find(substring) == std::string::npos)
+        {
+            continue;
+        }
+        for (U32 slot : creator.second)
+        {
+            const Entry& entry = mEntries[slot];
+            if (entry.mUsed && entry.mCreatorID == creator.first)
+            {
+                matches.insert(entry.mID);
+            }
+        }
+    }
+    return true;
+}
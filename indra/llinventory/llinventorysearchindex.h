@@ -0,0 +1,115 @@
+/**
+ * @file llinventorysearchindex.h
+ * @brief Declaration of LLInventorySearchIndex.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYSEARCHINDEX_H
+#define LL_LLINVENTORYSEARCHINDEX_H
+
+#include "lluuid.h"
+
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventorySearchIndex
+//
+// Trigram index over item names and descriptions, plus a creator -> items
+// map, for answering substring searches without visiting every item.
+// Strings are stored as given; callers are expected to upper case them the
+// same way they upper case the search string.
+//
+// Removing or changing an item leaves its old posting entries behind.
+// Queries check every hit against the stored strings anyway, so stale
+// entries only cost time, and the postings are compacted once they make up
+// half of the index.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventorySearchIndex
+{
+public:
+    enum EField
+    {
+        FIELD_NAME,
+        FIELD_DESCRIPTION,
+        FIELD_COUNT
+    };
+
+    typedef std::unordered_set<LLUUID> match_set_t;
+    // Fills in the upper case name of a creator, returns false if the name
+    // is not known (yet).
+    typedef std::function<bool(const LLUUID& creator_id, std::string& name)> creator_name_func_t;
+
+    // Shortest search string the index can answer.
+    static const size_t MIN_SUBSTRING_LENGTH = 3;
+
+    LLInventorySearchIndex();
+
+    // Add an item or replace what is known about it.
+    void setItem(const LLUUID& id, const std::string& name, const std::string& desc, const LLUUID& creator_id);
+    void removeItem(const LLUUID& id);
+    void clear();
+
+    bool isIndexed(const LLUUID& id) const;
+    size_t size() const         { return mSlots.size(); }
+
+    // Bumped by every change that could alter the result of a search.
+    U32 getGeneration() const   { return mGeneration; }
+
+    // Collect every indexed item whose field contains substring. Returns
+    // false, leaving matches alone, if substring is too short to look up.
+    bool findSubString(EField field, const std::string& substring, match_set_t& matches) const;
+
+    // Collect every indexed item whose creator name contains substring.
+    // Items whose creator name is not known yet are collected as well, so
+    // matches is a superset of the real answer that callers can narrow.
+    bool findCreator(const std::string& substring, const creator_name_func_t& get_name, match_set_t& matches) const;
+
+private:
+    struct Entry
+    {
+        LLUUID mID;
+        std::string mFields[FIELD_COUNT];
+        LLUUID mCreatorID;
+        bool mUsed;
+    };
+
+    typedef std::vector<U32> slot_list_t;
+    typedef std::unordered_map<U32, slot_list_t> posting_map_t;
+
+    void addPostings(U32 slot);
+    void releaseSlot(U32 slot);
+    void compact();
+
+    std::vector<Entry> mEntries;
+    std::vector<U32> mFreeSlots;
+    std::unordered_map<LLUUID, U32> mSlots;
+    posting_map_t mPostings[FIELD_COUNT];
+    std::unordered_map<LLUUID, slot_list_t> mCreatorSlots;
+    size_t mLivePostings;
+    size_t mStalePostings;
+    U32 mGeneration;
+};
+
+#endif // LL_LLINVENTORYSEARCHINDEX_H
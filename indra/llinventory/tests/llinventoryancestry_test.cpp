@@ -0,0 +1,316 @@
+/**
+ * @file llinventoryancestry_test.cpp
+ * @brief Tests and benchmark for LLInventoryAncestryIndex.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llinventoryancestry.h"
+#include "../test/lltut.h"
+
+#include "llrand.h"
+#include "lltimer.h"
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace tut
+{
+    struct LLInventoryAncestryData
+    {
+        // Synthetic inventory: category tree plus items, in both the
+        // ordered containers the model used to keep and hashed ones.
+        void makeInventory(U32 category_count, U32 item_count)
+        {
+            mCategories.clear();
+            mParents.clear();
+            mChildren.clear();
+            mItems.clear();
+
+            mRootID.generate();
+            mCategories.push_back(mRootID);
+            mParents[mRootID] = LLUUID::null;
+            mChildren[LLUUID::null].push_back(mRootID);
+            for (U32 i = 1; i < category_count; i++)
+            {
+                LLUUID id;
+                id.generate();
+                // favour recent folders so the tree gets some depth
+                U32 range = llmin(i, (U32) 64);
+                LLUUID parent_id = ll_rand(2) ? mCategories[i - 1 - ll_rand(range)] : mCategories[ll_rand(i)];
+                mCategories.push_back(id);
+                mParents[id] = parent_id;
+                mChildren[parent_id].push_back(id);
+            }
+            for (U32 i = 0; i < item_count; i++)
+            {
+                LLUUID id;
+                id.generate();
+                mItems[id] = mCategories[ll_rand((S32) mCategories.size())];
+            }
+        }
+
+        void rebuild(LLInventoryAncestryIndex& index)
+        {
+            uuid_vec_t roots(1, mRootID);
+            index.rebuild(roots, [this](const LLUUID& parent_id, uuid_vec_t& children)
+                {
+                    std::map<LLUUID, uuid_vec_t>::const_iterator found = mChildren.find(parent_id);
+                    if (found != mChildren.end())
+                    {
+                        children.insert(children.end(), found->second.begin(), found->second.end());
+                    }
+                });
+        }
+
+        // What LLInventoryModel::isObjectDescendentOf used to do.
+        bool walkIsDescendent(const LLUUID& id, const LLUUID& ancestor_id) const
+        {
+            LLUUID cur = id;
+            while (cur.notNull())
+            {
+                if (cur == ancestor_id)
+                {
+                    return true;
+                }
+                std::map<LLUUID, LLUUID>::const_iterator found = mParents.find(cur);
+                if (found == mParents.end())
+                {
+                    return false;
+                }
+                cur = found->second;
+            }
+            return false;
+        }
+
+        void walkCollect(const LLUUID& id, std::set<LLUUID>& result) const
+        {
+            std::map<LLUUID, uuid_vec_t>::const_iterator found = mChildren.find(id);
+            if (found != mChildren.end())
+            {
+                for (const LLUUID& child_id : found->second)
+                {
+                    result.insert(child_id);
+                    walkCollect(child_id, result);
+                }
+            }
+        }
+
+        void addCategory(const LLUUID& id, const LLUUID& parent_id)
+        {
+            mCategories.push_back(id);
+            mParents[id] = parent_id;
+            mChildren[parent_id].push_back(id);
+        }
+
+        LLUUID mRootID;
+        uuid_vec_t mCategories;
+        std::map<LLUUID, LLUUID> mParents;
+        std::map<LLUUID, uuid_vec_t> mChildren;
+        std::map<LLUUID, LLUUID> mItems;
+    };
+
+    typedef test_group<LLInventoryAncestryData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llinventoryancestry_test_factory("LLInventoryAncestryIndex");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        // intervals agree with walking the parent chain, before and after leaf inserts
+        makeInventory(2000, 0);
+        LLInventoryAncestryIndex index;
+        ensure("new index is not valid", !index.isValid());
+        rebuild(index);
+        ensure("rebuilt index is valid", index.isValid());
+        ensure_equals("every category indexed", index.size(), mCategories.size());
+
+        for (U32 pass = 0; pass < 2; pass++)
+        {
+            for (U32 i = 0; i < 20000; i++)
+            {
+                const LLUUID& a = mCategories[ll_rand((S32) mCategories.size())];
+                const LLUUID& b = mCategories[ll_rand((S32) mCategories.size())];
+                ensure_equals("descendent test matches walk", index.isDescendentOf(a, b), walkIsDescendent(a, b));
+            }
+            for (U32 i = 0; i < 50; i++)
+            {
+                const LLUUID& id = mCategories[ll_rand((S32) mCategories.size())];
+                std::set<LLUUID> expected;
+                walkCollect(id, expected);
+                std::set<LLUUID> actual;
+                index.forEachDescendent(id, [&actual](const LLUUID& child_id)
+                    {
+                        actual.insert(child_id);
+                        return true;
+                    });
+                ensure("range matches recursive collect", actual == expected);
+            }
+
+            // grow some leaves, including leaves below new leaves
+            for (U32 i = 0; i < 500; i++)
+            {
+                LLUUID id;
+                id.generate();
+                LLUUID parent_id = mCategories[ll_rand((S32) mCategories.size())];
+                if (index.insertLeaf(id, parent_id))
+                {
+                    addCategory(id, parent_id);
+                }
+            }
+            ensure("leaf inserts keep the index valid", index.isValid());
+            ensure_equals("leaves indexed", index.size(), mCategories.size());
+        }
+
+        // a pruned subtree is skipped entirely
+        const LLUUID& skipped = mChildren[mRootID].front();
+        U32 visited = 0;
+        index.forEachDescendent(mRootID, [&](const LLUUID& id)
+            {
+                ensure("skipped subtree not visited", id == skipped || !walkIsDescendent(id, skipped));
+                visited++;
+                return id != skipped;
+            });
+        std::set<LLUUID> below_skipped;
+        walkCollect(skipped, below_skipped);
+        ensure_equals("visited everything else", (size_t) visited, mCategories.size() - 1 - below_skipped.size());
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        // index falls back to invalid instead of lying
+        makeInventory(10, 0);
+        LLInventoryAncestryIndex index;
+        rebuild(index);
+
+        // keep adding below the same folder until it runs out of room
+        LLUUID parent_id = mCategories.back();
+        U32 inserted = 0;
+        while (index.isValid() && inserted < 1000)
+        {
+            LLUUID id;
+            id.generate();
+            if (index.insertLeaf(id, parent_id))
+            {
+                ensure("new leaf is below its parent", index.isDescendentOf(id, parent_id));
+                ensure("new leaf is below the root", index.isDescendentOf(id, mRootID));
+                ensure("parent is not below the new leaf", !index.isDescendentOf(parent_id, id));
+                inserted++;
+            }
+        }
+        ensure("ran out of room", !index.isValid());
+        ensure("took several leaves first", inserted > 8);
+
+        rebuild(index);
+        LLUUID unknown;
+        unknown.generate();
+        ensure("leaf below an unindexed parent is refused", !index.insertLeaf(LLUUID::generateNewID(), unknown));
+        ensure("refusal does not invalidate", index.isValid());
+        ensure("re-adding a category invalidates", !index.insertLeaf(mCategories[3], mRootID));
+        ensure("move invalidated the index", !index.isValid());
+
+        rebuild(index);
+        index.remove(mCategories[5]);
+        ensure("removed category is unknown", !index.isIndexed(mCategories[5]));
+        ensure("removed category is no descendent", !index.isDescendentOf(mCategories[5], mRootID));
+        index.clear();
+        ensure_equals("cleared", index.size(), (size_t) 0);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        // headless benchmark on a synthetic 300k item inventory
+        const U32 CATEGORIES = 15000;
+        const U32 ITEMS = 300000;
+        const U32 QUERIES = 300000;
+        makeInventory(CATEGORIES, ITEMS);
+
+        LLTimer timer;
+        std::unordered_map<LLUUID, LLUUID> hashed_items(mItems.begin(), mItems.end());
+        LLInventoryAncestryIndex index;
+        rebuild(index);
+        F64 index_time = timer.getElapsedTimeF64();
+
+        uuid_vec_t item_ids;
+        item_ids.reserve(ITEMS);
+        for (const auto& item : mItems)
+        {
+            item_ids.push_back(item.first);
+        }
+        std::vector<std::pair<LLUUID, LLUUID> > queries;
+        for (U32 i = 0; i < QUERIES; i++)
+        {
+            queries.emplace_back(item_ids[ll_rand(ITEMS)], mCategories[ll_rand(CATEGORIES / 8)]);
+        }
+
+        timer.reset();
+        U32 walk_hits = 0;
+        for (const auto& query : queries)
+        {
+            walk_hits += walkIsDescendent(mItems[query.first], query.second) ? 1 : 0;
+        }
+        F64 walk_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        U32 index_hits = 0;
+        for (const auto& query : queries)
+        {
+            const LLUUID& parent_id = hashed_items.find(query.first)->second;
+            index_hits += index.isDescendentOf(parent_id, query.second) ? 1 : 0;
+        }
+        F64 lookup_time = timer.getElapsedTimeF64();
+        ensure_equals("same answers", index_hits, walk_hits);
+
+        timer.reset();
+        std::set<LLUUID> walked;
+        walkCollect(mRootID, walked);
+        F64 collect_walk_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        size_t ranged = 0;
+        index.forEachDescendent(mRootID, [&ranged](const LLUUID&)
+            {
+                ranged++;
+                return true;
+            });
+        F64 collect_range_time = timer.getElapsedTimeF64();
+        ensure_equals("same descendents", ranged, walked.size());
+
+        LL_INFOS("Inventory") << ITEMS << " items in " << CATEGORIES << " folders, index built in "
+            << index_time * 1000.0 << "ms; " << QUERIES << " descendent tests: parent walk "
+            << walk_time * 1000.0 << "ms, interval " << lookup_time * 1000.0 << "ms; full collect: recursive "
+            << collect_walk_time * 1000.0 << "ms, range " << collect_range_time * 1000.0 << "ms" << LL_ENDL;
+    }
+}
@@ -0,0 +1,278 @@
+/**
+ * @file llinventorysearchindex_test.cpp
+ * @brief Tests and benchmark for LLInventorySearchIndex.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llinventorysearchindex.h"
+#include "../test/lltut.h"
+
+#include "llrand.h"
+#include "lltimer.h"
+
+#include <map>
+
+namespace tut
+{
+    struct LLInventorySearchIndexData
+    {
+        struct Item
+        {
+            std::string mName;
+            std::string mDesc;
+            LLUUID mCreatorID;
+        };
+
+        std::string makeName(U32 words)
+        {
+            static const char* WORDS[] = { "BLUE", "SHIRT", "HAIR", "RED", "JACKET", "SCRIPT", "BOX",
+                                           "DRESS", "SHOE", "LEFT", "RIGHT", "HUD", "ALPHA", "TATTOO",
+                                           "MESH", "BODY", "EYES", "SKIN", "POSE", "STAND" };
+            std::string name;
+            for (U32 i = 0; i < words; i++)
+            {
+                if (i)
+                {
+                    name += ' ';
+                }
+                name += WORDS[ll_rand(LL_ARRAY_SIZE(WORDS))];
+            }
+            name += " " + std::to_string(ll_rand(1000));
+            return name;
+        }
+
+        void makeInventory(U32 item_count, U32 creator_count)
+        {
+            mItems.clear();
+            mCreators.clear();
+            for (U32 i = 0; i < creator_count; i++)
+            {
+                mCreators.push_back(LLUUID::generateNewID());
+            }
+            for (U32 i = 0; i < item_count; i++)
+            {
+                Item& item = mItems[LLUUID::generateNewID()];
+                item.mName = makeName(1 + ll_rand(4));
+                item.mDesc = ll_rand(3) ? std::string() : makeName(2);
+                item.mCreatorID = mCreators[ll_rand(creator_count)];
+            }
+        }
+
+        void fill(LLInventorySearchIndex& index) const
+        {
+            for (const auto& item : mItems)
+            {
+                index.setItem(item.first, item.second.mName, item.second.mDesc, item.second.mCreatorID);
+            }
+        }
+
+        // What the inventory filter does today, one item at a time.
+        LLInventorySearchIndex::match_set_t scan(LLInventorySearchIndex::EField field, const std::string& substring) const
+        {
+            LLInventorySearchIndex::match_set_t matches;
+            for (const auto& item : mItems)
+            {
+                const std::string& str = field == LLInventorySearchIndex::FIELD_NAME ? item.second.mName : item.second.mDesc;
+                if (str.find(substring) != std::string::npos)
+                {
+                    matches.insert(item.first);
+                }
+            }
+            return matches;
+        }
+
+        std::string creatorName(const LLUUID& creator_id) const
+        {
+            std::string name = creator_id.asString();
+            LLStringUtil::toUpper(name);
+            return name;
+        }
+
+        std::map<LLUUID, Item> mItems;
+        uuid_vec_t mCreators;
+    };
+
+    typedef test_group<LLInventorySearchIndexData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llinventorysearchindex_test_factory("LLInventorySearchIndex");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        // index answers exactly what a linear scan does
+        makeInventory(5000, 50);
+        LLInventorySearchIndex index;
+        fill(index);
+        ensure_equals("every item indexed", index.size(), mItems.size());
+
+        LLInventorySearchIndex::match_set_t matches;
+        ensure("short strings are not answered", !index.findSubString(LLInventorySearchIndex::FIELD_NAME, "BL", matches));
+        ensure("nothing collected", matches.empty());
+
+        const char* queries[] = { "BLUE", "SHIRT 1", "T RED", "HUD", "XYZ", "ESS", "ALPHA TATTOO", "  " , "99" };
+        for (const char* query : queries)
+        {
+            for (U32 field = 0; field < LLInventorySearchIndex::FIELD_COUNT; field++)
+            {
+                LLInventorySearchIndex::EField efield = (LLInventorySearchIndex::EField)field;
+                if (strlen(query) < LLInventorySearchIndex::MIN_SUBSTRING_LENGTH)
+                {
+                    continue;
+                }
+                matches.clear();
+                ensure("query answered", index.findSubString(efield, query, matches));
+                ensure(std::string("same matches as a scan for ") + query, matches == scan(efield, query));
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        // changes, removals and compaction keep answers exact
+        makeInventory(3000, 20);
+        LLInventorySearchIndex index;
+        fill(index);
+
+        for (U32 round = 0; round < 5; round++)
+        {
+            U32 generation = index.getGeneration();
+            std::map<LLUUID, Item>::iterator it = mItems.begin();
+            while (it != mItems.end())
+            {
+                switch (ll_rand(4))
+                {
+                case 0:
+                    index.removeItem(it->first);
+                    it = mItems.erase(it);
+                    continue;
+                case 1:
+                    it->second.mName = makeName(2);
+                    index.setItem(it->first, it->second.mName, it->second.mDesc, it->second.mCreatorID);
+                    break;
+                default:
+                    // unchanged fields are a no-op
+                    index.setItem(it->first, it->second.mName, it->second.mDesc, it->second.mCreatorID);
+                    break;
+                }
+                ++it;
+            }
+            for (U32 i = 0; i < 1000; i++)
+            {
+                Item& item = mItems[LLUUID::generateNewID()];
+                item.mName = makeName(3);
+                item.mCreatorID = mCreators[ll_rand((S32)mCreators.size())];
+            }
+            fill(index);
+            ensure("changes bump the generation", index.getGeneration() != generation);
+            ensure_equals("indexed count follows changes", index.size(), mItems.size());
+
+            LLInventorySearchIndex::match_set_t matches;
+            index.findSubString(LLInventorySearchIndex::FIELD_NAME, "SHIRT", matches);
+            ensure("names match after changes", matches == scan(LLInventorySearchIndex::FIELD_NAME, "SHIRT"));
+        }
+
+        U32 generation = index.getGeneration();
+        fill(index);
+        ensure_equals("re-adding unchanged items changes nothing", index.getGeneration(), generation);
+
+        index.clear();
+        ensure_equals("cleared", index.size(), (size_t)0);
+        LLInventorySearchIndex::match_set_t matches;
+        index.findSubString(LLInventorySearchIndex::FIELD_NAME, "SHIRT", matches);
+        ensure("nothing found after clear", matches.empty());
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        // creator lookups, including names that are not known yet
+        makeInventory(2000, 10);
+        LLInventorySearchIndex index;
+        fill(index);
+
+        const LLUUID& known = mCreators[0];
+        const LLUUID& unknown = mCreators[1];
+        std::string substring = creatorName(known).substr(4, 6);
+        LLInventorySearchIndex::match_set_t matches;
+        ensure("creator query answered", index.findCreator(substring, [&](const LLUUID& creator_id, std::string& name)
+            {
+                if (creator_id == unknown)
+                {
+                    return false;
+                }
+                name = creatorName(creator_id);
+                return true;
+            }, matches));
+
+        for (const auto& item : mItems)
+        {
+            bool expected = item.second.mCreatorID == unknown
+                || creatorName(item.second.mCreatorID).find(substring) != std::string::npos;
+            ensure_equals("creator match", matches.count(item.first) != 0, expected);
+        }
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        // headless benchmark: per keystroke search of a 300k item inventory
+        const U32 ITEMS = 300000;
+        makeInventory(ITEMS, 2000);
+
+        LLTimer timer;
+        LLInventorySearchIndex index;
+        fill(index);
+        F64 build_time = timer.getElapsedTimeF64();
+
+        const std::string typed = "TATTOO 12";
+        F64 scan_time = 0.0;
+        F64 index_time = 0.0;
+        for (size_t length = LLInventorySearchIndex::MIN_SUBSTRING_LENGTH; length <= typed.size(); length++)
+        {
+            const std::string substring = typed.substr(0, length);
+            timer.reset();
+            LLInventorySearchIndex::match_set_t scanned = scan(LLInventorySearchIndex::FIELD_NAME, substring);
+            scan_time += timer.getElapsedTimeF64();
+
+            timer.reset();
+            LLInventorySearchIndex::match_set_t matches;
+            index.findSubString(LLInventorySearchIndex::FIELD_NAME, substring, matches);
+            index_time += timer.getElapsedTimeF64();
+            ensure("same matches", matches == scanned);
+        }
+
+        LL_INFOS("Inventory") << ITEMS << " items indexed in " << build_time * 1000.0 << "ms; typing \""
+            << typed << "\": linear scan " << scan_time * 1000.0 << "ms, trigram index "
+            << index_time * 1000.0 << "ms" << LL_ENDL;
+    }
+}
@@ -296,6 +296,193 @@ S32 LLCamera::AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVec
     return AABBInFrustumNoFarClip(center, radius, mRegionPlanes);
 }
 
+U32 LLCamera::AABBInFrustumBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache, const LLPlane* planes)
+{
+    return AABBInFrustumBatch(boxes, results, plane_cache, planes, PLANE_MASK_NONE);
+}
+
+U32 LLCamera::AABBInRegionFrustumBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache)
+{
+    return AABBInFrustumBatch(boxes, results, plane_cache, mRegionPlanes, PLANE_MASK_NONE);
+}
+
+U32 LLCamera::AABBInFrustumNoFarClipBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache, const LLPlane* planes)
+{
+    return AABBInFrustumBatch(boxes, results, plane_cache, planes, AGENT_PLANE_FAR);
+}
+
+U32 LLCamera::AABBInRegionFrustumNoFarClipBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache)
+{
+    return AABBInFrustumBatch(boxes, results, plane_cache, mRegionPlanes, AGENT_PLANE_FAR);
+}
+
+// Same test as AABBInFrustum(), but with each SIMD lane holding a different box.
+// For a plane with normal n, the box corner nearest the plane's back side is
+// center - sign(n) * radius, so n.minp = n.center - |n|.radius and
+// n.maxp = n.center + |n|.radius, which needs no per-plane corner selection.
+U32 LLCamera::AABBInFrustumBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache, const LLPlane* planes, U32 skip_plane)
+{
+    if (!planes)
+    {
+        //use agent space
+        planes = mAgentPlanes;
+    }
+
+    // splat the active planes once for the whole batch
+    LLVector4a nx[AGENT_PLANE_USER_CLIP_NUM], ny[AGENT_PLANE_USER_CLIP_NUM], nz[AGENT_PLANE_USER_CLIP_NUM];
+    LLVector4a ax[AGENT_PLANE_USER_CLIP_NUM], ay[AGENT_PLANE_USER_CLIP_NUM], az[AGENT_PLANE_USER_CLIP_NUM];
+    LLVector4a nd[AGENT_PLANE_USER_CLIP_NUM];
+    U8 plane_index[AGENT_PLANE_USER_CLIP_NUM];
+    U8 plane_slot[PLANE_MASK_NUM];
+    U32 num_planes = 0;
+
+    U32 max_planes = llmin(mPlaneCount, (U32) AGENT_PLANE_USER_CLIP_NUM);       // mAgentPlanes[] size is 7
+    for (U32 i = 0; i < PLANE_MASK_NUM; i++)
+    {
+        plane_slot[i] = PLANE_MASK_NONE;
+    }
+    for (U32 i = 0; i < max_planes; i++)
+    {
+        if (i != skip_plane && mPlaneMask[i] < PLANE_MASK_NUM)
+        {
+            const LLPlane& p(planes[i]);
+            nx[num_planes].splat(p[0]);
+            ny[num_planes].splat(p[1]);
+            nz[num_planes].splat(p[2]);
+            ax[num_planes].splat(fabsf(p[0]));
+            ay[num_planes].splat(fabsf(p[1]));
+            az[num_planes].splat(fabsf(p[2]));
+            nd[num_planes].splat(-p[3]);
+            plane_index[num_planes] = (U8) i;
+            plane_slot[i] = (U8) num_planes;
+            ++num_planes;
+        }
+    }
+
+    LL_ALIGN_16(F32 pad[6][4]);
+    U32 visible = 0;
+
+    for (U32 base = 0; base < boxes.mCount; base += 4)
+    {
+        U32 lanes = llmin(boxes.mCount - base, (U32) 4);
+        const U32 valid = (1 << lanes) - 1;
+
+        LLVector4a cx, cy, cz, rx, ry, rz;
+        if (lanes == 4)
+        {
+            cx.loadua(boxes.mCenter[0] + base);
+            cy.loadua(boxes.mCenter[1] + base);
+            cz.loadua(boxes.mCenter[2] + base);
+            rx.loadua(boxes.mRadius[0] + base);
+            ry.loadua(boxes.mRadius[1] + base);
+            rz.loadua(boxes.mRadius[2] + base);
+        }
+        else
+        {   // tail, pad unused lanes with empty boxes at the origin
+            for (U32 j = 0; j < 4; j++)
+            {
+                for (U32 k = 0; k < 3; k++)
+                {
+                    pad[k][j] = j < lanes ? boxes.mCenter[k][base + j] : 0.f;
+                    pad[k + 3][j] = j < lanes ? boxes.mRadius[k][base + j] : 0.f;
+                }
+            }
+            cx.load4a(pad[0]);
+            cy.load4a(pad[1]);
+            cz.load4a(pad[2]);
+            rx.load4a(pad[3]);
+            ry.load4a(pad[4]);
+            rz.load4a(pad[5]);
+        }
+
+        U32 outside = 0;
+        U32 partial = 0;
+        U32 tested = 0;
+        U8 rejected_by[4] = { PLANE_MASK_NONE, PLANE_MASK_NONE, PLANE_MASK_NONE, PLANE_MASK_NONE };
+
+        auto test_plane = [&](U32 k)
+        {
+            tested |= 1 << k;
+
+            LLVector4a dist, rad, tmp;
+            dist.setMul(cx, nx[k]);
+            tmp.setMul(cy, ny[k]);
+            dist.add(tmp);
+            tmp.setMul(cz, nz[k]);
+            dist.add(tmp);
+
+            rad.setMul(rx, ax[k]);
+            tmp.setMul(ry, ay[k]);
+            rad.add(tmp);
+            tmp.setMul(rz, az[k]);
+            rad.add(tmp);
+
+            tmp.setSub(dist, rad);
+            U32 out = tmp.greaterThan(nd[k]).getGatheredBits() & valid & ~outside;
+            if (out)
+            {
+                for (U32 j = 0; j < lanes; j++)
+                {
+                    if (out & (1 << j))
+                    {
+                        rejected_by[j] = plane_index[k];
+                    }
+                }
+                outside |= out;
+            }
+
+            tmp.setAdd(dist, rad);
+            partial |= tmp.greaterThan(nd[k]).getGatheredBits();
+        };
+
+        if (plane_cache)
+        {   // planes that rejected these boxes last time are the most likely to reject them again
+            for (U32 j = 0; j < lanes && outside != valid; j++)
+            {
+                U8 cached = plane_cache[base + j];
+                if (cached < PLANE_MASK_NUM)
+                {
+                    U32 k = plane_slot[cached];
+                    if (k != PLANE_MASK_NONE && !(tested & (1 << k)))
+                    {
+                        test_plane(k);
+                    }
+                }
+            }
+        }
+
+        for (U32 k = 0; k < num_planes && outside != valid; k++)
+        {
+            if (!(tested & (1 << k)))
+            {
+                test_plane(k);
+            }
+        }
+
+        for (U32 j = 0; j < lanes; j++)
+        {
+            U8 res;
+            if (outside & (1 << j))
+            {
+                res = 0;
+            }
+            else
+            {
+                res = (partial & (1 << j)) ? 1 : 2;
+                ++visible;
+            }
+            results[base + j] = res;
+
+            if (plane_cache)
+            {
+                plane_cache[base + j] = rejected_by[j];
+            }
+        }
+    }
+
+    return visible;
+}
+
 int LLCamera::sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius)
 {
     LLVector3 dist = sphere_center-mFrustCenter;
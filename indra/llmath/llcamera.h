@@ -51,6 +51,16 @@ constexpr F32 MIN_FAR_PLANE     = 0.2f;
 constexpr F32 MIN_FIELD_OF_VIEW = 5.0f * DEG_TO_RAD;
 constexpr F32 MAX_FIELD_OF_VIEW = 175.f * DEG_TO_RAD;
 
+// Structure-of-arrays view of a set of axis aligned boxes, as consumed by
+// LLCamera::AABBInFrustumBatch().  Each array must hold at least mCount
+// entries; no particular alignment is required.
+struct LLAABBSoA
+{
+    const F32* mCenter[3];  // center x, y, z
+    const F32* mRadius[3];  // half extents x, y, z
+    U32 mCount;
+};
+
 // An LLCamera is an LLCoorFrame with a view frustum.
 // This means that it has several methods for moving it around
 // that are inherited from the LLCoordFrame() class :
@@ -202,6 +212,18 @@ public:
     S32 AABBInFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius, const LLPlane* planes = NULL);
     S32 AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius);
 
+    // Batch versions of the above, testing four boxes per iteration against all
+    // active planes.  results[i] receives what AABBInFrustum() would return for
+    // box i (0 = outside, 1 = partly in, 2 = fully in).
+    // plane_cache is optional per-box storage for temporal coherence: it holds the
+    // index of the plane that last rejected each box (or PLANE_MASK_NONE), those
+    // planes are tested first, and it is updated on return.
+    // Returns the number of boxes at least partly inside.
+    U32 AABBInFrustumBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache = NULL, const LLPlane* planes = NULL);
+    U32 AABBInRegionFrustumBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache = NULL);
+    U32 AABBInFrustumNoFarClipBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache = NULL, const LLPlane* planes = NULL);
+    U32 AABBInRegionFrustumNoFarClipBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache = NULL);
+
     //does a quick 'n dirty sphere-sphere check
     S32 sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius);
 
@@ -215,6 +237,8 @@ public:
     friend std::ostream& operator<<(std::ostream &s, const LLCamera &C);
 
 protected:
+    U32 AABBInFrustumBatch(const LLAABBSoA& boxes, U8* results, U8* plane_cache, const LLPlane* planes, U32 skip_plane);
+
     void calculateFrustumPlanes();
     void calculateFrustumPlanes(F32 left, F32 right, F32 top, F32 bottom);
     void calculateFrustumPlanesFromWindow(F32 x1, F32 y1, F32 x2, F32 y2);
@@ -0,0 +1,212 @@
+/**
+ * @file llcamera_test.cpp
+ * @brief Tests for the batched LLCamera frustum culling API.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llcamera.h"
+#include "llrand.h"
+#include "lltimer.h"
+
+#include <vector>
+
+namespace tut
+{
+    struct LLCameraData
+    {
+        LLCameraData()
+        {
+            // pyramid frustum looking down -Z, near plane at z = -1, far plane at z = -100
+            LLVector3 frust[LLCamera::AGENT_FRUSTRUM_NUM] =
+            {
+                LLVector3(-1.f, -1.f, -1.f),
+                LLVector3( 1.f, -1.f, -1.f),
+                LLVector3( 1.f,  1.f, -1.f),
+                LLVector3(-1.f,  1.f, -1.f),
+                LLVector3(-100.f, -100.f, -100.f),
+                LLVector3( 100.f, -100.f, -100.f),
+                LLVector3( 100.f,  100.f, -100.f),
+                LLVector3(-100.f,  100.f, -100.f)
+            };
+            mCamera.calcAgentFrustumPlanes(frust);
+        }
+
+        // random scene of count boxes scattered around the frustum
+        void makeScene(U32 count)
+        {
+            for (U32 k = 0; k < 3; k++)
+            {
+                mCenter[k].resize(count);
+                mRadius[k].resize(count);
+            }
+            for (U32 i = 0; i < count; i++)
+            {
+                mCenter[0][i] = ll_frand(300.f) - 150.f;
+                mCenter[1][i] = ll_frand(300.f) - 150.f;
+                mCenter[2][i] = ll_frand(160.f) - 130.f;
+                for (U32 k = 0; k < 3; k++)
+                {
+                    mRadius[k][i] = 0.1f + ll_frand(8.f);
+                }
+            }
+        }
+
+        LLAABBSoA getBoxes()
+        {
+            LLAABBSoA boxes;
+            for (U32 k = 0; k < 3; k++)
+            {
+                boxes.mCenter[k] = mCenter[k].data();
+                boxes.mRadius[k] = mRadius[k].data();
+            }
+            boxes.mCount = (U32) mCenter[0].size();
+            return boxes;
+        }
+
+        S32 scalarTest(U32 i, bool no_far_clip)
+        {
+            LLVector4a center(mCenter[0][i], mCenter[1][i], mCenter[2][i]);
+            LLVector4a radius(mRadius[0][i], mRadius[1][i], mRadius[2][i]);
+            return no_far_clip ? mCamera.AABBInFrustumNoFarClip(center, radius) : mCamera.AABBInFrustum(center, radius);
+        }
+
+        LLCamera mCamera;
+        std::vector<F32> mCenter[3];
+        std::vector<F32> mRadius[3];
+    };
+
+    typedef test_group<LLCameraData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llcamera_test_factory("LLCamera");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        // batch results match the scalar test, including a partial tail of 3 boxes
+        makeScene(1027);
+        LLAABBSoA boxes = getBoxes();
+        std::vector<U8> results(boxes.mCount);
+
+        U32 visible = mCamera.AABBInFrustumBatch(boxes, results.data());
+
+        U32 expected_visible = 0;
+        U32 fully_in = 0;
+        for (U32 i = 0; i < boxes.mCount; i++)
+        {
+            S32 expected = scalarTest(i, false);
+            ensure_equals("batch result matches AABBInFrustum", (S32) results[i], expected);
+            expected_visible += expected ? 1 : 0;
+            fully_in += expected == 2 ? 1 : 0;
+        }
+        ensure_equals("visible count", visible, expected_visible);
+        ensure("scene has visible boxes", visible > 0);
+        ensure("scene has culled boxes", visible < boxes.mCount);
+        ensure("scene has boxes fully inside", fully_in > 0);
+
+        std::vector<U8> no_far(boxes.mCount);
+        mCamera.AABBInFrustumNoFarClipBatch(boxes, no_far.data());
+        for (U32 i = 0; i < boxes.mCount; i++)
+        {
+            ensure_equals("batch result matches AABBInFrustumNoFarClip", (S32) no_far[i], scalarTest(i, true));
+        }
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        // plane coherency cache does not change results and records the rejecting plane
+        makeScene(512);
+        LLAABBSoA boxes = getBoxes();
+        std::vector<U8> first(boxes.mCount), second(boxes.mCount);
+        std::vector<U8> cache(boxes.mCount, LLCamera::PLANE_MASK_NONE);
+
+        mCamera.AABBInFrustumBatch(boxes, first.data(), cache.data());
+        for (U32 i = 0; i < boxes.mCount; i++)
+        {
+            ensure_equals("cache set only for culled boxes", cache[i] != LLCamera::PLANE_MASK_NONE, first[i] == 0);
+        }
+
+        mCamera.AABBInFrustumBatch(boxes, second.data(), cache.data());
+        for (U32 i = 0; i < boxes.mCount; i++)
+        {
+            ensure_equals("coherent pass matches first pass", second[i], first[i]);
+            ensure_equals("coherent pass matches scalar", (S32) second[i], scalarTest(i, false));
+        }
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        // CPU-only benchmark on a random scene, scalar vs batch vs batch with coherency
+        const U32 COUNT = 64 * 1024;
+        const U32 PASSES = 20;
+        makeScene(COUNT);
+        LLAABBSoA boxes = getBoxes();
+        std::vector<U8> results(COUNT);
+        std::vector<U8> cache(COUNT, LLCamera::PLANE_MASK_NONE);
+
+        LLTimer timer;
+        U32 scalar_visible = 0;
+        for (U32 pass = 0; pass < PASSES; pass++)
+        {
+            for (U32 i = 0; i < COUNT; i++)
+            {
+                scalar_visible += scalarTest(i, false) ? 1 : 0;
+            }
+        }
+        F64 scalar_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        U32 batch_visible = 0;
+        for (U32 pass = 0; pass < PASSES; pass++)
+        {
+            batch_visible += mCamera.AABBInFrustumBatch(boxes, results.data());
+        }
+        F64 batch_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        U32 coherent_visible = 0;
+        for (U32 pass = 0; pass < PASSES; pass++)
+        {
+            coherent_visible += mCamera.AABBInFrustumBatch(boxes, results.data(), cache.data());
+        }
+        F64 coherent_time = timer.getElapsedTimeF64();
+
+        ensure_equals("batch visible count", batch_visible, scalar_visible);
+        ensure_equals("coherent visible count", coherent_visible, scalar_visible);
+
+        LL_INFOS("LLCamera") << COUNT * PASSES << " boxes: scalar " << scalar_time * 1000.0 << "ms, batch "
+            << batch_time * 1000.0 << "ms, batch+coherency " << coherent_time * 1000.0 << "ms" << LL_ENDL;
+    }
+}
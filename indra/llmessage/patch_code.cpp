@@ -229,6 +229,16 @@ void    decode_patch_group_header(LLBitPack &bitpack, LLGroupHeader *gopp)
 }
 
 void    decode_patch_header(LLBitPack &bitpack, LLPatchHeader *ph)
+{
+    S32 word_bits;
+    decode_patch_header(bitpack, ph, &word_bits);
+    if (END_OF_PATCHES != ph->quant_wbits)
+    {
+        gWordBits = word_bits;
+    }
+}
+
+void    decode_patch_header(LLBitPack &bitpack, LLPatchHeader *ph, S32 *word_bits)
 {
     U8 retvalu8;
 
@@ -277,116 +287,35 @@ void    decode_patch_header(LLBitPack &bitpack, LLPatchHeader *ph)
 #endif
     ph->patchids = retvalu16;
 
-    gWordBits = (ph->quant_wbits & 0xf) + 2;
+    *word_bits = (ph->quant_wbits & 0xf) + 2;
 }
 
 void    decode_patch(LLBitPack &bitpack, S32 *patches)
 {
-#ifdef LL_BIG_ENDIAN
-    S32     i, j, patch_size = gPatchSize, wbits = gWordBits;
-    U8      tempu8;
-    U16     tempu16;
-    U32     tempu32;
-    for (i = 0; i < patch_size*patch_size; i++)
-    {
-        bitpack.bitUnpack((U8 *)&tempu8, 1);
-        if (tempu8)
-        {
-            // either 0 EOB or Value
-            bitpack.bitUnpack((U8 *)&tempu8, 1);
-            if (tempu8)
-            {
-                // value
-                bitpack.bitUnpack((U8 *)&tempu8, 1);
-                if (tempu8)
-                {
-                    // negative
-                    patches[i] = -1;
-                }
-                else
-                {
-                    // positive
-                    patches[i] = 1;
-                }
-                if (wbits <= 8)
-                {
-                    bitpack.bitUnpack((U8 *)&tempu8, wbits);
-                    patches[i] *= tempu8;
-                }
-                else if (wbits <= 16)
-                {
-                    tempu16 = 0;
-                    U8 *ret = (U8 *)&tempu16;
-                    bitpack.bitUnpack(&(ret[1]), 8);
-                    bitpack.bitUnpack(&(ret[0]), wbits - 8);
-                    patches[i] *= tempu16;
-                }
-                else if (wbits <= 24)
-                {
-                    tempu32 = 0;
-                    U8 *ret = (U8 *)&tempu32;
-                    bitpack.bitUnpack(&(ret[2]), 8);
-                    bitpack.bitUnpack(&(ret[1]), 8);
-                    bitpack.bitUnpack(&(ret[0]), wbits - 16);
-                    patches[i] *= tempu32;
-                }
-                else if (wbits <= 32)
-                {
-                    tempu32 = 0;
-                    U8 *ret = (U8 *)&tempu32;
-                    bitpack.bitUnpack(&(ret[3]), 8);
-                    bitpack.bitUnpack(&(ret[2]), 8);
-                    bitpack.bitUnpack(&(ret[1]), 8);
-                    bitpack.bitUnpack(&(ret[0]), wbits - 24);
-                    patches[i] *= tempu32;
-                }
-            }
-            else
-            {
-                for (j = i; j < patch_size*patch_size; j++)
-                {
-                    patches[j] = 0;
-                }
-                return;
-            }
-        }
-        else
-        {
-            patches[i] = 0;
-        }
-    }
-#else
-    S32     i, j, patch_size = gPatchSize, wbits = gWordBits;
+    decode_patch(bitpack, patches, gPatchSize, gWordBits);
+}
+
+void    decode_patch(LLBitPack &bitpack, S32 *patches, S32 patch_size, S32 wbits)
+{
+    S32     i, j;
     U32     temp;
     for (i = 0; i < patch_size*patch_size; i++)
     {
-        temp = 0;
-        bitpack.bitUnpack((U8 *)&temp, 1);
-        if (temp)
+        if (bitpack.unpackBits(1))
         {
             // either 0 EOB or Value
-            temp = 0;
-            bitpack.bitUnpack((U8 *)&temp, 1);
-            if (temp)
+            if (bitpack.unpackBits(1))
             {
-                // value
+                // value, sign first. The word is stored low byte first, as
+                // bitUnpack() into a U32 would read it on a little endian
+                // machine.
+                bool negative = bitpack.unpackBits(1) != 0;
                 temp = 0;
-                bitpack.bitUnpack((U8 *)&temp, 1);
-                if (temp)
-                {
-                    // negative
-                    temp = 0;
-                    bitpack.bitUnpack((U8 *)&temp, wbits);
-                    patches[i] = temp;
-                    patches[i] *= -1;
-                }
-                else
+                for (S32 shift = 0; shift < wbits; shift += 8)
                 {
-                    // positive
-                    temp = 0;
-                    bitpack.bitUnpack((U8 *)&temp, wbits);
-                    patches[i] = temp;
+                    temp |= bitpack.unpackBits(llmin(wbits - shift, 8)) << shift;
                 }
+                patches[i] = negative ? -(S32)temp : (S32)temp;
             }
             else
             {
@@ -402,6 +331,4 @@ void    decode_patch(LLBitPack &bitpack, S32 *patches)
             patches[i] = 0;
         }
     }
-#endif
 }
-
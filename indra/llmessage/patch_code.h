@@ -43,4 +43,9 @@ void    decode_patch_group_header(LLBitPack &bitpack, LLGroupHeader *gopp);
 void    decode_patch_header(LLBitPack &bitpack, LLPatchHeader *ph);
 void    decode_patch(LLBitPack &bitpack, S32 *patches);
 
+// Same as above without the patch and word size globals, for decoding on
+// any thread. word_bits is left alone at the end of patches.
+void    decode_patch_header(LLBitPack &bitpack, LLPatchHeader *ph, S32 *word_bits);
+void    decode_patch(LLBitPack &bitpack, S32 *patches, S32 patch_size, S32 word_bits);
+
 #endif
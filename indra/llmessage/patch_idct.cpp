@@ -24,9 +24,11 @@
  * $/LicenseInfo$
  */
 
+
 #include "linden_common.h"
 
 #include "llmath.h"
+#include "llvector4a.h"
 #include "v3math.h"
 #include "patch_dct.h"
 
@@ -37,24 +39,31 @@ void set_group_of_patch_header(LLGroupHeader *gopp)
     gGOPP = gopp;
 }
 
-F32 gPatchDequantizeTable[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-void build_patch_dequantize_table(S32 size)
+// Decompression tables for one patch size. Both sizes are built once, on
+// first use, so patches can be decoded on any thread.
+struct LLPatchDecompressTables
+{
+    LLPatchDecompressTables(S32 size);
+
+    S32 mSize;
+    LL_ALIGN_16(F32 mICosines[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE]);
+    F32 mDequantize[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+    S32 mDeCopyMatrix[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+};
+
+static void build_patch_dequantize_table(F32 *table, S32 size)
 {
     S32 i, j;
     for (j = 0; j < size; j++)
     {
         for (i = 0; i < size; i++)
         {
-            gPatchDequantizeTable[j*size + i] = (1.f + 2.f*(i+j));
+            table[j*size + i] = (1.f + 2.f*(i+j));
         }
     }
 }
 
-S32 gCurrentDeSize = 0;
-
-F32 gPatchICosines[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-void setup_patch_icosines(S32 size)
+static void setup_patch_icosines(F32 *table, S32 size)
 {
     S32 n, u;
     F32 oosob = F_PI*0.5f/size;
@@ -63,14 +72,12 @@ void setup_patch_icosines(S32 size)
     {
         for (n = 0; n < size; n++)
         {
-            gPatchICosines[u*size+n] = cosf((2.f*n+1.f)*u*oosob);
+            table[u*size+n] = cosf((2.f*n+1.f)*u*oosob);
         }
     }
 }
 
-S32 gDeCopyMatrix[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-void build_decopy_matrix(S32 size)
+static void build_decopy_matrix(S32 *matrix, S32 size)
 {
     S32 i, j, count;
     bool    b_diag = false;
@@ -83,7 +90,7 @@ void build_decopy_matrix(S32 size)
     while (  (i < size)
            &&(j < size))
     {
-        gDeCopyMatrix[j*size + i] = count;
+        matrix[j*size + i] = count;
 
         count++;
 
@@ -134,494 +141,121 @@ void build_decopy_matrix(S32 size)
     }
 }
 
-void init_patch_decompressor(S32 size)
+LLPatchDecompressTables::LLPatchDecompressTables(S32 size)
+:   mSize(size)
 {
-    if (size != gCurrentDeSize)
-    {
-        gCurrentDeSize = size;
-        build_patch_dequantize_table(size);
-        setup_patch_icosines(size);
-        build_decopy_matrix(size);
-    }
+    build_patch_dequantize_table(mDequantize, size);
+    setup_patch_icosines(mICosines, size);
+    build_decopy_matrix(mDeCopyMatrix, size);
 }
 
-inline void idct_line(F32 *linein, F32 *lineout, S32 line)
+static const LLPatchDecompressTables& get_decompress_tables(S32 size)
 {
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-    F32 oosob = 2.f/16.f;
-    S32 line_size = line*NORMAL_PATCH_SIZE;
-    F32 *tlinein, *tpcp;
-
-
-    for (n = 0; n < NORMAL_PATCH_SIZE; n++)
-    {
-        tpcp = pcp + n;
-        tlinein = linein + line_size;
-
-        total = OO_SQRT2*(*(tlinein++));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        *(lineout + line_size + n) = total*oosob;
-    }
-#else
-    F32 oosob = 2.f/size;
-    S32 size = gGOPP->patch_size;
-    S32 line_size = line*size;
-    S32 u;
-    for (n = 0; n < size; n++)
-    {
-        total = OO_SQRT2*linein[line_size];
-        for (u = 1; u < size; u++)
-        {
-            total += linein[line_size + u]*pcp[u*size+n];
-        }
-        lineout[line_size + n] = total*oosob;
-    }
-#endif
+    static const LLPatchDecompressTables normal_tables(NORMAL_PATCH_SIZE);
+    static const LLPatchDecompressTables large_tables(LARGE_PATCH_SIZE);
+    return size == NORMAL_PATCH_SIZE ? normal_tables : large_tables;
 }
 
-inline void idct_line_large_slow(F32 *linein, F32 *lineout, S32 line)
-{
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-    F32 oosob = 2.f/32.f;
-    S32 line_size = line*LARGE_PATCH_SIZE;
-    F32 *tlinein, *tpcp;
-
-
-    for (n = 0; n < LARGE_PATCH_SIZE; n++)
-    {
-        tpcp = pcp + n;
-        tlinein = linein + line_size;
-
-        total = OO_SQRT2*(*(tlinein++));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        *(lineout + line_size + n) = total*oosob;
-    }
-}
-
-// Nota Bene: assumes that coefficients beyond 128 are 0!
-
-void idct_line_large(F32 *linein, F32 *lineout, S32 line)
+void init_patch_decompressor(S32 size)
 {
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-    F32 oosob = 2.f/32.f;
-    S32 line_size = line*LARGE_PATCH_SIZE;
-    F32 *tlinein, *tpcp;
-    F32 *baselinein = linein + line_size;
-    F32 *baselineout = lineout + line_size;
-
-
-    for (n = 0; n < LARGE_PATCH_SIZE; n++)
-    {
-        tpcp = pcp++;
-        tlinein = baselinein;
-
-        total = OO_SQRT2*(*(tlinein++));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein++)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein)*(*(tpcp));
-
-        *baselineout++ = total*oosob;
-    }
+    // the tables for both patch sizes are built on first use
+    get_decompress_tables(size);
 }
 
-inline void idct_column(F32 *linein, F32 *lineout, S32 column)
+// Separable IDCT of a SIZE x SIZE block, four columns (or outputs) at a
+// time. Every lane sums its terms in the same order as the scalar
+// idct_column()/idct_line() pair this replaced, so the results are bit for
+// bit the same.
+template <S32 SIZE>
+static void idct_patch(F32 *block, const F32 *icosines)
 {
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-    F32 *tlinein, *tpcp;
-
-    for (n = 0; n < NORMAL_PATCH_SIZE; n++)
-    {
-        tpcp = pcp + n;
-        tlinein = linein + column;
-
-        total = OO_SQRT2*(*tlinein);
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-        total += *(tlinein += NORMAL_PATCH_SIZE)*(*(tpcp += NORMAL_PATCH_SIZE));
-
-        *(lineout + (n<<4) + column) = total;
-    }
-
-#else
-    S32 size = gGOPP->patch_size;
-    S32 u;
-    S32 u_size;
+    LL_ALIGN_16(F32 temp[SIZE*SIZE]);
+    LLVector4a sqrt2;
+    sqrt2.splat(OO_SQRT2);
+    LLVector4a total, term, cosine;
 
-    for (n = 0; n < size; n++)
+    // columns: temp[n][c] = OO_SQRT2*block[0][c] + sum(block[u][c]*cos[u][n])
+    for (S32 c = 0; c < SIZE; c += 4)
     {
-        total = OO_SQRT2*linein[column];
-        for (u = 1; u < size; u++)
+        for (S32 n = 0; n < SIZE; n++)
         {
-            u_size = u*size;
-            total += linein[u_size + column]*pcp[u_size+n];
+            total.load4a(block + c);
+            total.mul(sqrt2);
+            for (S32 u = 1; u < SIZE; u++)
+            {
+                term.load4a(block + u*SIZE + c);
+                cosine.splat(icosines[u*SIZE + n]);
+                term.mul(cosine);
+                total.add(term);
+            }
+            total.store4a(temp + n*SIZE + c);
         }
-        lineout[size*n + column] = total;
     }
-#endif
-}
-
-inline void idct_column_large_slow(F32 *linein, F32 *lineout, S32 column)
-{
-    S32 n;
-    F32 total;
-    F32 *pcp = gPatchICosines;
 
-    F32 *tlinein, *tpcp;
-
-    for (n = 0; n < LARGE_PATCH_SIZE; n++)
+    // lines: block[l][n] = (OO_SQRT2*temp[l][0] + sum(temp[l][u]*cos[u][n]))*2/SIZE
+    const F32 oosob = 2.f/SIZE;
+    for (S32 line = 0; line < SIZE; line++)
     {
-        tpcp = pcp + n;
-        tlinein = linein + column;
-
-        total = OO_SQRT2*(*tlinein);
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-        total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        *(lineout + (n<<5) + column) = total;
+        const F32 *linein = temp + line*SIZE;
+        for (S32 n = 0; n < SIZE; n += 4)
+        {
+            total.splat(OO_SQRT2*linein[0]);
+            for (S32 u = 1; u < SIZE; u++)
+            {
+                term.splat(linein[u]);
+                cosine.load4a(icosines + u*SIZE + n);
+                term.mul(cosine);
+                total.add(term);
+            }
+            total.mul(oosob);
+            total.store4a(block + line*SIZE + n);
+        }
     }
 }
 
-// Nota Bene: assumes that coefficients beyond 128 are 0!
+S32 gDitherNoise = 128;
 
-void idct_column_large(F32 *linein, F32 *lineout, S32 column)
+// Dequantized, transformed patch, before scaling into heights.
+static void decompress_block(F32 *block, const S32 *cpatch, S32 size)
 {
-    S32 n, m;
-    F32 total;
-    F32 *pcp = gPatchICosines;
+    const LLPatchDecompressTables &tables = get_decompress_tables(size);
+    const F32 *dq = tables.mDequantize;
+    const S32 *decopy_matrix = tables.mDeCopyMatrix;
 
-    F32 *tlinein, *tpcp;
-    F32 *baselinein = linein + column;
-    F32 *baselineout = lineout + column;
-
-    for (n = 0; n < LARGE_PATCH_SIZE; n++)
+    for (S32 i = 0; i < size*size; i++)
     {
-        tpcp = pcp++;
-        tlinein = baselinein;
-
-        total = OO_SQRT2*(*tlinein);
-        for (m = 1; m < NORMAL_PATCH_SIZE; m++)
-            total += *(tlinein += LARGE_PATCH_SIZE)*(*(tpcp += LARGE_PATCH_SIZE));
-
-        *(baselineout + (n<<5)) = total;
+        block[i] = cpatch[decopy_matrix[i]]*dq[i];
     }
-}
 
-inline void idct_patch(F32 *block)
-{
-    F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-#ifdef _PATCH_SIZE_16_AND_32_ONLY
-    idct_column(block, temp, 0);
-    idct_column(block, temp, 1);
-    idct_column(block, temp, 2);
-    idct_column(block, temp, 3);
-
-    idct_column(block, temp, 4);
-    idct_column(block, temp, 5);
-    idct_column(block, temp, 6);
-    idct_column(block, temp, 7);
-
-    idct_column(block, temp, 8);
-    idct_column(block, temp, 9);
-    idct_column(block, temp, 10);
-    idct_column(block, temp, 11);
-
-    idct_column(block, temp, 12);
-    idct_column(block, temp, 13);
-    idct_column(block, temp, 14);
-    idct_column(block, temp, 15);
-
-    idct_line(temp, block, 0);
-    idct_line(temp, block, 1);
-    idct_line(temp, block, 2);
-    idct_line(temp, block, 3);
-
-    idct_line(temp, block, 4);
-    idct_line(temp, block, 5);
-    idct_line(temp, block, 6);
-    idct_line(temp, block, 7);
-
-    idct_line(temp, block, 8);
-    idct_line(temp, block, 9);
-    idct_line(temp, block, 10);
-    idct_line(temp, block, 11);
-
-    idct_line(temp, block, 12);
-    idct_line(temp, block, 13);
-    idct_line(temp, block, 14);
-    idct_line(temp, block, 15);
-#else
-    S32 i;
-    S32 size = gGOPP->patch_size;
-    for (i = 0; i < size; i++)
+    if (size == NORMAL_PATCH_SIZE)
     {
-        idct_column(block, temp, i);
+        idct_patch<NORMAL_PATCH_SIZE>(block, tables.mICosines);
     }
-    for (i = 0; i < size; i++)
+    else
     {
-        idct_line(temp, block, i);
+        idct_patch<LARGE_PATCH_SIZE>(block, tables.mICosines);
     }
-#endif
-}
-
-inline void idct_patch_large(F32 *block)
-{
-    F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-
-    idct_column_large_slow(block, temp, 0);
-    idct_column_large_slow(block, temp, 1);
-    idct_column_large_slow(block, temp, 2);
-    idct_column_large_slow(block, temp, 3);
-
-    idct_column_large_slow(block, temp, 4);
-    idct_column_large_slow(block, temp, 5);
-    idct_column_large_slow(block, temp, 6);
-    idct_column_large_slow(block, temp, 7);
-
-    idct_column_large_slow(block, temp, 8);
-    idct_column_large_slow(block, temp, 9);
-    idct_column_large_slow(block, temp, 10);
-    idct_column_large_slow(block, temp, 11);
-
-    idct_column_large_slow(block, temp, 12);
-    idct_column_large_slow(block, temp, 13);
-    idct_column_large_slow(block, temp, 14);
-    idct_column_large_slow(block, temp, 15);
-
-    idct_column_large_slow(block, temp, 16);
-    idct_column_large_slow(block, temp, 17);
-    idct_column_large_slow(block, temp, 18);
-    idct_column_large_slow(block, temp, 19);
-
-    idct_column_large_slow(block, temp, 20);
-    idct_column_large_slow(block, temp, 21);
-    idct_column_large_slow(block, temp, 22);
-    idct_column_large_slow(block, temp, 23);
-
-    idct_column_large_slow(block, temp, 24);
-    idct_column_large_slow(block, temp, 25);
-    idct_column_large_slow(block, temp, 26);
-    idct_column_large_slow(block, temp, 27);
-
-    idct_column_large_slow(block, temp, 28);
-    idct_column_large_slow(block, temp, 29);
-    idct_column_large_slow(block, temp, 30);
-    idct_column_large_slow(block, temp, 31);
-
-    idct_line_large_slow(temp, block, 0);
-    idct_line_large_slow(temp, block, 1);
-    idct_line_large_slow(temp, block, 2);
-    idct_line_large_slow(temp, block, 3);
-
-    idct_line_large_slow(temp, block, 4);
-    idct_line_large_slow(temp, block, 5);
-    idct_line_large_slow(temp, block, 6);
-    idct_line_large_slow(temp, block, 7);
-
-    idct_line_large_slow(temp, block, 8);
-    idct_line_large_slow(temp, block, 9);
-    idct_line_large_slow(temp, block, 10);
-    idct_line_large_slow(temp, block, 11);
-
-    idct_line_large_slow(temp, block, 12);
-    idct_line_large_slow(temp, block, 13);
-    idct_line_large_slow(temp, block, 14);
-    idct_line_large_slow(temp, block, 15);
-
-    idct_line_large_slow(temp, block, 16);
-    idct_line_large_slow(temp, block, 17);
-    idct_line_large_slow(temp, block, 18);
-    idct_line_large_slow(temp, block, 19);
-
-    idct_line_large_slow(temp, block, 20);
-    idct_line_large_slow(temp, block, 21);
-    idct_line_large_slow(temp, block, 22);
-    idct_line_large_slow(temp, block, 23);
-
-    idct_line_large_slow(temp, block, 24);
-    idct_line_large_slow(temp, block, 25);
-    idct_line_large_slow(temp, block, 26);
-    idct_line_large_slow(temp, block, 27);
-
-    idct_line_large_slow(temp, block, 28);
-    idct_line_large_slow(temp, block, 29);
-    idct_line_large_slow(temp, block, 30);
-    idct_line_large_slow(temp, block, 31);
 }
 
-S32 gDitherNoise = 128;
-
-void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph)
+void decompress_patch(F32 *patch, const S32 *cpatch, const LLPatchHeader *ph, S32 size, S32 stride)
 {
     S32     i, j;
 
-    F32     block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], *tblock = block;
+    LL_ALIGN_16(F32 block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE]);
+    F32     *tblock;
     F32     *tpatch;
 
-    LLGroupHeader   *gopp = gGOPP;
-    S32     size = gopp->patch_size;
     F32     range = ph->range;
     S32     prequant = (ph->quant_wbits >> 4) + 2;
     S32     quantize = 1<<prequant;
     F32     hmin = ph->dc_offset;
-    S32     stride = gopp->stride;
 
     F32     ooq = 1.f/(F32)quantize;
-    F32     *dq = gPatchDequantizeTable;
-    S32     *decopy_matrix = gDeCopyMatrix;
 
     F32     mult = ooq*range;
     F32     addval = mult*(F32)(1<<(prequant - 1))+hmin;
 
-    for (i = 0; i < size*size; i++)
-    {
-        *(tblock++) = *(cpatch + *(decopy_matrix++))*(*dq++);
-    }
-
-    if (size == 16)
-    {
-        idct_patch(block);
-    }
-    else
-    {
-        idct_patch_large(block);
-    }
+    decompress_block(block, cpatch, size);
 
     for (j = 0; j < size; j++)
     {
@@ -634,12 +268,17 @@ void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph)
     }
 }
 
+void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph)
+{
+    decompress_patch(patch, cpatch, ph, gGOPP->patch_size, gGOPP->stride);
+}
 
 void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph)
 {
     S32     i, j;
 
-    F32         block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], *tblock = block;
+    LL_ALIGN_16(F32 block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE]);
+    F32         *tblock;
     LLVector3   *tvec;
 
     LLGroupHeader   *gopp = gGOPP;
@@ -651,24 +290,11 @@ void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph)
     S32     stride = gopp->stride;
 
     F32     ooq = 1.f/(F32)quantize;
-    F32     *dq = gPatchDequantizeTable;
-    S32     *decopy_matrix = gDeCopyMatrix;
 
     F32     mult = ooq*range;
     F32     addval = mult*(F32)(1<<(prequant - 1))+hmin;
 
-//  bool    b_diag = false;
-//  bool    b_right = true;
-
-    for (i = 0; i < size*size; i++)
-    {
-        *(tblock++) = *(cpatch + *(decopy_matrix++))*(*dq++);
-    }
-
-    if (size == 16)
-        idct_patch(block);
-    else
-        idct_patch_large(block);
+    decompress_block(block, cpatch, size);
 
     for (j = 0; j < size; j++)
     {
@@ -680,4 +306,3 @@ void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph)
         }
     }
 }
-
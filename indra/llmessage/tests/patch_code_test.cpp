@@ -0,0 +1,423 @@
+/**
+ * @file patch_code_test.cpp
+ * @brief Tests and benchmark for terrain patch decoding.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../patch_code.h"
+#include "../patch_dct.h"
+#include "../test/lltut.h"
+
+#include "llbitpack.h"
+#include "llmath.h"
+#include "llrand.h"
+#include "lltimer.h"
+
+#include <vector>
+
+namespace tut
+{
+    struct patch_code_data
+    {
+        // One decoded patch: its id and its heights, size rows of size.
+        struct Patch
+        {
+            U16 mID;
+            std::vector<F32> mZ;
+        };
+        typedef std::vector<Patch> patch_list_t;
+
+        // Rolling hills plus a little noise, for a region grids_per_edge on
+        // a side.
+        void makeTerrain(std::vector<F32>& heights, S32 grids_per_edge)
+        {
+            heights.resize(grids_per_edge*grids_per_edge);
+            for (S32 j = 0; j < grids_per_edge; j++)
+            {
+                for (S32 i = 0; i < grids_per_edge; i++)
+                {
+                    heights[j*grids_per_edge + i] = 24.f
+                        + 12.f*sinf(i*0.07f)*cosf(j*0.05f)
+                        + 3.f*sinf((i + j)*0.31f)
+                        + ll_frand(0.5f);
+                }
+            }
+        }
+
+        // A LayerData land packet for the whole region, the way the
+        // simulator codes it.
+        void encodeLayer(std::vector<F32>& heights, S32 grids_per_edge, S32 patch_size, std::vector<U8>& packet)
+        {
+            S32 patches_per_edge = grids_per_edge/patch_size;
+            packet.assign(patches_per_edge*patches_per_edge*patch_size*patch_size*4 + 64, 0);
+            LLBitPack bitpack(&packet[0], (U32)packet.size());
+
+            init_patch_compressor(patch_size, grids_per_edge, 'L');
+            init_patch_coding(bitpack);
+
+            LLGroupHeader goph;
+            get_patch_group_header(&goph);
+            code_patch_group_header(bitpack, &goph);
+
+            S32 cpatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+            for (S32 j = 0; j < patches_per_edge; j++)
+            {
+                for (S32 i = 0; i < patches_per_edge; i++)
+                {
+                    F32* patch = &heights[j*patch_size*grids_per_edge + i*patch_size];
+                    LLPatchHeader ph;
+                    F32 zmax, zmin;
+                    prescan_patch(patch, &ph, zmax, zmin);
+                    compress_patch(patch, cpatch, &ph, 10);
+                    ph.patchids = (i << 5) | j;
+                    code_patch_header(bitpack, &ph, cpatch);
+                    code_patch(bitpack, cpatch, 0);
+                }
+            }
+            code_end_of_data(bitpack);
+            packet.resize(bitpack.flushBitPack());
+        }
+
+        // The decoder as it was: one bit at a time into the bytes of a
+        // U32, dequantize, then a scalar column and line IDCT.
+        void referenceDecode(std::vector<U8>& packet, patch_list_t& patches)
+        {
+            LLBitPack bitpack(&packet[0], (U32)packet.size());
+            LLGroupHeader goph;
+            decode_patch_group_header(bitpack, &goph);
+            S32 size = goph.patch_size;
+
+            std::vector<F32> dequantize(size*size), icosines(size*size);
+            std::vector<S32> decopy(size*size);
+            for (S32 j = 0; j < size; j++)
+            {
+                for (S32 i = 0; i < size; i++)
+                {
+                    dequantize[j*size + i] = 1.f + 2.f*(i + j);
+                    icosines[j*size + i] = cosf((2.f*i + 1.f)*j*(F_PI*0.5f/size));
+                }
+            }
+            makeDecopyMatrix(decopy, size);
+
+            while (1)
+            {
+                LLPatchHeader ph;
+                U32 temp = 0;
+                bitpack.bitUnpack((U8*)&temp, 8);
+                ph.quant_wbits = (U8)temp;
+                if (ph.quant_wbits == END_OF_PATCHES)
+                {
+                    break;
+                }
+                bitpack.bitUnpack((U8*)&ph.dc_offset, 32);
+                ph.range = 0;
+                bitpack.bitUnpack((U8*)&ph.range, 16);
+                ph.patchids = 0;
+                bitpack.bitUnpack((U8*)&ph.patchids, 10);
+                S32 wbits = (ph.quant_wbits & 0xf) + 2;
+
+                S32 cpatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+                S32 k = 0;
+                for (; k < size*size; k++)
+                {
+                    temp = 0;
+                    bitpack.bitUnpack((U8*)&temp, 1);
+                    if (!temp)
+                    {
+                        cpatch[k] = 0;
+                        continue;
+                    }
+                    temp = 0;
+                    bitpack.bitUnpack((U8*)&temp, 1);
+                    if (!temp)
+                    {
+                        break;
+                    }
+                    temp = 0;
+                    bitpack.bitUnpack((U8*)&temp, 1);
+                    bool negative = temp != 0;
+                    temp = 0;
+                    bitpack.bitUnpack((U8*)&temp, wbits);
+                    cpatch[k] = negative ? -(S32)temp : (S32)temp;
+                }
+                for (; k < size*size; k++)
+                {
+                    cpatch[k] = 0;
+                }
+
+                F32 block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], temp_block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+                for (S32 i = 0; i < size*size; i++)
+                {
+                    block[i] = cpatch[decopy[i]]*dequantize[i];
+                }
+                for (S32 column = 0; column < size; column++)
+                {
+                    for (S32 n = 0; n < size; n++)
+                    {
+                        F32 total = OO_SQRT2*block[column];
+                        for (S32 u = 1; u < size; u++)
+                        {
+                            total += block[u*size + column]*icosines[u*size + n];
+                        }
+                        temp_block[n*size + column] = total;
+                    }
+                }
+                F32 oosob = 2.f/size;
+                for (S32 line = 0; line < size; line++)
+                {
+                    for (S32 n = 0; n < size; n++)
+                    {
+                        F32 total = OO_SQRT2*temp_block[line*size];
+                        for (S32 u = 1; u < size; u++)
+                        {
+                            total += temp_block[line*size + u]*icosines[u*size + n];
+                        }
+                        block[line*size + n] = total*oosob;
+                    }
+                }
+
+                S32 prequant = (ph.quant_wbits >> 4) + 2;
+                F32 mult = (1.f/(F32)(1 << prequant))*ph.range;
+                F32 addval = mult*(F32)(1 << (prequant - 1)) + ph.dc_offset;
+                Patch patch;
+                patch.mID = ph.patchids;
+                patch.mZ.resize(size*size);
+                for (S32 i = 0; i < size*size; i++)
+                {
+                    patch.mZ[i] = block[i]*mult + addval;
+                }
+                patches.push_back(patch);
+            }
+        }
+
+        void makeDecopyMatrix(std::vector<S32>& decopy, S32 size)
+        {
+            // zig-zag order, as build_decopy_matrix() lays it out
+            S32 i = 0, j = 0, count = 0;
+            bool diag = false, right = true;
+            while (i < size && j < size)
+            {
+                decopy[j*size + i] = count++;
+                if (!diag)
+                {
+                    if (right)
+                    {
+                        if (i < size - 1) i++; else j++;
+                    }
+                    else
+                    {
+                        if (j < size - 1) j++; else i++;
+                    }
+                    right = !right;
+                    diag = true;
+                }
+                else if (right)
+                {
+                    i++;
+                    j--;
+                    diag = !(i == size - 1 || j == 0);
+                }
+                else
+                {
+                    i--;
+                    j++;
+                    diag = !(i == 0 || j == size - 1);
+                }
+            }
+        }
+
+        // What LLSurface::decodeDCTPatches() does, without the viewer.
+        void decode(std::vector<U8>& packet, patch_list_t& patches)
+        {
+            LLBitPack bitpack(&packet[0], (U32)packet.size());
+            LLGroupHeader goph;
+            decode_patch_group_header(bitpack, &goph);
+            S32 size = goph.patch_size;
+
+            S32 cpatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+            while (1)
+            {
+                LLPatchHeader ph;
+                S32 word_bits;
+                decode_patch_header(bitpack, &ph, &word_bits);
+                if (ph.quant_wbits == END_OF_PATCHES)
+                {
+                    break;
+                }
+                Patch patch;
+                patch.mID = ph.patchids;
+                patch.mZ.resize(size*size);
+                decode_patch(bitpack, cpatch, size, word_bits);
+                decompress_patch(&patch.mZ[0], cpatch, &ph, size, size);
+                patches.push_back(patch);
+            }
+        }
+
+        void ensureSame(const std::string& what, const patch_list_t& expected, const patch_list_t& actual)
+        {
+            ensure_equals(what + ": patch count", actual.size(), expected.size());
+            for (size_t i = 0; i < expected.size(); i++)
+            {
+                ensure_equals(what + ": patch id", actual[i].mID, expected[i].mID);
+                ensure(what + ": heights bit for bit",
+                       !memcmp(&actual[i].mZ[0], &expected[i].mZ[0], expected[i].mZ.size()*sizeof(F32)));
+            }
+        }
+    };
+
+    typedef test_group<patch_code_data> patch_code_t;
+    typedef patch_code_t::object patch_code_object_t;
+    tut::patch_code_t tut_patch_code("patch_code");
+
+    // 16 grid patches decode exactly as before
+    template<> template<>
+    void patch_code_object_t::test<1>()
+    {
+        std::vector<F32> heights;
+        makeTerrain(heights, 256);
+        std::vector<U8> packet;
+        encodeLayer(heights, 256, NORMAL_PATCH_SIZE, packet);
+
+        patch_list_t expected, actual;
+        referenceDecode(packet, expected);
+        decode(packet, actual);
+        ensure_equals("every patch coded", expected.size(), (size_t)(16*16));
+        ensureSame("16 grid patches", expected, actual);
+
+        // and close to what was coded
+        for (const Patch& patch : actual)
+        {
+            S32 i = patch.mID >> 5;
+            S32 j = patch.mID & 0x1F;
+            for (S32 y = 0; y < NORMAL_PATCH_SIZE; y++)
+            {
+                for (S32 x = 0; x < NORMAL_PATCH_SIZE; x++)
+                {
+                    F32 coded = heights[(j*NORMAL_PATCH_SIZE + y)*256 + i*NORMAL_PATCH_SIZE + x];
+                    ensure("height survives the round trip", fabsf(patch.mZ[y*NORMAL_PATCH_SIZE + x] - coded) < 1.f);
+                }
+            }
+        }
+    }
+
+    // 32 grid patches decode exactly as before
+    template<> template<>
+    void patch_code_object_t::test<2>()
+    {
+        std::vector<F32> heights;
+        makeTerrain(heights, 256);
+        std::vector<U8> packet;
+        encodeLayer(heights, 256, LARGE_PATCH_SIZE, packet);
+
+        patch_list_t expected, actual;
+        referenceDecode(packet, expected);
+        decode(packet, actual);
+        ensure_equals("every patch coded", expected.size(), (size_t)(8*8));
+        ensureSame("32 grid patches", expected, actual);
+    }
+
+    // the global state entry points still work, with a stride
+    template<> template<>
+    void patch_code_object_t::test<3>()
+    {
+        const S32 grids_per_edge = 64;
+        std::vector<F32> heights;
+        makeTerrain(heights, grids_per_edge);
+        std::vector<U8> packet;
+        encodeLayer(heights, grids_per_edge, NORMAL_PATCH_SIZE, packet);
+
+        patch_list_t expected;
+        referenceDecode(packet, expected);
+
+        std::vector<F32> surface(grids_per_edge*grids_per_edge, 0.f);
+        LLBitPack bitpack(&packet[0], (U32)packet.size());
+        LLGroupHeader goph;
+        decode_patch_group_header(bitpack, &goph);
+        init_patch_decompressor(goph.patch_size);
+        goph.stride = grids_per_edge;
+        set_group_of_patch_header(&goph);
+
+        S32 cpatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+        LLPatchHeader ph;
+        while (1)
+        {
+            decode_patch_header(bitpack, &ph);
+            if (ph.quant_wbits == END_OF_PATCHES)
+            {
+                break;
+            }
+            S32 i = ph.patchids >> 5;
+            S32 j = ph.patchids & 0x1F;
+            decode_patch(bitpack, cpatch);
+            decompress_patch(&surface[(j*grids_per_edge + i)*NORMAL_PATCH_SIZE], cpatch, &ph);
+        }
+
+        for (const Patch& patch : expected)
+        {
+            S32 i = patch.mID >> 5;
+            S32 j = patch.mID & 0x1F;
+            for (S32 y = 0; y < NORMAL_PATCH_SIZE; y++)
+            {
+                ensure("row matches", !memcmp(&surface[(j*NORMAL_PATCH_SIZE + y)*grids_per_edge + i*NORMAL_PATCH_SIZE],
+                                              &patch.mZ[y*NORMAL_PATCH_SIZE], NORMAL_PATCH_SIZE*sizeof(F32)));
+            }
+        }
+    }
+
+    // headless benchmark: decoding the land packets of a full region
+    template<> template<>
+    void patch_code_object_t::test<4>()
+    {
+        std::vector<F32> heights;
+        makeTerrain(heights, 256);
+        std::vector<U8> packets[2];
+        encodeLayer(heights, 256, NORMAL_PATCH_SIZE, packets[0]);
+        encodeLayer(heights, 256, LARGE_PATCH_SIZE, packets[1]);
+
+        const S32 ROUNDS = 20;
+        for (S32 p = 0; p < 2; p++)
+        {
+            LLTimer timer;
+            for (S32 round = 0; round < ROUNDS; round++)
+            {
+                patch_list_t patches;
+                referenceDecode(packets[p], patches);
+            }
+            F64 reference_time = timer.getElapsedTimeF64();
+
+            timer.reset();
+            for (S32 round = 0; round < ROUNDS; round++)
+            {
+                patch_list_t patches;
+                decode(packets[p], patches);
+            }
+            F64 decode_time = timer.getElapsedTimeF64();
+
+            LL_INFOS("Terrain") << "256m region of " << (p ? 32 : 16) << " grid patches, " << packets[p].size()
+                << " bytes: scalar decode " << reference_time * 1000.0 / ROUNDS << "ms, vectorized decode "
+                << decode_time * 1000.0 / ROUNDS << "ms" << LL_ENDL;
+        }
+    }
+}
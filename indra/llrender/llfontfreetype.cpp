@@ -40,6 +40,7 @@
 #ifdef FT_FREETYPE_H
 #include FT_FREETYPE_H
 #endif
+#include FT_ADVANCES_H
 
 #include "lldir.h"
 #include "llerror.h"
@@ -50,7 +51,9 @@
 #include "llstring.h"
 //#include "imdebug.h"
 #include "llfontbitmapcache.h"
+#include "llfontglyphthread.h"
 #include "llgl.h"
+#include "lltrace.h"
 
 #define ENABLE_OT_SVG_SUPPORT
 
@@ -60,12 +63,33 @@ LLFontManager *gFontManagerp = NULL;
 
 FT_Library gFTLibrary = NULL;
 
+static LLTrace::CountStatHandle<> sGlyphsRendered("fontglyphsrendered", "Glyphs rendered on the main thread");
+static LLTrace::CountStatHandle<> sGlyphsThreaded("fontglyphsthreaded", "Glyphs rendered on the glyph thread");
+
+// Fonts by LLFontFreetype::mFontId, for glyphs finishing on the glyph thread
+static std::map<U32, LLFontFreetype*> sFontsById;
+static U32 sNextFontId = 1;
+static U32 sNextGlyphRequestId = 1;
+
+static void set_svg_hooks(FT_Library library)
+{
+#ifdef ENABLE_OT_SVG_SUPPORT
+    SVG_RendererHooks hooks = {
+        LLFontFreeTypeSvgRenderer::OnInit,
+        LLFontFreeTypeSvgRenderer::OnFree,
+        LLFontFreeTypeSvgRenderer::OnRender,
+        LLFontFreeTypeSvgRenderer::OnPresetGlypthSlot,
+    };
+    FT_Property_Set(library, "ot-svg", "svg-hooks", &hooks);
+#endif
+}
+
 //static
-void LLFontManager::initClass()
+void LLFontManager::initClass(bool glyph_thread)
 {
     if (!gFontManagerp)
     {
-        gFontManagerp = new LLFontManager;
+        gFontManagerp = new LLFontManager(glyph_thread);
     }
 }
 
@@ -76,7 +100,7 @@ void LLFontManager::cleanupClass()
     gFontManagerp = NULL;
 }
 
-LLFontManager::LLFontManager()
+LLFontManager::LLFontManager(bool glyph_thread)
 {
     int error;
     error = FT_Init_FreeType(&gFTLibrary);
@@ -87,19 +111,17 @@ LLFontManager::LLFontManager()
         FT_Done_FreeType(gFTLibrary);
     }
 
-#ifdef ENABLE_OT_SVG_SUPPORT
-    SVG_RendererHooks hooks = {
-        LLFontFreeTypeSvgRenderer::OnInit,
-        LLFontFreeTypeSvgRenderer::OnFree,
-        LLFontFreeTypeSvgRenderer::OnRender,
-        LLFontFreeTypeSvgRenderer::OnPresetGlypthSlot,
-    };
-    FT_Property_Set(gFTLibrary, "ot-svg", "svg-hooks", &hooks);
-#endif
+    set_svg_hooks(gFTLibrary);
+
+    if (glyph_thread && !LLFontGlyphThread::instanceExists())
+    {
+        LLFontGlyphThread::createInstance(set_svg_hooks);
+    }
 }
 
 LLFontManager::~LLFontManager()
 {
+    LLFontGlyphThread::deleteSingleton();
     FT_Done_FreeType(gFTLibrary);
 }
 
@@ -147,13 +169,20 @@ LLFontFreetype::LLFontFreetype()
     mFTFace(NULL),
     mRenderGlyphCount(0),
     mStyle(0),
-    mPointSize(0)
+    mPointSize(0),
+    mVertDPI(0.f),
+    mHorzDPI(0.f),
+    mGlyphGeneration(0),
+    mFontId(sNextFontId++)
 {
+    sFontsById[mFontId] = this;
 }
 
 
 LLFontFreetype::~LLFontFreetype()
 {
+    sFontsById.erase(mFontId);
+
     // Clean up freetype libs.
     if (mFTFace)
         FT_Done_Face(mFTFace);
@@ -215,6 +244,8 @@ bool LLFontFreetype::loadFace(const std::string& filename, F32 point_size, F32 v
     }
 
     mIsFallback = is_fallback;
+    mVertDPI = vert_dpi;
+    mHorzDPI = horz_dpi;
     F32 pixels_per_em = (point_size / 72.f)*vert_dpi; // Size in inches * dpi
 
     error = FT_Set_Char_Size(mFTFace,    /* handle to face object           */
@@ -544,34 +575,85 @@ LLFontGlyphInfo* LLFontFreetype::addGlyph(llwchar wch, EFontGlyphType glyph_type
     return NULL;
 }
 
-LLFontGlyphInfo* LLFontFreetype::addGlyphFromFont(const LLFontFreetype *fontp, llwchar wch, U32 glyph_index, EFontGlyphType requested_glyph_type) const
+LLFontGlyphInfo* LLFontFreetype::addGlyphFromFont(const LLFontFreetype *fontp, llwchar wch, U32 glyph_index, EFontGlyphType requested_glyph_type, bool allow_thread) const
 {
     LL_PROFILE_ZONE_SCOPED;
     if (mFTFace == NULL)
         return NULL;
 
     llassert(!mIsFallback);
-    fontp->renderGlyph(requested_glyph_type, glyph_index, wch);
-
-    EFontGlyphType bitmap_glyph_type = EFontGlyphType::Unspecified;
-    switch (fontp->mFTFace->glyph->bitmap.pixel_mode)
-    {
-        case FT_PIXEL_MODE_MONO:
-        case FT_PIXEL_MODE_GRAY:
-            bitmap_glyph_type = EFontGlyphType::Grayscale;
-            break;
-        case FT_PIXEL_MODE_BGRA:
-            bitmap_glyph_type = EFontGlyphType::Color;
-            break;
-        default:
-            llassert_always(true);
-            break;
-    }
-    S32 width = fontp->mFTFace->glyph->bitmap.width;
-    S32 height = fontp->mFTFace->glyph->bitmap.rows;
-
-    S32 pos_x, pos_y;
-    U32 bitmap_num;
+
+    // Latin-1 stays on the main thread so UI text never waits a frame for
+    // its glyphs; the scripts and emoji arriving in bulk with chat go to
+    // the glyph thread when there is one.
+    if (allow_thread && wch > LAST_CHAR_FULL)
+    {
+        LLFontGlyphInfo* gi = addPendingGlyph(fontp, wch, glyph_index, requested_glyph_type);
+        if (gi)
+        {
+            return gi;
+        }
+    }
+
+    LLFontGlyphBitmap bitmap;
+    fontp->renderGlyphBitmap(requested_glyph_type, glyph_index, wch, bitmap);
+    LLTrace::add(sGlyphsRendered, 1);
+
+    LLFontGlyphInfo* gi = addGlyphBitmap(wch, glyph_index, requested_glyph_type, bitmap);
+    uploadDirtyBitmaps();
+    return gi;
+}
+
+LLFontGlyphInfo* LLFontFreetype::addPendingGlyph(const LLFontFreetype *fontp, llwchar wch, U32 glyph_index, EFontGlyphType requested_glyph_type) const
+{
+    if (!LLFontGlyphThread::instanceExists() || fontp->mName.empty() || !mFontBitmapCachep->getNumBitmaps(EFontGlyphType::Grayscale))
+    {
+        return NULL;
+    }
+
+    // The advance comes from the font's metrics without rendering anything,
+    // so that text lays out close to where it will end up.
+    FT_Fixed advance = 0;
+    if (FT_Get_Advance(fontp->mFTFace, glyph_index, FT_LOAD_NO_HINTING, &advance) != FT_Err_Ok)
+    {
+        return NULL;
+    }
+
+    LLFontGlyphRequest request;
+    request.mFontId = mFontId;
+    request.mRequestId = sNextGlyphRequestId++;
+    request.mChar = wch;
+    request.mGlyphIndex = glyph_index;
+    request.mGlyphType = requested_glyph_type;
+    request.mFileName = fontp->mName;
+    request.mFaceIndex = (S32)fontp->mFTFace->face_index;
+    request.mPointSize = fontp->mPointSize;
+    request.mVertDPI = fontp->mVertDPI;
+    request.mHorzDPI = fontp->mHorzDPI;
+    request.mRenderMode = gFontRenderMode;
+    if (!LLFontGlyphThread::instance().request(request))
+    {
+        return NULL;
+    }
+
+    // Draws nothing until the real glyph replaces it
+    LLFontGlyphInfo* gi = new LLFontGlyphInfo(glyph_index, requested_glyph_type);
+    gi->mXAdvance = (F32)ll_round(advance / 65536.f);
+    gi->mBitmapEntry = std::make_pair(EFontGlyphType::Grayscale, 0);
+    insertGlyphInfo(wch, gi);
+
+    mPendingGlyphs[std::make_pair(wch, requested_glyph_type)] = PendingGlyph{ request.mRequestId, fontp, glyph_index };
+    return gi;
+}
+
+LLFontGlyphInfo* LLFontFreetype::addGlyphBitmap(llwchar wch, U32 glyph_index, EFontGlyphType requested_glyph_type, const LLFontGlyphBitmap& bitmap) const
+{
+    EFontGlyphType bitmap_glyph_type = bitmap.mBitmapType;
+    S32 width = bitmap.mWidth;
+    S32 height = bitmap.mHeight;
+
+    S32 pos_x = 0, pos_y = 0;
+    U32 bitmap_num = 0;
     mFontBitmapCachep->nextOpenPos(width, pos_x, pos_y, bitmap_glyph_type, bitmap_num);
 
     LLFontGlyphInfo* gi = new LLFontGlyphInfo(glyph_index, requested_glyph_type);
@@ -580,11 +662,10 @@ LLFontGlyphInfo* LLFontFreetype::addGlyphFromFont(const LLFontFreetype *fontp, l
     gi->mBitmapEntry = std::make_pair(bitmap_glyph_type, bitmap_num);
     gi->mWidth = width;
     gi->mHeight = height;
-    gi->mXBearing = fontp->mFTFace->glyph->bitmap_left;
-    gi->mYBearing = fontp->mFTFace->glyph->bitmap_top;
-    // Convert these from 26.6 units to float pixels.
-    gi->mXAdvance = fontp->mFTFace->glyph->advance.x / 64.f;
-    gi->mYAdvance = fontp->mFTFace->glyph->advance.y / 64.f;
+    gi->mXBearing = bitmap.mXBearing;
+    gi->mYBearing = bitmap.mYBearing;
+    gi->mXAdvance = bitmap.mXAdvance;
+    gi->mYAdvance = bitmap.mYAdvance;
 
     insertGlyphInfo(wch, gi);
 
@@ -595,78 +676,129 @@ LLFontGlyphInfo* LLFontFreetype::addGlyphFromFont(const LLFontFreetype *fontp, l
         insertGlyphInfo(wch, gi_temp);
     }
 
-    if (fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO
-        || fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_GRAY)
+    if (EFontGlyphType::Grayscale == bitmap_glyph_type)
     {
-        U8 *buffer_data = fontp->mFTFace->glyph->bitmap.buffer;
-        S32 buffer_row_stride = fontp->mFTFace->glyph->bitmap.pitch;
-        U8 *tmp_graydata = NULL;
-
-        if (fontp->mFTFace->glyph->bitmap.pixel_mode
-            == FT_PIXEL_MODE_MONO)
-        {
-            // need to expand 1-bit bitmap to 8-bit graymap.
-            tmp_graydata = new U8[width * height];
-            S32 xpos, ypos;
-            for (ypos = 0; ypos < height; ++ypos)
-            {
-                S32 bm_row_offset = buffer_row_stride * ypos;
-                for (xpos = 0; xpos < width; ++xpos)
-                {
-                    U32 bm_col_offsetbyte = xpos / 8;
-                    U32 bm_col_offsetbit = 7 - (xpos % 8);
-                    U32 bit =
-                    !!(buffer_data[bm_row_offset
-                               + bm_col_offsetbyte
-                       ] & (1 << bm_col_offsetbit) );
-                    tmp_graydata[width*ypos + xpos] =
-                        255 * bit;
-                }
-            }
-            // use newly-built graymap.
-            buffer_data = tmp_graydata;
-            buffer_row_stride = width;
-        }
-
         setSubImageLuminanceAlpha(pos_x,
                                     pos_y,
                                     bitmap_num,
                                     width,
                                     height,
-                                    buffer_data,
-                                    buffer_row_stride);
-
-        if (tmp_graydata)
-            delete[] tmp_graydata;
+                                    bitmap.mPixels.data(),
+                                    width);
     }
-    else if (fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_BGRA)
+    else if (EFontGlyphType::Color == bitmap_glyph_type)
     {
         setSubImageBGRA(pos_x,
                         pos_y,
                         bitmap_num,
-                        fontp->mFTFace->glyph->bitmap.width,
-                        fontp->mFTFace->glyph->bitmap.rows,
-                        fontp->mFTFace->glyph->bitmap.buffer,
-                        llabs(fontp->mFTFace->glyph->bitmap.pitch));
+                        width,
+                        height,
+                        bitmap.mPixels.data(),
+                        width * 4);
     } else {
         llassert(false);
+        return gi;
     }
 
-    LLImageGL *image_gl = mFontBitmapCachep->getImageGL(bitmap_glyph_type, bitmap_num);
-    LLImageRaw *image_raw = mFontBitmapCachep->getImageRaw(bitmap_glyph_type, bitmap_num);
-    if (image_gl && image_raw)
+    // uploaded by uploadDirtyBitmaps(), once for any number of glyphs
+    mDirtyBitmaps.insert(std::make_pair(bitmap_glyph_type, bitmap_num));
+    return gi;
+}
+
+void LLFontFreetype::uploadDirtyBitmaps() const
+{
+    for (const std::pair<EFontGlyphType, U32>& entry : mDirtyBitmaps)
     {
-        image_gl->setSubImage(image_raw, 0, 0, image_gl->getWidth(), image_gl->getHeight());
+        LLImageGL *image_gl = mFontBitmapCachep->getImageGL(entry.first, entry.second);
+        LLImageRaw *image_raw = mFontBitmapCachep->getImageRaw(entry.first, entry.second);
+        if (image_gl && image_raw)
+        {
+            image_gl->setSubImage(image_raw, 0, 0, image_gl->getWidth(), image_gl->getHeight());
+        }
+        else
+        {
+            llassert(false); //images were just inserted by nextOpenPos, they shouldn't be missing
+        }
     }
-    else
+    mDirtyBitmaps.clear();
+}
+
+void LLFontFreetype::addFinishedGlyph(const LLFontGlyphResult& result) const
+{
+    const LLFontGlyphRequest& request = result.mRequest;
+    pending_glyph_map_t::iterator found = mPendingGlyphs.find(std::make_pair(request.mChar, request.mGlyphType));
+    if (found == mPendingGlyphs.end() || found->second.mRequestId != request.mRequestId)
     {
-        llassert(false); //images were just inserted by nextOpenPos, they shouldn't be missing
+        // asked for again since, after a reset
+        return;
     }
+    PendingGlyph pending = found->second;
+    mPendingGlyphs.erase(found);
 
-    return gi;
+    if (EFontGlyphType::Unspecified == result.mBitmap.mBitmapType)
+    {
+        // the thread could not render it; try here, with all the fallbacks
+        addGlyphFromFont(pending.mFont, request.mChar, pending.mGlyphIndex, request.mGlyphType, false);
+        return;
+    }
+
+    pending.mFont->mRenderGlyphCount++;
+    LLTrace::add(sGlyphsThreaded, 1);
+    addGlyphBitmap(request.mChar, pending.mGlyphIndex, request.mGlyphType, result.mBitmap);
+}
+
+//static
+void LLFontFreetype::addFinishedGlyphs()
+{
+    if (!LLFontGlyphThread::instanceExists())
+    {
+        return;
+    }
+    LL_PROFILE_ZONE_SCOPED;
+
+    std::vector<LLFontGlyphResult> finished;
+    LLFontGlyphThread::instance().takeFinished(finished);
+
+    std::set<const LLFontFreetype*> fonts;
+    for (const LLFontGlyphResult& result : finished)
+    {
+        std::map<U32, LLFontFreetype*>::iterator found = sFontsById.find(result.mRequest.mFontId);
+        if (found != sFontsById.end())
+        {
+            found->second->addFinishedGlyph(result);
+            fonts.insert(found->second);
+        }
+    }
+
+    for (const LLFontFreetype* font : fonts)
+    {
+        font->uploadDirtyBitmaps();
+    }
 }
 
 LLFontGlyphInfo* LLFontFreetype::getGlyphInfo(llwchar wch, EFontGlyphType glyph_type) const
+{
+    if (wch >= GLYPH_TABLE_SIZE)
+    {
+        return findGlyphInfo(wch, glyph_type);
+    }
+
+    std::unique_ptr<glyph_page_t>& page = mGlyphPages[wch >> GLYPH_PAGE_BITS];
+    if (!page)
+    {
+        page.reset(new glyph_page_t());
+    }
+    U32 type_idx = glyph_type < EFontGlyphType::Count ? (U32)glyph_type : (U32)EFontGlyphType::Count;
+    LLFontGlyphInfo*& entry = (*page)[(wch & (GLYPH_PAGE_SIZE - 1)) * GLYPH_TABLE_TYPES + type_idx];
+    if (!entry)
+    {
+        // adding a glyph clears this character's entries, so fill in after
+        entry = findGlyphInfo(wch, glyph_type);
+    }
+    return entry;
+}
+
+LLFontGlyphInfo* LLFontFreetype::findGlyphInfo(llwchar wch, EFontGlyphType glyph_type) const
 {
     std::pair<char_glyph_info_map_t::iterator, char_glyph_info_map_t::iterator> range_it = mCharGlyphInfoMap.equal_range(wch);
 
@@ -691,6 +823,8 @@ void LLFontFreetype::insertGlyphInfo(llwchar wch, LLFontGlyphInfo* gi) const
 
     char_glyph_info_map_t::iterator iter =
         std::find_if(range_it.first, range_it.second, [&gi](const char_glyph_info_map_t::value_type& entry) { return entry.second->mGlyphType == gi->mGlyphType; });
+    // an existing glyph is going away or the character's first glyph may change
+    bool had_glyphs = range_it.first != range_it.second;
     if (iter != range_it.second)
     {
         delete iter->second;
@@ -700,6 +834,25 @@ void LLFontFreetype::insertGlyphInfo(llwchar wch, LLFontGlyphInfo* gi) const
     {
         mCharGlyphInfoMap.insert(std::make_pair(wch, gi));
     }
+
+    if (had_glyphs)
+    {
+        mGlyphGeneration++;
+    }
+    if (wch < GLYPH_TABLE_SIZE && mGlyphPages[wch >> GLYPH_PAGE_BITS])
+    {
+        glyph_page_t& page = *mGlyphPages[wch >> GLYPH_PAGE_BITS];
+        U32 first = (wch & (GLYPH_PAGE_SIZE - 1)) * GLYPH_TABLE_TYPES;
+        std::fill(page.begin() + first, page.begin() + first + GLYPH_TABLE_TYPES, nullptr);
+    }
+}
+
+void LLFontFreetype::clearGlyphTable() const
+{
+    for (std::unique_ptr<glyph_page_t>& page : mGlyphPages)
+    {
+        page.reset();
+    }
 }
 
 void LLFontFreetype::renderGlyph(EFontGlyphType bitmap_type, U32 glyph_index, llwchar wch) const
@@ -747,6 +900,15 @@ void LLFontFreetype::renderGlyph(EFontGlyphType bitmap_type, U32 glyph_index, ll
     mRenderGlyphCount++;
 }
 
+bool LLFontFreetype::renderGlyphBitmap(EFontGlyphType bitmap_type, U32 glyph_index, llwchar wch, LLFontGlyphBitmap& bitmap) const
+{
+    if (mFTFace == NULL)
+        return false;
+
+    renderGlyph(bitmap_type, glyph_index, wch);
+    return bitmap.copyFrom(mFTFace->glyph);
+}
+
 void LLFontFreetype::reset(F32 vert_dpi, F32 horz_dpi)
 {
     resetBitmapCache();
@@ -777,6 +939,10 @@ void LLFontFreetype::resetBitmapCache()
         delete it->second;
     }
     mCharGlyphInfoMap.clear();
+    clearGlyphTable();
+    mGlyphGeneration++;
+    mPendingGlyphs.clear();
+    mDirtyBitmaps.clear();
     mFontBitmapCachep->reset();
 
     // Adding default glyph is skipped for fallback fonts here as well as in loadFace().
@@ -875,7 +1041,7 @@ bool LLFontFreetype::setSubImageBGRA(U32 x, U32 y, U32 bitmap_num, U16 width, U1
     return true;
 }
 
-void LLFontFreetype::setSubImageLuminanceAlpha(U32 x, U32 y, U32 bitmap_num, U32 width, U32 height, U8 *data, S32 stride) const
+void LLFontFreetype::setSubImageLuminanceAlpha(U32 x, U32 y, U32 bitmap_num, U32 width, U32 height, const U8 *data, S32 stride) const
 {
     LLImageRaw *image_raw = mFontBitmapCachep->getImageRaw(EFontGlyphType::Grayscale, bitmap_num);
 
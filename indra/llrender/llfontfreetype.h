@@ -28,11 +28,16 @@
 #define LL_LLFONTFREETYPE_H
 
 #include <boost/unordered_map.hpp>
+#include <array>
+#include <map>
+#include <memory>
+#include <set>
 #include "llpointer.h"
 #include "llstl.h"
 
 #include "llimagegl.h"
 #include "llfontbitmapcache.h"
+#include "llfontglyphthread.h"
 
 // Hack.  FT_Face is just a typedef for a pointer to a struct,
 // but there's no simple forward declarations file for FreeType,
@@ -46,11 +51,13 @@ typedef struct FT_StreamRec_ LLFT_Stream;
 class LLFontManager
 {
 public:
-    static void initClass();
+    // glyph_thread starts an LLFontGlyphThread to render glyphs beyond
+    // Latin-1 off the main thread
+    static void initClass(bool glyph_thread = false);
     static void cleanupClass();
 
 private:
-    LLFontManager();
+    LLFontManager(bool glyph_thread);
     ~LLFontManager();
 };
 
@@ -137,6 +144,14 @@ public:
 
     LLFontGlyphInfo* getGlyphInfo(llwchar wch, EFontGlyphType glyph_type) const;
 
+    // Renders a glyph of this face on the calling thread, as the main thread
+    // does for the glyphs it does not hand to the glyph thread.
+    bool renderGlyphBitmap(EFontGlyphType bitmap_type, U32 glyph_index, llwchar wch, LLFontGlyphBitmap& bitmap) const;
+
+    // Changes whenever glyph infos handed out earlier may have been replaced
+    // or deleted, so anything holding on to them has to look them up again.
+    U32 getGlyphGeneration() const { return mGlyphGeneration; }
+
     void reset(F32 vert_dpi, F32 horz_dpi);
 
     void destroyGL();
@@ -149,21 +164,34 @@ public:
     void setStyle(U8 style);
     U8 getStyle() const;
 
+    // Copies glyphs the glyph thread has finished into the bitmap caches of
+    // the fonts which asked for them, replacing their placeholders. Call
+    // once a frame from the main thread, outside of any text rendering.
+    static void addFinishedGlyphs();
+
 private:
     void resetBitmapCache();
-    void setSubImageLuminanceAlpha(U32 x, U32 y, U32 bitmap_num, U32 width, U32 height, U8 *data, S32 stride = 0) const;
+    void setSubImageLuminanceAlpha(U32 x, U32 y, U32 bitmap_num, U32 width, U32 height, const U8 *data, S32 stride = 0) const;
     bool setSubImageBGRA(U32 x, U32 y, U32 bitmap_num, U16 width, U16 height, const U8* data, U32 stride) const;
     bool hasGlyph(llwchar wch) const;       // Has a glyph for this character
     LLFontGlyphInfo* addGlyph(llwchar wch, EFontGlyphType glyph_type) const;        // Add a new character to the font if necessary
-    LLFontGlyphInfo* addGlyphFromFont(const LLFontFreetype *fontp, llwchar wch, U32 glyph_index, EFontGlyphType bitmap_type) const; // Add a glyph from this font to the other (returns the glyph_index, 0 if not found)
+    LLFontGlyphInfo* addGlyphFromFont(const LLFontFreetype *fontp, llwchar wch, U32 glyph_index, EFontGlyphType bitmap_type, bool allow_thread = true) const; // Add a glyph from this font to the other (returns the glyph_index, 0 if not found)
+    LLFontGlyphInfo* addPendingGlyph(const LLFontFreetype *fontp, llwchar wch, U32 glyph_index, EFontGlyphType requested_glyph_type) const;
+    LLFontGlyphInfo* addGlyphBitmap(llwchar wch, U32 glyph_index, EFontGlyphType requested_glyph_type, const LLFontGlyphBitmap& bitmap) const;
+    void addFinishedGlyph(const LLFontGlyphResult& result) const;
+    void uploadDirtyBitmaps() const;
     void renderGlyph(EFontGlyphType bitmap_type, U32 glyph_index, llwchar wch) const;
     void insertGlyphInfo(llwchar wch, LLFontGlyphInfo* gi) const;
+    LLFontGlyphInfo* findGlyphInfo(llwchar wch, EFontGlyphType glyph_type) const;
+    void clearGlyphTable() const;
 
     std::string mName;
 
     U8 mStyle;
 
     F32 mPointSize;
+    F32 mVertDPI;
+    F32 mHorzDPI;
     F32 mAscender;
     F32 mDescender;
     F32 mLineHeight;
@@ -184,8 +212,38 @@ private:
     typedef boost::unordered_multimap<llwchar, LLFontGlyphInfo*> char_glyph_info_map_t;
     mutable char_glyph_info_map_t mCharGlyphInfoMap; // Information about glyph location in bitmap
 
+    // Direct lookup in front of mCharGlyphInfoMap for the Basic Multilingual
+    // Plane, in pages of 256 characters allocated as they are first used.
+    // Each page holds getGlyphInfo()'s answer per character and glyph type,
+    // with Unspecified stored after the real types.
+    static const U32 GLYPH_PAGE_BITS = 8;
+    static const U32 GLYPH_PAGE_SIZE = 1 << GLYPH_PAGE_BITS;
+    static const U32 GLYPH_TABLE_SIZE = 0x10000;
+    static const U32 GLYPH_TABLE_TYPES = (U32)EFontGlyphType::Count + 1;
+    typedef std::array<LLFontGlyphInfo*, GLYPH_PAGE_SIZE * GLYPH_TABLE_TYPES> glyph_page_t;
+    mutable std::unique_ptr<glyph_page_t> mGlyphPages[GLYPH_TABLE_SIZE / GLYPH_PAGE_SIZE];
+    mutable U32 mGlyphGeneration;
+
     mutable LLFontBitmapCache* mFontBitmapCachep;
 
+    // Bitmaps written to since they were last uploaded to GL
+    mutable std::set<std::pair<EFontGlyphType, U32> > mDirtyBitmaps;
+
+    // Glyphs with a placeholder in mCharGlyphInfoMap while the glyph thread
+    // renders them from mFont, which is this font or one of its fallbacks.
+    struct PendingGlyph
+    {
+        U32 mRequestId;
+        const LLFontFreetype* mFont;
+        U32 mGlyphIndex;
+    };
+    typedef std::map<std::pair<llwchar, EFontGlyphType>, PendingGlyph> pending_glyph_map_t;
+    mutable pending_glyph_map_t mPendingGlyphs;
+
+    // Identifies this font to the glyph thread, which may finish a glyph
+    // after the font is gone.
+    U32 mFontId;
+
     mutable S32 mRenderGlyphCount;
 };
 
@@ -279,6 +279,13 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
         }
     }
 
+    const EFontGlyphType glyph_type = (!use_color) ? EFontGlyphType::Grayscale : EFontGlyphType::Color;
+    LLFontRunCache::run_ptr_t run = getRun(wstr.c_str() + begin_offset, length, glyph_type);
+    if (run && run->size() != length)
+    {
+        // stopped short at an embedded terminator
+        run.reset();
+    }
     const LLFontGlyphInfo* next_glyph = NULL;
 
     // string can have more than one glyph per char (ex: bold or shadow),
@@ -302,11 +309,11 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
     {
         llwchar wch = wstr[i];
 
-        const LLFontGlyphInfo* fgi = next_glyph;
+        const LLFontGlyphInfo* fgi = run ? run->mGlyphs[i - begin_offset].mInfo : next_glyph;
         next_glyph = NULL;
-        if(!fgi)
+        if(!fgi && !run)
         {
-            fgi = mFontFreetype->getGlyphInfo(wch, (!use_color) ? EFontGlyphType::Grayscale : EFontGlyphType::Color);
+            fgi = mFontFreetype->getGlyphInfo(wch, glyph_type);
         }
         if (!fgi)
         {
@@ -382,8 +389,16 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
         if (next_char && (next_char < LAST_CHARACTER))
         {
             // Kern this puppy.
-            next_glyph = mFontFreetype->getGlyphInfo(next_char, (!use_color) ? EFontGlyphType::Grayscale : EFontGlyphType::Color);
-            cur_x += mFontFreetype->getXKerning(fgi, next_glyph);
+            if (run && i + 1 < begin_offset + length)
+            {
+                cur_x += run->mGlyphs[i - begin_offset].mKerning;
+            }
+            else
+            {
+                // the character after the last one drawn still kerns
+                next_glyph = mFontFreetype->getGlyphInfo(next_char, glyph_type);
+                cur_x += mFontFreetype->getXKerning(fgi, next_glyph);
+            }
         }
 
         // Round after kerning.
@@ -525,8 +540,19 @@ F32 LLFontGL::getWidthF32(const llwchar* wchars, S32 begin_offset, S32 max_chars
     LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
     const S32 LAST_CHARACTER = LLFontFreetype::LAST_CHAR_FULL;
 
+    const LLFontRunCache::run_ptr_t run = getRun(wchars + begin_offset, max_chars, EFontGlyphType::Unspecified);
+    if (run)
+    {
+        F32& width = no_padding ? run->mUnpaddedWidth : run->mWidth;
+        if (width >= 0.f)
+        {
+            return width / sScaleX;
+        }
+    }
+
     F32 cur_x = 0;
-    const S32 max_index = begin_offset + max_chars;
+    // max_chars is S32_MAX by default, so make sure we don't get overflow
+    const S32 max_index = begin_offset + llmin(S32_MAX - begin_offset, max_chars);
 
     const LLFontGlyphInfo* next_glyph = NULL;
 
@@ -536,13 +562,26 @@ F32 LLFontGL::getWidthF32(const llwchar* wchars, S32 begin_offset, S32 max_chars
         llwchar wch = wchars[i];
 
         const LLFontGlyphInfo* fgi = next_glyph;
-        next_glyph = NULL;
-        if(!fgi)
+        F32 advance;
+        F32 extent;
+        F32 kerning = 0.f;
+        if (run)
         {
-            fgi = mFontFreetype->getGlyphInfo(wch, EFontGlyphType::Unspecified);
+            const LLFontRun::Glyph& glyph = run->mGlyphs[i - begin_offset];
+            advance = glyph.mAdvance;
+            extent = glyph.mExtent;
+            kerning = glyph.mKerning;
+        }
+        else
+        {
+            next_glyph = NULL;
+            if(!fgi)
+            {
+                fgi = mFontFreetype->getGlyphInfo(wch, EFontGlyphType::Unspecified);
+            }
+            advance = mFontFreetype->getXAdvance(fgi);
+            extent = (F32)(fgi->mWidth + fgi->mXBearing);
         }
-
-        F32 advance = mFontFreetype->getXAdvance(fgi);
 
         if (!no_padding)
         {
@@ -551,19 +590,23 @@ F32 LLFontGL::getWidthF32(const llwchar* wchars, S32 begin_offset, S32 max_chars
             // so we can fix things up at the end
             width_padding = llmax(0.f,                                          // always use positive padding amount
                 width_padding - advance,                        // previous padding left over after advance of current character
-                (F32)(fgi->mWidth + fgi->mXBearing) - advance); // difference between width of this character and advance to next character
+                extent - advance);                              // difference between width of this character and advance to next character
         }
 
         cur_x += advance;
         llwchar next_char = wchars[i+1];
 
-        if (((i + 1) < begin_offset + max_chars)
+        if (((i + 1) < max_index)
             && next_char
             && (next_char < LAST_CHARACTER))
         {
             // Kern this puppy.
-            next_glyph = mFontFreetype->getGlyphInfo(next_char, EFontGlyphType::Unspecified);
-            cur_x += mFontFreetype->getXKerning(fgi, next_glyph);
+            if (!run)
+            {
+                next_glyph = mFontFreetype->getGlyphInfo(next_char, EFontGlyphType::Unspecified);
+                kerning = mFontFreetype->getXKerning(fgi, next_glyph);
+            }
+            cur_x += kerning;
         }
         // Round after kerning.
         cur_x = (F32)ll_round(cur_x);
@@ -575,9 +618,43 @@ F32 LLFontGL::getWidthF32(const llwchar* wchars, S32 begin_offset, S32 max_chars
         cur_x += width_padding;
     }
 
+    if (run)
+    {
+        (no_padding ? run->mUnpaddedWidth : run->mWidth) = cur_x;
+    }
+
     return cur_x / sScaleX;
 }
 
+LLFontRunCache::run_ptr_t LLFontGL::getRun(const llwchar* wchars, S32 max_chars, EFontGlyphType glyph_type) const
+{
+    // count no further than one past what a run can hold
+    const S32 limit = llmin(max_chars, LLFontRunCache::MAX_RUN_LENGTH + 1);
+    S32 length = 0;
+    while (length < limit && wchars[length])
+    {
+        length++;
+    }
+
+    return mRunCache.getRun(wchars, length, (U32)glyph_type, mFontFreetype->getGlyphGeneration(),
+        [this, glyph_type](const llwchar* text, S32 count, LLFontRun& run)
+        {
+            run.mGlyphs.resize(count);
+            const LLFontGlyphInfo* fgi = mFontFreetype->getGlyphInfo(text[0], glyph_type);
+            for (S32 i = 0; i < count; i++)
+            {
+                const LLFontGlyphInfo* next_glyph = (i + 1 < count) ? mFontFreetype->getGlyphInfo(text[i + 1], glyph_type) : NULL;
+                LLFontRun::Glyph& glyph = run.mGlyphs[i];
+                glyph.mInfo = fgi;
+                glyph.mAdvance = fgi ? mFontFreetype->getXAdvance(fgi) : 0.f;
+                glyph.mExtent = fgi ? (F32)(fgi->mWidth + fgi->mXBearing) : 0.f;
+                glyph.mKerning = (fgi && next_glyph) ? mFontFreetype->getXKerning(fgi, next_glyph) : 0.f;
+                fgi = next_glyph;
+            }
+            return mFontFreetype->getGlyphGeneration();
+        });
+}
+
 void LLFontGL::generateASCIIglyphs()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
@@ -609,7 +686,9 @@ S32 LLFontGL::maxDrawableChars(const llwchar* wchars, F32 max_pixels, S32 max_ch
     F32 scaled_max_pixels = max_pixels * sScaleX;
     F32 width_padding = 0.f;
 
-    LLFontGlyphInfo* next_glyph = NULL;
+    const LLFontRunCache::run_ptr_t run = getRun(wchars, max_chars, EFontGlyphType::Unspecified);
+
+    const LLFontGlyphInfo* next_glyph = NULL;
 
     S32 i;
     for (i=0; (i < max_chars); i++)
@@ -653,24 +732,25 @@ S32 LLFontGL::maxDrawableChars(const llwchar* wchars, F32 max_pixels, S32 max_ch
             }
         }
 
-        LLFontGlyphInfo* fgi = next_glyph;
+        const LLFontGlyphInfo* fgi = run ? run->mGlyphs[i].mInfo : next_glyph;
         next_glyph = NULL;
-        if(!fgi)
+        if(!fgi && !run)
         {
             fgi = mFontFreetype->getGlyphInfo(wch, EFontGlyphType::Unspecified);
-
-            if (NULL == fgi)
-            {
-                return 0;
-            }
         }
+        if (NULL == fgi)
+        {
+            return 0;
+        }
+        const F32 advance = fgi->mXAdvance;
+        const F32 extent = (F32)(fgi->mWidth + fgi->mXBearing);
 
         // account for glyphs that run beyond the starting point for the next glyphs
-        width_padding = llmax(  0.f,                                                    // always use positive padding amount
-                                width_padding - fgi->mXAdvance,                         // previous padding left over after advance of current character
-                                (F32)(fgi->mWidth + fgi->mXBearing) - fgi->mXAdvance);  // difference between width of this character and advance to next character
+        width_padding = llmax(  0.f,                                    // always use positive padding amount
+                                width_padding - advance,                // previous padding left over after advance of current character
+                                extent - advance);                      // difference between width of this character and advance to next character
 
-        cur_x += fgi->mXAdvance;
+        cur_x += advance;
 
         // clip if current character runs past scaled_max_pixels (using width_padding)
         if (scaled_max_pixels < cur_x + width_padding)
@@ -679,7 +759,11 @@ S32 LLFontGL::maxDrawableChars(const llwchar* wchars, F32 max_pixels, S32 max_ch
             break;
         }
 
-        if (((i+1) < max_chars) && wchars[i+1])
+        if (run)
+        {
+            cur_x += run->mGlyphs[i].mKerning;
+        }
+        else if (((i+1) < max_chars) && wchars[i+1])
         {
             // Kern this puppy.
             next_glyph = mFontFreetype->getGlyphInfo(wchars[i+1], EFontGlyphType::Unspecified);
@@ -725,11 +809,18 @@ S32 LLFontGL::firstDrawableChar(const llwchar* wchars, F32 max_pixels, S32 text_
     F32 scaled_max_pixels = max_pixels * sScaleX;
 
     S32 start = llmin(start_pos, text_len - 1);
+    // the run has to cover everything up to start
+    LLFontRunCache::run_ptr_t run = getRun(wchars, start + 1, EFontGlyphType::Unspecified);
+    if (run && run->size() != start + 1)
+    {
+        run.reset();
+    }
+
     for (S32 i = start; i >= 0; i--)
     {
         llwchar wch = wchars[i];
 
-        const LLFontGlyphInfo* fgi= mFontFreetype->getGlyphInfo(wch, EFontGlyphType::Unspecified);
+        const LLFontGlyphInfo* fgi = run ? run->mGlyphs[i].mInfo : mFontFreetype->getGlyphInfo(wch, EFontGlyphType::Unspecified);
 
         // last character uses character width, since the whole character needs to be visible
         // other characters just use advance
@@ -753,7 +844,7 @@ S32 LLFontGL::firstDrawableChar(const llwchar* wchars, F32 max_pixels, S32 text_
         if ( i > 0 )
         {
             // kerning
-            total_width += mFontFreetype->getXKerning(wchars[i-1], wch);
+            total_width += run ? run->mGlyphs[i-1].mKerning : mFontFreetype->getXKerning(wchars[i-1], wch);
         }
 
         // Round after kerning.
@@ -30,6 +30,7 @@
 
 #include "llcoord.h"
 #include "llfontregistry.h"
+#include "llfontruncache.h"
 #include "llimagegl.h"
 #include "llpointer.h"
 #include "llrect.h"
@@ -39,6 +40,7 @@ class LLColor4;
 // Key used to request a font.
 class LLFontDescriptor;
 class LLFontFreetype;
+enum class EFontGlyphType : U32;
 
 // Structure used to store previously requested fonts.
 class LLFontRegistry;
@@ -240,6 +242,14 @@ private:
     LLFontDescriptor mFontDescriptor;
     LLPointer<LLFontFreetype> mFontFreetype;
 
+    // Laid out runs of short text, so labels, name tags and chat lines that
+    // are drawn every frame are only measured once.
+    mutable LLFontRunCache mRunCache;
+
+    // The run for wchars up to the terminator or max_chars characters,
+    // whichever comes first. Empty for text too long to cache.
+    LLFontRunCache::run_ptr_t getRun(const llwchar* wchars, S32 max_chars, EFontGlyphType glyph_type) const;
+
     void renderTriangle(LLVector4a* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, F32 slant_amt) const;
     void drawGlyph(S32& glyph_count, LLVector4a* vertex_out, LLVector2* uv_out, LLColor4U* colors_out, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4U& color, U8 style, ShadowType shadow, F32 drop_shadow_fade) const;
 
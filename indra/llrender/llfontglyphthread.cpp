@@ -0,0 +1,223 @@
+/**
+ * @file llfontglyphthread.cpp
+ * @brief Renders font glyphs with FreeType off the main thread.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llfontglyphthread.h"
+
+#include <ft2build.h>
+#ifdef FT_FREETYPE_H
+#include FT_FREETYPE_H
+#endif
+
+#include "llstring.h"
+
+LLFontGlyphBitmap::LLFontGlyphBitmap()
+:   mBitmapType(EFontGlyphType::Unspecified),
+    mWidth(0),
+    mHeight(0),
+    mXBearing(0),
+    mYBearing(0),
+    mXAdvance(0.f),
+    mYAdvance(0.f)
+{
+}
+
+bool LLFontGlyphBitmap::copyFrom(LLFT_GlyphSlot slot)
+{
+    const FT_Bitmap& bitmap = slot->bitmap;
+    mWidth = bitmap.width;
+    mHeight = bitmap.rows;
+    mXBearing = slot->bitmap_left;
+    mYBearing = slot->bitmap_top;
+    // Convert these from 26.6 units to float pixels.
+    mXAdvance = slot->advance.x / 64.f;
+    mYAdvance = slot->advance.y / 64.f;
+
+    const S32 pitch = llabs(bitmap.pitch);
+    switch (bitmap.pixel_mode)
+    {
+        case FT_PIXEL_MODE_MONO:
+            // need to expand 1-bit bitmap to 8-bit graymap.
+            mBitmapType = EFontGlyphType::Grayscale;
+            mPixels.resize(mWidth * mHeight);
+            for (S32 ypos = 0; ypos < mHeight; ++ypos)
+            {
+                const U8* row = bitmap.buffer + pitch * ypos;
+                for (S32 xpos = 0; xpos < mWidth; ++xpos)
+                {
+                    U32 bit = !!(row[xpos / 8] & (1 << (7 - (xpos % 8))));
+                    mPixels[mWidth * ypos + xpos] = 255 * bit;
+                }
+            }
+            return true;
+
+        case FT_PIXEL_MODE_GRAY:
+            mBitmapType = EFontGlyphType::Grayscale;
+            mPixels.resize(mWidth * mHeight);
+            for (S32 ypos = 0; ypos < mHeight; ++ypos)
+            {
+                memcpy(&mPixels[mWidth * ypos], bitmap.buffer + pitch * ypos, mWidth);
+            }
+            return true;
+
+        case FT_PIXEL_MODE_BGRA:
+            mBitmapType = EFontGlyphType::Color;
+            mPixels.resize(mWidth * mHeight * 4);
+            for (S32 ypos = 0; ypos < mHeight; ++ypos)
+            {
+                memcpy(&mPixels[mWidth * ypos * 4], bitmap.buffer + pitch * ypos, mWidth * 4);
+            }
+            return true;
+
+        default:
+            mBitmapType = EFontGlyphType::Unspecified;
+            mPixels.clear();
+            return false;
+    }
+}
+
+LLFontGlyphThread::LLFontGlyphThread(const init_library_func_t& init_library)
+    // We want exactly one thread.
+    : LL::ThreadPool("LLFontGlyph", 1)
+    , mLibrary(NULL)
+    , mPending(0)
+{
+    if (FT_Init_FreeType(&mLibrary))
+    {
+        LL_WARNS("Font") << "Could not initialize FreeType for the glyph thread, rendering glyphs on the main thread" << LL_ENDL;
+        mLibrary = NULL;
+        getQueue().close();
+        return;
+    }
+    if (init_library)
+    {
+        init_library(mLibrary);
+    }
+    LL::ThreadPool::start();
+}
+
+LLFontGlyphThread::~LLFontGlyphThread()
+{
+    close();
+
+    for (auto& entry : mFaces)
+    {
+        if (entry.second)
+        {
+            FT_Done_Face(entry.second);
+        }
+    }
+    mFaces.clear();
+    if (mLibrary)
+    {
+        FT_Done_FreeType(mLibrary);
+        mLibrary = NULL;
+    }
+}
+
+bool LLFontGlyphThread::request(const LLFontGlyphRequest& request)
+{
+    mPending++;
+    if (!getQueue().post([this, request]() { renderRequest(request); }))
+    {
+        mPending--;
+        return false;
+    }
+    return true;
+}
+
+void LLFontGlyphThread::takeFinished(std::vector<LLFontGlyphResult>& finished)
+{
+    {
+        std::lock_guard<std::mutex> lock(mFinishedMutex);
+        finished.swap(mFinished);
+    }
+    mPending -= (S32)finished.size();
+}
+
+// static
+bool LLFontGlyphThread::render(LLFT_Face face, const LLFontGlyphRequest& request, LLFontGlyphBitmap& bitmap)
+{
+    FT_Int32 load_flags = FT_LOAD_FORCE_AUTOHINT;
+    if (EFontGlyphType::Color == request.mGlyphType)
+    {
+        // We may not actually get a color render; copyFrom() sorts out which we got
+        load_flags |= FT_LOAD_COLOR;
+    }
+
+    if (FT_Load_Glyph(face, request.mGlyphIndex, load_flags) != FT_Err_Ok
+        || FT_Render_Glyph(face->glyph, (FT_Render_Mode)request.mRenderMode) != FT_Err_Ok)
+    {
+        return false;
+    }
+    return bitmap.copyFrom(face->glyph);
+}
+
+void LLFontGlyphThread::renderRequest(const LLFontGlyphRequest& request)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    LLFontGlyphResult result;
+    result.mRequest = request;
+    {
+        std::lock_guard<std::mutex> lock(mRenderMutex);
+        LLFT_Face face = getFace(request);
+        if (!face || !render(face, request, result.mBitmap))
+        {
+            result.mBitmap = LLFontGlyphBitmap();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mFinishedMutex);
+    mFinished.push_back(std::move(result));
+}
+
+LLFT_Face LLFontGlyphThread::getFace(const LLFontGlyphRequest& request)
+{
+    std::string key = llformat("%s|%d|%.2f|%.2f|%.2f", request.mFileName.c_str(), request.mFaceIndex,
+                               request.mPointSize, request.mVertDPI, request.mHorzDPI);
+    auto found = mFaces.find(key);
+    if (found != mFaces.end())
+    {
+        return found->second;
+    }
+
+    // Sized the way LLFontFreetype::loadFace() sizes its face
+    LLFT_Face face = NULL;
+    if (FT_New_Face(mLibrary, request.mFileName.c_str(), request.mFaceIndex, &face))
+    {
+        LL_WARNS("Font") << "Glyph thread could not open " << request.mFileName << LL_ENDL;
+        face = NULL;
+    }
+    else if (FT_Set_Char_Size(face, 0, (S32)(request.mPointSize * 64), (U32)request.mHorzDPI, (U32)request.mVertDPI))
+    {
+        FT_Done_Face(face);
+        face = NULL;
+    }
+    // failures are remembered too, leaving every glyph of that face to the main thread
+    mFaces[key] = face;
+    return face;
+}
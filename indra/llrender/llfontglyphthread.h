@@ -0,0 +1,146 @@
+/**
+ * @file llfontglyphthread.h
+ * @brief Renders font glyphs with FreeType off the main thread.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFONTGLYPHTHREAD_H
+#define LL_LLFONTGLYPHTHREAD_H
+
+#include "llimagegl.h"
+#include "llfontbitmapcache.h"
+#include "llsingleton.h"
+#include "threadpool.h"
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Same hack as llfontfreetype.h: forward declare FreeType's handles rather
+// than pull in its headers.
+struct FT_LibraryRec_;
+typedef struct FT_LibraryRec_* LLFT_Library;
+struct FT_FaceRec_;
+typedef struct FT_FaceRec_* LLFT_Face;
+struct FT_GlyphSlotRec_;
+typedef struct FT_GlyphSlotRec_* LLFT_GlyphSlot;
+
+// A rendered glyph's metrics and pixels, copied out of FreeType's glyph slot
+// so that they can outlive the next glyph rendered into it.
+struct LLFontGlyphBitmap
+{
+    LLFontGlyphBitmap();
+
+    // Copies the glyph last rendered into slot. Returns false, leaving
+    // mBitmapType Unspecified, for pixel modes fonts have no bitmaps for.
+    bool copyFrom(LLFT_GlyphSlot slot);
+
+    EFontGlyphType mBitmapType; // Grayscale or Color once copied
+    S32 mWidth;                 // In pixels
+    S32 mHeight;                // In pixels
+    S32 mXBearing;
+    S32 mYBearing;
+    F32 mXAdvance;
+    F32 mYAdvance;
+
+    // Rows top first as FreeType renders them and tightly packed: one byte
+    // per pixel for Grayscale, four (BGRA) for Color.
+    std::vector<U8> mPixels;
+};
+
+// A glyph one font wants rendered. The face is described rather than passed
+// since FreeType faces must not be shared between threads: the glyph thread
+// opens its own copy of each.
+struct LLFontGlyphRequest
+{
+    U32 mFontId;                // font that will take the glyph
+    U32 mRequestId;             // lets the font tell a stale answer from a current one
+    llwchar mChar;
+    U32 mGlyphIndex;
+    EFontGlyphType mGlyphType;  // as requested, which the bitmap may not match
+
+    std::string mFileName;      // of the face holding the glyph, maybe a fallback font's
+    S32 mFaceIndex;
+    F32 mPointSize;
+    F32 mVertDPI;
+    F32 mHorzDPI;
+    S32 mRenderMode;            // FT_Render_Mode
+};
+
+struct LLFontGlyphResult
+{
+    LLFontGlyphRequest mRequest;
+    LLFontGlyphBitmap mBitmap;  // mBitmapType Unspecified if the thread could not render it
+};
+
+//
+// One thread with its own FreeType library rendering requested glyphs into
+// a staging area. The main thread takes finished glyphs from there once a
+// frame and copies them into its fonts' bitmap caches, so a chat line full
+// of unseen CJK or emoji glyphs costs the main thread only the copies.
+//
+class LLFontGlyphThread : public LLSimpleton<LLFontGlyphThread>, LL::ThreadPool
+{
+public:
+    // Called with the thread's FreeType library before any glyph is
+    // rendered, to set the same properties (such as SVG hooks) as the
+    // main thread's.
+    typedef std::function<void(LLFT_Library)> init_library_func_t;
+
+    LLFontGlyphThread(const init_library_func_t& init_library = nullptr);
+    ~LLFontGlyphThread();
+
+    // Queues request. Returns false if the thread is no longer taking work,
+    // in which case the caller renders the glyph itself.
+    bool request(const LLFontGlyphRequest& request);
+
+    // Moves the glyphs finished since the last call to finished, in the
+    // order they finished. Main thread.
+    void takeFinished(std::vector<LLFontGlyphResult>& finished);
+
+    // Requested glyphs not yet taken
+    S32 getPending() const { return mPending; }
+
+    // Renders request's glyph from face into bitmap, loading it the way
+    // LLFontFreetype::renderGlyph() does. Returns false on any FreeType
+    // error; the main thread's own rendering deals with those.
+    static bool render(LLFT_Face face, const LLFontGlyphRequest& request, LLFontGlyphBitmap& bitmap);
+
+private:
+    void renderRequest(const LLFontGlyphRequest& request);
+    LLFT_Face getFace(const LLFontGlyphRequest& request);
+
+    // Only touched by the glyph thread once it has started. The thread pool
+    // is sized to one thread, but a ThreadPoolSizes override can widen it.
+    std::mutex mRenderMutex;
+    LLFT_Library mLibrary;
+    std::map<std::string, LLFT_Face> mFaces; // by file, face index, size and resolution
+
+    std::mutex mFinishedMutex;
+    std::vector<LLFontGlyphResult> mFinished;
+    std::atomic<S32> mPending;
+};
+
+#endif // LL_LLFONTGLYPHTHREAD_H
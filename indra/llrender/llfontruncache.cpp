@@ -0,0 +1,125 @@
+/**
+ * @file llfontruncache.cpp
+ * @brief Cache of laid out runs of text for one font.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llfontruncache.h"
+
+#include "lltrace.h"
+
+#include <boost/functional/hash.hpp>
+
+static LLTrace::CountStatHandle<> sFontRunHits("fontrunhits", "Text measured or drawn from an already laid out run");
+static LLTrace::CountStatHandle<> sFontRunMisses("fontrunmisses", "Text laid out glyph by glyph");
+
+// Plenty for every label, name tag and chat line in view at once.
+static const size_t DEFAULT_MAX_CHARS = 32 * 1024;
+
+LLFontRunCache::LLFontRunCache()
+:   mChars(0),
+    mMaxChars(DEFAULT_MAX_CHARS)
+{
+}
+
+void LLFontRunCache::setMaxChars(size_t max_chars)
+{
+    mMaxChars = max_chars;
+    evict(mMaxChars);
+}
+
+LLFontRunCache::run_ptr_t LLFontRunCache::getRun(const llwchar* wchars, S32 length, U32 glyph_type, U32 generation, const layout_func_t& layout)
+{
+    if (length <= 0 || length > MAX_RUN_LENGTH)
+    {
+        return run_ptr_t();
+    }
+
+    size_t hash = boost::hash_range(wchars, wchars + length);
+    boost::hash_combine(hash, glyph_type);
+
+    auto range = mEntries.equal_range(hash);
+    for (auto found = range.first; found != range.second; ++found)
+    {
+        Entry& entry = *found->second;
+        if (entry.mGlyphType != glyph_type
+            || entry.mText.size() != (size_t)length
+            || memcmp(entry.mText.data(), wchars, length * sizeof(llwchar)) != 0)
+        {
+            continue;
+        }
+
+        mLRU.splice(mLRU.begin(), mLRU, found->second);
+        if (entry.mGeneration != generation)
+        {
+            // glyph infos have been replaced since; lay it out again in place
+            LLTrace::add(sFontRunMisses, 1);
+            std::shared_ptr<LLFontRun> run = std::make_shared<LLFontRun>();
+            entry.mGeneration = layout(wchars, length, *run);
+            entry.mRun = run;
+        }
+        else
+        {
+            LLTrace::add(sFontRunHits, 1);
+        }
+        return entry.mRun;
+    }
+
+    LLTrace::add(sFontRunMisses, 1);
+    std::shared_ptr<LLFontRun> run = std::make_shared<LLFontRun>();
+    U32 run_generation = layout(wchars, length, *run);
+
+    evict(mMaxChars > (size_t)length ? mMaxChars - length : 0);
+    mLRU.push_front(Entry{ hash, glyph_type, run_generation, std::vector<llwchar>(wchars, wchars + length), run });
+    mEntries.emplace(hash, mLRU.begin());
+    mChars += length;
+    return run;
+}
+
+void LLFontRunCache::clear()
+{
+    mLRU.clear();
+    mEntries.clear();
+    mChars = 0;
+}
+
+void LLFontRunCache::evict(size_t max_chars)
+{
+    while (mChars > max_chars && !mLRU.empty())
+    {
+        lru_list_t::iterator coldest = std::prev(mLRU.end());
+        auto range = mEntries.equal_range(coldest->mHash);
+        for (auto found = range.first; found != range.second; ++found)
+        {
+            if (found->second == coldest)
+            {
+                mEntries.erase(found);
+                break;
+            }
+        }
+        mChars -= coldest->mText.size();
+        mLRU.erase(coldest);
+    }
+}
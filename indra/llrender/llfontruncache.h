@@ -0,0 +1,120 @@
+/**
+ * @file llfontruncache.h
+ * @brief Cache of laid out runs of text for one font.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFONTRUNCACHE_H
+#define LL_LLFONTRUNCACHE_H
+
+#include "stdtypes.h"
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct LLFontGlyphInfo;
+
+//
+// The glyphs of a piece of text with their raw metrics in font pixels,
+// looked up once so that measuring or drawing the same text again needs
+// no glyph map or kerning lookups.
+//
+struct LLFontRun
+{
+    struct Glyph
+    {
+        const LLFontGlyphInfo* mInfo;   // NULL if the font had no glyph to give
+        F32 mAdvance;
+        F32 mExtent;                    // width plus left bearing
+        F32 mKerning;                   // towards the next glyph of the run, 0 for the last
+    };
+
+    LLFontRun() : mWidth(-1.f), mUnpaddedWidth(-1.f) {}
+
+    S32 size() const    { return (S32)mGlyphs.size(); }
+
+    std::vector<Glyph> mGlyphs;
+
+    // Totals as LLFontGL::getWidthF32() measures them, filled in the first
+    // time they are asked for. Negative until then.
+    mutable F32 mWidth;
+    mutable F32 mUnpaddedWidth;
+};
+
+//
+// Least recently used runs of one font, keyed by the text and the glyph
+// type it was laid out with, bounded by the number of characters held.
+// Runs are tagged with the font's glyph generation and laid out again
+// once glyph infos they point at may have been replaced. Main thread only.
+//
+class LLFontRunCache
+{
+public:
+    typedef std::shared_ptr<const LLFontRun> run_ptr_t;
+
+    // Fills in a run for length characters and returns the font's glyph
+    // generation once they are all looked up.
+    typedef std::function<U32(const llwchar* wchars, S32 length, LLFontRun& run)> layout_func_t;
+
+    // Longer text goes uncached: it is document text being wrapped, which
+    // is rarely measured twice from the same offset.
+    static const S32 MAX_RUN_LENGTH = 256;
+
+    LLFontRunCache();
+
+    void setMaxChars(size_t max_chars);
+    size_t getMaxChars() const      { return mMaxChars; }
+
+    // Returns the run for length characters of wchars, laying them out on
+    // a miss or when generation has moved on. Returns an empty pointer for
+    // text over MAX_RUN_LENGTH, which the caller measures itself.
+    run_ptr_t getRun(const llwchar* wchars, S32 length, U32 glyph_type, U32 generation, const layout_func_t& layout);
+
+    void clear();
+
+    size_t getChars() const         { return mChars; }
+    size_t size() const             { return mLRU.size(); }
+
+private:
+    struct Entry
+    {
+        size_t mHash;
+        U32 mGlyphType;
+        U32 mGeneration;
+        std::vector<llwchar> mText;
+        run_ptr_t mRun;
+    };
+    typedef std::list<Entry> lru_list_t;
+
+    void evict(size_t max_chars);
+
+    lru_list_t mLRU; // most recently used first
+    std::unordered_multimap<size_t, lru_list_t::iterator> mEntries;
+    size_t mChars;
+    size_t mMaxChars;
+};
+
+#endif // LL_LLFONTRUNCACHE_H
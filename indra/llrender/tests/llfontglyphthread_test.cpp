@@ -0,0 +1,282 @@
+/**
+ * @file llfontglyphthread_test.cpp
+ * @brief Glyph thread results, and main thread time rendering large CJK and
+ * emoji strings with and without it.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llfontglyphthread.h"
+#include "../llfontfreetype.h"
+
+#include "../test/lltut.h"
+
+#include "llfile.h"
+#include "lltimer.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <thread>
+
+namespace tut
+{
+    struct LLFontGlyphThreadData
+    {
+        LLFontGlyphThreadData()
+        :   mLibrary(NULL),
+            mFace(NULL)
+        {
+            FT_Init_FreeType(&mLibrary);
+        }
+
+        ~LLFontGlyphThreadData()
+        {
+            if (mFace)
+            {
+                FT_Done_Face(mFace);
+            }
+            FT_Done_FreeType(mLibrary);
+        }
+
+        // LL_FONT_TEST_FILE if set, otherwise the first common CJK capable
+        // system font there is, otherwise any; CJK and emoji characters the
+        // font lacks are left out of the strings.
+        bool openFont()
+        {
+            std::vector<std::string> candidates;
+            const char* env = getenv("LL_FONT_TEST_FILE");
+            if (env && *env)
+            {
+                candidates.push_back(env);
+            }
+            candidates.push_back("C:\\Windows\\Fonts\\msyh.ttc");
+            candidates.push_back("C:\\Windows\\Fonts\\meiryo.ttc");
+            candidates.push_back("/System/Library/Fonts/Hiragino Sans GB.ttc");
+            candidates.push_back("/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc");
+            candidates.push_back("/usr/share/fonts/truetype/droid/DroidSansFallbackFull.ttf");
+            candidates.push_back("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+            candidates.push_back("C:\\Windows\\Fonts\\arial.ttf");
+            candidates.push_back("/System/Library/Fonts/Helvetica.ttc");
+            for (const std::string& candidate : candidates)
+            {
+                if (LLFile::isfile(candidate) && !FT_New_Face(mLibrary, candidate.c_str(), 0, &mFace))
+                {
+                    mFileName = candidate;
+                    FT_Set_Char_Size(mFace, 0, (S32)(POINT_SIZE * 64), (U32)DPI, (U32)DPI);
+                    return true;
+                }
+                mFace = NULL;
+            }
+            return false;
+        }
+
+        // Characters a chat line could bring all at once: CJK ideographs,
+        // kana, hangul and emoji, with Cyrillic and Greek to fall back on for
+        // fonts without them.
+        std::vector<llwchar> getChars(size_t max_chars)
+        {
+            const llwchar ranges[][2] = {
+                { 0x4E00, 0x9FFF }, { 0x3040, 0x30FF }, { 0xAC00, 0xD7A3 },
+                { 0x1F300, 0x1F64F }, { 0x0400, 0x04FF }, { 0x0370, 0x03FF }, { 0x2190, 0x2BFF }
+            };
+            std::vector<llwchar> chars;
+            for (const auto& range : ranges)
+            {
+                for (llwchar wch = range[0]; wch <= range[1] && chars.size() < max_chars; wch++)
+                {
+                    if (FT_Get_Char_Index(mFace, wch))
+                    {
+                        chars.push_back(wch);
+                    }
+                }
+            }
+            return chars;
+        }
+
+        LLFontGlyphRequest makeRequest(llwchar wch)
+        {
+            LLFontGlyphRequest request;
+            request.mFontId = 1;
+            request.mRequestId = wch;
+            request.mChar = wch;
+            request.mGlyphIndex = FT_Get_Char_Index(mFace, wch);
+            request.mGlyphType = EFontGlyphType::Grayscale;
+            request.mFileName = mFileName;
+            request.mFaceIndex = 0;
+            request.mPointSize = POINT_SIZE;
+            request.mVertDPI = DPI;
+            request.mHorzDPI = DPI;
+            request.mRenderMode = FT_RENDER_MODE_NORMAL;
+            return request;
+        }
+
+        // What the main thread does with a finished glyph: copy it into an
+        // atlas row by row
+        void blit(const LLFontGlyphBitmap& bitmap)
+        {
+            if (mAtlas.empty())
+            {
+                mAtlas.resize(512 * 512);
+            }
+            for (S32 row = 0; row < llmin(bitmap.mHeight, 512); row++)
+            {
+                memcpy(&mAtlas[row * 512], &bitmap.mPixels[row * bitmap.mWidth], llmin(bitmap.mWidth, 512));
+            }
+        }
+
+        static constexpr F32 POINT_SIZE = 12.f;
+        static constexpr F32 DPI = 96.f;
+
+        FT_Library mLibrary;
+        FT_Face mFace;
+        std::string mFileName;
+        std::vector<U8> mAtlas;
+    };
+
+    typedef test_group<LLFontGlyphThreadData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llfontglyphthread_test_factory("LLFontGlyphThread");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("thread renders what the main thread would");
+        if (!openFont())
+        {
+            skip("no font to render; set LL_FONT_TEST_FILE");
+        }
+        std::vector<llwchar> chars = getChars(64);
+        ensure("characters to render", !chars.empty());
+
+        LLFontGlyphThread thread;
+        for (llwchar wch : chars)
+        {
+            ensure("queued", thread.request(makeRequest(wch)));
+        }
+        LLFontGlyphRequest missing = makeRequest(chars[0]);
+        missing.mFileName += ".missing";
+        ensure("queued", thread.request(missing));
+
+        std::vector<LLFontGlyphResult> finished;
+        LLTimer timer;
+        while (finished.size() < chars.size() + 1 && timer.getElapsedTimeF32() < 30.f)
+        {
+            std::vector<LLFontGlyphResult> more;
+            thread.takeFinished(more);
+            std::move(more.begin(), more.end(), std::back_inserter(finished));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ensure_equals("all finished", finished.size(), chars.size() + 1);
+        ensure_equals("none pending", thread.getPending(), 0);
+
+        // the same face loaded the way the viewer loads it, rendering on
+        // this thread the way the main thread does without the glyph thread
+        LLFontManager::initClass();
+        LLPointer<LLFontFreetype> font = new LLFontFreetype;
+        ensure("face loaded", font->loadFace(mFileName, POINT_SIZE, DPI, DPI, true, 0));
+
+        for (const LLFontGlyphResult& result : finished)
+        {
+            if (result.mRequest.mFileName == missing.mFileName)
+            {
+                ensure("unopenable face is left to the main thread",
+                       result.mBitmap.mBitmapType == EFontGlyphType::Unspecified);
+                continue;
+            }
+            LLFontGlyphBitmap expected;
+            ensure("rendered here", font->renderGlyphBitmap(EFontGlyphType::Grayscale, result.mRequest.mGlyphIndex,
+                                                              result.mRequest.mChar, expected));
+            ensure("rendered there", result.mBitmap.mBitmapType == EFontGlyphType::Grayscale);
+            ensure_equals("same width", result.mBitmap.mWidth, expected.mWidth);
+            ensure_equals("same height", result.mBitmap.mHeight, expected.mHeight);
+            ensure_equals("same advance", result.mBitmap.mXAdvance, expected.mXAdvance);
+            ensure("same pixels", result.mBitmap.mPixels == expected.mPixels);
+        }
+
+        font = NULL;
+        LLFontManager::cleanupClass();
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("main thread time for a burst of unseen glyphs");
+        if (!openFont())
+        {
+            skip("no font to render; set LL_FONT_TEST_FILE");
+        }
+        std::vector<llwchar> chars = getChars(3000);
+
+        // as before: render and copy each glyph as the text asks for it
+        LLTimer timer;
+        for (llwchar wch : chars)
+        {
+            LLFontGlyphBitmap bitmap;
+            LLFontGlyphThread::render(mFace, makeRequest(wch), bitmap);
+            blit(bitmap);
+        }
+        F64 inline_time = timer.getElapsedTimeF64();
+
+        // threaded: queue them all, then take and copy what has finished
+        // once a "frame" until everything is in
+        LLFontGlyphThread thread;
+        F64 main_time = 0.0;
+        size_t taken = 0;
+        S32 frames = 0;
+        LLTimer wall;
+        timer.reset();
+        for (llwchar wch : chars)
+        {
+            thread.request(makeRequest(wch));
+        }
+        main_time += timer.getElapsedTimeF64();
+        while (taken < chars.size() && wall.getElapsedTimeF32() < 60.f)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            frames++;
+            timer.reset();
+            std::vector<LLFontGlyphResult> finished;
+            thread.takeFinished(finished);
+            for (const LLFontGlyphResult& result : finished)
+            {
+                blit(result.mBitmap);
+            }
+            taken += finished.size();
+            main_time += timer.getElapsedTimeF64();
+        }
+        ensure_equals("all glyphs arrived", taken, chars.size());
+
+        LL_INFOS("Font") << chars.size() << " glyphs from " << mFileName << ": rendered inline "
+            << inline_time * 1000.0 << "ms on the main thread, threaded " << main_time * 1000.0
+            << "ms on the main thread over " << frames << " frames" << LL_ENDL;
+    }
+}
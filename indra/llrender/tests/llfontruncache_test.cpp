@@ -0,0 +1,264 @@
+/**
+ * @file llfontruncache_test.cpp
+ * @brief LLFontRunCache behaviour and a text layout benchmark that needs no GL.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llfontruncache.h"
+
+#include "../test/lltut.h"
+
+#include "llmath.h"
+#include "llstring.h"
+#include "lltimer.h"
+
+#include <boost/unordered_map.hpp>
+#include <map>
+
+// Just the metrics; the real thing lives with FreeType in llfontfreetype.h.
+struct LLFontGlyphInfo
+{
+    U32 mGlyphIndex;
+    S32 mWidth;
+    S32 mXBearing;
+    F32 mXAdvance;
+};
+
+namespace tut
+{
+    struct LLFontRunCacheData
+    {
+        LLFontRunCacheData()
+        :   mGeneration(0),
+            mLayouts(0)
+        {
+        }
+
+        ~LLFontRunCacheData()
+        {
+            for (auto& entry : mGlyphs)
+            {
+                delete entry.second;
+            }
+        }
+
+        // Looked up the way LLFontFreetype does, creating glyphs on demand.
+        const LLFontGlyphInfo* getGlyphInfo(llwchar wch)
+        {
+            auto found = mGlyphs.find(wch);
+            if (found != mGlyphs.end())
+            {
+                return found->second;
+            }
+            LLFontGlyphInfo* info = new LLFontGlyphInfo{ (U32)mGlyphs.size() + 1, 5 + (S32)(wch % 4), (S32)(wch % 2), 6.f + (F32)(wch % 5) };
+            mGlyphs.emplace(wch, info);
+            return info;
+        }
+
+        F32 getXKerning(const LLFontGlyphInfo* left, const LLFontGlyphInfo* right)
+        {
+            auto found = mKerning.find(std::make_pair(left->mGlyphIndex, right->mGlyphIndex));
+            return found != mKerning.end() ? found->second : 0.f;
+        }
+
+        U32 layout(const llwchar* wchars, S32 length, LLFontRun& run)
+        {
+            mLayouts++;
+            run.mGlyphs.resize(length);
+            for (S32 i = 0; i < length; i++)
+            {
+                const LLFontGlyphInfo* fgi = getGlyphInfo(wchars[i]);
+                LLFontRun::Glyph& glyph = run.mGlyphs[i];
+                glyph.mInfo = fgi;
+                glyph.mAdvance = fgi->mXAdvance;
+                glyph.mExtent = (F32)(fgi->mWidth + fgi->mXBearing);
+                glyph.mKerning = (i + 1 < length) ? getXKerning(fgi, getGlyphInfo(wchars[i + 1])) : 0.f;
+            }
+            return mGeneration;
+        }
+
+        LLFontRunCache::run_ptr_t getRun(LLFontRunCache& cache, const LLWString& text, U32 glyph_type = 0)
+        {
+            return cache.getRun(text.c_str(), (S32)text.length(), glyph_type, mGeneration,
+                                [this](const llwchar* wchars, S32 length, LLFontRun& run)
+                                {
+                                    return layout(wchars, length, run);
+                                });
+        }
+
+        // getWidthF32()'s arithmetic, once over looked up glyphs and once
+        // over a run.
+        F32 measure(const LLWString& text)
+        {
+            F32 cur_x = 0.f;
+            F32 width_padding = 0.f;
+            for (size_t i = 0; i < text.length(); i++)
+            {
+                const LLFontGlyphInfo* fgi = getGlyphInfo(text[i]);
+                width_padding = llmax(0.f, width_padding - fgi->mXAdvance, (F32)(fgi->mWidth + fgi->mXBearing) - fgi->mXAdvance);
+                cur_x += fgi->mXAdvance;
+                if (i + 1 < text.length())
+                {
+                    cur_x += getXKerning(fgi, getGlyphInfo(text[i + 1]));
+                }
+                cur_x = (F32)ll_round(cur_x);
+            }
+            return cur_x + width_padding;
+        }
+
+        static F32 measure(const LLFontRun& run)
+        {
+            if (run.mWidth >= 0.f)
+            {
+                return run.mWidth;
+            }
+            F32 cur_x = 0.f;
+            F32 width_padding = 0.f;
+            for (const LLFontRun::Glyph& glyph : run.mGlyphs)
+            {
+                width_padding = llmax(0.f, width_padding - glyph.mAdvance, glyph.mExtent - glyph.mAdvance);
+                cur_x = (F32)ll_round(cur_x + glyph.mAdvance + glyph.mKerning);
+            }
+            run.mWidth = cur_x + width_padding;
+            return run.mWidth;
+        }
+
+        boost::unordered_multimap<llwchar, LLFontGlyphInfo*> mGlyphs;
+        std::map<std::pair<U32, U32>, F32> mKerning;
+        U32 mGeneration;
+        S32 mLayouts;
+    };
+
+    typedef test_group<LLFontRunCacheData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llfontruncache_test_factory("LLFontRunCache");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("hits, misses and invalidation");
+        LLFontRunCache cache;
+        LLWString hello = utf8str_to_wstring("Hello World");
+
+        LLFontRunCache::run_ptr_t run = getRun(cache, hello);
+        ensure("laid out", run.get() != NULL);
+        ensure_equals("one glyph per character", run->size(), (S32)hello.length());
+        ensure_equals("one layout", mLayouts, 1);
+
+        ensure("same run again", getRun(cache, hello) == run);
+        ensure_equals("still one layout", mLayouts, 1);
+
+        getRun(cache, hello, 1);
+        ensure_equals("glyph types are kept apart", mLayouts, 2);
+
+        mGeneration++;
+        LLFontRunCache::run_ptr_t relaid = getRun(cache, hello);
+        ensure_equals("new generation lays out again", mLayouts, 3);
+        ensure("old run still usable by whoever holds it", run->size() == relaid->size());
+        ensure_equals("replaced in place", cache.size(), (size_t)2);
+
+        LLWString longer(LLFontRunCache::MAX_RUN_LENGTH + 1, 'x');
+        ensure("long text is not cached", !getRun(cache, longer));
+        ensure("empty text is not cached", !cache.getRun(hello.c_str(), 0, 0, mGeneration, nullptr));
+        ensure_equals("nothing laid out for them", mLayouts, 3);
+
+        cache.setMaxChars(hello.length() + 5);
+        ensure_equals("evicted down to one run", cache.size(), (size_t)1);
+        ensure_equals("chars held", cache.getChars(), hello.length());
+        getRun(cache, utf8str_to_wstring("Goodbye"));
+        ensure_equals("oldest run evicted", cache.size(), (size_t)1);
+        getRun(cache, hello);
+        ensure_equals("evicted run is laid out again", mLayouts, 5);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("run width matches glyph by glyph width");
+        for (U32 left = 1; left < 40; left++)
+        {
+            mKerning[std::make_pair(left, left + 1)] = -1.5f;
+        }
+        LLFontRunCache cache;
+        LLWString text = utf8str_to_wstring("Kerning AVAV To Ty, wide W and narrow i");
+        LLFontRunCache::run_ptr_t run = getRun(cache, text);
+        F32 expected = measure(text);
+        ensure_equals("first measure", measure(*run), expected);
+        ensure_equals("remembered measure", measure(*getRun(cache, text)), expected);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("layout benchmark");
+        // a screenful of labels, name tags and chat lines, measured every frame
+        std::vector<LLWString> strings;
+        for (S32 i = 0; i < 400; i++)
+        {
+            strings.push_back(utf8str_to_wstring(llformat("Resident %d: the quick brown fox %d jumps", i, i * 7)));
+        }
+        for (U32 left = 1; left < 128; left++)
+        {
+            mKerning[std::make_pair(left, (left * 7) % 128)] = -1.f;
+        }
+
+        const S32 FRAMES = 200;
+        F32 check = 0.f;
+        LLTimer timer;
+        for (S32 frame = 0; frame < FRAMES; frame++)
+        {
+            for (const LLWString& text : strings)
+            {
+                check += measure(text);
+            }
+        }
+        F64 uncached_time = timer.getElapsedTimeF64();
+
+        LLFontRunCache cache;
+        F32 cached_check = 0.f;
+        timer.reset();
+        for (S32 frame = 0; frame < FRAMES; frame++)
+        {
+            for (const LLWString& text : strings)
+            {
+                cached_check += measure(*getRun(cache, text));
+            }
+        }
+        F64 cached_time = timer.getElapsedTimeF64();
+
+        ensure_equals("same widths", cached_check, check);
+        ensure_equals("each string laid out once", mLayouts, (S32)strings.size());
+
+        LL_INFOS("FontRunCache") << strings.size() << " strings x " << FRAMES << " frames: glyph by glyph "
+            << uncached_time * 1000.0 << "ms, cached runs " << cached_time * 1000.0 << "ms" << LL_ENDL;
+    }
+}
@@ -84,9 +84,8 @@ struct SortScrollListItem
 
             S32 order = sort_ascending ? 1 : -1; // ascending or descending sort for this column?
 
-            const LLScrollListCell *cell1 = i1->getColumn(col_idx);
-            const LLScrollListCell *cell2 = i2->getColumn(col_idx);
-            if (cell1 && cell2)
+            // compare column data of virtualized rows without making cells of them
+            if (i1->hasColumn(col_idx) && i2->hasColumn(col_idx))
             {
                 if(mSortSignal)
                 {
@@ -94,13 +93,16 @@ struct SortScrollListItem
                 }
                 else
                 {
-                    if (mAltSort && !cell1->getAltValue().asString().empty() && !cell2->getAltValue().asString().empty())
+                    std::string alt1, alt2;
+                    if (mAltSort
+                        && !(alt1 = i1->getColumnAltValueString(col_idx)).empty()
+                        && !(alt2 = i2->getColumnAltValueString(col_idx)).empty())
                     {
-                        sort_result = order * LLStringUtil::compareDict(cell1->getAltValue().asString(), cell2->getAltValue().asString());
+                        sort_result = order * LLStringUtil::compareDict(alt1, alt2);
                     }
                     else
                     {
-                        sort_result = order * LLStringUtil::compareDict(cell1->getValue().asString(), cell2->getValue().asString());
+                        sort_result = order * LLStringUtil::compareDict(i1->getColumnValueString(col_idx), i2->getColumnValueString(col_idx));
                     }
                 }
                 if (sort_result != 0)
@@ -148,6 +150,7 @@ LLScrollListCtrl::Params::Params()
     sort_column("sort_column", -1),
     sort_ascending("sort_ascending", true),
     can_sort("can_sort", true),
+    virtualized("virtualized", false),
     mouse_wheel_opaque("mouse_wheel_opaque", false),
     commit_on_keyboard_movement("commit_on_keyboard_movement", true),
     commit_on_selection_change("commit_on_selection_change", false),
@@ -200,6 +203,8 @@ LLScrollListCtrl::LLScrollListCtrl(const LLScrollListCtrl::Params& p)
     mTotalStaticColumnWidth(0),
     mTotalColumnPadding(0),
     mSorted(false),
+    mUnsortedTail(-1),
+    mVirtualized(p.virtualized),
     mDirty(false),
     mOriginalSelection(-1),
     mLastSelected(NULL),
@@ -585,7 +590,16 @@ bool LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, bool r
         case ADD_DEFAULT:
         case ADD_BOTTOM:
             mItemList.push_back(item);
-            setNeedsSort();
+            if (mUnsortedTail >= 0)
+            {
+                // everything above is still in order
+                mUnsortedTail++;
+                mSorted = false;
+            }
+            else
+            {
+                setNeedsSort();
+            }
             break;
 
         default:
@@ -605,14 +619,10 @@ bool LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, bool r
             addColumn(col_params);
         }
 
-        S32 num_cols = item->getNumColumns();
-        S32 i = 0;
-        for (LLScrollListCell* cell = item->getColumn(i); i < num_cols; cell = item->getColumn(++i))
+        S32 num_cols = llmin(item->getNumColumns(), (S32)mColumnsIndexed.size());
+        for (S32 i = 0; i < num_cols; ++i)
         {
-            if (i >= (S32)mColumnsIndexed.size())
-                break;
-
-            cell->setWidth(mColumnsIndexed[i]->getWidth());
+            item->setColumnWidth(i, mColumnsIndexed[i]->getWidth());
         }
 
         updateLineHeightInsert(item);
@@ -644,9 +654,9 @@ S32 LLScrollListCtrl::calcMaxContentWidth()
             column->mMaxContentWidth = column->mHeader ? LLFontGL::getFontSansSerifSmall()->getWidth(column->mLabel.getWString().c_str()) + mColumnPadding + HEADING_TEXT_PADDING : 0;
             for (LLScrollListItem* item : mItemList)
             {
-                if (LLScrollListCell* cellp = item->getColumn(column->mIndex))
+                if (item->hasColumn(column->mIndex))
                 {
-                    column->mMaxContentWidth = llmax(LLFontGL::getFontSansSerifSmall()->getWidth(cellp->getValue().asString()) + mColumnPadding + COLUMN_TEXT_PADDING, column->mMaxContentWidth);
+                    column->mMaxContentWidth = llmax(LLFontGL::getFontSansSerifSmall()->getWidth(item->getColumnValueString(column->mIndex)) + mColumnPadding + COLUMN_TEXT_PADDING, column->mMaxContentWidth);
                 }
             }
         }
@@ -700,10 +710,9 @@ void LLScrollListCtrl::updateLineHeight()
     {
         LLScrollListItem *itemp = *iter;
         S32 num_cols = itemp->getNumColumns();
-        S32 i = 0;
-        for (const LLScrollListCell* cell = itemp->getColumn(i); i < num_cols; cell = itemp->getColumn(++i))
+        for (S32 i = 0; i < num_cols; ++i)
         {
-            mLineHeight = llmax( mLineHeight, cell->getHeight() + mRowPadding );
+            mLineHeight = llmax( mLineHeight, itemp->getColumnHeight(i) + mRowPadding );
         }
     }
 }
@@ -712,10 +721,9 @@ void LLScrollListCtrl::updateLineHeight()
 void LLScrollListCtrl::updateLineHeightInsert(LLScrollListItem* itemp)
 {
     S32 num_cols = itemp->getNumColumns();
-    S32 i = 0;
-    for (const LLScrollListCell* cell = itemp->getColumn(i); i < num_cols; cell = itemp->getColumn(++i))
+    for (S32 i = 0; i < num_cols; ++i)
     {
-        mLineHeight = llmax( mLineHeight, cell->getHeight() + mRowPadding );
+        mLineHeight = llmax( mLineHeight, itemp->getColumnHeight(i) + mRowPadding );
     }
 }
 
@@ -787,14 +795,10 @@ void LLScrollListCtrl::updateColumns(bool force_update)
         for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
         {
             LLScrollListItem *itemp = *iter;
-            S32 num_cols = itemp->getNumColumns();
-            S32 i = 0;
-            for (LLScrollListCell* cell = itemp->getColumn(i); i < num_cols; cell = itemp->getColumn(++i))
+            S32 num_cols = llmin(itemp->getNumColumns(), (S32)mColumnsIndexed.size());
+            for (S32 i = 0; i < num_cols; ++i)
             {
-                if (i >= (S32)mColumnsIndexed.size())
-                    break;
-
-                cell->setWidth(mColumnsIndexed[i]->getWidth());
+                itemp->setColumnWidth(i, mColumnsIndexed[i]->getWidth());
             }
         }
     }
@@ -805,11 +809,7 @@ void LLScrollListCtrl::updateColumns(bool force_update)
         for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
         {
             LLScrollListItem *itemp = *iter;
-            LLScrollListCell* cell = itemp->getColumn(index);
-            if (cell)
-            {
-                cell->setWidth(last_header->getColumn()->getWidth());
-            }
+            itemp->setColumnWidth(index, last_header->getColumn()->getWidth());
         }
     }
 }
@@ -942,6 +942,7 @@ void LLScrollListCtrl::swapWithNext(S32 index)
     LLScrollListItem *cur_itemp = mItemList[index];
     mItemList[index] = mItemList[index + 1];
     mItemList[index + 1] = cur_itemp;
+    mUnsortedTail = -1;
 }
 
 
@@ -956,6 +957,7 @@ void LLScrollListCtrl::swapWithPrevious(S32 index)
     LLScrollListItem *cur_itemp = mItemList[index];
     mItemList[index] = mItemList[index - 1];
     mItemList[index - 1] = cur_itemp;
+    mUnsortedTail = -1;
 }
 
 
@@ -1268,7 +1270,7 @@ LLScrollListItem* LLScrollListCtrl::getItemByLabel(const std::string& label, boo
 
     for (LLScrollListItem* item : mItemList)
     {
-        std::string item_text = item->getColumn(column)->getValue().asString(); // Only select enabled items with matching names
+        std::string item_text = item->getColumnValueString(column); // Only select enabled items with matching names
         if (!case_sensitive)
         {
             LLStringUtil::toLower(item_text);
@@ -1313,8 +1315,8 @@ bool LLScrollListCtrl::selectItemByPrefix(const LLWString& target, bool case_sen
         {
             LLScrollListItem* item = *iter;
             // Only select enabled items with matching names
-            LLScrollListCell* cellp = item->getColumn(column == -1 ? getSearchColumn() : column);
-            bool select = cellp ? item->getEnabled() && ('\0' == cellp->getValue().asString()[0]) : false;
+            S32 search_column = column == -1 ? getSearchColumn() : column;
+            bool select = item->hasColumn(search_column) ? item->getEnabled() && item->getColumnValueString(search_column).empty() : false;
             if (select)
             {
                 selectItem(item, -1);
@@ -1336,12 +1338,12 @@ bool LLScrollListCtrl::selectItemByPrefix(const LLWString& target, bool case_sen
             LLScrollListItem* item = *iter;
 
             // Only select enabled items with matching names
-            LLScrollListCell* cellp = item->getColumn(column == -1 ? getSearchColumn() : column);
-            if (!cellp)
+            S32 search_column = column == -1 ? getSearchColumn() : column;
+            if (!item->hasColumn(search_column))
             {
                 continue;
             }
-            LLWString item_label = utf8str_to_wstring(cellp->getValue().asString());
+            LLWString item_label = utf8str_to_wstring(item->getColumnValueString(search_column));
             if (!case_sensitive)
             {
                 LLWStringUtil::toLower(item_label);
@@ -1356,7 +1358,7 @@ bool LLScrollListCtrl::selectItemByPrefix(const LLWString& target, bool case_sen
             {
                 // find offset of matching text (might have leading whitespace)
                 auto offset = item_label.find(target_trimmed);
-                cellp->highlightText(static_cast<S32>(offset), static_cast<S32>(target_trimmed.size()));
+                item->getColumn(search_column)->highlightText(static_cast<S32>(offset), static_cast<S32>(target_trimmed.size()));
                 selectItem(item, -1);
                 found = true;
                 break;
@@ -1406,12 +1408,11 @@ U32 LLScrollListCtrl::searchItems(const LLWString& substring, bool case_sensitiv
             {
                 continue;
             }
-            LLScrollListCell* cellp = item->getColumn(getSearchColumn());
-            if (!cellp)
+            if (!item->hasColumn(getSearchColumn()))
             {
                 continue;
             }
-            LLWString item_label = utf8str_to_wstring(cellp->getValue().asString());
+            LLWString item_label = utf8str_to_wstring(item->getColumnValueString(getSearchColumn()));
             if (!case_sensitive)
             {
                 LLWStringUtil::toLower(item_label);
@@ -1424,7 +1425,7 @@ U32 LLScrollListCtrl::searchItems(const LLWString& substring, bool case_sensitiv
             if (found_iter != std::string::npos)
             {
                 // find offset of matching text
-                cellp->highlightText(static_cast<S32>(found_iter), static_cast<S32>(substring_trimmed.size()));
+                item->getColumn(getSearchColumn())->highlightText(static_cast<S32>(found_iter), static_cast<S32>(substring_trimmed.size()));
                 selectItem(item, -1, false);
 
                 found++;
@@ -2762,13 +2763,26 @@ void LLScrollListCtrl::updateSort() const
 {
     if (hasSortOrder() && !isSorted())
     {
-        // do stable sort to preserve any previous sorts
-        std::stable_sort(
-            mItemList.begin(),
-            mItemList.end(),
-            SortScrollListItem(mSortColumns,mSortCallback, mAlternateSort));
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
+        SortScrollListItem compare(mSortColumns, mSortCallback, mAlternateSort);
+        if (mUnsortedTail >= 0 && mUnsortedTail < (S32)mItemList.size())
+        {
+            // only rows added at the bottom since the last sort are out of
+            // place; deletions since may have left fewer than counted, which
+            // just means sorting a few rows that were in order already
+            sortTail(mItemList, mUnsortedTail, compare);
+        }
+        else
+        {
+            // do stable sort to preserve any previous sorts
+            std::stable_sort(
+                mItemList.begin(),
+                mItemList.end(),
+                compare);
+        }
 
         mSorted = true;
+        mUnsortedTail = 0;
     }
 }
 
@@ -2783,6 +2797,8 @@ void LLScrollListCtrl::sortOnce(S32 column, bool ascending)
         mItemList.begin(),
         mItemList.end(),
         SortScrollListItem(sort_column,mSortCallback,mAlternateSort));
+    // out of the permanent order now, so the next sort has to be a full one
+    mUnsortedTail = -1;
 }
 
 void LLScrollListCtrl::dirtyColumns()
@@ -3197,6 +3213,18 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
             cell_p.width = columnp->getWidth();
         }
 
+        if (mVirtualized && cell_p.type() == "text")
+        {
+            new_item->setColumnData(index, cell_p);
+            if (columnp->mHeader
+                && !new_item->getColumnValueString(index).empty())
+            {
+                columnp->mHeader->setHasResizableElement(true);
+            }
+            col_index++;
+            continue;
+        }
+
         LLScrollListCell* cell = LLScrollListCell::create(cell_p);
 
         if (cell)
@@ -3224,8 +3252,17 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
             new_item->setNumColumns(static_cast<S32>(mColumns.size()));
         }
 
-        LLScrollListCell* cell = LLScrollListCell::create(LLScrollListCell::Params().value(item_p.value));
-        if (cell)
+        if (mVirtualized)
+        {
+            new_item->setColumnData(0, LLScrollListCell::Params().value(item_p.value));
+            LLScrollListColumn* columnp = mColumns.begin()->second;
+            if (columnp->mHeader
+                && !new_item->getColumnValueString(0).empty())
+            {
+                columnp->mHeader->setHasResizableElement(true);
+            }
+        }
+        else if (LLScrollListCell* cell = LLScrollListCell::create(LLScrollListCell::Params().value(item_p.value)))
         {
             LLScrollListColumn* columnp = mColumns.begin()->second;
 
@@ -3243,7 +3280,11 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
     for (column_map_t::iterator column_it = mColumns.begin(); column_it != mColumns.end(); ++column_it)
     {
         S32 column_idx = column_it->second->mIndex;
-        if (new_item->getColumn(column_idx) == NULL)
+        if (mVirtualized && !new_item->hasColumn(column_idx))
+        {
+            new_item->setColumnSpacer(column_idx, column_it->second->getWidth());
+        }
+        else if (new_item->getColumn(column_idx) == NULL)
         {
             LLScrollListColumn* column_ptr = column_it->second;
             LLScrollListCell::Params cell_p;
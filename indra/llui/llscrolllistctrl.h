@@ -133,6 +133,10 @@ public:
         Optional<bool>  sort_ascending,
                         can_sort; // whether user is allowed to sort
 
+        // keep plain text cells as data until their row is drawn, for lists
+        // that can grow to thousands of rows
+        Optional<bool>  virtualized;
+
         // colors
         Optional<LLUIColor> fg_unselected_color,
                             fg_selected_color,
@@ -215,6 +219,7 @@ public:
     bool            setSelectedByValue(const LLSD& value, bool selected);
 
     bool            isSorted() const { return mSorted; }
+    bool            isVirtualized() const { return mVirtualized; }
 
     virtual bool    isSelected(const LLSD& value) const;
 
@@ -415,8 +420,19 @@ public:
     // sorts a list without affecting the permanent sort order (so further list insertions can be unsorted, for example)
     void            sortOnce(S32 column, bool ascending);
 
+    // Stably sorts the last tail items and merges them into the ones before,
+    // which must already be in order: the order a stable sort of the whole
+    // list would give, for the cost of sorting the tail.
+    template<typename LIST, typename COMPARE>
+    static void     sortTail(LIST& items, size_t tail, COMPARE compare)
+    {
+        typename LIST::iterator middle = items.end() - tail;
+        std::stable_sort(middle, items.end(), compare);
+        std::inplace_merge(items.begin(), middle, items.end(), compare);
+    }
+
     // manually call this whenever editing list items in place to flag need for resorting
-    void            setNeedsSort(bool val = true) { mSorted = !val; }
+    void            setNeedsSort(bool val = true) { mSorted = !val; mUnsortedTail = val ? -1 : 0; }
     void            dirtyColumns(); // some operation has potentially affected column layout or ordering
 
     bool highlightMatchingItems(const std::string& filter_str);
@@ -539,6 +555,11 @@ private:
     S32             mTotalColumnPadding;
 
     mutable bool    mSorted;
+    // Items added at the bottom since the list was last in sort order, which
+    // updateSort() merges in rather than sorting everything again; -1 when
+    // the list has to be sorted whole.
+    mutable S32     mUnsortedTail;
+    bool            mVirtualized;
 
     typedef std::map<std::string, LLScrollListColumn*> column_map_t;
     column_map_t mColumns;
@@ -33,6 +33,67 @@
 #include "llui.h"
 
 
+//---------------------------------------------------------------------------
+// LLScrollListCellData
+//---------------------------------------------------------------------------
+
+LLScrollListCellData::LLScrollListCellData()
+:   mFont(NULL),
+    mWidth(0),
+    mAlignment(LLFontGL::LEFT),
+    mType(NONE),
+    mUseColor(false),
+    mVisible(true)
+{
+}
+
+// Takes what LLScrollListText's constructor and LLScrollListCell::create()
+// take, so that createCell() makes the same cell create() would have.
+LLScrollListCellData::LLScrollListCellData(const LLScrollListCell::Params& p)
+:   mText(p.value.isProvided() ? p.value().asString() : (p.label.isProvided() ? p.label() : p.value().asString())),
+    mAltText(p.alt_value().asString()),
+    mToolTip(p.tool_tip),
+    mFont(p.font),
+    mColor(p.color),
+    mWidth(p.width),
+    mAlignment(p.font_halign),
+    mType(TEXT),
+    mUseColor(p.color.isProvided()),
+    mVisible(p.visible)
+{
+}
+
+LLScrollListCell* LLScrollListCellData::createCell() const
+{
+    LLScrollListCell::Params p;
+    p.width = mWidth;
+    p.tool_tip = mToolTip;
+    switch (mType)
+    {
+    case TEXT:
+        p.label = mText;
+        p.alt_value = mAltText;
+        p.font = mFont;
+        if (mUseColor)
+        {
+            p.color = mColor;
+        }
+        p.font_halign = mAlignment;
+        p.visible = mVisible;
+        return LLScrollListCell::create(p);
+    case SPACER:
+        return new LLScrollListSpacer(p);
+    default:
+        return NULL;
+    }
+}
+
+S32 LLScrollListCellData::getHeight() const
+{
+    // as LLScrollListText::getHeight(); spacers have none
+    return (mType == TEXT && mFont) ? mFont->getLineHeight() : 0;
+}
+
 //---------------------------------------------------------------------------
 // LLScrollListItem
 //---------------------------------------------------------------------------
@@ -97,6 +158,11 @@ void LLScrollListItem::setNumColumns(S32 columns)
     {
         mColumns[col] = NULL;
     }
+
+    if (!mColumnData.empty())
+    {
+        mColumnData.resize(columns);
+    }
 }
 
 void LLScrollListItem::setColumn( S32 column, LLScrollListCell *cell )
@@ -105,6 +171,10 @@ void LLScrollListItem::setColumn( S32 column, LLScrollListCell *cell )
     {
         delete mColumns[column];
         mColumns[column] = cell;
+        if (column < (S32)mColumnData.size())
+        {
+            mColumnData[column] = LLScrollListCellData();
+        }
     }
     else
     {
@@ -122,11 +192,127 @@ LLScrollListCell* LLScrollListItem::getColumn(const S32 i) const
 {
     if (0 <= i && i < (S32)mColumns.size())
     {
+        if (!mColumns[i] && i < (S32)mColumnData.size() && mColumnData[i].mType != LLScrollListCellData::NONE)
+        {
+            // Once made, a cell stays: callers may hold on to it
+            mColumns[i] = mColumnData[i].createCell();
+            mColumnData[i] = LLScrollListCellData();
+        }
         return mColumns[i];
     }
     return NULL;
 }
 
+void LLScrollListItem::setColumnData(S32 column, const LLScrollListCell::Params& p)
+{
+    if (column < 0 || column >= (S32)mColumns.size())
+    {
+        LL_ERRS() << "LLScrollListItem::setColumnData: bad column: " << column << LL_ENDL;
+        return;
+    }
+    llassert(p.type() == "text");
+
+    delete mColumns[column];
+    mColumns[column] = NULL;
+    mColumnData.resize(mColumns.size());
+    mColumnData[column] = LLScrollListCellData(p);
+}
+
+void LLScrollListItem::setColumnSpacer(S32 column, S32 width)
+{
+    if (column < 0 || column >= (S32)mColumns.size())
+    {
+        LL_ERRS() << "LLScrollListItem::setColumnSpacer: bad column: " << column << LL_ENDL;
+        return;
+    }
+
+    delete mColumns[column];
+    mColumns[column] = NULL;
+    mColumnData.resize(mColumns.size());
+    LLScrollListCellData& data = mColumnData[column];
+    data = LLScrollListCellData();
+    data.mType = LLScrollListCellData::SPACER;
+    data.mWidth = width;
+}
+
+bool LLScrollListItem::hasColumn(S32 i) const
+{
+    if (i < 0 || i >= (S32)mColumns.size())
+    {
+        return false;
+    }
+    return mColumns[i] || (i < (S32)mColumnData.size() && mColumnData[i].mType != LLScrollListCellData::NONE);
+}
+
+bool LLScrollListItem::isColumnCreated(S32 i) const
+{
+    return 0 <= i && i < (S32)mColumns.size() && mColumns[i];
+}
+
+std::string LLScrollListItem::getColumnValueString(S32 i) const
+{
+    if (isColumnCreated(i))
+    {
+        return mColumns[i]->getValue().asString();
+    }
+    // spacers have an empty value, as LLScrollListCell does
+    return hasColumn(i) ? mColumnData[i].mText : LLStringUtil::null;
+}
+
+std::string LLScrollListItem::getColumnAltValueString(S32 i) const
+{
+    if (isColumnCreated(i))
+    {
+        return mColumns[i]->getAltValue().asString();
+    }
+    return hasColumn(i) ? mColumnData[i].mAltText : LLStringUtil::null;
+}
+
+S32 LLScrollListItem::getColumnHeight(S32 i) const
+{
+    if (isColumnCreated(i))
+    {
+        return mColumns[i]->getHeight();
+    }
+    return hasColumn(i) ? mColumnData[i].getHeight() : 0;
+}
+
+void LLScrollListItem::setColumnWidth(S32 i, S32 width)
+{
+    if (isColumnCreated(i))
+    {
+        mColumns[i]->setWidth(width);
+    }
+    else if (hasColumn(i))
+    {
+        mColumnData[i].mWidth = width;
+    }
+}
+
+void LLScrollListItem::setColumnValue(S32 i, const LLSD& value)
+{
+    if (isColumnCreated(i))
+    {
+        mColumns[i]->setValue(value);
+    }
+    else if (hasColumn(i) && mColumnData[i].mType == LLScrollListCellData::TEXT)
+    {
+        mColumnData[i].mText = value.asString();
+    }
+}
+
+void LLScrollListItem::setColumnAltValue(S32 i, const LLSD& value)
+{
+    if (isColumnCreated(i))
+    {
+        mColumns[i]->setAltValue(value);
+    }
+    else if (hasColumn(i) && mColumnData[i].mType == LLScrollListCellData::TEXT)
+    {
+        mColumnData[i].mAltText = value.asString();
+    }
+}
+
 std::string LLScrollListItem::getContentsCSV() const
 {
     std::string ret;
@@ -134,7 +320,7 @@ std::string LLScrollListItem::getContentsCSV() const
     S32 count = getNumColumns();
     for (S32 i=0; i<count; ++i)
     {
-        ret += getColumn(i)->getValue().asString();
+        ret += getColumnValueString(i);
         if (i < count-1)
         {
             ret += ", ";
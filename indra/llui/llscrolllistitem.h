@@ -43,6 +43,38 @@ class LLScrollListCtrl;
 class LLScrollColumnHeader;
 class LLUIImage;
 
+// What a plain text cell (or a spacer) is made from. Rows of virtualized
+// lists keep these instead of their cells until something asks for a cell,
+// which for most rows of a long list is never: only drawn rows need them.
+struct LLScrollListCellData
+{
+    enum EType : U8
+    {
+        NONE,       // no data; the cell, if any, already exists
+        TEXT,
+        SPACER
+    };
+
+    LLScrollListCellData();
+    LLScrollListCellData(const LLScrollListCell::Params& p);
+
+    // The cell this data describes, NULL for NONE
+    LLScrollListCell* createCell() const;
+
+    S32 getHeight() const;
+
+    std::string         mText;
+    std::string         mAltText;
+    std::string         mToolTip;
+    const LLFontGL*     mFont;
+    LLColor4            mColor;
+    S32                 mWidth;
+    LLFontGL::HAlign    mAlignment;
+    EType               mType;
+    bool                mUseColor;
+    bool                mVisible;
+};
+
 //---------------------------------------------------------------------------
 // LLScrollListItem
 //---------------------------------------------------------------------------
@@ -112,8 +144,24 @@ public:
 
     S32     getNumColumns() const;
 
+    // Creates the cell first if the column only has data so far
     LLScrollListCell *getColumn(const S32 i) const;
 
+    // Store column as data, leaving its cell to be made by getColumn().
+    // Only plain text cells (p.type "text") and spacers can wait like this.
+    void    setColumnData( S32 column, const LLScrollListCell::Params& p );
+    void    setColumnSpacer( S32 column, S32 width );
+
+    // These work on column data as well as on cells, and leave the data be.
+    bool    hasColumn(S32 i) const;
+    bool    isColumnCreated(S32 i) const;
+    std::string getColumnValueString(S32 i) const;
+    std::string getColumnAltValueString(S32 i) const;
+    S32     getColumnHeight(S32 i) const;
+    void    setColumnWidth(S32 i, S32 width);
+    void    setColumnValue(S32 i, const LLSD& value);
+    void    setColumnAltValue(S32 i, const LLSD& value);
+
     std::string getContentsCSV() const;
 
     virtual void draw(const LLRect& rect,
@@ -135,7 +183,10 @@ private:
     void*   mUserdata;
     LLSD    mItemValue;
     LLSD    mItemAltValue;
-    std::vector<LLScrollListCell *> mColumns;
+    // A column has its cell in mColumns or, for virtualized lists, its data
+    // in mColumnData, which stays empty for everything else.
+    mutable std::vector<LLScrollListCell *> mColumns;
+    mutable std::vector<LLScrollListCellData> mColumnData;
     LLRect  mRectangle;
 };
 
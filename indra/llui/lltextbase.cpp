@@ -104,6 +104,19 @@ bool LLTextBase::compare_top::operator()(const LLTextBase::line_info& a, const L
     return a.mRect.mTop > b.mRect.mTop; // top of a is higher than top of b
 }
 
+struct LLTextBase::line_num_compare
+{
+    bool operator()(const S32& line_num, const LLTextBase::line_info& info) const
+    {
+        return (line_num < info.mLineNum);
+    }
+
+    bool operator()(const LLTextBase::line_info& info, const S32& line_num) const
+    {
+        return (info.mLineNum < line_num);
+    }
+};
+
 struct LLTextBase::line_end_compare
 {
     bool operator()(const S32& pos, const LLTextBase::line_info& info) const
@@ -991,6 +1004,9 @@ S32 LLTextBase::insertStringNoUndo(S32 pos, const LLWString &wstr, LLTextBase::s
         return pos;
     }
 
+    // before any segment is inserted, so that theirs come after this edit
+    needsReflowAfterEdit(pos, 0, insert_len);
+
     if (segmentp->canEdit())
     {
         segmentp->setEnd(segmentp->getEnd() + insert_len);
@@ -1062,7 +1078,6 @@ S32 LLTextBase::insertStringNoUndo(S32 pos, const LLWString &wstr, LLTextBase::s
     }
 
     onValueChange(pos, pos + insert_len);
-    needsReflow(pos);
 
     return insert_len;
 }
@@ -1115,13 +1130,14 @@ S32 LLTextBase::removeStringNoUndo(S32 pos, S32 length)
         ++seg_iter;
     }
 
+    S32 removed = llclamp(length, 0, getLength() - pos);
     getViewModel()->getEditableDisplay().erase(pos, length);
 
     // recreate default segment in case we erased everything
     createDefaultSegment();
 
     onValueChange(pos, pos);
-    needsReflow(pos);
+    needsReflowAfterEdit(pos, removed, 0);
 
     return -length; // This will be wrong if someone calls removeStringNoUndo with an excessive length
 }
@@ -1137,7 +1153,7 @@ S32 LLTextBase::overwriteCharNoUndo(S32 pos, llwchar wc)
     getViewModel()->getEditableDisplay()[pos] = wc;
 
     onValueChange(pos, pos + 1);
-    needsReflow(pos);
+    needsReflowAfterEdit(pos, 1, 1);
 
     return 1;
 }
@@ -1233,7 +1249,8 @@ void LLTextBase::insertSegment(LLTextSegmentPtr segment_to_insert)
     }
 
     // layout potentially changed
-    needsReflow(reflow_start_index);
+    S32 restyled = llmax(0, segment_to_insert->getEnd() - reflow_start_index);
+    needsReflowAfterEdit(reflow_start_index, restyled, restyled);
 }
 
 //virtual
@@ -1250,24 +1267,13 @@ bool LLTextBase::handleMouseDown(S32 x, S32 y, MASK mask)
         S32 real_line = getLineNumFromDocIndex(mCursorPos, false);
         S32 line_start = -1;
         S32 line_end = -1;
-        for (line_list_t::const_iterator it = mLineInfoList.begin(), end_it = mLineInfoList.end();
-                it != end_it;
-                ++it)
+        // word wrapped lines of the paragraph
+        std::pair<line_list_t::const_iterator, line_list_t::const_iterator> paragraph =
+            std::equal_range(mLineInfoList.begin(), mLineInfoList.end(), real_line, line_num_compare());
+        if (paragraph.first != paragraph.second)
         {
-            if (it->mLineNum < real_line)
-            {
-                continue;
-            }
-            if (it->mLineNum > real_line)
-            {
-                break;
-            }
-            if (line_start == -1)
-            {
-                line_start = it->mDocIndexStart;
-            }
-            line_end = it->mDocIndexEnd;
-            line_end = llclamp(line_end, 0, getLength());
+            line_start = paragraph.first->mDocIndexStart;
+            line_end = llclamp((paragraph.second - 1)->mDocIndexEnd, 0, getLength());
         }
 
         if (line_start == -1)
@@ -1767,6 +1773,12 @@ void LLTextBase::reflow()
     first_char_rect.mTop = mVisibleTextRect.mTop - first_char_rect.mTop;
     first_char_rect.mBottom = mVisibleTextRect.mTop - first_char_rect.mBottom;
 
+    // the anchor was found on lines laid out before the edits; past them, it moved with its text
+    if (mReflowTail.isValid() && mScrollIndex >= mReflowTail.getOldStart())
+    {
+        mScrollIndex += mReflowTail.getDelta();
+    }
+
     S32 reflow_count = 0;
     while(mReflowIndex < S32_MAX)
     {
@@ -1800,6 +1812,10 @@ void LLTextBase::reflow()
         F32 remaining_pixels = text_available_width;
         S32 line_count = 0;
 
+        // lines from before the edits, in case layout reaches a paragraph they left alone
+        line_list_t old_lines;
+        S32 prev_line_num = -1;
+
         // find and erase line info structs starting at start_index and going to end of document
         if (!mLineInfoList.empty())
         {
@@ -1811,10 +1827,29 @@ void LLTextBase::reflow()
                 line_count = iter->mLineNum;
                 cur_top = iter->mRect.mTop;
                 getSegmentAndOffset(iter->mDocIndexStart, &seg_iter, &seg_offset);
+                if (mReflowTail.isValid())
+                {
+                    prev_line_num = (iter == mLineInfoList.begin()) ? -1 : (iter - 1)->mLineNum;
+                    old_lines.assign(iter, mLineInfoList.end());
+                }
                 mLineInfoList.erase(iter, mLineInfoList.end());
             }
         }
 
+        // first character laid out again, first one whose line was taken as it was
+        // and how far those lines moved
+        S32 relaid_start = line_start_index;
+        S32 relaid_end = S32_MAX;
+        S32 reused_delta_y = 0;
+
+        if (!old_lines.empty()
+            && reuseLaidOutLines(old_lines, prev_line_num, line_start_index, line_count, cur_top, reused_delta_y))
+        {
+            // the edits removed whole paragraphs from here, nothing to lay out
+            relaid_end = line_start_index;
+            seg_iter = mSegments.end();
+        }
+
         S32 line_height = 0;
         S32 seg_line_offset = line_count + 1;
 
@@ -1901,19 +1936,41 @@ void LLTextBase::reflow()
             if (force_newline)
             {
                 line_count++;
+
+                // a new paragraph: if the edits left it alone, so is the rest of the document
+                if (!old_lines.empty()
+                    && reuseLaidOutLines(old_lines, prev_line_num, line_start_index, line_count, cur_top, reused_delta_y))
+                {
+                    relaid_end = line_start_index;
+                    break;
+                }
             }
         }
 
         // calculate visible region for diplaying text
+        S32 first_line_top = mLineInfoList.empty() ? 0 : mLineInfoList.front().mRect.mTop;
         updateRects();
+        // updateRects() moves all lines by the same amount
+        S32 moved_y = mLineInfoList.empty() ? 0 : mLineInfoList.front().mRect.mTop - first_line_top;
 
+        // segments on lines laid out again need laying out again, the others only follow their lines
         for (segment_set_t::iterator segment_it = mSegments.begin();
             segment_it != mSegments.end();
             ++segment_it)
         {
             LLTextSegmentPtr segmentp = *segment_it;
-            segmentp->updateLayout(*this);
-
+            if (segmentp->getEnd() >= relaid_start && segmentp->getStart() < relaid_end)
+            {
+                segmentp->updateLayout(*this);
+            }
+            else
+            {
+                S32 delta_y = moved_y + (segmentp->getStart() >= relaid_end ? reused_delta_y : 0);
+                if (delta_y != 0)
+                {
+                    segmentp->translateLayout(delta_y);
+                }
+            }
         }
     }
 
@@ -1953,6 +2010,36 @@ void LLTextBase::reflow()
     updateCursorXPos();
 }
 
+// Takes the lines laid out before the edits from the paragraph starting at
+// line_start_index to the end of the document, if the edits left that
+// paragraph alone.
+bool LLTextBase::reuseLaidOutLines(const line_list_t& old_lines, S32 prev_line_num, S32 line_start_index,
+                                   S32 line_count, S32 cur_top, S32& delta_y)
+{
+    if (line_start_index < mReflowTail.getStart())
+    {
+        return false;
+    }
+    const S32 delta_index = mReflowTail.getDelta();
+    S32 first = LLTextReflowTail::findParagraph(old_lines, line_start_index - delta_index, prev_line_num);
+    if (first < 0)
+    {
+        return false;
+    }
+
+    delta_y = cur_top - old_lines[first].mRect.mTop;
+    const S32 delta_line = line_count - old_lines[first].mLineNum;
+    line_list_t::iterator reused = mLineInfoList.insert(mLineInfoList.end(), old_lines.begin() + first, old_lines.end());
+    for (; reused != mLineInfoList.end(); ++reused)
+    {
+        reused->mDocIndexStart += delta_index;
+        reused->mDocIndexEnd += delta_index;
+        reused->mRect.translate(0, delta_y);
+        reused->mLineNum += delta_line;
+    }
+    return true;
+}
+
 LLRect LLTextBase::getTextBoundingRect()
 {
     reflow();
@@ -1964,6 +2051,8 @@ void LLTextBase::clearSegments()
 {
     mSegments.clear();
     createDefaultSegment();
+    // every style gone, and text usually replaced without edits that reflow could track
+    needsReflow();
 }
 
 S32 LLTextBase::getLineStart( S32 line ) const
@@ -2479,18 +2568,51 @@ void LLTextBase::needsReflow(S32 index)
 {
     LL_DEBUGS() << "reflow on object " << (void*)this << " index = " << mReflowIndex << ", new index = " << index << LL_ENDL;
     mReflowIndex = llmin(mReflowIndex, index);
+    // not an edit: whatever changed may have changed the layout of the whole document
+    mReflowTail.invalidate();
+}
+
+void LLTextBase::needsReflowAfterEdit(S32 pos, S32 removed, S32 inserted)
+{
+    if (mReflowIndex == S32_MAX)
+    {
+        // first edit since the last reflow
+        mReflowTail.reset();
+    }
+    mReflowTail.edited(pos, removed, inserted);
+    mReflowIndex = llmin(mReflowIndex, pos);
 }
 
 S32 LLTextBase::removeFirstLine()
 {
     if (!mLineInfoList.empty())
     {
-        S32 length = getLineEnd(0);
+        return removeLeadingText(getLineEnd(0));
+    }
+    return 0;
+}
+
+S32 LLTextBase::removeLeadingText(S32 length)
+{
+    length = llclamp(length, 0, getLength());
+    if (length > 0)
+    {
         deselect();
         removeStringNoUndo(0, length);
-        return length;
     }
-    return 0;
+    return length;
+}
+
+S32 LLTextBase::prependWidget(const LLInlineViewSegment::Params& params, const std::string& text)
+{
+    LLWString widget_wide_text = utf8str_to_wstring(text);
+    segment_vec_t segments;
+    segments.push_back(new LLInlineViewSegment(params, 0, static_cast<S32>(widget_wide_text.size())));
+
+    deselect();
+    S32 old_length = getLength();
+    insertStringNoUndo(0, widget_wide_text, &segments);
+    return getLength() - old_length;
 }
 
 // virtual
@@ -3053,19 +3175,12 @@ bool LLTextBase::setCursor(S32 row, S32 column)
 {
     if (row < 0 || column < 0) return false;
 
-    S32 n_lines = static_cast<S32>(mLineInfoList.size());
-    for (S32 line = row; line < n_lines; ++line)
+    // word wrapped lines of row
+    std::pair<line_list_t::const_iterator, line_list_t::const_iterator> lines =
+        std::equal_range(mLineInfoList.begin(), mLineInfoList.end(), row, line_num_compare());
+    for (line_list_t::const_iterator it = lines.first; it != lines.second; ++it)
     {
-        const line_info& li = mLineInfoList[line];
-
-        if (li.mLineNum < row)
-        {
-            continue;
-        }
-        else if (li.mLineNum > row)
-        {
-            break; // invalid column specified
-        }
+        const line_info& li = *it;
 
         // Found the given row.
         S32 line_length = li.mDocIndexEnd - li.mDocIndexStart;;
@@ -3319,10 +3434,11 @@ LLRect LLTextBase::getVisibleDocumentRect() const
         LLRect doc_rect = mDocumentView->getRect();
         visible_text_rect.translate(-doc_rect.mLeft, -doc_rect.mBottom);
 
-        // reject partially visible lines
+        // reject partially visible lines; lines above the visible top or below its bottom cannot be visible
         LLRect visible_lines_rect;
-        for (line_list_t::const_iterator it = mLineInfoList.begin(), end_it = mLineInfoList.end();
-            it != end_it;
+        for (line_list_t::const_iterator it = std::lower_bound(mLineInfoList.begin(), mLineInfoList.end(), visible_text_rect.mTop, compare_bottom()),
+                end_it = std::upper_bound(mLineInfoList.begin(), mLineInfoList.end(), visible_text_rect.mBottom, compare_top());
+            it < end_it;
             ++it)
         {
             bool line_visible = mClipPartial ? visible_text_rect.contains(it->mRect) : visible_text_rect.overlaps(it->mRect);
@@ -3416,6 +3532,7 @@ bool LLTextSegment::getDimensions(S32 first_char, S32 num_chars, S32& width, S32
 S32 LLTextSegment::getOffset(S32 segment_local_x_coord, S32 start_offset, S32 num_chars, bool round) const { return 0; }
 S32 LLTextSegment::getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const { return 0; }
 void LLTextSegment::updateLayout(const LLTextBase& editor) {}
+void LLTextSegment::translateLayout(S32 delta_y) {}
 F32 LLTextSegment::draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect) { return draw_rect.mLeft; }
 bool LLTextSegment::canEdit() const { return false; }
 void LLTextSegment::unlinkFromDocument(LLTextBase*) {}
@@ -4051,6 +4168,11 @@ void LLInlineViewSegment::updateLayout(const LLTextBase& editor)
     mView->setOrigin(start_rect.mLeft + mLeftPad, start_rect.mBottom + mBottomPad);
 }
 
+void LLInlineViewSegment::translateLayout(S32 delta_y)
+{
+    mView->translate(0, delta_y);
+}
+
 F32 LLInlineViewSegment::draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect)
 {
     // return padded width of widget
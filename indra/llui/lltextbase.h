@@ -36,6 +36,7 @@
 #include "llkeywords.h"
 #include "llpanel.h"
 #include "llurlmatch.h"
+#include "lltextreflowtail.h"
 
 #include <string>
 #include <vector>
@@ -85,6 +86,9 @@ public:
     */
     virtual S32                 getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const;
     virtual void                updateLayout(const class LLTextBase& editor);
+    // moves whatever updateLayout() placed by delta_y, for lines that moved
+    // without being laid out again
+    virtual void                translateLayout(S32 delta_y);
     virtual F32                 draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect);
     virtual bool                canEdit() const;
     virtual void                unlinkFromDocument(class LLTextBase* editor);
@@ -253,6 +257,7 @@ public:
     /*virtual*/ bool        getDimensionsF32(S32 first_char, S32 num_chars, F32& width, S32& height) const;
     /*virtual*/ S32         getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const;
     /*virtual*/ void        updateLayout(const class LLTextBase& editor);
+    /*virtual*/ void        translateLayout(S32 delta_y);
     /*virtual*/ F32         draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect);
     /*virtual*/ bool        canEdit() const { return false; }
     /*virtual*/ void        unlinkFromDocument(class LLTextBase* editor);
@@ -485,6 +490,8 @@ public:
     S32                     getLength() const { return static_cast<S32>(getWText().length()); }
     S32                     getLineCount() const { return static_cast<S32>(mLineInfoList.size()); }
     S32                     removeFirstLine(); // returns removed length
+    S32                     removeLeadingText(S32 length); // returns removed length
+    S32                     prependWidget(const LLInlineViewSegment::Params& params, const std::string& text); // returns inserted length
 
     void                    addDocumentChild(LLView* view);
     void                    removeDocumentChild(LLView* view);
@@ -566,6 +573,7 @@ protected:
         bool operator()(const line_info& a, const line_info& b) const;
     };
     struct line_end_compare;
+    struct line_num_compare;
     typedef std::vector<LLTextSegmentPtr> segment_vec_t;
 
     // Abstract inner base class representing an undoable editor command.
@@ -657,6 +665,8 @@ protected:
     std::pair<S32, S32>             getVisibleLines(bool fully_visible = false);
     S32                             getLeftOffset(S32 width);
     void                            reflow();
+    bool                            reuseLaidOutLines(const line_list_t& old_lines, S32 prev_line_num, S32 line_start_index,
+                                                      S32 line_count, S32 cur_top, S32& delta_y);
 
     // cursor
     void                            updateCursorXPos();
@@ -673,6 +683,7 @@ protected:
     // misc
     void                            updateRects();
     void                            needsScroll() { mScrollNeeded = true; }
+    void                            needsReflowAfterEdit(S32 pos, S32 removed, S32 inserted);
 
     struct URLLabelCallback;
     // Replace a URL with a new icon and label, for example, when
@@ -774,6 +785,7 @@ protected:
 
     // transient state
     S32                         mReflowIndex;       // index at which to start reflow.  S32_MAX indicates no reflow needed.
+    LLTextReflowTail            mReflowTail;        // end of the document the edits since the last reflow left alone
     bool                        mScrollNeeded;      // need to change scroll region because of change to cursor position
     S32                         mScrollIndex;       // index of first character to keep visible in scroll region
 
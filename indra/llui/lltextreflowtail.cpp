@@ -0,0 +1,47 @@
+/**
+ * @file lltextreflowtail.cpp
+ * @brief Tracks the part of a laid out text document that edits left alone.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltextreflowtail.h"
+
+void LLTextReflowTail::reset()
+{
+    // the whole document is tail until something is edited
+    mOldStart = 0;
+    mDelta = 0;
+    mValid = true;
+}
+
+void LLTextReflowTail::edited(S32 pos, S32 removed, S32 inserted)
+{
+    // Whatever follows the edit is untouched, and where that is before the
+    // tail, the tail just moves along. pos + removed is the first character
+    // past the edit as the document was before this edit, which the earlier
+    // edits have shifted by mDelta from where it was laid out.
+    mOldStart = llmax(mOldStart, pos + removed - mDelta);
+    mDelta += inserted - removed;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file lltextreflowtail.h
+ * @brief Tracks the part of a laid out text document that edits left alone.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTREFLOWTAIL_H
+#define LL_LLTEXTREFLOWTAIL_H
+
+#include <algorithm>
+#include <vector>
+
+//
+// The end of a document that no edit since its last reflow has touched.
+// A paragraph's layout depends only on its own text, so once reflow has laid
+// out the edited paragraphs and reaches a paragraph starting in this tail,
+// the lines laid out before for the rest of the document can be taken as
+// they were: their document indices shifted by the length the edits added
+// or removed, their rects moved up or down by the edited paragraphs' change
+// in height.
+//
+class LLTextReflowTail
+{
+public:
+    LLTextReflowTail() { reset(); }
+
+    // Nothing edited since the last reflow
+    void reset();
+
+    // Layout changed for some reason other than an edit (width, fonts,
+    // embedded widgets...): nothing can be reused until the next reset()
+    void invalidate() { mValid = false; }
+
+    // removed characters at pos, counted in the document as it is now, were
+    // replaced by inserted ones. A change of style alone removes and
+    // inserts the same number.
+    void edited(S32 pos, S32 removed, S32 inserted);
+
+    bool isValid() const { return mValid; }
+
+    // First character of the tail in the document as it was laid out, and
+    // as it is now
+    S32 getOldStart() const { return mOldStart; }
+    S32 getStart() const { return mOldStart + mDelta; }
+    // Length the edits added (or removed, if negative)
+    S32 getDelta() const { return mDelta; }
+
+    // Index into lines, laid out before the edits and in document order, of
+    // the one starting at old_index if that line starts a paragraph; -1 if
+    // there is none. prev_line_num is the paragraph number (mLineNum) of the
+    // line before lines[0], or -1 if lines[0] is the document's first line.
+    template<typename LINE>
+    static S32 findParagraph(const std::vector<LINE>& lines, S32 old_index, S32 prev_line_num);
+
+private:
+    S32  mOldStart;
+    S32  mDelta;
+    bool mValid;
+};
+
+// static
+template<typename LINE>
+S32 LLTextReflowTail::findParagraph(const std::vector<LINE>& lines, S32 old_index, S32 prev_line_num)
+{
+    typename std::vector<LINE>::const_iterator iter =
+        std::lower_bound(lines.begin(), lines.end(), old_index,
+                         [](const LINE& line, S32 index) { return line.mDocIndexStart < index; });
+    if (iter == lines.end() || iter->mDocIndexStart != old_index)
+    {
+        return -1;
+    }
+    S32 prev = (iter == lines.begin()) ? prev_line_num : (iter - 1)->mLineNum;
+    // word wrapped lines share their paragraph's number
+    return (prev != iter->mLineNum) ? (S32)(iter - lines.begin()) : -1;
+}
+
+#endif // LL_LLTEXTREFLOWTAIL_H
@@ -0,0 +1,361 @@
+/**
+ * @file llscrolllistitem_test.cpp
+ * @brief Rows kept as column data, and a benchmark populating and sorting
+ * 50,000 of them without any UI.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llscrolllistitem.h"
+#include "../llscrolllistctrl.h"
+#include "lltut.h"
+
+#include "lltimer.h"
+
+#include <deque>
+
+// link seams
+
+static S32 sCellsCreated = 0;
+
+// Stands in for LLScrollListText, counting how many get made
+class LLTestScrollListCell : public LLScrollListCell
+{
+public:
+    LLTestScrollListCell(const LLScrollListCell::Params& p)
+    :   LLScrollListCell(p),
+        mText(p.label.isProvided() ? p.label() : p.value().asString()),
+        mAltText(p.alt_value().asString())
+    {
+        sCellsCreated++;
+    }
+
+    /*virtual*/ void setValue(const LLSD& value) { mText = value.asString(); }
+    /*virtual*/ void setAltValue(const LLSD& value) { mAltText = value.asString(); }
+    /*virtual*/ const LLSD getValue() const { return LLSD(mText); }
+    /*virtual*/ const LLSD getAltValue() const { return LLSD(mAltText); }
+
+    std::string mText;
+    std::string mAltText;
+};
+
+LLScrollListCell* LLScrollListCell::create(const LLScrollListCell::Params& cell_p)
+{
+    LLScrollListCell* cell = new LLTestScrollListCell(cell_p);
+    if (cell_p.value.isProvided())
+    {
+        cell->setValue(cell_p.value);
+    }
+    return cell;
+}
+
+LLScrollListCell::LLScrollListCell(const LLScrollListCell::Params& p)
+:   mWidth(p.width),
+    mToolTip(p.tool_tip)
+{}
+
+// virtual
+const LLSD LLScrollListCell::getValue() const
+{
+    return LLStringUtil::null;
+}
+
+// virtual
+const LLSD LLScrollListCell::getAltValue() const
+{
+    return LLStringUtil::null;
+}
+
+namespace LLInitParam
+{
+    bool ParamCompare<const LLFontGL*, false>::equals(const LLFontGL* a, const LLFontGL* b)
+    {
+        return false;
+    }
+
+    ParamValue<const LLFontGL*>::ParamValue(const LLFontGL* fontp)
+    :   super_t(fontp)
+    {}
+
+    void ParamValue<const LLFontGL*>::updateValueFromBlock()
+    {}
+
+    void ParamValue<const LLFontGL*>::updateBlockFromValue(bool)
+    {}
+
+    void TypeValues<LLFontGL::HAlign>::declareValues()
+    {}
+}
+
+//static
+LLFontGL* LLFontGL::getFontEmojiSmall()
+{
+    return NULL;
+}
+
+namespace tut
+{
+    struct LLScrollListItemData
+    {
+        // LLScrollListItem's constructor is for LLScrollListCtrl only
+        class Item : public LLScrollListItem
+        {
+        public:
+            Item(const LLScrollListItem::Params& p) : LLScrollListItem(p) {}
+        };
+
+        typedef std::deque<LLScrollListItem*> item_list;
+
+        LLScrollListItemData()
+        :   mSeed(12345)
+        {
+            sCellsCreated = 0;
+        }
+
+        ~LLScrollListItemData()
+        {
+            clear(mItems);
+        }
+
+        static void clear(item_list& items)
+        {
+            std::for_each(items.begin(), items.end(), DeletePointer());
+            items.clear();
+        }
+
+        U32 random()
+        {
+            mSeed = mSeed * 1103515245 + 12345;
+            return (mSeed >> 8) & 0xffffff;
+        }
+
+        // A group member as LLPanelGroupMembersSubTab would add it, with its
+        // cells kept as data the way a virtualized list keeps them. Names
+        // repeat so that sorting has ties to keep stable.
+        LLScrollListItem* makeRow(S32 index)
+        {
+            LLScrollListItem::Params item_p;
+            item_p.value = index;
+            Item* item = new Item(item_p);
+            item->setNumColumns(4);
+
+            LLScrollListCell::Params name_p;
+            name_p.value = llformat("Resident %05u", random() % 20000);
+            name_p.width = 120;
+            item->setColumnData(0, name_p);
+
+            LLScrollListCell::Params donated_p;
+            donated_p.value = llformat("%u", random() % 1000);
+            item->setColumnData(1, donated_p);
+
+            LLScrollListCell::Params online_p;
+            online_p.value = llformat("%02u/%02u/%04u", random() % 12 + 1, random() % 28 + 1, 2010 + random() % 15);
+            online_p.alt_value = llformat("%08u", random());
+            item->setColumnData(2, online_p);
+
+            item->setColumnSpacer(3, 10);
+            return item;
+        }
+
+        // SortScrollListItem's comparison for an ascending sort on column
+        struct CompareColumn
+        {
+            CompareColumn(S32 column) : mColumn(column) {}
+
+            bool operator()(const LLScrollListItem* i1, const LLScrollListItem* i2) const
+            {
+                return LLStringUtil::compareDict(i1->getColumnValueString(mColumn), i2->getColumnValueString(mColumn)) < 0;
+            }
+
+            S32 mColumn;
+        };
+
+        item_list mItems;
+        U32 mSeed;
+    };
+
+    typedef test_group<LLScrollListItemData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llscrolllistitem_test_factory("LLScrollListItem");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("column data reads like the cell it becomes");
+        LLScrollListItem::Params item_p;
+        Item item(item_p);
+        item.setNumColumns(3);
+
+        LLScrollListCell::Params label_p;
+        label_p.label = "label only";
+        label_p.width = 50;
+        item.setColumnData(0, label_p);
+
+        LLScrollListCell::Params value_p;
+        value_p.label = "label";
+        value_p.value = "value wins";
+        value_p.alt_value = "alt";
+        item.setColumnData(1, value_p);
+
+        ensure("data is a column", item.hasColumn(0) && item.hasColumn(1));
+        ensure("missing column", !item.hasColumn(2) && !item.hasColumn(3));
+        ensure_equals("label", item.getColumnValueString(0), std::string("label only"));
+        ensure_equals("value over label", item.getColumnValueString(1), std::string("value wins"));
+        ensure_equals("alt value", item.getColumnAltValueString(1), std::string("alt"));
+        ensure_equals("CSV", item.getContentsCSV(), std::string("label only, value wins, "));
+
+        item.setColumnWidth(0, 75);
+        item.setColumnValue(0, "renamed");
+        ensure_equals("no cells yet", sCellsCreated, 0);
+        ensure("not created", !item.isColumnCreated(0));
+
+        LLScrollListCell* cell = item.getColumn(0);
+        ensure("created on demand", cell != NULL && item.isColumnCreated(0));
+        ensure_equals("one cell", sCellsCreated, 1);
+        ensure_equals("cell value", cell->getValue().asString(), std::string("renamed"));
+        ensure_equals("cell width", cell->getWidth(), 75);
+        ensure("same cell again", item.getColumn(0) == cell);
+        ensure_equals("still one cell", sCellsCreated, 1);
+
+        item.setColumnValue(0, "on the cell");
+        ensure_equals("set on the cell", cell->getValue().asString(), std::string("on the cell"));
+        ensure_equals("read from the cell", item.getColumnValueString(0), std::string("on the cell"));
+
+        ensure_equals("value wins on the cell too", item.getColumn(1)->getValue().asString(), std::string("value wins"));
+        ensure_equals("alt value on the cell", item.getColumn(1)->getAltValue().asString(), std::string("alt"));
+
+        item.setColumnSpacer(2, 10);
+        ensure("spacer is a column", item.hasColumn(2));
+        ensure_equals("spacer has no value", item.getColumnValueString(2), std::string());
+        ensure_equals("spacer has no height", item.getColumnHeight(2), 0);
+        ensure_equals("spacer cell width", item.getColumn(2)->getWidth(), 10);
+
+        item.setNumColumns(1);
+        ensure("columns dropped", !item.hasColumn(1) && !item.hasColumn(2));
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("merging a sorted tail is a stable sort");
+        for (S32 i = 0; i < 2000; i++)
+        {
+            mItems.push_back(makeRow(i));
+        }
+        std::stable_sort(mItems.begin(), mItems.end(), CompareColumn(0));
+
+        for (size_t tail : { 1, 7, 300, 1999 })
+        {
+            for (size_t i = 0; i < tail; i++)
+            {
+                mItems.push_back(makeRow((S32)(mItems.size() + i)));
+            }
+            item_list expected(mItems);
+            std::stable_sort(expected.begin(), expected.end(), CompareColumn(0));
+
+            LLScrollListCtrl::sortTail(mItems, tail, CompareColumn(0));
+            ensure("same order, ties included", mItems == expected);
+        }
+        ensure_equals("no cells made to sort", sCellsCreated, 0);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("populate and sort 50000 rows");
+        const S32 ROWS = 50000;
+        const S32 ADDED = 25;
+
+        LLTimer timer;
+        for (S32 i = 0; i < ROWS; i++)
+        {
+            mItems.push_back(makeRow(i));
+        }
+        F64 populate_time = timer.getElapsedTimeF64();
+
+        // what LLScrollListCtrl::updateColumns() does to every row
+        timer.reset();
+        for (LLScrollListItem* item : mItems)
+        {
+            for (S32 i = 0; i < item->getNumColumns(); i++)
+            {
+                item->setColumnWidth(i, 100 + i);
+            }
+        }
+        F64 width_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        std::stable_sort(mItems.begin(), mItems.end(), CompareColumn(0));
+        F64 sort_time = timer.getElapsedTimeF64();
+        ensure_equals("no cells made", sCellsCreated, 0);
+
+        // names trickling in a few per frame, sorted the old way: everything
+        item_list resorted(mItems);
+        item_list added;
+        timer.reset();
+        for (S32 i = 0; i < ADDED; i++)
+        {
+            added.push_back(makeRow(ROWS + i));
+            resorted.push_back(added.back());
+            std::stable_sort(resorted.begin(), resorted.end(), CompareColumn(0));
+        }
+        F64 resort_time = timer.getElapsedTimeF64();
+
+        // and merged into the rows sorted already
+        timer.reset();
+        for (S32 i = 0; i < ADDED; i++)
+        {
+            mItems.push_back(makeRow(ROWS + i));
+            LLScrollListCtrl::sortTail(mItems, 1, CompareColumn(0));
+        }
+        F64 merge_time = timer.getElapsedTimeF64();
+        ensure("still sorted", std::is_sorted(mItems.begin(), mItems.end(), CompareColumn(0)));
+
+        // only a screenful of rows is ever drawn
+        for (S32 line = 0; line < 30; line++)
+        {
+            for (S32 i = 0; i < mItems[line]->getNumColumns(); i++)
+            {
+                mItems[line]->getColumn(i);
+            }
+        }
+        // three text cells a row; spacers do not come from create()
+        ensure_equals("cells only for drawn rows", sCellsCreated, 30 * 3);
+
+        // the rest of the resorted copy is shared with mItems
+        clear(added);
+
+        LL_INFOS("ScrollList") << ROWS << " rows: populated in " << populate_time * 1000.0
+            << "ms, widths set in " << width_time * 1000.0 << "ms, sorted in " << sort_time * 1000.0
+            << "ms; " << ADDED << " rows added one at a time: full sorts " << resort_time * 1000.0
+            << "ms, merged " << merge_time * 1000.0 << "ms" << LL_ENDL;
+    }
+}
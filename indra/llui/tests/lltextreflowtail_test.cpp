@@ -0,0 +1,381 @@
+/**
+ * @file lltextreflowtail_test.cpp
+ * @brief LLTextReflowTail bookkeeping, and a benchmark editing and paging
+ * out a 20,000 message chat laid out without any UI.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltextreflowtail.h"
+
+#include "../test/lltut.h"
+
+#include "llstring.h"
+#include "lltimer.h"
+
+namespace tut
+{
+    struct LLTextReflowTailData
+    {
+        // LLTextBase::line_info without the horizontal extent
+        struct Line
+        {
+            S32 mDocIndexStart;
+            S32 mDocIndexEnd;
+            S32 mTop;
+            S32 mLineNum;
+
+            bool operator==(const Line& other) const
+            {
+                return mDocIndexStart == other.mDocIndexStart && mDocIndexEnd == other.mDocIndexEnd
+                    && mTop == other.mTop && mLineNum == other.mLineNum;
+            }
+        };
+        typedef std::vector<Line> line_list_t;
+
+        static const S32 WRAP = 60;         // characters to a line
+        static const S32 LINE_HEIGHT = 16;
+
+        LLTextReflowTailData()
+        :   mSeed(12345),
+            mReflowIndex(S32_MAX),
+            mLaidOut(0)
+        {
+        }
+
+        U32 random()
+        {
+            mSeed = mSeed * 1103515245 + 12345;
+            return (mSeed >> 8) & 0xffffff;
+        }
+
+        // LLTextBase::insertStringNoUndo() and removeStringNoUndo()
+        void insert(S32 pos, const LLWString& wstr)
+        {
+            if (mReflowIndex == S32_MAX)
+            {
+                mTail.reset();
+            }
+            mTail.edited(pos, 0, (S32)wstr.length());
+            mReflowIndex = llmin(mReflowIndex, pos);
+            mText.insert(pos, wstr);
+        }
+
+        void remove(S32 pos, S32 length)
+        {
+            if (mReflowIndex == S32_MAX)
+            {
+                mTail.reset();
+            }
+            mTail.edited(pos, length, 0);
+            mReflowIndex = llmin(mReflowIndex, pos);
+            mText.erase(pos, length);
+        }
+
+        // LLTextBase::reflow() with a monospaced font, word wrapping
+        // anywhere. Without reuse, it lays out everything from the first
+        // edited line the way it did before the edits were tracked.
+        void reflow(bool reuse)
+        {
+            if (mReflowIndex == S32_MAX)
+            {
+                return;
+            }
+            S32 start_index = mReflowIndex;
+            mReflowIndex = S32_MAX;
+
+            S32 line_start_index = 0;
+            S32 line_count = 0;
+            S32 cur_top = 0;
+            line_list_t old_lines;
+            S32 prev_line_num = -1;
+            // LLTextBase's last line ends past the end of the text; here the
+            // line ending where an edit starts is laid out again too
+            line_list_t::iterator iter =
+                std::lower_bound(mLines.begin(), mLines.end(), start_index,
+                                 [](const Line& line, S32 pos) { return line.mDocIndexEnd < pos; });
+            if (iter != mLines.end())
+            {
+                line_start_index = iter->mDocIndexStart;
+                line_count = iter->mLineNum;
+                cur_top = iter->mTop;
+                if (reuse && mTail.isValid())
+                {
+                    prev_line_num = (iter == mLines.begin()) ? -1 : (iter - 1)->mLineNum;
+                    old_lines.assign(iter, mLines.end());
+                }
+                mLines.erase(iter, mLines.end());
+            }
+            else
+            {
+                mLines.clear();
+            }
+
+            const S32 length = (S32)mText.length();
+            while (!reuseLines(old_lines, prev_line_num, line_start_index, line_count, cur_top))
+            {
+                size_t newline = mText.find('\n', line_start_index);
+                S32 paragraph_end = (newline == LLWString::npos) ? length : (S32)newline + 1;
+                do
+                {
+                    S32 line_end = llmin(line_start_index + WRAP, paragraph_end);
+                    mLines.push_back({ line_start_index, line_end, cur_top, line_count });
+                    mLaidOut++;
+                    line_start_index = line_end;
+                    cur_top -= LINE_HEIGHT;
+                } while (line_start_index < paragraph_end);
+
+                if (newline == LLWString::npos)
+                {
+                    break;
+                }
+                line_count++;
+                if (line_start_index == length)
+                {
+                    // empty last line after a final newline
+                    mLines.push_back({ length, length, cur_top, line_count });
+                    mLaidOut++;
+                    break;
+                }
+            }
+        }
+
+        // LLTextBase::reuseLaidOutLines()
+        bool reuseLines(const line_list_t& old_lines, S32 prev_line_num, S32 line_start_index, S32 line_count, S32 cur_top)
+        {
+            if (old_lines.empty() || line_start_index < mTail.getStart())
+            {
+                return false;
+            }
+            const S32 delta_index = mTail.getDelta();
+            S32 first = LLTextReflowTail::findParagraph(old_lines, line_start_index - delta_index, prev_line_num);
+            if (first < 0)
+            {
+                return false;
+            }
+            const S32 delta_y = cur_top - old_lines[first].mTop;
+            const S32 delta_line = line_count - old_lines[first].mLineNum;
+            line_list_t::iterator reused = mLines.insert(mLines.end(), old_lines.begin() + first, old_lines.end());
+            for (; reused != mLines.end(); ++reused)
+            {
+                reused->mDocIndexStart += delta_index;
+                reused->mDocIndexEnd += delta_index;
+                reused->mTop += delta_y;
+                reused->mLineNum += delta_line;
+            }
+            return true;
+        }
+
+        line_list_t layoutFromScratch()
+        {
+            line_list_t lines;
+            mLines.swap(lines);
+            mReflowIndex = 0;
+            mTail.invalidate();
+            reflow(false);
+            mLines.swap(lines);
+            return lines;
+        }
+
+        LLWString makeMessage(S32 i)
+        {
+            std::string body(10 + random() % 150, 'x');
+            for (size_t pos = 0; pos < body.size(); pos += 1 + random() % 8)
+            {
+                body[pos] = ' ';
+            }
+            return utf8str_to_wstring(llformat("[%02u:%02u] Resident %d: ", random() % 24, random() % 60, i) + body + "\n");
+        }
+
+        U32 mSeed;
+        LLWString mText;
+        line_list_t mLines;
+        LLTextReflowTail mTail;
+        S32 mReflowIndex;
+        S32 mLaidOut;
+    };
+
+    typedef test_group<LLTextReflowTailData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory lltextreflowtail_test_factory("LLTextReflowTail");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("edits move the tail");
+        LLTextReflowTail tail;
+        ensure("valid after reset", tail.isValid());
+        ensure_equals("all tail", tail.getOldStart(), 0);
+
+        tail.edited(10, 0, 5);
+        ensure_equals("after an insertion", tail.getOldStart(), 10);
+        ensure_equals("longer", tail.getDelta(), 5);
+        ensure_equals("now starts after it", tail.getStart(), 15);
+
+        tail.edited(2, 3, 0);
+        ensure_equals("edit before it leaves it", tail.getOldStart(), 10);
+        ensure_equals("but moves it", tail.getStart(), 12);
+
+        tail.edited(20, 4, 1);
+        ensure_equals("edit inside it shortens it", tail.getOldStart(), 22);
+        ensure_equals("by what came before", tail.getStart(), 21);
+        ensure_equals("delta", tail.getDelta(), -1);
+
+        tail.edited(21, 2, 2);
+        ensure_equals("restyling its start", tail.getOldStart(), 24);
+        ensure_equals("changes no length", tail.getDelta(), -1);
+
+        tail.invalidate();
+        ensure("invalid", !tail.isValid());
+        tail.reset();
+        ensure("valid again", tail.isValid());
+        ensure_equals("no delta", tail.getDelta(), 0);
+
+        // four lines: a paragraph wrapped in two, then two of one line each
+        std::vector<LLTextReflowTailData::Line> lines = {
+            { 0, 10, 0, 0 }, { 10, 15, -16, 0 }, { 15, 20, -32, 1 }, { 20, 21, -48, 2 } };
+        ensure_equals("first line", LLTextReflowTail::findParagraph(lines, 0, -1), 0);
+        ensure_equals("first line continues a paragraph", LLTextReflowTail::findParagraph(lines, 0, 0), -1);
+        ensure_equals("word wrapped", LLTextReflowTail::findParagraph(lines, 10, -1), -1);
+        ensure_equals("paragraph", LLTextReflowTail::findParagraph(lines, 15, -1), 2);
+        ensure_equals("last", LLTextReflowTail::findParagraph(lines, 20, -1), 3);
+        ensure_equals("no line starts there", LLTextReflowTail::findParagraph(lines, 12, -1), -1);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("reused lines match laying out again");
+        for (S32 i = 0; i < 300; i++)
+        {
+            LLWString message = makeMessage(i);
+            insert((S32)mText.length(), message);
+        }
+        reflow(true);
+        ensure("laid out", mLines == layoutFromScratch());
+
+        const LLWString pieces[] = { utf8str_to_wstring("word "), utf8str_to_wstring("\n"),
+                                     utf8str_to_wstring("two\nparagraphs\n"), utf8str_to_wstring(std::string(130, 'y')) };
+        for (S32 round = 0; round < 400; round++)
+        {
+            // up to three edits before each reflow, as typing and restyling between frames do
+            for (U32 edits = random() % 3 + 1; edits > 0; edits--)
+            {
+                S32 pos = (S32)(random() % (mText.length() + 1));
+                if (random() % 2)
+                {
+                    insert(pos, pieces[random() % 4]);
+                }
+                else
+                {
+                    remove(pos, llmin((S32)(random() % 200), (S32)mText.length() - pos));
+                }
+            }
+            reflow(true);
+            ensure("same lines as laid out from scratch", mLines == layoutFromScratch());
+        }
+
+        // whole paragraphs off the front, as LLChatHistory pages them out
+        size_t newline = mText.find('\n', mText.length() / 2);
+        ensure("paragraphs left", newline != LLWString::npos);
+        remove(0, (S32)newline + 1);
+        mLaidOut = 0;
+        reflow(true);
+        ensure_equals("without laying anything out", mLaidOut, 0);
+        ensure("paged out", mLines == layoutFromScratch());
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("edit and page out a 20000 message chat");
+        const S32 MESSAGES = 20000;
+        const S32 EDITS = 50;
+        const S32 PAGED_OUT = 1000;
+
+        LLTimer timer;
+        for (S32 i = 0; i < MESSAGES; i++)
+        {
+            insert((S32)mText.length(), makeMessage(i));
+            reflow(true);
+        }
+        F64 append_time = timer.getElapsedTimeF64();
+        S32 line_count = (S32)mLines.size();
+        std::vector<S32> starts;
+        for (const Line& line : mLines)
+        {
+            if (line.mDocIndexStart == 0 || mText[line.mDocIndexStart - 1] == '\n')
+            {
+                starts.push_back(line.mDocIndexStart);
+            }
+        }
+
+        // a word into a message a third of the way down, laid out again
+        // from there to the end as before, then only up to the next paragraph
+        F64 edit_time[2];
+        S32 laid_out[2];
+        const LLWString word = utf8str_to_wstring("word ");
+        for (S32 reuse = 0; reuse < 2; reuse++)
+        {
+            mLaidOut = 0;
+            timer.reset();
+            for (S32 i = 0; i < EDITS; i++)
+            {
+                insert(starts[MESSAGES / 3] + 12, word);
+                reflow(reuse != 0);
+            }
+            edit_time[reuse] = timer.getElapsedTimeF64();
+            laid_out[reuse] = mLaidOut;
+        }
+        ensure("edited", mLines == layoutFromScratch());
+
+        // the oldest messages out of the document, one at a time
+        F64 page_time[2];
+        for (S32 reuse = 0; reuse < 2; reuse++)
+        {
+            timer.reset();
+            for (S32 i = 0; i < PAGED_OUT; i++)
+            {
+                size_t newline = mText.find('\n');
+                remove(0, (S32)newline + 1);
+                reflow(reuse != 0);
+            }
+            page_time[reuse] = timer.getElapsedTimeF64();
+        }
+        ensure("paged out", mLines == layoutFromScratch());
+
+        LL_INFOS("TextReflow") << MESSAGES << " messages appended and laid out in " << append_time * 1000.0
+            << "ms (" << line_count << " lines); " << EDITS << " edits: laid out to the end " << edit_time[0] * 1000.0
+            << "ms (" << laid_out[0] << " lines), to the next paragraph " << edit_time[1] * 1000.0 << "ms ("
+            << laid_out[1] << " lines); " << PAGED_OUT << " messages paged out: laid out again "
+            << page_time[0] * 1000.0 << "ms, lines reused " << page_time[1] * 1000.0 << "ms" << LL_ENDL;
+    }
+}
@@ -372,7 +372,8 @@ const std::string LLControlGroup::mTypeString[TYPE_COUNT] = { "U32"
 
 LLControlGroup::LLControlGroup(const std::string& name)
 :   LLInstanceTracker<LLControlGroup, std::string>(name),
-    mSettingsProfile(false)
+    mSettingsProfile(false),
+    mProfileFrames(0)
 {
 
     if (NULL != getenv("LL_SETTINGS_PROFILE"))
@@ -553,11 +554,65 @@ LLControlVariable* LLControlGroup::declareLLSD(const std::string& name, const LL
 
 void LLControlGroup::incrCount(std::string_view name)
 {
+    // getControl() is called from worker threads too
+    LLMutexLock lock(&mProfileMutex);
     if (0.0 == start_time)
     {
         start_time = LLTimer::getTotalSeconds();
     }
-    getCount[name.data()] = getCount[name.data()].asInteger() + 1;
+    std::string key(name);
+    getCount[key] = getCount[key].asInteger() + 1;
+
+    lookup_count_t::iterator iter = mProfileFrameCounts.find(name);
+    if (iter == mProfileFrameCounts.end())
+    {
+        mProfileFrameCounts.emplace(std::move(key), 1);
+    }
+    else
+    {
+        ++iter->second;
+    }
+}
+
+U32 LLControlGroup::getProfileFrameCount(std::string_view name)
+{
+    LLMutexLock lock(&mProfileMutex);
+    lookup_count_t::const_iterator iter = mProfileFrameCounts.find(name);
+    return iter == mProfileFrameCounts.end() ? 0 : iter->second;
+}
+
+void LLControlGroup::profileFrame(U32 frames_per_report)
+{
+    if (!mSettingsProfile)
+    {
+        return;
+    }
+
+    LLMutexLock lock(&mProfileMutex);
+    if (++mProfileFrames < llmax(frames_per_report, (U32)1))
+    {
+        return;
+    }
+
+    settings_vec_t hot;
+    for (const lookup_count_t::value_type& entry : mProfileFrameCounts)
+    {
+        if (entry.second >= mProfileFrames)
+        {
+            hot.push_back(settings_pair_t(entry.first, entry.second));
+        }
+    }
+    std::sort(hot.begin(), hot.end(), compareRoutine);
+
+    LL_INFOS("SettingsProfile") << getKey() << ": " << hot.size() << " settings looked up by name every frame over the last "
+        << mProfileFrames << " frames" << LL_ENDL;
+    for (const settings_pair_t& entry : hot)
+    {
+        LL_INFOS("SettingsProfile") << llformat("%8.1f/frame  %s", (F32)entry.second / (F32)mProfileFrames, entry.first.c_str()) << LL_ENDL;
+    }
+
+    mProfileFrames = 0;
+    mProfileFrameCounts.clear();
 }
 
 bool LLControlGroup::getBOOL(std::string_view name)
@@ -33,6 +33,7 @@
 #include "llrect.h"
 #include "llrefcount.h"
 #include "llinstancetracker.h"
+#include "llmutex.h"
 
 #include <vector>
 
@@ -282,7 +283,20 @@ public:
     void    resetToDefaults();
     void    incrCount(std::string_view name);
 
+    // With LL_SETTINGS_PROFILE set, call profileFrame() once per frame: every
+    // frames_per_report frames it logs each setting looked up by name at least
+    // once per frame on average, so hot per-frame lookups can be found and
+    // replaced by LLCachedControl, then starts a new interval.
+    void    profileFrame(U32 frames_per_report = 256);
+    U32     getProfileFrameCount(std::string_view name);
+
     bool    mSettingsProfile;
+
+private:
+    typedef std::map<std::string, U32, std::less<> > lookup_count_t;
+    U32             mProfileFrames;
+    lookup_count_t  mProfileFrameCounts;
+    LLMutex         mProfileMutex;
 };
 
 
@@ -48,6 +48,185 @@
 // static
 bool LLXMLNode::sStripEscapedStrings = true;
 bool LLXMLNode::sStripWhitespaceValues = false;
+std::string LLXMLNode::sLayeredCacheDir;
+
+namespace
+{
+    // Bump when the binary node layout changes.
+    const U32 XML_BINARY_VERSION = 1;
+    const char XML_CACHE_MAGIC[4] = { 'L', 'X', 'M', 'B' };
+
+    // The cache only ever lives on the machine that wrote it, so values are
+    // stored in native byte order.
+    void put_u32(std::string& output, U32 value)
+    {
+        output.append((const char*)&value, sizeof(value));
+    }
+
+    void put_u64(std::string& output, U64 value)
+    {
+        output.append((const char*)&value, sizeof(value));
+    }
+
+    void put_string(std::string& output, const std::string& value)
+    {
+        put_u32(output, (U32)value.size());
+        output.append(value);
+    }
+
+    struct LLXMLBinaryReader
+    {
+        LLXMLBinaryReader(const char* buffer, U64 length)
+        :   mPos(buffer),
+            mEnd(buffer + length)
+        {
+        }
+
+        bool getU32(U32& value)
+        {
+            if (mEnd - mPos < (ptrdiff_t)sizeof(value)) return false;
+            memcpy(&value, mPos, sizeof(value));
+            mPos += sizeof(value);
+            return true;
+        }
+
+        bool getString(std::string& value)
+        {
+            U32 size;
+            if (!getU32(size) || (U64)(mEnd - mPos) < size) return false;
+            value.assign(mPos, size);
+            mPos += size;
+            return true;
+        }
+
+        bool readNode(LLXMLNodePtr& node)
+        {
+            std::string name;
+            std::string value;
+            std::string id;
+            U32 fields[9];
+            if (!getString(name) || name.empty() || !getString(value) || !getString(id))
+            {
+                return false;
+            }
+            for (U32& field : fields)
+            {
+                if (!getU32(field)) return false;
+            }
+
+            node = new LLXMLNode(name.c_str(), fields[0] != 0);
+            node->mID = id;
+            node->setValue(value);
+            node->mVersionMajor = fields[1];
+            node->mVersionMinor = fields[2];
+            node->mLength = fields[3];
+            node->mPrecision = fields[4];
+            node->mType = (LLXMLNode::ValueType)fields[5];
+            node->mEncoding = (LLXMLNode::Encoding)fields[6];
+            node->setLineNumber((S32)fields[7]);
+
+            // attributes, then children in document order
+            U32 count = fields[8];
+            for (U32 i = 0; i < count; i++)
+            {
+                LLXMLNodePtr child;
+                if (!readNode(child)) return false;
+                node->addChild(child);
+            }
+            if (!getU32(count)) return false;
+            for (U32 i = 0; i < count; i++)
+            {
+                LLXMLNodePtr child;
+                if (!readNode(child)) return false;
+                node->addChild(child);
+            }
+            return true;
+        }
+
+        const char* mPos;
+        const char* mEnd;
+    };
+
+    // Everything the merged tree depends on: the parser switches and each
+    // layer's path, size and modification time.
+    bool get_layered_cache_key(const std::vector<std::string>& paths, std::string& key)
+    {
+        put_u32(key, XML_BINARY_VERSION);
+        put_u32(key, LLXMLNode::sStripEscapedStrings);
+        put_u32(key, LLXMLNode::sStripWhitespaceValues);
+        for (const std::string& path : paths)
+        {
+            llstat stat_data;
+            if (path.empty() || LLFile::stat(path, &stat_data) != 0)
+            {
+                return false;
+            }
+            put_string(key, path);
+            put_u64(key, (U64)stat_data.st_size);
+            put_u64(key, (U64)stat_data.st_mtime);
+        }
+        return true;
+    }
+
+    std::string get_layered_cache_filename(const std::vector<std::string>& paths)
+    {
+        // one entry per set of files, overwritten whenever one of them changes
+        std::string joined;
+        for (const std::string& path : paths)
+        {
+            joined.append(path);
+            joined.append(1, '\n');
+        }
+        LLUUID id;
+        id.generate(joined);
+        return LLXMLNode::getLayeredCacheDir() + gDirUtilp->getDirDelimiter() + id.asString() + ".xmlb";
+    }
+
+    bool load_layered_cache(const std::string& filename, const std::string& key, LLXMLNodePtr& root)
+    {
+        std::string contents = LLFile::getContents(filename);
+        size_t header_size = sizeof(XML_CACHE_MAGIC) + sizeof(U32) + key.size();
+        if (contents.size() < header_size
+            || memcmp(contents.data(), XML_CACHE_MAGIC, sizeof(XML_CACHE_MAGIC)) != 0)
+        {
+            return false;
+        }
+
+        LLXMLBinaryReader reader(contents.data() + sizeof(XML_CACHE_MAGIC), contents.size() - sizeof(XML_CACHE_MAGIC));
+        std::string cached_key;
+        if (!reader.getString(cached_key) || cached_key != key)
+        {
+            LL_DEBUGS("XMLNode") << "Stale cache " << filename << LL_ENDL;
+            return false;
+        }
+
+        return LLXMLNode::readBinary(reader.mPos, reader.mEnd - reader.mPos, root);
+    }
+
+    void save_layered_cache(const std::string& filename, const std::string& key, const LLXMLNodePtr& root)
+    {
+        std::string contents(XML_CACHE_MAGIC, sizeof(XML_CACHE_MAGIC));
+        put_string(contents, key);
+        root->writeBinary(contents);
+
+        std::string temp_filename = filename + ".tmp";
+        LLFILE* fp = LLFile::fopen(temp_filename, "wb");
+        if (!fp)
+        {
+            return;
+        }
+        size_t written = fwrite(contents.data(), 1, contents.size(), fp);
+        LLFile::close(fp);
+
+        // rename won't replace an existing file on Windows
+        LLFile::remove(filename, ENOENT);
+        if (written != contents.size() || LLFile::rename(temp_filename, filename) != 0)
+        {
+            LL_WARNS("XMLNode") << "Unable to write cache " << filename << LL_ENDL;
+            LLFile::remove(temp_filename, ENOENT);
+        }
+    }
+}
 
 LLXMLNode::LLXMLNode() :
     mID(""),
@@ -829,6 +1008,46 @@ bool LLXMLNode::getLayeredXMLNode(LLXMLNodePtr& root,
 {
     if (paths.empty()) return false;
 
+    std::string cache_key;
+    std::string cache_filename;
+    if (!sLayeredCacheDir.empty() && get_layered_cache_key(paths, cache_key))
+    {
+        cache_filename = get_layered_cache_filename(paths);
+        if (load_layered_cache(cache_filename, cache_key, root))
+        {
+            return true;
+        }
+    }
+
+    if (!parseLayeredXMLNode(root, paths))
+    {
+        return false;
+    }
+
+    if (!cache_filename.empty())
+    {
+        save_layered_cache(cache_filename, cache_key, root);
+    }
+    return true;
+}
+
+// static
+void LLXMLNode::setLayeredCacheDir(const std::string& dir)
+{
+    if (!dir.empty() && LLFile::mkdir(dir) != 0)
+    {
+        LL_WARNS("XMLNode") << "Unable to create " << dir << ", not caching parsed XML" << LL_ENDL;
+        sLayeredCacheDir.clear();
+        return;
+    }
+    sLayeredCacheDir = dir;
+}
+
+// static
+bool LLXMLNode::parseLayeredXMLNode(LLXMLNodePtr& root,
+                                    const std::vector<std::string>& paths)
+{
+
     std::string filename = paths.front();
     if (filename.empty())
     {
@@ -876,6 +1095,51 @@ bool LLXMLNode::getLayeredXMLNode(LLXMLNodePtr& root,
     return true;
 }
 
+void LLXMLNode::writeBinary(std::string& output) const
+{
+    put_string(output, mName ? mName->mString : std::string());
+    put_string(output, mValue);
+    put_string(output, mID);
+    put_u32(output, mIsAttribute);
+    put_u32(output, mVersionMajor);
+    put_u32(output, mVersionMinor);
+    put_u32(output, mLength);
+    put_u32(output, mPrecision);
+    put_u32(output, (U32)mType);
+    put_u32(output, (U32)mEncoding);
+    put_u32(output, (U32)mLineNumber);
+
+    put_u32(output, (U32)mAttributes.size());
+    for (LLXMLAttribList::const_iterator iter = mAttributes.begin(); iter != mAttributes.end(); ++iter)
+    {
+        iter->second->writeBinary(output);
+    }
+
+    U32 child_count = 0;
+    for (LLXMLNodePtr child = getFirstChild(); child.notNull(); child = child->getNextSibling())
+    {
+        child_count++;
+    }
+    put_u32(output, child_count);
+    for (LLXMLNodePtr child = getFirstChild(); child.notNull(); child = child->getNextSibling())
+    {
+        child->writeBinary(output);
+    }
+}
+
+// static
+bool LLXMLNode::readBinary(const char* buffer, U64 length, LLXMLNodePtr& node)
+{
+    LLXMLBinaryReader reader(buffer, length);
+    if (!reader.readNode(node) || reader.mPos != reader.mEnd)
+    {
+        LL_WARNS("XMLNode") << "Corrupt binary XML" << LL_ENDL;
+        node = NULL;
+        return false;
+    }
+    return true;
+}
+
 // static
 void LLXMLNode::writeHeaderToFile(LLFILE *out_file)
 {
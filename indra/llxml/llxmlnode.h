@@ -150,6 +150,15 @@ public:
 
     static bool getLayeredXMLNode(LLXMLNodePtr& root, const std::vector<std::string>& paths);
 
+    // When set, getLayeredXMLNode() keeps a binary copy of each merged tree
+    // in this directory and reads it back in one go for as long as none of
+    // the layer files changes size or modification time. Empty disables.
+    static void setLayeredCacheDir(const std::string& dir);
+    static const std::string& getLayeredCacheDir() { return sLayeredCacheDir; }
+
+    // Compact binary form of this node and everything under it.
+    void writeBinary(std::string& output) const;
+    static bool readBinary(const char* buffer, U64 length, LLXMLNodePtr& node);
 
     // Write standard XML file header:
     // <?xml version="1.0" encoding="utf-8" standalone="yes" ?>
@@ -295,6 +304,8 @@ protected:
     bool removeChild(LLXMLNode* child);
     bool isFullyDefault();
 
+    static bool parseLayeredXMLNode(LLXMLNodePtr& root, const std::vector<std::string>& paths);
+
     std::string getXMLRPCTextContents() const;
     bool parseXmlRpcArrayValue(LLSD& target);
     bool parseXmlRpcStructValue(LLSD& target);
@@ -321,6 +332,7 @@ public:
 
     static bool sStripEscapedStrings;
     static bool sStripWhitespaceValues;
+    static std::string sLayeredCacheDir;
 
 protected:
     LLStringTableEntry *mName;      // The name of this node
@@ -151,4 +151,34 @@ namespace tut
         ensure("listener fired on changed setting", mListenerFired);
     }
 
+    //settings profile, per frame
+    template<> template<>
+    void control_group_t::test<5>()
+    {
+        mCG->loadFromFile(mTestConfigFile.c_str());
+        mCG->getU32("TestSetting");
+        ensure_equals("lookups not counted without the profile", mCG->getProfileFrameCount("TestSetting"), 0U);
+
+        // as if LL_SETTINGS_PROFILE were set
+        mCG->mSettingsProfile = true;
+        for (int i = 0; i < 3; ++i)
+        {
+            mCG->getU32("TestSetting");
+        }
+        ensure_equals("string keyed lookups counted", mCG->getProfileFrameCount("TestSetting"), 3U);
+
+        LLCachedControl<U32> cached(*mCG, "TestSetting");
+        U32 before = mCG->getProfileFrameCount("TestSetting");
+        for (int i = 0; i < 3; ++i)
+        {
+            ensure_equals("cached value", (U32)cached, 12U);
+        }
+        ensure_equals("cached control reads are not lookups", mCG->getProfileFrameCount("TestSetting"), before);
+
+        mCG->profileFrame(1);
+        ensure_equals("report starts a new interval", mCG->getProfileFrameCount("TestSetting"), 0U);
+        // no settings_profile.log from the test
+        mCG->mSettingsProfile = false;
+    }
+
 }
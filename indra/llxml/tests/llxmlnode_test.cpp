@@ -0,0 +1,226 @@
+/**
+ * @file llxmlnode_test.cpp
+ * @brief LLXMLNode binary form and layered file cache tests.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lldiriterator.h"
+#include "llfile.h"
+#include "lltimer.h"
+#include "stringize.h"
+
+#include "../llxmlnode.h"
+
+#include "../test/lltut.h"
+
+#include <sstream>
+
+namespace tut
+{
+    struct LLXMLNodeData
+    {
+        LLXMLNodeData()
+        {
+            LLUUID random;
+            random.generate();
+            mDir = STRINGIZE(LLFile::tmpdir() << "llxmlnode-test-" << random << "/");
+            LLFile::mkdir(mDir);
+            mCacheDir = mDir + "cache";
+        }
+
+        ~LLXMLNodeData()
+        {
+            LLXMLNode::setLayeredCacheDir("");
+            for (const std::string& filename : mCleanups)
+            {
+                LLFile::remove(filename, ENOENT);
+            }
+            LLFile::rmdir(mCacheDir);
+            LLFile::rmdir(mDir);
+        }
+
+        std::string writeFile(const std::string& name, const std::string& contents)
+        {
+            std::string filename = mDir + name;
+            LLFILE* fp = LLFile::fopen(filename, "wb");
+            ensure("file written", fp != NULL);
+            fwrite(contents.data(), 1, contents.size(), fp);
+            fclose(fp);
+            mCleanups.push_back(filename);
+            return filename;
+        }
+
+        // Roughly the shape of a floater definition, with widget_count
+        // named controls spread across a few panels.
+        static std::string makeFloater(S32 widget_count, const std::string& label)
+        {
+            std::ostringstream xml;
+            xml << "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\" ?>\n"
+                << "<floater name=\"test\" title=\"" << label << "\" width=\"400\" height=\"300\" can_resize=\"true\">\n"
+                << "  <string name=\"greeting\">Hello &amp; welcome</string>\n";
+            for (S32 panel = 0; panel < 4; panel++)
+            {
+                xml << "  <panel name=\"panel" << panel << "\" layout=\"topleft\" follows=\"all\">\n";
+                for (S32 i = panel; i < widget_count; i += 4)
+                {
+                    xml << "    <button name=\"button" << i << "\" label=\"" << label << " " << i
+                        << "\" left=\"" << i % 50 << "\" top_pad=\"4\" width=\"80\" height=\"20\" tool_tip=\"Does thing " << i << "\">\n"
+                        << "      <button.commit_callback function=\"Test.Click\" parameter=\"" << i << "\" />\n"
+                        << "    </button>\n";
+                }
+                xml << "  </panel>\n";
+            }
+            xml << "</floater>\n";
+            return xml.str();
+        }
+
+        static std::string dump(LLXMLNodePtr node)
+        {
+            std::ostringstream str;
+            node->writeToOstream(str);
+            return str.str();
+        }
+
+        std::string mDir;
+        std::string mCacheDir;
+        std::vector<std::string> mCleanups;
+    };
+
+    typedef test_group<LLXMLNodeData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llxmlnode_test_factory("LLXMLNode");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("binary round trip");
+        std::string xml = makeFloater(20, "Label");
+        LLXMLNodePtr parsed;
+        ensure("parsed", LLXMLNode::parseBuffer(xml.data(), xml.size(), parsed));
+
+        std::string binary;
+        parsed->writeBinary(binary);
+        LLXMLNodePtr loaded;
+        ensure("loaded", LLXMLNode::readBinary(binary.data(), binary.size(), loaded));
+        ensure_equals("same tree", dump(loaded), dump(parsed));
+        ensure_equals("line numbers kept",
+                      loaded->getFirstChild()->getLineNumber(), parsed->getFirstChild()->getLineNumber());
+
+        std::string text;
+        ensure("attribute lookup", loaded->getFirstChild()->getAttributeString("name", text));
+        ensure_equals("attribute value", text, "greeting");
+        ensure_equals("unescaped value", loaded->getFirstChild()->getValue(), "Hello & welcome");
+
+        ensure("truncated data is rejected", !LLXMLNode::readBinary(binary.data(), binary.size() - 1, loaded));
+        ensure("rejected tree is cleared", loaded.isNull());
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("layered file cache");
+        std::vector<std::string> paths;
+        paths.push_back(writeFile("floater.xml", makeFloater(20, "English")));
+        paths.push_back(writeFile("floater_fr.xml", makeFloater(20, "Francais")));
+
+        LLXMLNodePtr uncached;
+        ensure("uncached", LLXMLNode::getLayeredXMLNode(uncached, paths));
+
+        LLXMLNode::setLayeredCacheDir(mCacheDir);
+        ensure_equals("cache dir", LLXMLNode::getLayeredCacheDir(), mCacheDir);
+
+        LLXMLNodePtr first;
+        ensure("first load", LLXMLNode::getLayeredXMLNode(first, paths));
+        ensure_equals("first load matches", dump(first), dump(uncached));
+
+        std::vector<std::string> cached;
+        LLDirIterator iter(mCacheDir, "*.xmlb");
+        std::string name;
+        while (iter.next(name))
+        {
+            cached.push_back(mCacheDir + "/" + name);
+        }
+        ensure_equals("one cache file", cached.size(), (size_t)1);
+        mCleanups.insert(mCleanups.end(), cached.begin(), cached.end());
+
+        LLXMLNodePtr second;
+        ensure("cached load", LLXMLNode::getLayeredXMLNode(second, paths));
+        ensure_equals("cached load matches", dump(second), dump(uncached));
+        std::string title;
+        second->getAttributeString("title", title);
+        ensure_equals("localized layer applied", title, "Francais");
+
+        // changing a layer invalidates the entry
+        writeFile("floater_fr.xml", makeFloater(20, "Deutsch"));
+        LLXMLNodePtr changed;
+        ensure("changed load", LLXMLNode::getLayeredXMLNode(changed, paths));
+        changed->getAttributeString("title", title);
+        ensure_equals("changed layer applied", title, "Deutsch");
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("parse versus cached load");
+        std::vector<std::string> paths;
+        paths.push_back(writeFile("big.xml", makeFloater(400, "English")));
+        paths.push_back(writeFile("big_fr.xml", makeFloater(400, "Francais")));
+
+        const S32 LOADS = 50;
+        LLTimer timer;
+        for (S32 i = 0; i < LOADS; i++)
+        {
+            LLXMLNodePtr root;
+            ensure("parsed", LLXMLNode::getLayeredXMLNode(root, paths));
+        }
+        F64 parse_time = timer.getElapsedTimeF64();
+
+        LLXMLNode::setLayeredCacheDir(mCacheDir);
+        LLXMLNodePtr root;
+        ensure("cache written", LLXMLNode::getLayeredXMLNode(root, paths));
+        LLDirIterator iter(mCacheDir, "*.xmlb");
+        std::string name;
+        while (iter.next(name))
+        {
+            mCleanups.push_back(mCacheDir + "/" + name);
+        }
+
+        timer.reset();
+        for (S32 i = 0; i < LOADS; i++)
+        {
+            ensure("cached", LLXMLNode::getLayeredXMLNode(root, paths));
+        }
+        F64 cached_time = timer.getElapsedTimeF64();
+
+        LL_INFOS("XMLNode") << LOADS << " layered loads of 400 widgets: parsed "
+            << parse_time * 1000.0 << "ms, cached " << cached_time * 1000.0 << "ms" << LL_ENDL;
+    }
+}
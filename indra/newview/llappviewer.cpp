@@ -101,6 +101,7 @@
 #include "llprogressview.h"
 #include "llvocache.h"
 #include "lldiskcache.h"
+#include "llxmlnode.h"
 #include "llvopartgroup.h"
 #include "llweb.h"
 #include "llspellcheck.h"
@@ -4370,6 +4371,11 @@ bool LLAppViewer::initCache()
     const std::string cache_dir = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, cache_dir_name);
     LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info);
 
+    if (gSavedSettings.getBOOL("XUIBinaryCache"))
+    {
+        LLXMLNode::setLayeredCacheDir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "xui"));
+    }
+
     if (!read_only)
     {
         if (gSavedSettings.getS32("DiskCacheVersion") != LLAppViewer::getDiskCacheVersion())
@@ -4441,6 +4447,11 @@ void LLAppViewer::purgeCache()
     LLAppViewer::getTextureCache()->purgeCache(LL_PATH_CACHE);
     LLVOCache::getInstance()->removeCache(LL_PATH_CACHE);
     LLViewerShaderMgr::instance()->clearShaderCache();
+    std::string xui_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "xui");
+    if (LLFile::isdir(xui_cache))
+    {
+        gDirUtilp->deleteFilesInDir(xui_cache, "*.xmlb");
+    }
     std::string browser_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "cef_cache");
     if (LLFile::isdir(browser_cache))
     {
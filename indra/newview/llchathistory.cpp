@@ -74,6 +74,8 @@ const static std::string NEW_LINE(rawstr_to_utf8("\n"));
 
 const static std::string SLURL_APP_AGENT = "secondlife:///app/agent/";
 const static std::string SLURL_ABOUT = "/about";
+// Bytes of paged out plain text getValue() still returns, about 10,000 lines of chat
+const static size_t MAX_PAGED_OUT_TEXT = 1024 * 1024;
 
 // support for secondlife:///app/objectim/{UUID}/ SLapps
 class LLObjectIMHandler : public LLCommandHandler
@@ -1122,7 +1124,7 @@ LLChatHistory::LLChatHistory(const LLChatHistory::Params& p)
 
 LLSD LLChatHistory::getValue() const
 {
-    return LLSD(mEditor->getText());
+    return LLSD(mPagedOutText + mEditor->getText());
 }
 
 LLChatHistory::~LLChatHistory()
@@ -1209,6 +1211,24 @@ LLView* LLChatHistory::getHeader(const LLChat& chat,const LLStyle::Params& style
     return header;
 }
 
+void LLChatHistory::initWidgetParams(LLView* view, S32 top_pad, S32 bottom_pad, LLInlineViewSegment::Params& p)
+{
+    p.force_newline = true;
+    p.left_pad = mLeftWidgetPad;
+    p.right_pad = mRightWidgetPad;
+    p.top_pad = top_pad;
+    p.bottom_pad = bottom_pad;
+    p.view = view;
+
+    //Prepare the rect for the view
+    LLRect target_rect = mEditor->getDocumentView()->getRect();
+    // squeeze down the widget by subtracting padding off left and right
+    target_rect.mLeft += mLeftWidgetPad + mEditor->getHPad();
+    target_rect.mRight -= mRightWidgetPad;
+    view->reshape(target_rect.getWidth(), view->getRect().getHeight());
+    view->setOrigin(target_rect.mLeft, view->getRect().mBottom);
+}
+
 void LLChatHistory::onClickMoreText()
 {
     mEditor->endOfDoc();
@@ -1219,6 +1239,69 @@ void LLChatHistory::clear()
     mLastFromName.clear();
     mEditor->clear();
     mLastFromID = LLUUID::null;
+    mMessageStarts.clear();
+    mLastHeader.reset();
+    mPagedOutText.clear();
+}
+
+void LLChatHistory::pageOutHistory()
+{
+    static LLCachedControl<S32> max_messages(gSavedSettings, "ChatHistoryPageOutMessages", 0);
+    // a quarter more before paging out, so that it is done once in a while rather than for every message
+    if (max_messages <= 0 || (S32)mMessageStarts.size() <= max_messages + max_messages / 4)
+    {
+        return;
+    }
+
+    size_t paged_out = mMessageStarts.size() - max_messages;
+    const MessageStart first = mMessageStarts[paged_out];
+    const LLWString& text = mEditor->getWText();
+    S32 length = llmin(first.mPos, mEditor->getLength());
+    // Everything before the first message kept goes, leaving that message's first
+    // paragraph and those after it as they were laid out
+    std::string paged_text = wstring_to_utf8str(text.substr(0, length));
+
+    // A header or separator's text starts with the newline ending the message before
+    // it. Page that out too and give the message a header of its own: it must not
+    // start with a blank line, nor with a separator following nothing.
+    LLView* header = NULL;
+    std::string header_text;
+    if (first.mHeader && first.mWidgetLength > 1 && length + first.mWidgetLength <= (S32)text.length()
+        && text[length] == '\n')
+    {
+        header = getHeader(first.mHeader->mChat, first.mHeader->mNameParams, first.mHeader->mArgs);
+        if (header)
+        {
+            paged_text += '\n';
+            header_text = wstring_to_utf8str(text.substr(length + 1, first.mWidgetLength - 1));
+            length += first.mWidgetLength;
+        }
+    }
+
+    mPagedOutText += paged_text;
+    if (mPagedOutText.size() > MAX_PAGED_OUT_TEXT)
+    {
+        // drop the oldest whole lines
+        size_t cut = mPagedOutText.find('\n', mPagedOutText.size() - MAX_PAGED_OUT_TEXT);
+        mPagedOutText.erase(0, cut == std::string::npos ? std::string::npos : cut + 1);
+    }
+
+    // text is invalid from here on
+    S32 shift = -mEditor->removeLeadingText(length);
+    mMessageStarts.erase(mMessageStarts.begin(), mMessageStarts.begin() + paged_out);
+    if (header)
+    {
+        bool teleport = first.mHeader->mChat.mSourceType == CHAT_SOURCE_TELEPORT;
+        LLInlineViewSegment::Params p;
+        initWidgetParams(header, 0, teleport ? mBottomSeparatorPad : mBottomHeaderPad, p);
+        mMessageStarts.front().mWidgetLength = mEditor->prependWidget(p, header_text);
+        shift += mMessageStarts.front().mWidgetLength;
+    }
+    for (MessageStart& start : mMessageStarts)
+    {
+        start.mPos += shift;
+    }
+    mMessageStarts.front().mPos = 0;
 }
 
 static LLTrace::BlockTimerStatHandle FTM_APPEND_MESSAGE("Append Chat Message");
@@ -1321,7 +1404,12 @@ void LLChatHistory::appendMessage(const LLChat& chat, const LLSD &args, const LL
         name_params.readonly_color(txt_color);
     }
 
-    bool prependNewLineState = mEditor->getText().size() != 0;
+    pageOutHistory();
+
+    bool prependNewLineState = mEditor->getLength() != 0;
+    // plain text messages start with a newline ending the previous one's last paragraph
+    MessageStart message_start = { mEditor->getLength() + ((use_plain_text_chat_history && prependNewLineState) ? 1 : 0), 0 };
+    mMessageStarts.push_back(message_start);
 
     // compact mode: show a timestamp and name
     if (use_plain_text_chat_history)
@@ -1400,10 +1488,8 @@ void LLChatHistory::appendMessage(const LLChat& chat, const LLSD &args, const LL
     {
         prependNewLineState = false;
         LLView* view = NULL;
-        LLInlineViewSegment::Params p;
-        p.force_newline = true;
-        p.left_pad = mLeftWidgetPad;
-        p.right_pad = mRightWidgetPad;
+        S32 top_pad = 0;
+        S32 bottom_pad = 0;
 
         LLDate new_message_time = LLDate::now();
         if (!teleport_separator
@@ -1421,8 +1507,8 @@ void LLChatHistory::appendMessage(const LLChat& chat, const LLSD &args, const LL
                 return;
             }
 
-            p.top_pad = mTopSeparatorPad;
-            p.bottom_pad = mBottomSeparatorPad;
+            top_pad = mTopSeparatorPad;
+            bottom_pad = mBottomSeparatorPad;
         }
         else
         {
@@ -1433,24 +1519,21 @@ void LLChatHistory::appendMessage(const LLChat& chat, const LLSD &args, const LL
                 return;
             }
 
-            p.top_pad = mEditor->getLength() ? mTopHeaderPad : 0;
-            p.bottom_pad = teleport_separator ? mBottomSeparatorPad : mBottomHeaderPad;
+            top_pad = mEditor->getLength() ? mTopHeaderPad : 0;
+            bottom_pad = teleport_separator ? mBottomSeparatorPad : mBottomHeaderPad;
+            mLastHeader = std::make_shared<HeaderSource>(HeaderSource{ chat, name_params, args });
         }
-        p.view = view;
-
-        //Prepare the rect for the view
-        LLRect target_rect = mEditor->getDocumentView()->getRect();
-        // squeeze down the widget by subtracting padding off left and right
-        target_rect.mLeft += mLeftWidgetPad + mEditor->getHPad();
-        target_rect.mRight -= mRightWidgetPad;
-        view->reshape(target_rect.getWidth(), view->getRect().getHeight());
-        view->setOrigin(target_rect.mLeft, view->getRect().mBottom);
+        LLInlineViewSegment::Params p;
+        initWidgetParams(view, top_pad, bottom_pad, p);
 
         std::string widget_associated_text = "\n[" + chat.mTimeStr + "] ";
         if (utf8str_trim(chat.mFromName).size() != 0 && chat.mFromName != SYSTEM_FROM)
             widget_associated_text += chat.mFromName + delimiter;
 
+        S32 widget_start = mEditor->getLength();
         mEditor->appendWidget(p, widget_associated_text, false);
+        mMessageStarts.back().mWidgetLength = mEditor->getLength() - widget_start;
+        mMessageStarts.back().mHeader = mLastHeader;
         mLastFromName = chat.mFromName;
         mLastFromID = chat.mFromID;
         mLastMessageTime = new_message_time;
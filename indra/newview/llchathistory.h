@@ -31,6 +31,9 @@
 #include "lltextbox.h"
 #include "llviewerchat.h"
 
+#include <deque>
+#include <memory>
+
 //Chat log widget allowing addition of a message as a widget
 class LLChatHistory : public LLUICtrl
 {
@@ -96,12 +99,25 @@ class LLChatHistory : public LLUICtrl
 
         void onClickMoreText();
 
+        /**
+         * Moves the oldest messages out of the editor once there are more
+         * than ChatHistoryPageOutMessages, keeping only the last megabyte of
+         * their plain text for getValue().
+         */
+        void pageOutHistory();
+
     private:
         /**
          * Builds a message header.
          * @return pointer to LLView header object.
          */
         LLView* getHeader(const LLChat& chat,const LLStyle::Params& style_params, const LLSD& args);
+
+        /**
+         * Sizes a header or separator to the editor width and sets up the
+         * inline segment params holding it.
+         */
+        void initWidgetParams(LLView* view, S32 top_pad, S32 bottom_pad, LLInlineViewSegment::Params& p);
     public:
         ~LLChatHistory();
         LLSD getValue() const;
@@ -148,5 +164,28 @@ class LLChatHistory : public LLUICtrl
         LLTextEditor*   mEditor;
         typedef std::set<std::string> unread_chat_source_t;
         unread_chat_source_t mUnreadChatSources;
+
+        // What a header was built from, kept to build it again for a
+        // message left first in the editor
+        struct HeaderSource
+        {
+            LLChat              mChat;
+            LLStyle::Params     mNameParams;
+            LLSD                mArgs;
+        };
+
+        struct MessageStart
+        {
+            S32 mPos;           // editor index of the message's first paragraph
+            S32 mWidgetLength;  // length of the text of its header or separator, if it has one
+            std::shared_ptr<const HeaderSource> mHeader;    // its header, or the one of the messages it follows
+        };
+
+        // Messages still shown, oldest first
+        std::deque<MessageStart> mMessageStarts;
+        std::shared_ptr<const HeaderSource> mLastHeader;
+        // Plain text of the newest messages paged out of the editor; older
+        // ones are only in the chat log on disk
+        std::string     mPagedOutText;
 };
 #endif /* LLCHATHISTORY_H_ */
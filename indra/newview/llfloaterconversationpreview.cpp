@@ -33,6 +33,7 @@
 #include "llfloaterimnearbychat.h"
 #include "llspinctrl.h"
 #include "lltrans.h"
+#include "lltranscriptindex.h"
 #include "llnotificationsutil.h"
 
 const std::string LL_FCP_COMPLETE_NAME("complete_name");
@@ -99,6 +100,7 @@ bool LLFloaterConversationPreview::postBuild()
 
 void LLFloaterConversationPreview::setPages(std::list<LLSD>* messages, const std::string& file_name)
 {
+    LLLoadHistoryThread* loadThread = LLLogChat::getInstance()->getLoadHistoryThread(mSessionID);
     if(file_name == mChatHistoryFileName && messages)
     {
         // additional protection to avoid changes of mMessages in setPages()
@@ -108,7 +110,9 @@ void LLFloaterConversationPreview::setPages(std::list<LLSD>* messages, const std
             delete mMessages; // Clean up temporary message list with "Loading..." text
         }
         mMessages = messages;
-        mCurrentPage = (mMessages->size() ? (static_cast<int>(mMessages->size()) - 1) / mPageSize : 0);
+        mTranscript = loadThread ? loadThread->getTranscript() : nullptr;
+        S32 num_messages = mTranscript ? mTranscript->getMessageCount() : static_cast<int>(mMessages->size());
+        mCurrentPage = (num_messages ? (num_messages - 1) / mPageSize : 0);
 
         mPageSpinner->setEnabled(true);
         mPageSpinner->setMaxValue((F32)(mCurrentPage+1));
@@ -118,7 +122,6 @@ void LLFloaterConversationPreview::setPages(std::list<LLSD>* messages, const std
         getChild<LLTextBox>("page_num_label")->setValue(total_page_num);
         mShowHistory = true;
     }
-    LLLoadHistoryThread* loadThread = LLLogChat::getInstance()->getLoadHistoryThread(mSessionID);
     if (loadThread)
     {
         loadThread->removeLoadEndSignal(boost::bind(&LLFloaterConversationPreview::setPages, this, _1, _2));
@@ -149,10 +152,9 @@ void LLFloaterConversationPreview::onOpen(const LLSD& key)
         closeFloater();
         return;
     }
-    LLSD load_params;
-    load_params["load_all_history"] = true;
-    load_params["cut_off_todays_date"] = false;
-    load_params["is_group"] = mIsGroup;
+    mLoadParams["load_all_history"] = true;
+    mLoadParams["cut_off_todays_date"] = false;
+    mLoadParams["is_group"] = mIsGroup;
 
     // The temporary message list with "Loading..." text
     // Will be deleted upon loading completion in setPages() method
@@ -176,10 +178,11 @@ void LLFloaterConversationPreview::onOpen(const LLSD& key)
     LLLogChat *log_chat_inst = LLLogChat::getInstance();
     log_chat_inst->cleanupHistoryThreads();
 
-    LLLoadHistoryThread* loadThread = new LLLoadHistoryThread(mChatHistoryFileName, messages, load_params);
+    LLLoadHistoryThread* loadThread = new LLLoadHistoryThread(mChatHistoryFileName, messages, mLoadParams);
     loadThread->setLoadEndSignal(boost::bind(&LLFloaterConversationPreview::setPages, this, _1, _2));
-    loadThread->start();
+    // registered before it starts, so that setPages() finds it for the transcript
     log_chat_inst->addLoadHistoryThread(mSessionID, loadThread);
+    loadThread->start();
 
     LLDeleteHistoryThread* deleteThread = new LLDeleteHistoryThread(messages, loadThread);
     log_chat_inst->addDeleteHistoryThread(mSessionID, deleteThread);
@@ -204,20 +207,29 @@ void LLFloaterConversationPreview::showHistory()
 {
     // additional protection to avoid changes of mMessages in setPages
     LLMutexLock lock(&mMutex);
-    if(mMessages == NULL || !mMessages->size() || mCurrentPage * mPageSize >= mMessages->size())
+    std::list<LLSD> page;
+    if (mTranscript)
+    {
+        // only this page's messages are parsed out of the transcript
+        LLLogChat::loadChatHistoryPage(*mTranscript, mCurrentPage * mPageSize, mPageSize, page, mLoadParams);
+    }
+    else if (mMessages && mCurrentPage * mPageSize < mMessages->size())
+    {
+        std::list<LLSD>::const_iterator iter = mMessages->begin();
+        std::advance(iter, mCurrentPage * mPageSize);
+        for (int msg_num = 0; iter != mMessages->end() && msg_num < mPageSize; ++iter, ++msg_num)
+        {
+            page.push_back(*iter);
+        }
+    }
+    if (page.empty())
     {
         return;
     }
 
     mChatHistory->clear();
-    std::ostringstream message;
-    std::list<LLSD>::const_iterator iter = mMessages->begin();
-    std::advance(iter, mCurrentPage * mPageSize);
-
-    for (int msg_num = 0; iter != mMessages->end() && msg_num < mPageSize; ++iter, ++msg_num)
+    for (const LLSD& msg : page)
     {
-        LLSD msg = *iter;
-
         LLUUID from_id      = LLUUID::null;
         std::string time    = msg["time"].asString();
         std::string from    = msg["from"].asString();
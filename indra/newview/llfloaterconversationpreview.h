@@ -33,6 +33,7 @@ extern const std::string LL_FCP_COMPLETE_NAME;  //"complete_name"
 extern const std::string LL_FCP_ACCOUNT_NAME;       //"user_name"
 
 class LLSpinCtrl;
+class LLTranscriptIndex;
 
 class LLFloaterConversationPreview : public LLFloater
 {
@@ -60,6 +61,8 @@ private:
     int             mPageSize;
 
     std::list<LLSD>*    mMessages;
+    std::shared_ptr<LLTranscriptIndex> mTranscript; // pages are parsed from it as they are shown
+    LLSD            mLoadParams;
     std::string     mAccountName;
     std::string     mCompleteName;
     std::string     mChatHistoryFileName;
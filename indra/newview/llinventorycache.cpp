@@ -0,0 +1,592 @@
+/**
+ * @file llinventorycache.cpp
+ * @brief Binary on-disk cache of the inventory skeleton contents.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorycache.h"
+
+#include "llfile.h"
+#include "llviewerinventory.h"
+#include "threadpool.h"
+#include "workqueue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <type_traits>
+
+#ifdef LL_USESYSTEMLIBS
+# include <zlib.h>
+#else
+# include "zlib-ng/zlib.h"
+#endif
+
+static const char * const LOG_INV("Inventory");
+
+namespace
+{
+    // Bump CACHE_FORMAT_VERSION whenever a record layout changes.
+    const char CACHE_MAGIC[8] = { 'L', 'L', 'I', 'N', 'V', 'B', 'I', 'N' };
+    const U32 CACHE_FORMAT_VERSION = 1;
+
+    // Records per chunk. Small enough that a big inventory gives every
+    // worker several chunks, large enough that zlib has something to chew.
+    const U32 RECORDS_PER_CHUNK = 4096;
+
+    // Sanity limit on sizes read back from disk.
+    const U32 MAX_CHUNK_BYTES = 64 * 1024 * 1024;
+
+    enum EChunkKind : U32
+    {
+        CHUNK_END = 0,
+        CHUNK_CATEGORIES = 1,
+        CHUNK_ITEMS = 2
+    };
+
+    struct FileHeader
+    {
+        char mMagic[8];
+        U32 mFormatVersion;
+        S32 mCacheVersion;
+    };
+
+    struct ChunkHeader
+    {
+        U32 mKind;
+        U32 mRecordCount;
+        U32 mRawSize;
+        U32 mPackedSize;
+    };
+
+    // Strings live in a blob after the records of their chunk.
+    struct StringRef
+    {
+        U32 mOffset;
+        U32 mLength;
+    };
+
+    struct CategoryRecord
+    {
+        LLUUID mID;
+        LLUUID mParentID;
+        LLUUID mOwnerID;
+        LLUUID mThumbnailID;
+        S32 mVersion;
+        S8 mType;
+        S8 mPreferredType;
+        U8 mPad[2];
+        StringRef mName;
+    };
+
+    struct ItemRecord
+    {
+        LLUUID mID;
+        LLUUID mParentID;
+        LLUUID mAssetID;
+        LLUUID mThumbnailID;
+        LLUUID mCreatorID;
+        LLUUID mOwnerID;
+        LLUUID mLastOwnerID;
+        LLUUID mGroupID;
+        U32 mMaskBase;
+        U32 mMaskOwner;
+        U32 mMaskGroup;
+        U32 mMaskEveryone;
+        U32 mMaskNext;
+        U32 mFlags;
+        S32 mCreationDate;
+        S32 mSalePrice;
+        S8 mType;
+        S8 mInventoryType;
+        U8 mSaleType;
+        U8 mPad;
+        StringRef mName;
+        StringRef mDescription;
+    };
+
+    static_assert(std::is_trivially_copyable<CategoryRecord>::value, "records are copied as bytes");
+    static_assert(std::is_trivially_copyable<ItemRecord>::value, "records are copied as bytes");
+
+    // Accumulates one chunk worth of records and writes it out compressed.
+    class ChunkWriter
+    {
+    public:
+        ChunkWriter(std::ostream& out, U32 kind)
+        :   mOut(out),
+            mKind(kind),
+            mCount(0)
+        {
+        }
+
+        StringRef addString(const std::string& str)
+        {
+            StringRef ref = { (U32)mStrings.size(), (U32)str.size() };
+            mStrings.insert(mStrings.end(), str.begin(), str.end());
+            return ref;
+        }
+
+        template <typename RECORD>
+        bool addRecord(const RECORD& record)
+        {
+            const U8* bytes = reinterpret_cast<const U8*>(&record);
+            mRecords.insert(mRecords.end(), bytes, bytes + sizeof(RECORD));
+            if (++mCount >= RECORDS_PER_CHUNK)
+            {
+                return flush();
+            }
+            return true;
+        }
+
+        bool flush()
+        {
+            if (!mCount)
+            {
+                return true;
+            }
+            mRecords.insert(mRecords.end(), mStrings.begin(), mStrings.end());
+            uLongf packed_size = compressBound((uLong)mRecords.size());
+            mPacked.resize(packed_size);
+            if (compress2(mPacked.data(), &packed_size, mRecords.data(), (uLong)mRecords.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+            {
+                return false;
+            }
+            ChunkHeader header = { mKind, mCount, (U32)mRecords.size(), (U32)packed_size };
+            mOut.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            mOut.write(reinterpret_cast<const char*>(mPacked.data()), packed_size);
+            mRecords.clear();
+            mStrings.clear();
+            mCount = 0;
+            return !mOut.fail();
+        }
+
+    private:
+        std::ostream& mOut;
+        const U32 mKind;
+        U32 mCount;
+        std::vector<U8> mRecords;
+        std::vector<U8> mStrings;
+        std::vector<U8> mPacked;
+    };
+
+    struct Chunk
+    {
+        ChunkHeader mHeader;
+        const U8* mPacked;
+
+        // decoded on a worker
+        LLInventoryModel::cat_array_t mCategories;
+        LLInventoryModel::item_array_t mItems;
+        LLInventoryModel::changed_items_t mCatsToUpdate;
+        bool mValid = false;
+    };
+
+    bool read_string(const std::vector<U8>& raw, size_t blob_start, const StringRef& ref, std::string& str)
+    {
+        if ((size_t)ref.mOffset + ref.mLength > raw.size() - blob_start)
+        {
+            return false;
+        }
+        const char* begin = reinterpret_cast<const char*>(raw.data() + blob_start + ref.mOffset);
+        str.assign(begin, ref.mLength);
+        return true;
+    }
+
+    template <typename RECORD, typename FUNC>
+    bool decode_records(Chunk& chunk, FUNC func)
+    {
+        const ChunkHeader& header = chunk.mHeader;
+        const size_t blob_start = (size_t)header.mRecordCount * sizeof(RECORD);
+        if (blob_start > header.mRawSize)
+        {
+            return false;
+        }
+        std::vector<U8> raw(header.mRawSize);
+        uLongf raw_size = header.mRawSize;
+        if (uncompress(raw.data(), &raw_size, chunk.mPacked, header.mPackedSize) != Z_OK
+            || raw_size != header.mRawSize)
+        {
+            return false;
+        }
+        RECORD record;
+        for (U32 i = 0; i < header.mRecordCount; ++i)
+        {
+            memcpy(&record, raw.data() + i * sizeof(RECORD), sizeof(RECORD));
+            if (!func(record, raw, blob_start))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool decode_categories(Chunk& chunk)
+    {
+        chunk.mCategories.reserve(chunk.mHeader.mRecordCount);
+        std::string name;
+        return decode_records<CategoryRecord>(chunk,
+            [&](const CategoryRecord& record, const std::vector<U8>& raw, size_t blob_start)
+            {
+                if (!read_string(raw, blob_start, record.mName, name))
+                {
+                    return false;
+                }
+                LLPointer<LLViewerInventoryCategory> cat = new LLViewerInventoryCategory(record.mOwnerID);
+                cat->setUUID(record.mID);
+                cat->setParent(record.mParentID);
+                cat->setType((LLAssetType::EType)record.mType);
+                cat->setPreferredType((LLFolderType::EType)record.mPreferredType);
+                cat->importName(name);
+                cat->setThumbnailUUID(record.mThumbnailID);
+                cat->setVersion(record.mVersion);
+                chunk.mCategories.push_back(cat);
+                return true;
+            });
+    }
+
+    bool decode_items(Chunk& chunk)
+    {
+        chunk.mItems.reserve(chunk.mHeader.mRecordCount);
+        std::string name;
+        std::string desc;
+        return decode_records<ItemRecord>(chunk,
+            [&](const ItemRecord& record, const std::vector<U8>& raw, size_t blob_start)
+            {
+                if (!read_string(raw, blob_start, record.mName, name)
+                    || !read_string(raw, blob_start, record.mDescription, desc))
+                {
+                    return false;
+                }
+                if (record.mID.isNull())
+                {
+                    LL_DEBUGS(LOG_INV) << "Ignoring inventory with null item id: " << name << LL_ENDL;
+                    return true;
+                }
+
+                // Same steps as LLInventoryItem::fromLLSD() on the notation cache,
+                // names and descriptions included.
+                LLPermissions perm;
+                perm.init(record.mCreatorID, record.mOwnerID, record.mLastOwnerID, record.mGroupID);
+                perm.setMaskBase(record.mMaskBase);
+                perm.setMaskOwner(record.mMaskOwner);
+                perm.setMaskEveryone(record.mMaskEveryone);
+                perm.setMaskGroup(record.mMaskGroup);
+                perm.setMaskNext(record.mMaskNext);
+                perm.fix();
+
+                LLPointer<LLViewerInventoryItem> item = new LLViewerInventoryItem;
+                item->fromLLSDBegin();
+                item->setUUID(record.mID);
+                item->setParent(record.mParentID);
+                item->setPermissions(perm);
+                item->setThumbnailUUID(record.mThumbnailID);
+                item->setAssetUUID(record.mAssetID);
+                item->setType((LLAssetType::EType)record.mType);
+                item->setInventoryType((LLInventoryType::EType)record.mInventoryType);
+                item->setFlags(record.mFlags);
+                item->setSaleInfo(LLSaleInfo((LLSaleInfo::EForSale)record.mSaleType, record.mSalePrice));
+                item->importName(name);
+                item->importDescription(desc);
+                item->setCreationDate(record.mCreationDate);
+                item->fromLLSDEnd();
+
+                if (item->getType() == LLAssetType::AT_UNKNOWN)
+                {
+                    chunk.mCatsToUpdate.insert(item->getParentUUID());
+                }
+                else
+                {
+                    chunk.mItems.push_back(item);
+                }
+                return true;
+            });
+    }
+
+    void decode_chunk(Chunk& chunk)
+    {
+        LL_PROFILE_ZONE_SCOPED;
+        if (chunk.mHeader.mKind == CHUNK_CATEGORIES)
+        {
+            chunk.mValid = decode_categories(chunk);
+        }
+        else
+        {
+            chunk.mValid = decode_items(chunk);
+        }
+    }
+
+    // Decode every chunk, sharing the work with idle "General" threads.
+    // The calling thread takes chunks too, so this never waits on a pool
+    // that is busy with something else: helpers that have not started by
+    // the time all chunks are claimed simply do nothing.
+    void decode_chunks(std::vector<Chunk>& chunks)
+    {
+        struct SharedState
+        {
+            std::mutex mMutex;
+            std::condition_variable mCond;
+            S32 mActive = 0;
+            bool mDone = false;
+        };
+        std::shared_ptr<SharedState> state = std::make_shared<SharedState>();
+        std::atomic<size_t> next_chunk(0);
+        auto decode_some = [&chunks, &next_chunk]()
+        {
+            for (size_t i = next_chunk++; i < chunks.size(); i = next_chunk++)
+            {
+                decode_chunk(chunks[i]);
+            }
+        };
+
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        LL::ThreadPool::ptr_t general_pool = LL::ThreadPool::getInstance("General");
+        if (general_queue && general_pool && chunks.size() > 1)
+        {
+            const size_t helpers = llmin(chunks.size() - 1, general_pool->getWidth());
+            for (size_t i = 0; i < helpers; ++i)
+            {
+                general_queue->tryPost([state, decode_some]()
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(state->mMutex);
+                            if (state->mDone)
+                            {
+                                return;
+                            }
+                            ++state->mActive;
+                        }
+                        decode_some();
+                        {
+                            std::lock_guard<std::mutex> lock(state->mMutex);
+                            --state->mActive;
+                        }
+                        state->mCond.notify_all();
+                    });
+            }
+        }
+
+        decode_some();
+
+        std::unique_lock<std::mutex> lock(state->mMutex);
+        state->mDone = true;
+        state->mCond.wait(lock, [&state]() { return state->mActive == 0; });
+    }
+}
+
+// static
+bool LLInventoryCacheFile::save(const std::string& filename,
+                                S32 cache_version,
+                                const LLInventoryModel::cat_array_t& categories,
+                                const LLInventoryModel::item_array_t& items)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    llofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!out.is_open())
+    {
+        LL_WARNS(LOG_INV) << "Failed to open file. Unable to save inventory to: " << filename << LL_ENDL;
+        return false;
+    }
+
+    FileHeader header;
+    memcpy(header.mMagic, CACHE_MAGIC, sizeof(header.mMagic));
+    header.mFormatVersion = CACHE_FORMAT_VERSION;
+    header.mCacheVersion = cache_version;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    S32 cat_count = 0;
+    ChunkWriter cat_writer(out, CHUNK_CATEGORIES);
+    for (auto& cat : categories)
+    {
+        if (cat->getVersion() == LLViewerInventoryCategory::VERSION_UNKNOWN)
+        {
+            continue;
+        }
+        CategoryRecord record = {};
+        record.mID = cat->getUUID();
+        record.mParentID = cat->getParentUUID();
+        record.mOwnerID = cat->getOwnerID();
+        record.mThumbnailID = cat->getThumbnailUUID();
+        record.mVersion = cat->getVersion();
+        record.mType = (S8)cat->getType();
+        record.mPreferredType = (S8)cat->getPreferredType();
+        record.mName = cat_writer.addString(cat->getName());
+        if (!cat_writer.addRecord(record))
+        {
+            LL_WARNS(LOG_INV) << "Failed to write folders. Unable to save inventory to: " << filename << LL_ENDL;
+            return false;
+        }
+        cat_count++;
+    }
+
+    ChunkWriter item_writer(out, CHUNK_ITEMS);
+    for (auto& item : items)
+    {
+        // Raw fields like LLInventoryItem::asLLSD(), links must not be followed.
+        const LLInventoryItem* raw = item.get();
+        const LLPermissions& perm = raw->LLInventoryItem::getPermissions();
+        ItemRecord record = {};
+        record.mID = item->getUUID();
+        record.mParentID = item->getParentUUID();
+        record.mAssetID = raw->LLInventoryItem::getAssetUUID();
+        record.mThumbnailID = raw->LLInventoryObject::getThumbnailUUID();
+        record.mCreatorID = perm.getCreator();
+        record.mOwnerID = perm.getOwner();
+        record.mLastOwnerID = perm.getLastOwner();
+        record.mGroupID = perm.getGroup();
+        record.mMaskBase = perm.getMaskBase();
+        record.mMaskOwner = perm.getMaskOwner();
+        record.mMaskGroup = perm.getMaskGroup();
+        record.mMaskEveryone = perm.getMaskEveryone();
+        record.mMaskNext = perm.getMaskNextOwner();
+        record.mFlags = raw->LLInventoryItem::getFlags();
+        record.mCreationDate = (S32)raw->LLInventoryItem::getCreationDate();
+        record.mSalePrice = raw->LLInventoryItem::getSaleInfo().getSalePrice();
+        record.mType = (S8)raw->getActualType();
+        record.mInventoryType = (S8)raw->LLInventoryItem::getInventoryType();
+        record.mSaleType = (U8)raw->LLInventoryItem::getSaleInfo().getSaleType();
+        record.mName = item_writer.addString(raw->LLInventoryObject::getName());
+        record.mDescription = item_writer.addString(raw->getActualDescription());
+        if (!item_writer.addRecord(record))
+        {
+            LL_WARNS(LOG_INV) << "Failed to write items. Unable to save inventory to: " << filename << LL_ENDL;
+            return false;
+        }
+    }
+
+    ChunkHeader end = { CHUNK_END, 0, 0, 0 };
+    if (!cat_writer.flush() || !item_writer.flush()
+        || !out.write(reinterpret_cast<const char*>(&end), sizeof(end)))
+    {
+        LL_WARNS(LOG_INV) << "Failed to finish file. Unable to save inventory to: " << filename << LL_ENDL;
+        return false;
+    }
+    out.close();
+
+    LL_INFOS(LOG_INV) << "Inventory saved: " << cat_count << " categories, " << (S32)items.size() << " items." << LL_ENDL;
+    return true;
+}
+
+// static
+LLInventoryCacheFile::ELoadResult LLInventoryCacheFile::load(const std::string& filename,
+                                                             S32 cache_version,
+                                                             LLInventoryModel::cat_array_t& categories,
+                                                             LLInventoryModel::item_array_t& items,
+                                                             LLInventoryModel::changed_items_t& cats_to_update)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    llifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!in.is_open())
+    {
+        return LOAD_MISSING;
+    }
+    LL_INFOS(LOG_INV) << "loading inventory from: (" << filename << ")" << LL_ENDL;
+
+    std::vector<U8> data;
+    {
+        LL_PROFILE_ZONE_NAMED("inventory cache read");
+        in.seekg(0, std::ios::end);
+        std::streamoff size = in.tellg();
+        in.seekg(0, std::ios::beg);
+        if (size < (std::streamoff)sizeof(FileHeader))
+        {
+            return LOAD_INVALID;
+        }
+        data.resize((size_t)size);
+        if (!in.read(reinterpret_cast<char*>(data.data()), size))
+        {
+            return LOAD_INVALID;
+        }
+    }
+
+    FileHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.mMagic, CACHE_MAGIC, sizeof(header.mMagic)))
+    {
+        LL_WARNS(LOG_INV) << "Unrecognized inventory cache format in " << filename << LL_ENDL;
+        return LOAD_INVALID;
+    }
+    if (header.mFormatVersion != CACHE_FORMAT_VERSION || header.mCacheVersion != cache_version)
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache is out of date" << LL_ENDL;
+        return LOAD_OBSOLETE;
+    }
+
+    // Index the chunks. The file is only trusted if it ends with CHUNK_END,
+    // an interrupted save leaves no terminator.
+    std::vector<Chunk> chunks;
+    size_t pos = sizeof(FileHeader);
+    bool complete = false;
+    while (pos + sizeof(ChunkHeader) <= data.size())
+    {
+        Chunk chunk;
+        memcpy(&chunk.mHeader, data.data() + pos, sizeof(ChunkHeader));
+        pos += sizeof(ChunkHeader);
+        const ChunkHeader& chunk_header = chunk.mHeader;
+        if (chunk_header.mKind == CHUNK_END)
+        {
+            complete = (pos == data.size());
+            break;
+        }
+        if ((chunk_header.mKind != CHUNK_CATEGORIES && chunk_header.mKind != CHUNK_ITEMS)
+            || chunk_header.mRawSize > MAX_CHUNK_BYTES
+            || chunk_header.mPackedSize > data.size() - pos)
+        {
+            break;
+        }
+        chunk.mPacked = data.data() + pos;
+        pos += chunk_header.mPackedSize;
+        chunks.push_back(std::move(chunk));
+    }
+    if (!complete)
+    {
+        LL_WARNS(LOG_INV) << "Truncated or corrupt inventory cache " << filename << LL_ENDL;
+        return LOAD_INVALID;
+    }
+
+    decode_chunks(chunks);
+
+    size_t cat_count = 0;
+    size_t item_count = 0;
+    for (const Chunk& chunk : chunks)
+    {
+        if (!chunk.mValid)
+        {
+            LL_WARNS(LOG_INV) << "Corrupt chunk in inventory cache " << filename << LL_ENDL;
+            return LOAD_INVALID;
+        }
+        cat_count += chunk.mCategories.size();
+        item_count += chunk.mItems.size();
+    }
+
+    categories.reserve(categories.size() + cat_count);
+    items.reserve(items.size() + item_count);
+    for (const Chunk& chunk : chunks)
+    {
+        categories.insert(categories.end(), chunk.mCategories.begin(), chunk.mCategories.end());
+        items.insert(items.end(), chunk.mItems.begin(), chunk.mItems.end());
+        cats_to_update.insert(chunk.mCatsToUpdate.begin(), chunk.mCatsToUpdate.end());
+    }
+    return LOAD_OK;
+}
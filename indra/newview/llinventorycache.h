@@ -0,0 +1,66 @@
+/**
+ * @file llinventorycache.h
+ * @brief Binary on-disk cache of the inventory skeleton contents.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCACHE_H
+#define LL_LLINVENTORYCACHE_H
+
+#include "llinventorymodel.h"
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventoryCacheFile
+//
+// Binary counterpart of LLInventoryModel::saveToFile()/loadFromFile().
+// The file is a short header followed by independently zlib compressed
+// chunks, each holding fixed-size category or item records plus a blob
+// with their names and descriptions. Chunks are written as they fill up
+// and decoded in parallel on the "General" thread pool when loading.
+// Anything unexpected makes load() fail without touching its outputs, so
+// the caller can fall back to the notation cache.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventoryCacheFile
+{
+public:
+    enum ELoadResult
+    {
+        LOAD_OK,
+        LOAD_MISSING,   // no binary cache on disk
+        LOAD_INVALID,   // unreadable, truncated or not an inventory cache
+        LOAD_OBSOLETE   // written by another cache or file format version
+    };
+
+    static bool save(const std::string& filename,
+                     S32 cache_version,
+                     const LLInventoryModel::cat_array_t& categories,
+                     const LLInventoryModel::item_array_t& items);
+
+    static ELoadResult load(const std::string& filename,
+                            S32 cache_version,
+                            LLInventoryModel::cat_array_t& categories,
+                            LLInventoryModel::item_array_t& items,
+                            LLInventoryModel::changed_items_t& cats_to_update);
+};
+
+#endif // LL_LLINVENTORYCACHE_H
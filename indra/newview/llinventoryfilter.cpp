@@ -30,6 +30,7 @@
 
 // viewer includes
 #include "llagent.h"
+#include "llavatarnamecache.h"
 #include "llfolderviewmodel.h"
 #include "llfolderviewitem.h"
 #include "llinventorymodel.h"
@@ -83,6 +84,9 @@ LLInventoryFilter::LLInventoryFilter(const Params& p)
     mFirstRequiredGeneration(0),
     mFirstSuccessGeneration(0),
     mSearchType(SEARCHTYPE_NAME),
+    mSearchIndexType(SEARCHTYPE_NAME),
+    mSearchIndexGeneration(0),
+    mSearchIndexAnswered(false),
     mSingleFolderMode(false)
 {
     // copy mFilterOps into mDefaultFilterOps
@@ -102,55 +106,62 @@ bool LLInventoryFilter::check(const LLFolderViewModelItem* item)
         return true;
     }
 
-    std::string desc = listener->getSearchableCreatorName();
-    switch (mSearchType)
+    bool passed = true;
+    if (isRuledOutBySearchIndex(listener->getUUID()))
     {
-        case SEARCHTYPE_CREATOR:
-            desc = listener->getSearchableCreatorName();
-            break;
-        case SEARCHTYPE_DESCRIPTION:
-            desc = listener->getSearchableDescription();
-            break;
-        case SEARCHTYPE_UUID:
-            desc = listener->getSearchableUUIDString();
-            break;
-        case SEARCHTYPE_NAME:
-        default:
-            desc = listener->getSearchableName();
-            break;
+        // the index only knows the item name, the label suffix may still match
+        passed = (mSearchType == SEARCHTYPE_NAME) && checkAgainstLabelSuffix(listener);
     }
-
-
-    bool passed = true;
-    if (!mExactToken.empty() && (mSearchType == SEARCHTYPE_NAME))
+    else
     {
-        passed = false;
-        typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
-        boost::char_separator<char> sep(" ");
-        tokenizer tokens(desc, sep);
+        std::string desc;
+        switch (mSearchType)
+        {
+            case SEARCHTYPE_CREATOR:
+                desc = listener->getSearchableCreatorName();
+                break;
+            case SEARCHTYPE_DESCRIPTION:
+                desc = listener->getSearchableDescription();
+                break;
+            case SEARCHTYPE_UUID:
+                desc = listener->getSearchableUUIDString();
+                break;
+            case SEARCHTYPE_NAME:
+            default:
+                desc = listener->getSearchableName();
+                break;
+        }
 
-        for (const auto& token_iter : tokens)
+        if (!mExactToken.empty() && (mSearchType == SEARCHTYPE_NAME))
         {
-            if (token_iter == mExactToken)
+            passed = false;
+            typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+            boost::char_separator<char> sep(" ");
+            tokenizer tokens(desc, sep);
+
+            for (const auto& token_iter : tokens)
             {
-                passed = true;
-                break;
+                if (token_iter == mExactToken)
+                {
+                    passed = true;
+                    break;
+                }
             }
         }
-    }
-    else if (!mFilterTokens.empty() && mSearchType == SEARCHTYPE_NAME)
-    {
-        for (const auto& token_iter : mFilterTokens)
+        else if (!mFilterTokens.empty() && mSearchType == SEARCHTYPE_NAME)
         {
-            if (desc.find(token_iter) == std::string::npos)
+            for (const auto& token_iter : mFilterTokens)
             {
-                return false;
+                if (desc.find(token_iter) == std::string::npos)
+                {
+                    return false;
+                }
             }
         }
-    }
-    else
-    {
-        passed = checkAgainstFilterSubString(desc);
+        else
+        {
+            passed = checkAgainstFilterSubString(desc);
+        }
     }
 
     passed = passed && checkAgainstFilterType(listener);
@@ -304,6 +315,78 @@ bool LLInventoryFilter::checkAgainstFilterSubString(const std::string& desc) con
     return pos != std::string::npos;
 }
 
+bool LLInventoryFilter::checkAgainstLabelSuffix(const LLFolderViewModelItemInventory* listener) const
+{
+    // The searchable name is the display name plus the label suffix, only
+    // look at matches that end inside the suffix.
+    const std::string& searchable = listener->getSearchableName();
+    const size_t name_size = listener->getDisplayName().size();
+    if (searchable.size() <= name_size)
+    {
+        return false;
+    }
+    const size_t start = name_size >= mFilterSubString.size() ? name_size - mFilterSubString.size() + 1 : 0;
+    return searchable.find(mFilterSubString, start) != std::string::npos;
+}
+
+// Returns true if the inventory model's search index shows that the item
+// cannot match the filter string. Objects the index doesn't know about
+// (folders, links, other people's objects) are never ruled out.
+bool LLInventoryFilter::isRuledOutBySearchIndex(const LLUUID& object_id)
+{
+    if (!updateSearchIndexMatches())
+    {
+        return false;
+    }
+    return !mSearchIndexMatches.count(object_id) && gInventory.getSearchIndex().isIndexed(object_id);
+}
+
+bool LLInventoryFilter::updateSearchIndexMatches()
+{
+    if (!mFilterTokens.empty() || !mExactToken.empty() || mSearchType == SEARCHTYPE_UUID)
+    {
+        return false;
+    }
+
+    const LLInventorySearchIndex& index = gInventory.getSearchIndex();
+    if (mSearchIndexGeneration == index.getGeneration()
+        && mSearchIndexType == mSearchType
+        && mSearchIndexSubString == mFilterSubString)
+    {
+        return mSearchIndexAnswered;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+    mSearchIndexGeneration = index.getGeneration();
+    mSearchIndexType = mSearchType;
+    mSearchIndexSubString = mFilterSubString;
+    mSearchIndexMatches.clear();
+    switch (mSearchType)
+    {
+        case SEARCHTYPE_CREATOR:
+            mSearchIndexAnswered = index.findCreator(mFilterSubString, [](const LLUUID& creator_id, std::string& name)
+                {
+                    LLAvatarName av_name;
+                    if (!LLAvatarNameCache::get(creator_id, &av_name))
+                    {
+                        return false;
+                    }
+                    name = av_name.getUserName();
+                    LLStringUtil::toUpper(name);
+                    return true;
+                }, mSearchIndexMatches);
+            break;
+        case SEARCHTYPE_DESCRIPTION:
+            mSearchIndexAnswered = index.findSubString(LLInventorySearchIndex::FIELD_DESCRIPTION, mFilterSubString, mSearchIndexMatches);
+            break;
+        case SEARCHTYPE_NAME:
+        default:
+            mSearchIndexAnswered = index.findSubString(LLInventorySearchIndex::FIELD_NAME, mFilterSubString, mSearchIndexMatches);
+            break;
+    }
+    return mSearchIndexAnswered;
+}
+
 bool LLInventoryFilter::checkAgainstFilterType(const LLFolderViewModelItemInventory* listener) const
 {
     if (!listener)
@@ -30,6 +30,7 @@
 #include "llinventorytype.h"
 #include "llpermissionsflags.h"
 #include "llfolderviewmodel.h"
+#include "llinventorysearchindex.h"
 
 class LLFolderViewItem;
 class LLFolderViewFolder;
@@ -343,6 +344,9 @@ public:
 private:
     bool                areDateLimitsSet() const;
     bool                checkAgainstFilterSubString(const std::string& desc) const;
+    bool                checkAgainstLabelSuffix(const class LLFolderViewModelItemInventory* listener) const;
+    bool                isRuledOutBySearchIndex(const LLUUID& object_id);
+    bool                updateSearchIndexMatches();
     bool                checkAgainstFilterType(const class LLFolderViewModelItemInventory* listener) const;
     bool                checkAgainstFilterType(const LLInventoryItem* item) const;
     bool                checkAgainstPermissions(const class LLFolderViewModelItemInventory* listener) const;
@@ -380,6 +384,14 @@ private:
     std::vector<std::string> mFilterTokens;
     std::string              mExactToken;
 
+    // Items of the inventory model's search index that match the filter
+    // string, refreshed when the string, search type or index change.
+    LLInventorySearchIndex::match_set_t mSearchIndexMatches;
+    std::string             mSearchIndexSubString;
+    ESearchType             mSearchIndexType;
+    U32                     mSearchIndexGeneration;
+    bool                    mSearchIndexAnswered;
+
     bool mSingleFolderMode;
 };
 
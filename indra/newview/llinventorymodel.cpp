@@ -40,6 +40,7 @@
 #include "lldispatcher.h"
 #include "llinventorypanel.h"
 #include "llinventorybridge.h"
+#include "llinventorycache.h"
 #include "llinventoryfunctions.h"
 #include "llinventorymodelbackgroundfetch.h"
 #include "llinventoryobserver.h"
@@ -440,6 +441,9 @@ LLInventoryModel::LLInventoryModel()
     mItemMap(),
     mParentChildCategoryTree(),
     mParentChildItemTree(),
+    mAncestryIndex(),
+    mAncestryIndexMisses(0),
+    mSearchIndex(),
     mLastItem(NULL),
     mIsNotifyObservers(false),
     mModifyMask(LLInventoryObserver::ALL),
@@ -498,6 +502,20 @@ bool LLInventoryModel::isObjectDescendentOf(const LLUUID& obj_id,
 {
     if (obj_id == cat_id) return true;
 
+    if (useAncestryIndex() && mAncestryIndex.isIndexed(cat_id))
+    {
+        // Only categories are numbered, items start from their folder.
+        if (mAncestryIndex.isIndexed(obj_id))
+        {
+            return mAncestryIndex.isDescendentOf(obj_id, cat_id);
+        }
+        const LLViewerInventoryItem* item = getItem(obj_id);
+        if (item && mAncestryIndex.isIndexed(item->getParentUUID()))
+        {
+            return mAncestryIndex.isDescendentOf(item->getParentUUID(), cat_id);
+        }
+    }
+
     const LLInventoryObject* obj = getObject(obj_id);
     while(obj)
     {
@@ -517,6 +535,63 @@ bool LLInventoryModel::isObjectDescendentOf(const LLUUID& obj_id,
     return false;
 }
 
+// Rebuilding costs a walk over every folder, so while the index is stale
+// queries fall back to parent walks until enough of them have piled up;
+// a burst of folder moves would otherwise rebuild it once per move.
+static const U32 ANCESTRY_INDEX_REBUILD_MISSES = 32;
+
+bool LLInventoryModel::useAncestryIndex() const
+{
+    if (mAncestryIndex.isValid())
+    {
+        return true;
+    }
+    if (++mAncestryIndexMisses < ANCESTRY_INDEX_REBUILD_MISSES)
+    {
+        return false;
+    }
+    rebuildAncestryIndex();
+    return true;
+}
+
+void LLInventoryModel::rebuildAncestryIndex() const
+{
+    LL_PROFILE_ZONE_SCOPED;
+    mAncestryIndexMisses = 0;
+    uuid_vec_t roots;
+    if (const cat_array_t* root_cats = get_ptr_in_map(mParentChildCategoryTree, LLUUID::null))
+    {
+        for (const auto& cat : *root_cats)
+        {
+            roots.push_back(cat->getUUID());
+        }
+    }
+    mAncestryIndex.rebuild(roots, [this](const LLUUID& parent_id, uuid_vec_t& children)
+        {
+            if (const cat_array_t* cats = get_ptr_in_map(mParentChildCategoryTree, parent_id))
+            {
+                for (const auto& cat : *cats)
+                {
+                    children.push_back(cat->getUUID());
+                }
+            }
+        });
+}
+
+void LLInventoryModel::updateSearchIndex(const LLViewerInventoryItem* item)
+{
+    if (!item || item->getIsLinkType())
+    {
+        return;
+    }
+    // Same upper casing as the folder view bridges and the filter string.
+    std::string name = item->getName();
+    LLStringUtil::toUpper(name);
+    std::string desc = item->getDescription();
+    LLStringUtil::toUpper(desc);
+    mSearchIndex.setItem(item->getUUID(), name, desc, item->getCreatorUUID());
+}
+
 const LLViewerInventoryCategory *LLInventoryModel::getFirstNondefaultParent(const LLUUID& obj_id) const
 {
     const LLInventoryObject* obj = getObject(obj_id);
@@ -1278,6 +1353,48 @@ void LLInventoryModel::collectDescendentsIf(const LLUUID& id,
         if(trash_id.notNull() && (trash_id == id))
             return;
     }
+
+    if (useAncestryIndex() && mAncestryIndex.isIndexed(id))
+    {
+        // All folders below id are one contiguous range of the index,
+        // no need to recurse. Like the recursive version, the trash
+        // folder itself is offered to the functor but not its contents.
+        const LLUUID trash_id = include_trash ? LLUUID::null : findCategoryUUIDForType(LLFolderType::FT_TRASH);
+        auto add_items = [&](const LLUUID& cat_id)
+        {
+            if (item_array_t* item_array = get_ptr_in_map(mParentChildItemTree, cat_id))
+            {
+                for (auto& item : *item_array)
+                {
+                    if (add(NULL, item))
+                    {
+                        items.push_back(item);
+                    }
+                }
+            }
+        };
+        add_items(id);
+        mAncestryIndex.forEachDescendent(id, [&](const LLUUID& cat_id)
+            {
+                LLViewerInventoryCategory* cat = getCategory(cat_id);
+                if (!cat)
+                {
+                    return false;
+                }
+                if (add(cat, NULL))
+                {
+                    cats.push_back(cat);
+                }
+                if (trash_id.notNull() && cat_id == trash_id)
+                {
+                    return false;
+                }
+                add_items(cat_id);
+                return true;
+            });
+        return;
+    }
+
     cat_array_t* cat_array = get_ptr_in_map(mParentChildCategoryTree, id);
     if(cat_array)
     {
@@ -1617,6 +1734,7 @@ U32 LLInventoryModel::updateItem(const LLViewerInventoryItem* item, U32 mask)
     {
         mask |= LLInventoryObserver::GESTURE;
     }
+    updateSearchIndex(new_item);
     addChangedMask(mask, new_item->getUUID());
     return mask;
 }
@@ -1676,6 +1794,7 @@ void LLInventoryModel::updateCategory(const LLViewerInventoryCategory* cat, U32
             {
                 cat_array->push_back(old_cat);
             }
+            mAncestryIndex.invalidate();
             mask |= LLInventoryObserver::STRUCTURE;
             mask |= LLInventoryObserver::INTERNAL;
         }
@@ -1705,6 +1824,7 @@ void LLInventoryModel::updateCategory(const LLViewerInventoryCategory* cat, U32
         if(cat_array)
         {
             cat_array->push_back(new_cat);
+            mAncestryIndex.insertLeaf(new_cat->getUUID(), cat->getParentUUID());
         }
 
         // make space in the tree for this category's children.
@@ -1744,6 +1864,7 @@ void LLInventoryModel::moveObject(const LLUUID& object_id, const LLUUID& cat_id)
         cat_array = getUnlockedCatArray(cat_id);
         cat->setParent(cat_id);
         if(cat_array) cat_array->push_back(cat);
+        mAncestryIndex.invalidate();
         addChangedMask(LLInventoryObserver::STRUCTURE, object_id);
         return;
     }
@@ -1873,6 +1994,7 @@ void LLInventoryModel::onItemUpdated(const LLUUID& item_id, const LLSD& updates,
             }
         }
         mask |= LLInventoryObserver::INTERNAL;
+        updateSearchIndex(item);
         addChangedMask(mask, item->getUUID());
         if (update_parent_version)
         {
@@ -2044,6 +2166,8 @@ void LLInventoryModel::deleteObject(const LLUUID& id, bool fix_broken_links, boo
     LLUUID parent_id = obj->getParentUUID();
     mCategoryMap.erase(id);
     mItemMap.erase(id);
+    mAncestryIndex.remove(id);
+    mSearchIndex.removeItem(id);
     //mInventory.erase(id);
     item_array_t* item_list = getUnlockedItemArray(parent_id);
     if(item_list)
@@ -2078,6 +2202,8 @@ void LLInventoryModel::deleteObject(const LLUUID& id, bool fix_broken_links, boo
         if (cat_list->size())
         {
             LL_WARNS(LOG_INV) << "Deleting cat " << id << " while it still has child cats" << LL_ENDL;
+            // orphaned children are still numbered below the deleted folder
+            mAncestryIndex.invalidate();
         }
         delete cat_list;
         mParentChildCategoryTree.erase(id);
@@ -2181,6 +2307,17 @@ void LLInventoryModel::notifyObservers()
     }
 
     mIsNotifyObservers = true;
+
+    // Items are also renamed or described directly by code that only
+    // reports the change, pick those up before the views refilter.
+    if (mModifyMask & (LLInventoryObserver::LABEL | LLInventoryObserver::INTERNAL))
+    {
+        for (const LLUUID& id : mChangedItemIDs)
+        {
+            updateSearchIndex(getItem(id));
+        }
+    }
+
     for (observer_list_t::iterator iter = mObservers.begin();
          iter != mObservers.end(); )
     {
@@ -2366,16 +2503,47 @@ void LLInventoryModel::cache(
         items,
         INCLUDE_TRASH,
         can_cache);
+    std::string gzip_filename = getInvCacheAddres(agent_id);
+    std::string binary_filename = gzip_filename;
+    gzip_filename.append(".gz");
+    binary_filename.append(".bin");
+
+    static LLCachedControl<bool> binary_cache(gSavedSettings, "InventoryCacheBinary", true);
+    if (binary_cache)
+    {
+        // Written next to the final name and renamed into place, so a
+        // reader never sees a half written cache. rename() will not
+        // replace an existing file on Windows.
+        std::string temp_file = binary_filename + ".tmp";
+        bool saved = LLInventoryCacheFile::save(temp_file, sCurrentInvCacheVersion, categories, items);
+        if (saved)
+        {
+            LLFile::remove(binary_filename, ENOENT);
+            saved = (LLFile::rename(temp_file, binary_filename) == 0);
+        }
+        if (saved)
+        {
+            // the notation cache would only be stale from now on
+            LLFile::remove(gzip_filename, ENOENT);
+        }
+        else
+        {
+            LL_WARNS(LOG_INV) << "Unable to save binary inventory cache " << binary_filename << LL_ENDL;
+            LLFile::remove(temp_file, ENOENT);
+        }
+        return;
+    }
+
     // Use temporary file to avoid potential conflicts with other
     // instances (even a 'read only' instance unzips into a file)
     std::string temp_file = gDirUtilp->getTempFilename();
     saveToFile(temp_file, categories, items);
-    std::string gzip_filename = getInvCacheAddres(agent_id);
-    gzip_filename.append(".gz");
     if(gzip_file(temp_file, gzip_filename))
     {
         LL_DEBUGS(LOG_INV) << "Successfully compressed " << temp_file << " to " << gzip_filename << LL_ENDL;
         LLFile::remove(temp_file);
+        // a binary cache left from earlier would shadow this one
+        LLFile::remove(binary_filename, ENOENT);
     }
     else
     {
@@ -2533,6 +2701,7 @@ void LLInventoryModel::addItem(LLViewerInventoryItem* item)
             addBacklinkInfo(link_id, target_id);
         }
         mItemMap[item->getUUID()] = item;
+        updateSearchIndex(item);
     }
 }
 
@@ -2553,6 +2722,8 @@ void LLInventoryModel::empty()
     mBacklinkMMap.clear(); // forget all backlink information.
     mCategoryMap.clear(); // remove all references (should delete entries)
     mItemMap.clear(); // remove all references (should delete entries)
+    mAncestryIndex.clear();
+    mSearchIndex.clear();
     mLastItem = NULL;
     //mInventory.clear();
 }
@@ -2737,37 +2908,62 @@ bool LLInventoryModel::loadSkeleton(
         const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
         std::string gzip_filename(inventory_filename);
         gzip_filename.append(".gz");
-        LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+        std::string binary_filename(inventory_filename);
+        binary_filename.append(".bin");
+        bool is_cache_obsolete = false;
+        bool cache_loaded = false;
         bool remove_inventory_file = false;
-        if (LLAppViewer::instance()->isSecondInstance())
+
+        // Prefer the binary cache, fall back to the notation one if it is
+        // missing or unusable.
+        static LLCachedControl<bool> binary_cache(gSavedSettings, "InventoryCacheBinary", true);
+        if (binary_cache)
         {
-            // Safeguard viewer against trying to unpack file twice
-            // ex: user logs into two accounts simultaneously, so two
-            // viewers are trying to unpack library into same file
-            //
-            // Would be better to do it in gunzip_file, but it doesn't
-            // have access to llfilesystem
-            inventory_filename = gDirUtilp->getTempFilename();
-            remove_inventory_file = true;
+            LLInventoryCacheFile::ELoadResult result =
+                LLInventoryCacheFile::load(binary_filename, sCurrentInvCacheVersion, categories, items, categories_to_update);
+            cache_loaded = (result == LLInventoryCacheFile::LOAD_OK);
+            if ((result == LLInventoryCacheFile::LOAD_INVALID || result == LLInventoryCacheFile::LOAD_OBSOLETE)
+                && !LLAppViewer::instance()->isSecondInstance())
+            {
+                LL_WARNS(LOG_INV) << "Binary inventory cache unusable, removing" << LL_ENDL;
+                LLFile::remove(binary_filename);
+            }
         }
-        if(fp)
+
+        if (!cache_loaded)
         {
-            fclose(fp);
-            fp = NULL;
-            if(gunzip_file(gzip_filename, inventory_filename))
+            LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+            if (LLAppViewer::instance()->isSecondInstance())
             {
-                // we only want to remove the inventory file if it was
-                // gzipped before we loaded, and we successfully
-                // gunziped it.
+                // Safeguard viewer against trying to unpack file twice
+                // ex: user logs into two accounts simultaneously, so two
+                // viewers are trying to unpack library into same file
+                //
+                // Would be better to do it in gunzip_file, but it doesn't
+                // have access to llfilesystem
+                inventory_filename = gDirUtilp->getTempFilename();
                 remove_inventory_file = true;
             }
-            else
+            if(fp)
             {
-                LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+                fclose(fp);
+                fp = NULL;
+                if(gunzip_file(gzip_filename, inventory_filename))
+                {
+                    // we only want to remove the inventory file if it was
+                    // gzipped before we loaded, and we successfully
+                    // gunziped it.
+                    remove_inventory_file = true;
+                }
+                else
+                {
+                    LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+                }
             }
+            cache_loaded = loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete);
         }
-        bool is_cache_obsolete = false;
-        if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+
+        if (cache_loaded)
         {
             LL_PROFILE_ZONE_NAMED("loadFromFile");
             // We were able to find a cache of files. So, use what we
@@ -3097,6 +3293,9 @@ void LLInventoryModel::buildParentChildMap()
         }
     }
 
+    // The category tree is complete, number it for ancestry queries.
+    rebuildAncestryIndex();
+
     const bool COF_exists = (findCategoryUUIDForType(LLFolderType::FT_CURRENT_OUTFIT) != LLUUID::null);
     sFirstTimeInViewer2 = !COF_exists || gAgent.isFirstLogin();
 
@@ -3359,6 +3558,252 @@ bool LLUUIDAndName::operator>(const LLUUIDAndName& rhs) const
     return (mID > rhs.mID);
 }
 
+namespace
+{
+    // Builds inventory objects from the records of an inventory cache file
+    // as they are parsed, instead of parsing each record into an LLSD map
+    // first. Every record is a top level map; its fields are handed to the
+    // item or category one at a time, and only nested values (permissions,
+    // sale info, thumbnails) are assembled into LLSD.
+    class LLInventoryCacheReader : public LLSDSAXHandler
+    {
+    public:
+        LLInventoryCacheReader(S32 cache_version,
+                               LLInventoryModel::cat_array_t& categories,
+                               LLInventoryModel::item_array_t& items,
+                               LLInventoryModel::changed_items_t& cats_to_update) :
+            mCacheVersion(cache_version),
+            mCategories(categories),
+            mItems(items),
+            mCatsToUpdate(cats_to_update),
+            mCacheObsolete(true),
+            mDepth(0),
+            mInRecord(false),
+            mKind(RECORD_UNKNOWN),
+            mItemValid(false),
+            mHasVersion(false),
+            mVersion(0)
+        {
+        }
+
+        bool isCacheObsolete() const { return mCacheObsolete; }
+
+        bool mapBegin() override
+        {
+            if (mDepth++ == 0)
+            {
+                beginRecord();
+                return true;
+            }
+            return mValue.mapBegin();
+        }
+
+        bool mapKey(const std::string& key) override
+        {
+            if (mDepth == 1)
+            {
+                mKey = key;
+                mValue.reset();
+                return true;
+            }
+            return mValue.mapKey(key);
+        }
+
+        bool mapEnd() override
+        {
+            if (--mDepth == 0)
+            {
+                return endRecord();
+            }
+            mValue.mapEnd();
+            return valueDone();
+        }
+
+        bool arrayBegin() override
+        {
+            if (mDepth++ == 0)
+            {
+                // not a record, skip it
+                mInRecord = false;
+            }
+            return mValue.arrayBegin();
+        }
+
+        bool arrayEnd() override
+        {
+            --mDepth;
+            mValue.arrayEnd();
+            return valueDone();
+        }
+
+        bool undefValue() override                  { mValue.undefValue(); return valueDone(); }
+        bool booleanValue(LLSD::Boolean v) override { mValue.booleanValue(v); return valueDone(); }
+        bool integerValue(LLSD::Integer v) override { mValue.integerValue(v); return valueDone(); }
+        bool realValue(LLSD::Real v) override       { mValue.realValue(v); return valueDone(); }
+        bool stringValue(LLSD::String& v) override  { mValue.stringValue(v); return valueDone(); }
+        bool uuidValue(const LLSD::UUID& v) override { mValue.uuidValue(v); return valueDone(); }
+        bool dateValue(const LLSD::Date& v) override { mValue.dateValue(v); return valueDone(); }
+        bool uriValue(const LLSD::URI& v) override  { mValue.uriValue(v); return valueDone(); }
+        bool binaryValue(LLSD::Binary& v) override  { mValue.binaryValue(v); return valueDone(); }
+
+    private:
+        enum ERecordKind
+        {
+            RECORD_UNKNOWN,
+            RECORD_CATEGORY,
+            RECORD_ITEM
+        };
+
+        void beginRecord()
+        {
+            mInRecord = true;
+            mKind = RECORD_UNKNOWN;
+            mItemValid = false;
+            mHasVersion = false;
+            mPending.clear();
+            mCategory = NULL;
+            mItem = NULL;
+        }
+
+        // Called whenever a value completes; only values of record fields
+        // (depth 1 of a top level map) are of interest.
+        bool valueDone()
+        {
+            if (mDepth == 1 && mInRecord)
+            {
+                field(mKey, mValue.getLLSD());
+            }
+            return true;
+        }
+
+        void field(const std::string& key, const LLSD& value)
+        {
+            if (key == "inv_cache_version")
+            {
+                mHasVersion = true;
+                mVersion = value.asInteger();
+                return;
+            }
+
+            if (mKind == RECORD_UNKNOWN)
+            {
+                if (key == "cat_id")
+                {
+                    mKind = RECORD_CATEGORY;
+                    mCategory = new LLViewerInventoryCategory(LLUUID::null);
+                }
+                else if (key == "item_id")
+                {
+                    mKind = RECORD_ITEM;
+                    mItem = new LLViewerInventoryItem;
+                    mItem->fromLLSDBegin();
+                    mItemValid = true;
+                }
+                else
+                {
+                    // the record type is not known yet, hold on to the field
+                    mPending.emplace_back(key, value);
+                    return;
+                }
+
+                for (const auto& pending : mPending)
+                {
+                    applyField(pending.first, pending.second);
+                }
+                mPending.clear();
+            }
+
+            applyField(key, value);
+        }
+
+        void applyField(const std::string& key, const LLSD& value)
+        {
+            if (mKind == RECORD_CATEGORY)
+            {
+                mCategory->importLLSDField(key, value);
+            }
+            else if (mItemValid)
+            {
+                mItemValid = mItem->fromLLSDField(key, value);
+            }
+        }
+
+        // Returns false to stop reading the cache.
+        bool endRecord()
+        {
+            mInRecord = false;
+
+            if (mHasVersion)
+            {
+                if (mVersion == mCacheVersion)
+                {
+                    // Cache is up to date
+                    mCacheObsolete = false;
+                    return true;
+                }
+                LL_WARNS(LOG_INV) << "Inventory cache is out of date" << LL_ENDL;
+                return false;
+            }
+
+            if (mKind == RECORD_CATEGORY)
+            {
+                if (mCacheObsolete)
+                {
+                    return false;
+                }
+                mCategories.push_back(mCategory);
+            }
+            else if (mKind == RECORD_ITEM)
+            {
+                if (mCacheObsolete)
+                {
+                    return false;
+                }
+                if (mItemValid)
+                {
+                    mItem->fromLLSDEnd();
+                    if (mItem->getUUID().isNull())
+                    {
+                        LL_DEBUGS(LOG_INV) << "Ignoring inventory with null item id: "
+                            << mItem->getName() << LL_ENDL;
+                    }
+                    else if (mItem->getType() == LLAssetType::AT_UNKNOWN)
+                    {
+                        mCatsToUpdate.insert(mItem->getParentUUID());
+                    }
+                    else
+                    {
+                        mItems.push_back(mItem);
+                    }
+                }
+            }
+
+            mCategory = NULL;
+            mItem = NULL;
+            return true;
+        }
+
+        const S32 mCacheVersion;
+        LLInventoryModel::cat_array_t& mCategories;
+        LLInventoryModel::item_array_t& mItems;
+        LLInventoryModel::changed_items_t& mCatsToUpdate;
+        bool mCacheObsolete;
+
+        S32 mDepth;
+        bool mInRecord;
+        std::string mKey;
+        LLSDSAXBuilder mValue;
+
+        ERecordKind mKind;
+        LLPointer<LLViewerInventoryCategory> mCategory;
+        LLPointer<LLViewerInventoryItem> mItem;
+        bool mItemValid;
+        bool mHasVersion;
+        S32 mVersion;
+        std::vector<std::pair<std::string, LLSD> > mPending;
+    };
+}
+
 // static
 bool LLInventoryModel::loadFromFile(const std::string& filename,
                                     LLInventoryModel::cat_array_t& categories,
@@ -3385,70 +3830,23 @@ bool LLInventoryModel::loadFromFile(const std::string& filename,
 
     is_cache_obsolete = true; // Obsolete until proven current
 
+    // Records are read straight off the file by an event parse, so no
+    // per-line string or LLSD map is built for each item.
+    LLInventoryCacheReader reader(sCurrentInvCacheVersion, categories, items, cats_to_update);
     //U64 lines_count = 0U;
-    std::string line;
     LLPointer<LLSDParser> parser = new LLSDNotationParser();
-    while (std::getline(file, line))
+    while (file.good())
     {
-        LLSD s_item;
-        std::istringstream iss(line);
-        if (parser->parse(iss, s_item, line.length()) == LLSDParser::PARSE_FAILURE)
+        S32 count = parser->parse(file, reader, LLSDSerialize::SIZE_UNLIMITED);
+        if (count == LLSDParser::PARSE_FAILURE)
         {
             LL_WARNS(LOG_INV)<< "Parsing inventory cache failed" << LL_ENDL;
             break;
         }
-
-        if (s_item.has("inv_cache_version"))
+        if (count <= 0)
         {
-            S32 version = s_item["inv_cache_version"].asInteger();
-            if (version == sCurrentInvCacheVersion)
-            {
-                // Cache is up to date
-                is_cache_obsolete = false;
-                continue;
-            }
-            else
-            {
-                LL_WARNS(LOG_INV)<< "Inventory cache is out of date" << LL_ENDL;
-                break;
-            }
-        }
-        else if (s_item.has("cat_id"))
-        {
-            if (is_cache_obsolete)
-                break;
-
-            LLPointer<LLViewerInventoryCategory> inv_cat = new LLViewerInventoryCategory(LLUUID::null);
-            if(inv_cat->importLLSD(s_item))
-            {
-                categories.push_back(inv_cat);
-            }
-        }
-        else if (s_item.has("item_id"))
-        {
-            if (is_cache_obsolete)
-                break;
-
-            LLPointer<LLViewerInventoryItem> inv_item = new LLViewerInventoryItem;
-            if( inv_item->fromLLSD(s_item) )
-            {
-                if(inv_item->getUUID().isNull())
-                {
-                    LL_DEBUGS(LOG_INV) << "Ignoring inventory with null item id: "
-                        << inv_item->getName() << LL_ENDL;
-                }
-                else
-                {
-                    if (inv_item->getType() == LLAssetType::AT_UNKNOWN)
-                    {
-                        cats_to_update.insert(inv_item->getParentUUID());
-                    }
-                    else
-                    {
-                        items.push_back(inv_item);
-                    }
-                }
-            }
+            // end of file, or the reader stopped on an obsolete cache
+            break;
         }
 
 //      TODO(brad) - figure out how to reenable this without breaking everything else
@@ -3459,6 +3857,7 @@ bool LLInventoryModel::loadFromFile(const std::string& filename,
 //          pump_idle_startup_network();
 //      }
     }
+    is_cache_obsolete = reader.isCacheObsolete();
 
     file.close();
 
@@ -30,11 +30,14 @@
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "llassettype.h"
 #include "llfoldertype.h"
 #include "llframetimer.h"
+#include "llinventoryancestry.h"
+#include "llinventorysearchindex.h"
 #include "lluuid.h"
 #include "llpermissionsflags.h"
 #include "llviewerinventory.h"
@@ -202,15 +205,31 @@ private:
     // the inventory using several different identifiers.
     // mInventory member data is the 'master' list of inventory, and
     // mCategoryMap and mItemMap store uuid->object mappings.
-    typedef std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
-    typedef std::map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+    typedef std::unordered_map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
+    typedef std::unordered_map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
     cat_map_t mCategoryMap;
     item_map_t mItemMap;
     // This last set of indices is used to map parents to children.
-    typedef std::map<LLUUID, cat_array_t*> parent_cat_map_t;
-    typedef std::map<LLUUID, item_array_t*> parent_item_map_t;
+    typedef std::unordered_map<LLUUID, cat_array_t*> parent_cat_map_t;
+    typedef std::unordered_map<LLUUID, item_array_t*> parent_item_map_t;
     parent_cat_map_t mParentChildCategoryTree;
     parent_item_map_t mParentChildItemTree;
+    // Interval numbering of the category tree for O(1) ancestry tests.
+    // Rebuilt lazily after anything other than a new leaf folder changes
+    // the tree, see useAncestryIndex().
+    mutable LLInventoryAncestryIndex mAncestryIndex;
+    mutable U32 mAncestryIndexMisses;
+    bool useAncestryIndex() const;
+    void rebuildAncestryIndex() const;
+
+    // Trigram index of item names and descriptions for the inventory
+    // filter. Links are left out, their searchable strings come from
+    // whatever they point to.
+    LLInventorySearchIndex mSearchIndex;
+    void updateSearchIndex(const LLViewerInventoryItem* item);
+public:
+    const LLInventorySearchIndex& getSearchIndex() const { return mSearchIndex; }
+private:
 
     // Track links to items and categories. We do not store item or
     // category pointers here, because broken links are also supported.
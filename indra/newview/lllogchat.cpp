@@ -31,6 +31,7 @@
 #include "llavatarnamecache.h"
 #include "lllogchat.h"
 #include "llregex.h"
+#include "lltranscriptindex.h"
 #include "lltrans.h"
 #include "llviewercontrol.h"
 
@@ -62,7 +63,6 @@ const static std::string IM_SEPARATOR(std::string() + IM_SYMBOL_SEPARATOR + " ")
 const static std::string NEW_LINE("\n");
 const static std::string NEW_LINE_SPACE_PREFIX("\n ");
 const static std::string TWO_SPACES("  ");
-const static std::string MULTI_LINE_PREFIX(" ");
 
 /**
  *  Chat log lines - timestamp and name are optional but message text is mandatory.
@@ -112,15 +112,6 @@ const static int IDX_TEXT = 3;
 using namespace boost::posix_time;
 using namespace boost::gregorian;
 
-void append_to_last_message(std::list<LLSD>& messages, const std::string& line)
-{
-    if (!messages.size()) return;
-
-    std::string im_text = messages.back()[LL_IM_TEXT].asString();
-    im_text.append(line);
-    messages.back()[LL_IM_TEXT] = im_text;
-}
-
 const char* remove_utf8_bom(const char* buf)
 {
     const char* start = buf;
@@ -432,9 +423,9 @@ void LLLogChat::loadChatHistory(const std::string& file_name, std::list<LLSD>& m
     }
 
     // If we got here, we managed to stat the file.
-    // Open the file to read
-    LLFILE* fptr = LLFile::fopen(log_file_name, "r");       /*Flawfinder: ignore*/
-    if (!fptr)
+    // Map the file to read
+    LLTranscriptIndex transcript;
+    if (!transcript.open(log_file_name))
     {   // Ok, this is strange but not really tragic in the big picture of things
         LL_WARNS("ChatHistory") << "Unable to read file " << log_file_name << " after stat was successful" << LL_ENDL;
         return;
@@ -442,60 +433,42 @@ void LLLogChat::loadChatHistory(const std::string& file_name, std::list<LLSD>& m
 
     auto save_num_messages = messages.size();
 
-    char buffer[LOG_RECALL_SIZE];       /*Flawfinder: ignore*/
-    char *bptr;
-    size_t len;
-    bool firstline = true;
-
-    if (load_all_history || fseek(fptr, (LOG_RECALL_SIZE - 1) * -1  , SEEK_END))
-    {   //We need to load the whole historyFile or it's smaller than recall size, so get it all.
-        firstline = false;
-        if (fseek(fptr, 0, SEEK_SET))
-        {
-            fclose(fptr);
-            return;
-        }
+    if (load_all_history)
+    {
+        transcript.buildIndex();
     }
-    while (fgets(buffer, LOG_RECALL_SIZE, fptr)  && !feof(fptr))
+    else
     {
-        len = strlen(buffer) - 1;       /*Flawfinder: ignore*/
-        // backfill any end of line characters with nulls
-        for (bptr = (buffer + len); (*bptr == '\n' || *bptr == '\r') && bptr>buffer; bptr--)    *bptr='\0';
-
-        if (firstline)
-        {
-            firstline = false;
-            continue;
-        }
+        transcript.buildTailIndex(LOG_RECALL_SIZE - 1);
+    }
+    loadChatHistoryPage(transcript, 0, transcript.getMessageCount(), messages, load_params);
 
-        std::string line(remove_utf8_bom(buffer));
+    LL_DEBUGS("ChatHistory") << "Read " << (messages.size() - save_num_messages)
+        << " messages of chat history from " << log_file_name
+        << " file mod time " << (F64)stat_data.st_mtime << LL_ENDL;
+}
 
-        //updated 1.23 plain text log format requires a space added before subsequent lines in a multilined message
-        if (' ' == line[0])
-        {
-            line.erase(0, MULTI_LINE_PREFIX.length());
-            append_to_last_message(messages, '\n' + line);
-        }
-        else if (0 == len && ('\n' == line[0] || '\r' == line[0]))
+// static
+void LLLogChat::loadChatHistoryPage(const LLTranscriptIndex& transcript, S32 first, S32 count, std::list<LLSD>& messages, const LLSD& load_params)
+{
+    std::string line;
+    std::string more_lines;
+    S32 last = llmin(first + count, transcript.getMessageCount());
+    for (S32 index = llmax(first, 0); index < last; index++)
+    {
+        transcript.getMessage(index, line, more_lines);
+        LLSD item;
+        if (!LLChatLogParser::parse(line, item, load_params))
         {
-            //to support old format's multilined messages with new lines used to divide paragraphs
-            append_to_last_message(messages, line);
+            item[LL_IM_TEXT] = line;
         }
-        else
+        //updated 1.23 plain text log format requires a space added before subsequent lines in a multilined message
+        if (!more_lines.empty())
         {
-            LLSD item;
-            if (!LLChatLogParser::parse(line, item, load_params))
-            {
-                item[LL_IM_TEXT] = line;
-            }
-            messages.push_back(item);
+            item[LL_IM_TEXT] = item[LL_IM_TEXT].asString() + more_lines;
         }
+        messages.push_back(item);
     }
-    fclose(fptr);
-
-    LL_DEBUGS("ChatHistory") << "Read " << (messages.size() - save_num_messages)
-        << " messages of chat history from " << log_file_name
-        << " file mod time " << (F64)stat_data.st_mtime << LL_ENDL;
 }
 
 bool LLLogChat::historyThreadsFinished(LLUUID session_id)
@@ -1135,8 +1108,8 @@ void LLLoadHistoryThread::run()
     if(mNewLoad)
     {
         loadHistory(mFileName, mMessages, mLoadParams);
-        auto count = mMessages->size();
-        LL_INFOS() << "mMessages->size(): " << count << LL_ENDL;
+        S32 count = mTranscript ? mTranscript->getMessageCount() : (S32)mMessages->size();
+        LL_INFOS() << "Messages indexed: " << count << LL_ENDL;
         setFinished();
     }
 }
@@ -1150,28 +1123,26 @@ void LLLoadHistoryThread::loadHistory(const std::string& file_name, std::list<LL
     }
 
     bool load_all_history = load_params.has("load_all_history") ? load_params["load_all_history"].asBoolean() : false;
-    LLFILE* fptr = LLFile::fopen(LLLogChat::makeLogFileName(file_name), "r");/*Flawfinder: ignore*/
+    mTranscript = std::make_shared<LLTranscriptIndex>();
 
-    if (!fptr)
+    if (!mTranscript->open(LLLogChat::makeLogFileName(file_name)))
     {
         bool is_group = load_params.has("is_group") ? load_params["is_group"].asBoolean() : false;
         if (is_group)
         {
             std::string old_name(file_name);
             old_name.erase(old_name.size() - GROUP_CHAT_SUFFIX.size());
-            fptr = LLFile::fopen(LLLogChat::makeLogFileName(old_name), "r");
-            if (fptr)
+            if (LLFile::isfile(LLLogChat::makeLogFileName(old_name)))
             {
-                fclose(fptr);
                 LLFile::copy(LLLogChat::makeLogFileName(old_name), LLLogChat::makeLogFileName(file_name));
             }
-            fptr = LLFile::fopen(LLLogChat::makeLogFileName(file_name), "r");
+            mTranscript->open(LLLogChat::makeLogFileName(file_name));
         }
-        if (!fptr)
+        if (!mTranscript->isOpen())
         {
-            fptr = LLFile::fopen(LLLogChat::oldLogFileName(file_name), "r");/*Flawfinder: ignore*/
-            if (!fptr)
+            if (!mTranscript->open(LLLogChat::oldLogFileName(file_name)))
             {
+                mTranscript.reset();
                 mNewLoad = false;
                 (*mLoadEndSignal)(messages, file_name);
                 return;                     //No previous conversation with this name.
@@ -1179,62 +1150,18 @@ void LLLoadHistoryThread::loadHistory(const std::string& file_name, std::list<LL
         }
     }
 
-    char buffer[LOG_RECALL_SIZE];       /*Flawfinder: ignore*/
-
-    char *bptr;
-    size_t len;
-    bool firstline = true;
-
-    if (load_all_history || fseek(fptr, (LOG_RECALL_SIZE - 1) * -1  , SEEK_END))
-    {   //We need to load the whole historyFile or it's smaller than recall size, so get it all.
-        firstline = false;
-        if (fseek(fptr, 0, SEEK_SET))
-        {
-            fclose(fptr);
-            mNewLoad = false;
-            (*mLoadEndSignal)(messages, file_name);
-            return;
-        }
+    if (load_all_history)
+    {
+        // Only indexed here; whoever shows the history parses the messages
+        // it shows from getTranscript()
+        mTranscript->buildIndex();
     }
-
-
-    while (fgets(buffer, LOG_RECALL_SIZE, fptr)  && !feof(fptr))
+    else
     {
-        len = strlen(buffer) - 1;       /*Flawfinder: ignore*/
-
-        for (bptr = (buffer + len); (*bptr == '\n' || *bptr == '\r') && bptr>buffer; bptr--)    *bptr='\0';
-
-
-        if (firstline)
-        {
-            firstline = false;
-            continue;
-        }
-        std::string line(remove_utf8_bom(buffer));
-
-        //updated 1.23 plaint text log format requires a space added before subsequent lines in a multilined message
-        if (' ' == line[0])
-        {
-            line.erase(0, MULTI_LINE_PREFIX.length());
-            append_to_last_message(*messages, '\n' + line);
-        }
-        else if (0 == len && ('\n' == line[0] || '\r' == line[0]))
-        {
-            //to support old format's multilined messages with new lines used to divide paragraphs
-            append_to_last_message(*messages, line);
-        }
-        else
-        {
-            LLSD item;
-            if (!LLChatLogParser::parse(line, item, load_params))
-            {
-                item[LL_IM_TEXT] = line;
-            }
-            messages->push_back(item);
-        }
+        mTranscript->buildTailIndex(LOG_RECALL_SIZE - 1);
+        LLLogChat::loadChatHistoryPage(*mTranscript, 0, mTranscript->getMessageCount(), *messages, load_params);
     }
 
-    fclose(fptr);
     mNewLoad = false;
     (*mLoadEndSignal)(messages, file_name);
 }
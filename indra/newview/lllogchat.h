@@ -29,6 +29,7 @@
 #include "llthread.h"
 
 class LLChat;
+class LLTranscriptIndex;
 
 class LLActionThread : public LLThread
 {
@@ -53,6 +54,7 @@ private:
     std::list<LLSD>* mMessages;
     LLSD mLoadParams;
     bool mNewLoad;
+    std::shared_ptr<LLTranscriptIndex> mTranscript;
 public:
     LLLoadHistoryThread(const std::string& file_name, std::list<LLSD>* messages, const LLSD& load_params);
     ~LLLoadHistoryThread();
@@ -60,6 +62,10 @@ public:
     virtual void loadHistory(const std::string& file_name, std::list<LLSD>* messages, const LLSD& load_params);
     virtual void run();
 
+    // The mapped transcript, indexed; with "load_all_history" it is only
+    // indexed and messages are left empty
+    std::shared_ptr<LLTranscriptIndex> getTranscript() const { return mTranscript; }
+
     typedef boost::signals2::signal<void (std::list<LLSD>* messages,const std::string& file_name)> load_end_signal_t;
     load_end_signal_t * mLoadEndSignal;
     boost::signals2::connection setLoadEndSignal(const load_end_signal_t::slot_type& cb);
@@ -109,6 +115,8 @@ public:
     static void getListOfTranscriptBackupFiles(std::vector<std::string>& list_of_transcriptions);
 
     static void loadChatHistory(const std::string& file_name, std::list<LLSD>& messages, const LLSD& load_params = LLSD(), bool is_group = false);
+    // Parse count indexed messages from first on
+    static void loadChatHistoryPage(const LLTranscriptIndex& transcript, S32 first, S32 count, std::list<LLSD>& messages, const LLSD& load_params = LLSD());
 
     typedef boost::signals2::signal<void ()> save_history_signal_t;
     boost::signals2::connection setSaveHistorySignal(const save_history_signal_t::slot_type& cb);
@@ -425,11 +425,11 @@ LLScrollListItem* LLNameListCtrl::addNameItemRow(
         fullname.append(suffix);
     }
 
-    LLScrollListCell* cell = item->getColumn(mNameColumnIndex);
-    if (cell)
+    // on the column's data, in a virtualized list, rather than its cell
+    if (item->hasColumn(mNameColumnIndex))
     {
-        cell->setValue(prefix + fullname);
-        cell->setAltValue(name_item.alt_value());
+        item->setColumnValue(mNameColumnIndex, prefix + fullname);
+        item->setColumnAltValue(mNameColumnIndex, name_item.alt_value());
     }
 
     dirtyColumns();
@@ -548,10 +548,9 @@ void LLNameListCtrl::onAvatarNameCache(const LLUUID& agent_id,
     LLNameListItem* list_item = item.get();
     if (list_item && list_item->getUUID() == agent_id)
     {
-        LLScrollListCell* cell = list_item->getColumn(mNameColumnIndex);
-        if (cell)
+        if (list_item->hasColumn(mNameColumnIndex))
         {
-            cell->setValue(name);
+            list_item->setColumnValue(mNameColumnIndex, name);
             setNeedsSort();
         }
     }
@@ -591,10 +590,9 @@ void LLNameListCtrl::onGroupNameCache(const LLUUID& group_id, const std::string
     LLNameListItem* list_item = item.get();
     if (list_item && list_item->getUUID() == group_id)
     {
-        LLScrollListCell* cell = list_item->getColumn(mNameColumnIndex);
-        if (cell)
+        if (list_item->hasColumn(mNameColumnIndex))
         {
-            cell->setValue(name);
+            list_item->setColumnValue(mNameColumnIndex, name);
             setNeedsSort();
         }
     }
@@ -34,6 +34,9 @@
 #include "llvolume.h"
 #include "llrigginginfo.h"
 
+#include <bit>
+#include <unordered_map>
+
 #define DEBUG_SKINNING  LL_DEBUG
 
 void dump_avatar_and_skin_state(const std::string& reason, LLVOAvatar *avatar, const LLMeshSkinInfo *skin)
@@ -321,7 +324,192 @@ void LLSkinningUtil::initJointNums(LLMeshSkinInfo* skin, LLVOAvatar *avatar)
     }
 }
 
-void LLSkinningUtil::updateRiggingInfo(const LLMeshSkinInfo* skin, LLVOAvatar *avatar, LLVolumeFace& vol_face)
+namespace
+{
+    // Identifies the vertices of one face of a mesh as rigged by one skin.
+    // Vertex and index counts guard against faces of different LODs.
+    struct RiggedExtentsKey
+    {
+        LLUUID  mMeshID;
+        U64     mSkinHash;
+        S32     mFace;
+        S32     mNumVertices;
+        S32     mNumIndices;
+
+        bool operator==(const RiggedExtentsKey& other) const
+        {
+            return mMeshID == other.mMeshID && mSkinHash == other.mSkinHash && mFace == other.mFace
+                && mNumVertices == other.mNumVertices && mNumIndices == other.mNumIndices;
+        }
+    };
+
+    struct RiggedExtentsKeyHash
+    {
+        size_t operator()(const RiggedExtentsKey& key) const
+        {
+            size_t hash = 0;
+            boost::hash_combine(hash, key.mMeshID);
+            boost::hash_combine(hash, key.mSkinHash);
+            boost::hash_combine(hash, key.mFace);
+            boost::hash_combine(hash, key.mNumVertices);
+            boost::hash_combine(hash, key.mNumIndices);
+            return hash;
+        }
+    };
+
+    struct RiggedJointExtents
+    {
+        LLVector4a  mExtents[2];
+        S32         mJointNum;
+    };
+
+    typedef std::vector<RiggedJointExtents> rigged_extents_list_t;
+
+    // Faces are rigged from the main thread and the mesh repository thread.
+    LLMutex sRiggedExtentsMutex;
+    std::unordered_map<RiggedExtentsKey, rigged_extents_list_t, RiggedExtentsKeyHash> sRiggedExtentsCache;
+    // A few thousand faces; the cache is dropped wholesale past that.
+    const size_t MAX_RIGGED_EXTENTS_CACHE_SIZE = 4096;
+
+    // Joint space extents of positions[vertices[0..count)] transformed by mat,
+    // four vertices at a time, grown from (and so including) the origin like
+    // update_min_max() does.  Results are identical to calling
+    // LLMatrix4a::affineTransform() and update_min_max() per vertex.
+    void transformed_extents(const LLMatrix4a& mat, const LLVector4a* positions, const U32* vertices, size_t count,
+                             LLVector4a& out_min, LLVector4a& out_max)
+    {
+        // splat each matrix element so one multiply covers four vertices
+        __m128 m[4][4];
+        for (U32 row = 0; row < 4; ++row)
+        {
+            for (U32 col = 0; col < 4; ++col)
+            {
+                m[row][col] = _mm_set1_ps(mat.mMatrix[row][col]);
+            }
+        }
+
+        __m128 min[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+        __m128 max[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+
+        for (size_t i = 0; i < count; i += 4)
+        {
+            // repeating the last vertex to fill a block doesn't change min/max
+            __m128 x = positions[vertices[i]];
+            __m128 y = positions[vertices[llmin(i + 1, count - 1)]];
+            __m128 z = positions[vertices[llmin(i + 2, count - 1)]];
+            __m128 w = positions[vertices[llmin(i + 3, count - 1)]];
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+
+            for (U32 col = 0; col < 4; ++col)
+            {
+                // same operation order as LLMatrix4a::affineTransformSSE()
+                __m128 out = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[0][col]), _mm_mul_ps(y, m[1][col])),
+                                        _mm_add_ps(_mm_mul_ps(z, m[2][col]), m[3][col]));
+                min[col] = _mm_min_ps(min[col], out);
+                max[col] = _mm_max_ps(max[col], out);
+            }
+        }
+
+        // each register holds four candidates for one component
+        _MM_TRANSPOSE4_PS(min[0], min[1], min[2], min[3]);
+        _MM_TRANSPOSE4_PS(max[0], max[1], max[2], max[3]);
+        out_min = _mm_min_ps(_mm_min_ps(min[0], min[1]), _mm_min_ps(min[2], min[3]));
+        out_max = _mm_max_ps(_mm_max_ps(max[0], max[1]), _mm_max_ps(max[2], max[3]));
+    }
+}
+
+void LLSkinningUtil::computeRiggedExtents(const LLMeshSkinInfo* skin, const LLVolumeFace& vol_face, LLJointRiggingInfoTab& rig_info_tab)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+
+    const U32 num_verts = vol_face.mNumVertices;
+    const U32 num_joints = llmin((U32)skin->mJointNames.size(), (U32)skin->mJointNums.size());
+    rig_info_tab.resize(LL_CHARACTER_MAX_ANIMATED_JOINTS);
+    if (!num_verts || !num_joints || !vol_face.mWeights)
+    {
+        return;
+    }
+
+    // Unpack the weights once and bucket vertices by skin joint, so each
+    // joint transforms a contiguous list with its own bind pose matrix.
+    // Each packed weight is joint index + fraction; influences of 0.2 or
+    // less don't count towards the extents.
+    // scratch space, kept per thread to avoid reallocation
+    thread_local std::vector<U32> influence_joints;
+    thread_local std::vector<U32> influence_vertices;
+    thread_local std::vector<U32> offsets;
+    thread_local std::vector<U32> fill;
+    thread_local std::vector<U32> vertices;
+    influence_joints.clear();
+    influence_vertices.clear();
+    offsets.assign(num_joints + 1, 0);
+    const __m128 lowest = _mm_setzero_ps();
+    const __m128 highest = _mm_set1_ps((F32)(LL_CHARACTER_MAX_ANIMATED_JOINTS - 1));
+    const __m128 threshold = _mm_set1_ps(0.2f);
+    const __m128i joint_count = _mm_set1_epi32((S32)num_joints);
+    LL_ALIGN_16(S32 idx[4]);
+    for (U32 i = 0; i < num_verts; ++i)
+    {
+        __m128 weights = vol_face.mWeights[i];
+        // clamping before truncating matches clamping floorf() afterwards
+        __m128i joints = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(weights, lowest), highest));
+        __m128 wght = _mm_sub_ps(weights, _mm_cvtepi32_ps(joints));
+        __m128i valid = _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(wght, threshold)), _mm_cmplt_epi32(joints, joint_count));
+        _mm_store_si128((__m128i*)idx, joints);
+
+        // usually one or two influences per vertex
+        for (U32 mask = _mm_movemask_ps(_mm_castsi128_ps(valid)); mask; mask &= mask - 1)
+        {
+            U32 joint_index = idx[std::countr_zero(mask)];
+            influence_joints.push_back(joint_index);
+            influence_vertices.push_back(i);
+            offsets[joint_index + 1]++;
+        }
+    }
+
+    for (U32 j = 0; j < num_joints; ++j)
+    {
+        offsets[j + 1] += offsets[j];
+    }
+    vertices.resize(influence_vertices.size());
+    fill.assign(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < influence_vertices.size(); ++i)
+    {
+        vertices[fill[influence_joints[i]]++] = influence_vertices[i];
+    }
+
+    const size_t bind_poses_size = skin->mBindPoseMatrix.size();
+    for (U32 joint_index = 0; joint_index < num_joints; ++joint_index)
+    {
+        const size_t count = offsets[joint_index + 1] - offsets[joint_index];
+        S32 joint_num = skin->mJointNums[joint_index];
+        if (!count || joint_num < 0 || joint_num >= (S32)LL_CHARACTER_MAX_ANIMATED_JOINTS)
+        {
+            continue;
+        }
+
+        const LLMatrix4a& mat = bind_poses_size > joint_index ? skin->mBindPoseMatrix[joint_index] : LLMatrix4a::identity();
+        LLVector4a min, max;
+        transformed_extents(mat, vol_face.mPositions, &vertices[offsets[joint_index]], count, min, max);
+
+        // several skin joints may map to the same avatar joint
+        LLJointRiggingInfo& rig_info = rig_info_tab[joint_num];
+        LLVector4a* extents = rig_info.getRiggedExtents();
+        if (rig_info.isRiggedTo())
+        {
+            extents[0].setMin(extents[0], min);
+            extents[1].setMax(extents[1], max);
+        }
+        else
+        {
+            rig_info.setIsRiggedTo(true);
+            extents[0] = min;
+            extents[1] = max;
+        }
+    }
+}
+
+void LLSkinningUtil::updateRiggingInfo(const LLMeshSkinInfo* skin, LLVOAvatar *avatar, LLVolumeFace& vol_face, S32 face_index)
 {
     if (vol_face.mJointRiggingInfoTab.needsUpdate())
     {
@@ -333,46 +521,52 @@ void LLSkinningUtil::updateRiggingInfo(const LLMeshSkinInfo* skin, LLVOAvatar *a
             initJointNums(const_cast<LLMeshSkinInfo*>(skin), avatar);
             if (vol_face.mJointRiggingInfoTab.size()==0)
             {
-                vol_face.mJointRiggingInfoTab.resize(LL_CHARACTER_MAX_ANIMATED_JOINTS);
                 LLJointRiggingInfoTab &rig_info_tab = vol_face.mJointRiggingInfoTab;
-                for (S32 i=0; i<vol_face.mNumVertices; i++)
+                RiggedExtentsKey key{ skin->mMeshID, skin->mHash, face_index, num_verts, vol_face.mNumIndices };
+                bool cacheable = face_index >= 0 && skin->mMeshID.notNull();
+                if (cacheable)
                 {
-                    LLVector4a& pos = vol_face.mPositions[i];
-                    F32 *weights = vol_face.mWeights[i].getF32ptr();
-                    LLVector4 wght;
-                    S32 idx[4];
-                    F32 scale = 0.0f;
-                    // FIXME unpacking of weights should be pulled into a common function and optimized if possible.
-                    for (U32 k = 0; k < 4; k++)
+                    LLMutexLock lock(&sRiggedExtentsMutex);
+                    auto found = sRiggedExtentsCache.find(key);
+                    if (found != sRiggedExtentsCache.end())
                     {
-                        F32 w = weights[k];
-                        idx[k] = llclamp((S32) floorf(w), (S32)0, (S32)LL_CHARACTER_MAX_ANIMATED_JOINTS-1);
-                        wght[k] = w - idx[k];
+                        rig_info_tab.resize(LL_CHARACTER_MAX_ANIMATED_JOINTS);
+                        for (const RiggedJointExtents& joint : found->second)
+                        {
+                            LLJointRiggingInfo& rig_info = rig_info_tab[joint.mJointNum];
+                            rig_info.setIsRiggedTo(true);
+                            rig_info.getRiggedExtents()[0] = joint.mExtents[0];
+                            rig_info.getRiggedExtents()[1] = joint.mExtents[1];
+                        }
+                        rig_info_tab.setNeedsUpdate(false);
+                        return;
                     }
+                }
 
-                    for (U32 k=0; k<4; ++k)
+                computeRiggedExtents(skin, vol_face, rig_info_tab);
+                rig_info_tab.setNeedsUpdate(false);
+
+                if (cacheable)
+                {
+                    rigged_extents_list_t joints;
+                    for (S32 joint_num = 0; joint_num < rig_info_tab.size(); ++joint_num)
                     {
-                        S32 joint_index = idx[k];
-                        if (wght[k] > 0.2f && num_joints > joint_index)
+                        if (rig_info_tab[joint_num].isRiggedTo())
                         {
-                            S32 joint_num = skin->mJointNums[joint_index];
-                            if (joint_num >= 0 && joint_num < LL_CHARACTER_MAX_ANIMATED_JOINTS)
-                            {
-                                rig_info_tab[joint_num].setIsRiggedTo(true);
-
-                                size_t bind_poses_size = skin->mBindPoseMatrix.size();
-                                const LLMatrix4a& mat = bind_poses_size > joint_index ? skin->mBindPoseMatrix[joint_index] : LLMatrix4a::identity();
-                                LLVector4a pos_joint_space;
-
-                                mat.affineTransform(pos, pos_joint_space);
-
-                                LLVector4a *extents = rig_info_tab[joint_num].getRiggedExtents();
-                                update_min_max(extents[0], extents[1], pos_joint_space);
-                            }
+                            joints.emplace_back();
+                            joints.back().mExtents[0] = rig_info_tab[joint_num].getRiggedExtents()[0];
+                            joints.back().mExtents[1] = rig_info_tab[joint_num].getRiggedExtents()[1];
+                            joints.back().mJointNum = joint_num;
                         }
                     }
+
+                    LLMutexLock lock(&sRiggedExtentsMutex);
+                    if (sRiggedExtentsCache.size() >= MAX_RIGGED_EXTENTS_CACHE_SIZE)
+                    {
+                        sRiggedExtentsCache.clear();
+                    }
+                    sRiggedExtentsCache[key].swap(joints);
                 }
-                vol_face.mJointRiggingInfoTab.setNeedsUpdate(false);
             }
         }
     }
@@ -51,7 +51,7 @@ namespace LLSkinningUtil
     LL_FORCE_INLINE void getPerVertexSkinMatrixWithIndices(
         F32*        weights,
         U8*         idx,
-        LLMatrix4a* mat,
+        const LLMatrix4a* mat,
         LLMatrix4a& final_mat,
         LLMatrix4a* src)
     {
@@ -67,7 +67,15 @@ namespace LLSkinningUtil
     }
 
     void initJointNums(LLMeshSkinInfo* skin, LLVOAvatar *avatar);
-    void updateRiggingInfo(const LLMeshSkinInfo* skin, LLVOAvatar *avatar, LLVolumeFace& vol_face);
+
+    // Fills rig_info_tab (LL_CHARACTER_MAX_ANIMATED_JOINTS entries) with the
+    // joint space extents of the vertices of vol_face rigged to each joint.
+    // skin->mJointNums must already be initialized.
+    void computeRiggedExtents(const LLMeshSkinInfo* skin, const LLVolumeFace& vol_face, LLJointRiggingInfoTab& rig_info_tab);
+
+    // Passing the index of vol_face in its volume lets the result be shared
+    // by every volume holding the same face of the same mesh and skin.
+    void updateRiggingInfo(const LLMeshSkinInfo* skin, LLVOAvatar *avatar, LLVolumeFace& vol_face, S32 face_index = -1);
     LLQuaternion getUnscaledQuaternion(const LLMatrix4& mat4);
 };
 
@@ -705,6 +705,8 @@ bool idle_startup()
                 {
                     LL_INFOS("AppInit") << "Using media plugins to render streaming audio" << LL_ENDL;
                     gAudiop->setStreamingAudioImpl(new LLStreamingAudio_MediaPlugins());
+                    gAudiop->getPCMCache().setMaxBytes((size_t)gSavedSettings.getU32("AudioDecodedCacheSize") * 1024 * 1024);
+                    gAudiop->setWriteDecodedFiles(gSavedSettings.getBOOL("AudioCacheDecodedToDisk"));
 
                     gAudiop->setMuted(true);
                 }
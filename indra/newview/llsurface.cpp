@@ -641,26 +641,53 @@ template bool LLSurface::idleUpdate</*PBR=*/true>(F32 max_update_time);
 
 void LLSurface::decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, bool b_large_patch)
 {
+    decoded_patch_list_t patches;
+    if (decodeDCTPatches(bitpack, *gopp, patches))
+    {
+        applyDCTPatches(patches, gopp->patch_size);
+    }
+}
 
-    LLPatchHeader  ph;
-    S32 j, i;
-    S32 patch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
-    LLSurfacePatch *patchp;
+// static
+bool LLSurface::decodeDCTPatches(LLBitPack &bitpack, const LLGroupHeader &goph, decoded_patch_list_t &patches)
+{
+    const S32 size = goph.patch_size;
+    if (size != NORMAL_PATCH_SIZE && size != LARGE_PATCH_SIZE)
+    {
+        LL_WARNS() << "Received invalid terrain packet - patch size " << size << LL_ENDL;
+        return false;
+    }
 
-    init_patch_decompressor(gopp->patch_size);
-    gopp->stride = mGridsPerEdge;
-    set_group_of_patch_header(gopp);
+    LLPatchHeader ph;
+    S32 word_bits;
+    S32 patch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
 
     while (1)
     {
-        decode_patch_header(bitpack, &ph);
+        decode_patch_header(bitpack, &ph, &word_bits);
         if (ph.quant_wbits == END_OF_PATCHES)
         {
             break;
         }
 
-        i = ph.patchids >> 5;
-        j = ph.patchids & 0x1F;
+        DecodedPatch decoded;
+        decoded.mX = ph.patchids >> 5;
+        decoded.mY = ph.patchids & 0x1F;
+        decoded.mZ.resize(size*size);
+
+        decode_patch(bitpack, patch, size, word_bits);
+        decompress_patch(decoded.mZ.data(), patch, &ph, size, size);
+        patches.push_back(std::move(decoded));
+    }
+    return true;
+}
+
+void LLSurface::applyDCTPatches(const decoded_patch_list_t &patches, S32 patch_size)
+{
+    for (const DecodedPatch& decoded : patches)
+    {
+        S32 i = decoded.mX;
+        S32 j = decoded.mY;
 
         if ((i >= mPatchesPerEdge) || (j >= mPatchesPerEdge))
         {
@@ -668,19 +695,18 @@ void LLSurface::decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, bool
                 << " patches per edge " << mPatchesPerEdge
                 << " i " << i
                 << " j " << j
-                << " dc_offset " << ph.dc_offset
-                << " range " << (S32)ph.range
-                << " quant_wbits " << (S32)ph.quant_wbits
-                << " patchids " << (S32)ph.patchids
                 << LL_ENDL;
             return;
         }
 
-        patchp = &mPatchList[j*mPatchesPerEdge + i];
-
+        LLSurfacePatch *patchp = &mPatchList[j*mPatchesPerEdge + i];
 
-        decode_patch(bitpack, patch);
-        decompress_patch(patchp->getDataZ(), patch, &ph);
+        F32 *dest = patchp->getDataZ();
+        const F32 *src = decoded.mZ.data();
+        for (S32 row = 0; row < patch_size; row++)
+        {
+            memcpy(dest + row*mGridsPerEdge, src + row*patch_size, patch_size*sizeof(F32));
+        }
 
         // Update edges for neighbors.  Need to guarantee that this gets done before we generate vertical stats.
         patchp->updateNorthEdge();
@@ -84,6 +84,23 @@ public:
     void disconnectAllNeighbors();
 
     virtual void decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, bool b_large_patch);
+
+    // Heights of one patch of a LayerData packet, decoded but not yet
+    // applied to a surface.
+    struct DecodedPatch
+    {
+        S32 mX;
+        S32 mY;
+        std::vector<F32> mZ;    // patch_size rows of patch_size heights
+    };
+    typedef std::vector<DecodedPatch> decoded_patch_list_t;
+
+    // Decode every patch left in bitpack. Touches no surface and no patch
+    // decoder globals, so it can run on a worker thread. Returns false if
+    // the group header describes patches that can't be decoded.
+    static bool decodeDCTPatches(LLBitPack &bitpack, const LLGroupHeader &goph, decoded_patch_list_t &patches);
+    // Copy decoded patches into the surface and update their edges.
+    void applyDCTPatches(const decoded_patch_list_t &patches, S32 patch_size);
     virtual void updatePatchVisibilities(LLAgent &agent);
 
     inline F32 getZ(const U32 k) const              { return mSurfaceZ[k]; }
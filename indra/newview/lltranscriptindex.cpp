@@ -0,0 +1,323 @@
+/**
+ * @file lltranscriptindex.cpp
+ * @brief Memory mapped chat transcript with an index of where each message
+ * starts.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltranscriptindex.h"
+
+#include "llfile.h"
+#include "llstring.h"
+
+#include <algorithm>
+#include <functional>
+
+#if LL_WINDOWS
+#include "llwin32headers.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char UTF8_BOM[] = "\xEF\xBB\xBF";
+
+    inline char fold_case(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+    }
+
+    struct FoldedHash
+    {
+        size_t operator()(char c) const { return std::hash<char>()(fold_case(c)); }
+    };
+
+    struct FoldedEqual
+    {
+        bool operator()(char a, char b) const { return fold_case(a) == fold_case(b); }
+    };
+
+    // Length of the line without its line ending
+    inline size_t line_length(const char* line, size_t length)
+    {
+        while (length && (line[length - 1] == '\r' || line[length - 1] == '\n'))
+        {
+            length--;
+        }
+        return length;
+    }
+}
+
+LLTranscriptIndex::LLTranscriptIndex()
+:   mData(NULL),
+    mSize(0),
+    mEnd(0),
+    mMapped(false),
+    mOpenEmpty(false)
+#if LL_WINDOWS
+    , mFileHandle(INVALID_HANDLE_VALUE),
+    mMappingHandle(NULL)
+#endif
+{
+}
+
+LLTranscriptIndex::~LLTranscriptIndex()
+{
+    close();
+}
+
+bool LLTranscriptIndex::open(const std::string& filename)
+{
+    close();
+
+#if LL_WINDOWS
+    // Let the viewer keep appending to the transcript, or delete it, while
+    // it is mapped
+    llutf16string utf16filename = utf8str_to_utf16str(filename);
+    HANDLE file = CreateFileW((LPCWSTR)utf16filename.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            mOpenEmpty = true;
+            return true;
+        }
+        HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (view)
+        {
+            mFileHandle = file;
+            mMappingHandle = mapping;
+            mData = (const char*)view;
+            mSize = (size_t)size.QuadPart;
+            mMapped = true;
+            return true;
+        }
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat stat_data;
+        if (!fstat(fd, &stat_data))
+        {
+            if (stat_data.st_size == 0)
+            {
+                ::close(fd);
+                mOpenEmpty = true;
+                return true;
+            }
+            void* view = mmap(NULL, (size_t)stat_data.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+            {
+                // the mapping keeps its own reference to the file
+                ::close(fd);
+                madvise(view, (size_t)stat_data.st_size, MADV_SEQUENTIAL);
+                mData = (const char*)view;
+                mSize = (size_t)stat_data.st_size;
+                mMapped = true;
+                return true;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+    // Not mappable (or not there): read it whole instead
+    LLFILE* fp = LLFile::fopen(filename, "rb");
+    if (!fp)
+    {
+        return false;
+    }
+    char chunk[65536];      /*Flawfinder: ignore*/
+    size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+    {
+        mBuffer.insert(mBuffer.end(), chunk, chunk + count);
+    }
+    fclose(fp);
+    LL_DEBUGS("ChatHistory") << "Read " << mBuffer.size() << " bytes of " << filename << " unmapped" << LL_ENDL;
+    mSize = mBuffer.size();
+    mData = mSize ? &mBuffer[0] : NULL;
+    mOpenEmpty = (mSize == 0);
+    return true;
+}
+
+void LLTranscriptIndex::close()
+{
+    if (mMapped)
+    {
+#if LL_WINDOWS
+        UnmapViewOfFile(mData);
+        CloseHandle(mMappingHandle);
+        CloseHandle(mFileHandle);
+        mMappingHandle = NULL;
+        mFileHandle = INVALID_HANDLE_VALUE;
+#else
+        munmap((void*)mData, mSize);
+#endif
+    }
+    mData = NULL;
+    mSize = 0;
+    mEnd = 0;
+    mMapped = false;
+    mOpenEmpty = false;
+    mBuffer.clear();
+    mStarts.clear();
+}
+
+void LLTranscriptIndex::buildIndex()
+{
+    indexFrom(0);
+}
+
+void LLTranscriptIndex::buildTailIndex(size_t max_bytes)
+{
+    if (mSize <= max_bytes)
+    {
+        indexFrom(0);
+        return;
+    }
+    // what's left of the line the tail begins in goes too
+    const char* nl = (const char*)memchr(mData + mSize - max_bytes, '\n', max_bytes);
+    indexFrom(nl ? nl + 1 - mData : mSize);
+}
+
+void LLTranscriptIndex::indexFrom(size_t offset)
+{
+    mStarts.clear();
+    mEnd = offset;
+    const char* end = mData + mSize;
+    for (const char* line = mData + offset; line < end; )
+    {
+        const char* nl = (const char*)memchr(line, '\n', end - line);
+        if (!nl)
+        {
+            break;
+        }
+        // Lines starting with a space go on the message before them, as do
+        // the empty lines the old format divided paragraphs with
+        if (*line != ' ' && line_length(line, nl - line))
+        {
+            mStarts.push_back(line - mData);
+        }
+        line = nl + 1;
+        mEnd = line - mData;
+    }
+}
+
+void LLTranscriptIndex::getMessage(S32 index, std::string& first_line, std::string& more_lines) const
+{
+    first_line.clear();
+    more_lines.clear();
+    if (index < 0 || index >= getMessageCount())
+    {
+        return;
+    }
+
+    const char* line = mData + mStarts[index];
+    const char* end = mData + ((index + 1 < getMessageCount()) ? mStarts[index + 1] : mEnd);
+    bool first = true;
+    while (line < end)
+    {
+        const char* nl = (const char*)memchr(line, '\n', end - line);
+        size_t length = line_length(line, (nl ? nl : end) - line);
+        if (first)
+        {
+            if (length >= 3 && !memcmp(line, UTF8_BOM, 3))
+            {
+                line += 3;
+                length -= 3;
+            }
+            first_line.assign(line, length);
+            first = false;
+        }
+        else
+        {
+            more_lines += '\n';
+            if (length)
+            {
+                more_lines.append(line + 1, length - 1);
+            }
+        }
+        line = nl ? nl + 1 : end;
+    }
+}
+
+void LLTranscriptIndex::find(const std::string& text, std::vector<S32>& matches) const
+{
+    matches.clear();
+    if (text.empty() || mStarts.empty())
+    {
+        return;
+    }
+
+    std::boyer_moore_horspool_searcher<std::string::const_iterator, FoldedHash, FoldedEqual>
+        searcher(text.begin(), text.end());
+    const char* begin = mData + mStarts.front();
+    const char* end = mData + mEnd;
+    while (begin < end)
+    {
+        const char* found = searcher(begin, end).first;
+        if (found == end)
+        {
+            break;
+        }
+        S32 index = getMessageAt(found - mData);
+        size_t next = (index + 1 < getMessageCount()) ? mStarts[index + 1] : mEnd;
+        if ((size_t)(found - mData) + text.size() > next)
+        {
+            // runs into the next message
+            begin = found + 1;
+            continue;
+        }
+        matches.push_back(index);
+        // one match is enough for a message
+        begin = mData + next;
+    }
+}
+
+S32 LLTranscriptIndex::getMessageAt(size_t offset) const
+{
+    if (offset >= mEnd)
+    {
+        return -1;
+    }
+    std::vector<size_t>::const_iterator iter = std::upper_bound(mStarts.begin(), mStarts.end(), offset);
+    return (S32)(iter - mStarts.begin()) - 1;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file lltranscriptindex.h
+ * @brief Memory mapped chat transcript with an index of where each message
+ * starts.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTRANSCRIPTINDEX_H
+#define LL_LLTRANSCRIPTINDEX_H
+
+#include <string>
+#include <vector>
+
+//
+// A plain text transcript as LLLogChat writes it: one message per line, with
+// the further lines of a multi-line message prefixed by a space (or, in the
+// old format, left empty). The file is mapped rather than read, and indexing
+// it only records where each message starts, so a transcript of any size
+// costs one pass over its bytes; messages are turned into text only when
+// asked for, a page at a time.
+//
+// A trailing line without a newline is left out, as it is likely still being
+// written. The index is built by one thread and must be complete before
+// other threads read it; nothing changes it after that.
+//
+class LLTranscriptIndex
+{
+    LOG_CLASS(LLTranscriptIndex);
+public:
+    LLTranscriptIndex();
+    ~LLTranscriptIndex();
+
+    LLTranscriptIndex(const LLTranscriptIndex&) = delete;
+    LLTranscriptIndex& operator=(const LLTranscriptIndex&) = delete;
+
+    // Map the file, or read it if it can't be mapped. False if it can't be
+    // opened at all.
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return mData != NULL || mOpenEmpty; }
+
+    // Index every message
+    void buildIndex();
+    // Index only the messages starting in the last max_bytes of the file,
+    // skipping the line those bytes begin in, unless the file is no longer
+    // than that
+    void buildTailIndex(size_t max_bytes);
+
+    S32 getMessageCount() const { return (S32)mStarts.size(); }
+    size_t getSize() const { return mSize; }
+
+    // The message's first line, without any byte order mark or line ending,
+    // and what its further lines add to the text: each one with a newline
+    // in front and its space prefix removed
+    void getMessage(S32 index, std::string& first_line, std::string& more_lines) const;
+
+    // Indices of the indexed messages containing text, ignoring ASCII case.
+    // The mapped bytes are scanned directly, so text that runs over into a
+    // message's next line is not found.
+    void find(const std::string& text, std::vector<S32>& matches) const;
+
+    // Message at a byte offset into the file, -1 if before the first indexed
+    // message
+    S32 getMessageAt(size_t offset) const;
+
+private:
+    void indexFrom(size_t offset);
+
+    const char*         mData;
+    size_t              mSize;
+    size_t              mEnd;   // end of the last complete line
+    bool                mMapped;
+    bool                mOpenEmpty;
+    std::vector<char>   mBuffer;    // file contents if mapping failed
+    std::vector<size_t> mStarts;    // offset of each message's first line
+#if LL_WINDOWS
+    void*               mFileHandle;
+    void*               mMappingHandle;
+#endif
+};
+
+#endif // LL_LLTRANSCRIPTINDEX_H
@@ -46,6 +46,7 @@
 #include "llfeaturemanager.h"
 #include "llfloatertools.h"
 #include "llfocusmgr.h"
+#include "llfontfreetype.h"
 #include "llgl.h"
 #include "llglheaders.h"
 #include "llgltfmateriallist.h"
@@ -511,6 +512,11 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
 
     gViewerWindow->checkSettings();
 
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_DISPLAY("Font Glyphs");
+        LLFontFreetype::addFinishedGlyphs();
+    }
+
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_DISPLAY("Picking");
         gViewerWindow->performPick();
@@ -578,6 +584,7 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
 
     gPipeline.mBackfaceCull = true;
     gFrameCount++;
+    gSavedSettings.profileFrame();
     gRecentFrameCount++;
     if (gFocusMgr.getAppHasFocus())
     {
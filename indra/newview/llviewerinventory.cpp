@@ -774,6 +774,21 @@ bool LLViewerInventoryCategory::importLLSD(const LLSD& cat_data)
     return true;
 }
 
+bool LLViewerInventoryCategory::importLLSDField(const std::string& key, const LLSD& value)
+{
+    if (key == INV_OWNER_ID)
+    {
+        mOwnerID = value.asUUID();
+        return true;
+    }
+    if (key == INV_VERSION)
+    {
+        setVersion(value.asInteger());
+        return true;
+    }
+    return LLInventoryCategory::importLLSDField(key, value);
+}
+
 bool LLViewerInventoryCategory::acceptItem(LLInventoryItem* inv_item)
 {
     if (!inv_item)
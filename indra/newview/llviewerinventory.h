@@ -234,6 +234,7 @@ public:
 
     LLSD exportLLSD() const;
     bool importLLSD(const LLSD& cat_data);
+    bool importLLSDField(const std::string& key, const LLSD& value);
 
     void determineFolderType();
     void changeType(LLFolderType::EType new_folder_type);
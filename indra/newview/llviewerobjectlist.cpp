@@ -832,13 +832,21 @@ void LLViewerObjectList::update(LLAgent &agent)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
 
+    static LLCachedControl<bool> velocity_interpolate(gSavedSettings, "VelocityInterpolate");
+    static LLCachedControl<bool> ping_interpolate(gSavedSettings, "PingInterpolate");
+    static LLCachedControl<F32> interpolation_time(gSavedSettings, "InterpolationTime");
+    static LLCachedControl<F32> interpolation_phase_out(gSavedSettings, "InterpolationPhaseOut");
+    static LLCachedControl<F32> region_crossing_interpolation_time(gSavedSettings, "RegionCrossingInterpolationTime");
+    static LLCachedControl<bool> animate_textures(gSavedSettings, "AnimateTextures");
+    static LLCachedControl<bool> freeze_time(gSavedSettings, "FreezeTime");
+
     // Update globals
-    LLViewerObject::setVelocityInterpolate( gSavedSettings.getBOOL("VelocityInterpolate") );
-    LLViewerObject::setPingInterpolate( gSavedSettings.getBOOL("PingInterpolate") );
+    LLViewerObject::setVelocityInterpolate(velocity_interpolate);
+    LLViewerObject::setPingInterpolate(ping_interpolate);
 
-    F32 interp_time = gSavedSettings.getF32("InterpolationTime");
-    F32 phase_out_time = gSavedSettings.getF32("InterpolationPhaseOut");
-    F32 region_interp_time = llclamp(gSavedSettings.getF32("RegionCrossingInterpolationTime"), 0.5f, 5.f);
+    F32 interp_time = interpolation_time;
+    F32 phase_out_time = interpolation_phase_out;
+    F32 region_interp_time = llclamp((F32)region_crossing_interpolation_time, 0.5f, 5.f);
     if (interp_time < 0.0 ||
         phase_out_time < 0.0 ||
         phase_out_time > interp_time)
@@ -851,7 +859,7 @@ void LLViewerObjectList::update(LLAgent &agent)
     LLViewerObject::setMaxUpdateInterpolationTime( phase_out_time );
     LLViewerObject::setMaxRegionCrossingInterpolationTime(region_interp_time);
 
-    gAnimateTextures = gSavedSettings.getBOOL("AnimateTextures");
+    gAnimateTextures = animate_textures;
 
     // update global timer
     F32 last_time = gFrameTimeSeconds;
@@ -914,7 +922,7 @@ void LLViewerObjectList::update(LLAgent &agent)
 
     std::vector<LLViewerObject*>::iterator idle_end = idle_list.begin()+idle_count;
 
-    if (gSavedSettings.getBOOL("FreezeTime"))
+    if (freeze_time)
     {
 
         for (std::vector<LLViewerObject*>::iterator iter = idle_list.begin();
@@ -42,6 +42,7 @@
 #include "llspatialpartition.h"
 #include "llvoavatarself.h"
 #include "llvovolume.h"
+#include "llalignedarray.h"
 
 const F32 PART_SIM_BOX_SIDE = 16.f;
 
@@ -268,6 +269,8 @@ bool LLViewerPartGroup::addPart(LLViewerPart* part, F32 desired_size)
 
     mParticles.push_back(part);
     part->mSkipOffset=mSkippedTime;
+    mStore.add(*part, part->mVPCallback != NULL, part->mPosAgent, part->mVelocity, part->mAccel,
+               part->mColor, part->mScale, part->mLastUpdateTime, part->mSkipOffset);
     LLViewerPartSim::incPartCount(1);
     return true;
 }
@@ -283,11 +286,49 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
 
     LLViewerCamera* camera = LLViewerCamera::getInstance();
     LLViewerRegion *regionp = getRegion();
+
+    // Plain and wind driven particles are advanced a kind at a time out of
+    // the store, everything else one at a time below.
+    static std::vector<S32> slots;
+    static LLAlignedArray<LLVector4a, 64> wind_pos;
+    static LLAlignedArray<LLVector4a, 64> wind_vel;
+
+    mStore.getSlots(LLViewerPartStore::KIND_WIND, slots);
+    if (!slots.empty())
+    {
+        const S32 count = (S32)slots.size();
+        wind_pos.resize(count);
+        wind_vel.resize(count);
+        LLVector4a origin;
+        origin.load3(regionp->getOriginAgent().mV);
+        for (S32 k = 0; k < count; k++)
+        {
+            wind_pos[k].setSub(mStore.getPosition(slots[k]), origin);
+        }
+        regionp->mWind.getVelocities(&wind_pos[0], &wind_vel[0], count);
+        mStore.update(lastdt + mSkippedTime, &slots[0], count, &wind_vel[0]);
+        copyFromStore(slots);
+    }
+
+    mStore.getSlots(LLViewerPartStore::KIND_SIMPLE, slots);
+    if (!slots.empty())
+    {
+        mStore.update(lastdt + mSkippedTime, &slots[0], (S32)slots.size());
+        copyFromStore(slots);
+    }
+
     S32 end = (S32) mParticles.size();
     for (S32 i = 0 ; i < (S32)mParticles.size();)
     {
-        LLVector3 a(0.f, 0.f, 0.f);
         LLViewerPart* part = mParticles[i] ;
+        if (mStore.getKind(i) != LLViewerPartStore::KIND_SCALAR)
+        {
+            if (!checkPart(i, camera))
+            {
+                i++;
+            }
+            continue;
+        }
 
         dt = lastdt + mSkippedTime - part->mSkipOffset;
         part->mSkipOffset = 0.f;
@@ -395,28 +436,9 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
         // Set the last update time to now.
         part->mLastUpdateTime = cur_time;
 
-
-        // Kill dead particles (either flagged dead, or too old)
-        if ((part->mLastUpdateTime > part->mMaxAge) || (LLViewerPart::LL_PART_DEAD_MASK == part->mFlags))
-        {
-            mParticles[i] = mParticles.back() ;
-            mParticles.pop_back() ;
-            delete part ;
-        }
-        else
+        if (!checkPart(i, camera))
         {
-            F32 desired_size = calc_desired_size(camera, part->mPosAgent, part->mScale);
-            if (!posInGroup(part->mPosAgent, desired_size))
-            {
-                // Transfer particles between groups
-                LLViewerPartSim::getInstance()->put(part) ;
-                mParticles[i] = mParticles.back() ;
-                mParticles.pop_back() ;
-            }
-            else
-            {
-                i++ ;
-            }
+            i++;
         }
     }
 
@@ -452,6 +474,55 @@ void LLViewerPartGroup::shift(const LLVector3 &offset)
     {
         mParticles[i]->mPosAgent += offset;
     }
+
+    LLVector4a offset4a;
+    offset4a.load3(offset.mV);
+    mStore.shift(offset4a);
+}
+
+void LLViewerPartGroup::copyFromStore(const std::vector<S32>& slots)
+{
+    for (S32 slot : slots)
+    {
+        LLViewerPart* part = mParticles[slot];
+        part->mPosAgent.set(mStore.getPosition(slot).getF32ptr());
+        part->mVelocity.set(mStore.getVelocity(slot).getF32ptr());
+        part->mColor.set(mStore.getColor(slot).getF32ptr());
+        part->mScale.set(mStore.getScale(slot).getF32ptr());
+        part->mGlow.mV[3] = mStore.getGlow(slot);
+        part->mLastUpdateTime = mStore.getAge(slot);
+        part->mSkipOffset = 0.f;
+    }
+}
+
+bool LLViewerPartGroup::checkPart(S32 i, LLViewerCamera* camera)
+{
+    LLViewerPart* part = mParticles[i];
+
+    // Kill dead particles (either flagged dead, or too old)
+    if ((part->mLastUpdateTime > part->mMaxAge) || (LLViewerPart::LL_PART_DEAD_MASK == part->mFlags))
+    {
+        removePart(i);
+        delete part ;
+        return true;
+    }
+
+    F32 desired_size = calc_desired_size(camera, part->mPosAgent, part->mScale);
+    if (!posInGroup(part->mPosAgent, desired_size))
+    {
+        // Transfer particles between groups
+        removePart(i);
+        LLViewerPartSim::getInstance()->put(part) ;
+        return true;
+    }
+    return false;
+}
+
+void LLViewerPartGroup::removePart(S32 i)
+{
+    mParticles[i] = mParticles.back() ;
+    mParticles.pop_back() ;
+    mStore.remove(i);
 }
 
 void LLViewerPartGroup::removeParticlesByID(const U32 source_id)
@@ -519,6 +590,7 @@ void LLViewerPartSim::destroyClass()
         delete mViewerPartGroups[i];
     }
     mViewerPartGroups.clear();
+    LLViewerPartStore::cleanupClass();
 
     // Kill all of the sources
     mViewerPartSources.clear();
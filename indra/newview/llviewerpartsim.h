@@ -31,7 +31,9 @@
 #include "llpointer.h"
 #include "llpartdata.h"
 #include "llviewerpartsource.h"
+#include "llviewerpartstore.h"
 
+class LLViewerCamera;
 class LLViewerTexture;
 class LLViewerPart;
 class LLViewerRegion;
@@ -124,6 +126,13 @@ public:
     bool mHud;
 
 protected:
+    // Hand store results back to the particles the renderer reads.
+    void copyFromStore(const std::vector<S32>& slots);
+    // Kill or move particle i if it is done here. Returns true if it was
+    // removed, leaving another particle in slot i.
+    bool checkPart(S32 i, LLViewerCamera* camera);
+    void removePart(S32 i);
+
     LLVector3 mCenterAgent;
     F32 mBoxRadius;
     F32 mBoxSide;
@@ -131,6 +140,9 @@ protected:
     LLVector3 mMaxObjPos;
 
     LLViewerRegion *mRegionp;
+
+    // Integration state of mParticles, slot for slot.
+    LLViewerPartStore mStore;
 };
 
 class LLViewerPartSim : public LLSingleton<LLViewerPartSim>
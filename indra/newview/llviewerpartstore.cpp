@@ -0,0 +1,359 @@
+/**
+ * @file llviewerpartstore.cpp
+ * @brief Implementation of LLViewerPartStore.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llviewerpartstore.h"
+
+#include "llpartdata.h"
+
+// Smallest block handed out, in particles. Blocks double from here.
+static const S32 MIN_BLOCK_CAPACITY = 32;
+static const S32 BLOCK_SIZES = 16;
+
+static const U32 SCALAR_FLAGS = LLPartData::LL_PART_FOLLOW_SRC_MASK
+                              | LLPartData::LL_PART_TARGET_POS_MASK
+                              | LLPartData::LL_PART_TARGET_LINEAR_MASK
+                              | LLPartData::LL_PART_BOUNCE_MASK;
+
+// Each array starts on a cache line.
+static inline size_t array_bytes(S32 capacity, size_t element_size)
+{
+    return (capacity*element_size + 63) & ~(size_t)63;
+}
+
+static size_t block_bytes(S32 capacity)
+{
+    return array_bytes(capacity, sizeof(LLVector4a))*9
+         + array_bytes(capacity, sizeof(F32))*5
+         + array_bytes(capacity, sizeof(U8))*2;
+}
+
+static S32 block_index(S32 capacity)
+{
+    S32 index = 0;
+    while ((MIN_BLOCK_CAPACITY << index) < capacity)
+    {
+        index++;
+    }
+    llassert(index < BLOCK_SIZES);
+    return index;
+}
+
+// Free blocks by size, only touched from the main thread.
+static std::vector<U8*> sFreeBlocks[BLOCK_SIZES];
+
+//static
+U8* LLViewerPartStore::allocateBlock(S32 capacity)
+{
+    std::vector<U8*>& free_blocks = sFreeBlocks[block_index(capacity)];
+    if (!free_blocks.empty())
+    {
+        U8* block = free_blocks.back();
+        free_blocks.pop_back();
+        return block;
+    }
+    return (U8*)ll_aligned_malloc<64>(block_bytes(capacity));
+}
+
+//static
+void LLViewerPartStore::freeBlock(U8* block, S32 capacity)
+{
+    if (block)
+    {
+        sFreeBlocks[block_index(capacity)].push_back(block);
+    }
+}
+
+//static
+void LLViewerPartStore::cleanupClass()
+{
+    for (S32 i = 0; i < BLOCK_SIZES; i++)
+    {
+        for (U8* block : sFreeBlocks[i])
+        {
+            ll_aligned_free<64>(block);
+        }
+        sFreeBlocks[i].clear();
+    }
+}
+
+LLViewerPartStore::LLViewerPartStore()
+:   mCount(0),
+    mCapacity(0),
+    mBlock(NULL)
+{
+    setArrays(NULL, 0);
+}
+
+LLViewerPartStore::~LLViewerPartStore()
+{
+    freeBlock(mBlock, mCapacity);
+}
+
+void LLViewerPartStore::setArrays(U8* block, S32 capacity)
+{
+    U8* ptr = block;
+    auto take = [&ptr, capacity](size_t element_size)
+    {
+        U8* ret = ptr;
+        if (ptr)
+        {
+            ptr += array_bytes(capacity, element_size);
+        }
+        return ret;
+    };
+    mPosition = (LLVector4a*)take(sizeof(LLVector4a));
+    mVelocity = (LLVector4a*)take(sizeof(LLVector4a));
+    mAccel = (LLVector4a*)take(sizeof(LLVector4a));
+    mColor = (LLVector4a*)take(sizeof(LLVector4a));
+    mStartColor = (LLVector4a*)take(sizeof(LLVector4a));
+    mEndColor = (LLVector4a*)take(sizeof(LLVector4a));
+    mScale = (LLVector4a*)take(sizeof(LLVector4a));
+    mStartScale = (LLVector4a*)take(sizeof(LLVector4a));
+    mEndScale = (LLVector4a*)take(sizeof(LLVector4a));
+    mAge = (F32*)take(sizeof(F32));
+    mMaxAge = (F32*)take(sizeof(F32));
+    mSkipOffset = (F32*)take(sizeof(F32));
+    mStartGlow = (F32*)take(sizeof(F32));
+    mEndGlow = (F32*)take(sizeof(F32));
+    mGlow = take(sizeof(U8));
+    mKind = take(sizeof(U8));
+}
+
+void LLViewerPartStore::reserve(S32 count)
+{
+    if (count <= mCapacity)
+    {
+        return;
+    }
+
+    S32 capacity = llmax(mCapacity*2, MIN_BLOCK_CAPACITY);
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+
+    LLViewerPartStore old;
+    old.mBlock = mBlock;
+    old.mCapacity = mCapacity;
+    old.setArrays(mBlock, mCapacity);
+
+    mBlock = allocateBlock(capacity);
+    mCapacity = capacity;
+    setArrays(mBlock, capacity);
+
+    if (mCount)
+    {
+        auto copy = [this](void* dst, const void* src, size_t element_size)
+        {
+            memcpy(dst, src, mCount*element_size);
+        };
+        copy(mPosition, old.mPosition, sizeof(LLVector4a));
+        copy(mVelocity, old.mVelocity, sizeof(LLVector4a));
+        copy(mAccel, old.mAccel, sizeof(LLVector4a));
+        copy(mColor, old.mColor, sizeof(LLVector4a));
+        copy(mStartColor, old.mStartColor, sizeof(LLVector4a));
+        copy(mEndColor, old.mEndColor, sizeof(LLVector4a));
+        copy(mScale, old.mScale, sizeof(LLVector4a));
+        copy(mStartScale, old.mStartScale, sizeof(LLVector4a));
+        copy(mEndScale, old.mEndScale, sizeof(LLVector4a));
+        copy(mAge, old.mAge, sizeof(F32));
+        copy(mMaxAge, old.mMaxAge, sizeof(F32));
+        copy(mSkipOffset, old.mSkipOffset, sizeof(F32));
+        copy(mStartGlow, old.mStartGlow, sizeof(F32));
+        copy(mEndGlow, old.mEndGlow, sizeof(F32));
+        copy(mGlow, old.mGlow, sizeof(U8));
+        copy(mKind, old.mKind, sizeof(U8));
+    }
+    // old hands its block back to the pool
+}
+
+void LLViewerPartStore::add(const LLPartData& data, bool has_callback,
+                            const LLVector3& pos, const LLVector3& vel, const LLVector3& accel,
+                            const LLColor4& color, const LLVector2& scale, F32 age, F32 skip_offset)
+{
+    reserve(mCount + 1);
+    S32 slot = mCount++;
+
+    mPosition[slot].load3(pos.mV);
+    mVelocity[slot].load3(vel.mV);
+    mAccel[slot].load3(accel.mV);
+    mColor[slot].loadua(color.mV);
+    mScale[slot].set(scale.mV[VX], scale.mV[VY], 0.f, 0.f);
+
+    // Particles that don't interpolate get the same start and end, so the
+    // kernels can interpolate everything without looking at the flags.
+    if (data.mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK)
+    {
+        mStartColor[slot].loadua(data.mStartColor.mV);
+        mEndColor[slot].loadua(data.mEndColor.mV);
+    }
+    else
+    {
+        mStartColor[slot] = mColor[slot];
+        mEndColor[slot] = mColor[slot];
+    }
+
+    if (data.mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK)
+    {
+        mStartScale[slot].set(data.mStartScale.mV[VX], data.mStartScale.mV[VY], 0.f, 0.f);
+        mEndScale[slot].set(data.mEndScale.mV[VX], data.mEndScale.mV[VY], 0.f, 0.f);
+    }
+    else
+    {
+        mStartScale[slot] = mScale[slot];
+        mEndScale[slot] = mScale[slot];
+    }
+    mAge[slot] = age;
+    mMaxAge[slot] = data.mMaxAge;
+    mSkipOffset[slot] = skip_offset;
+    mStartGlow[slot] = data.mStartGlow;
+    mEndGlow[slot] = data.mEndGlow;
+    mGlow[slot] = 0;
+
+    if (has_callback || (data.mFlags & SCALAR_FLAGS))
+    {
+        mKind[slot] = KIND_SCALAR;
+    }
+    else if (data.mFlags & LLPartData::LL_PART_WIND_MASK)
+    {
+        mKind[slot] = KIND_WIND;
+    }
+    else
+    {
+        mKind[slot] = KIND_SIMPLE;
+    }
+}
+
+void LLViewerPartStore::remove(S32 slot)
+{
+    llassert(slot >= 0 && slot < mCount);
+    S32 last = --mCount;
+    if (slot == last)
+    {
+        return;
+    }
+
+    mPosition[slot] = mPosition[last];
+    mVelocity[slot] = mVelocity[last];
+    mAccel[slot] = mAccel[last];
+    mColor[slot] = mColor[last];
+    mStartColor[slot] = mStartColor[last];
+    mEndColor[slot] = mEndColor[last];
+    mScale[slot] = mScale[last];
+    mStartScale[slot] = mStartScale[last];
+    mEndScale[slot] = mEndScale[last];
+    mAge[slot] = mAge[last];
+    mMaxAge[slot] = mMaxAge[last];
+    mSkipOffset[slot] = mSkipOffset[last];
+    mStartGlow[slot] = mStartGlow[last];
+    mEndGlow[slot] = mEndGlow[last];
+    mGlow[slot] = mGlow[last];
+    mKind[slot] = mKind[last];
+}
+
+void LLViewerPartStore::clear()
+{
+    mCount = 0;
+}
+
+void LLViewerPartStore::shift(const LLVector4a& offset)
+{
+    for (S32 i = 0; i < mCount; i++)
+    {
+        mPosition[i].add(offset);
+    }
+}
+
+void LLViewerPartStore::getSlots(EKind kind, std::vector<S32>& slots) const
+{
+    // Kinds are mixed at random through the store, so write every slot and
+    // only advance past the ones that match rather than branch on each.
+    slots.resize(mCount + 1);
+    S32 count = 0;
+    for (S32 i = 0; i < mCount; i++)
+    {
+        slots[count] = i;
+        count += (mKind[i] == kind);
+    }
+    slots.resize(count);
+}
+
+void LLViewerPartStore::update(F32 dt, const S32* slots, S32 count, const LLVector4a* wind)
+{
+    // Same operations in the same order as the scalar update in
+    // LLViewerPartGroup, so both paths agree to within rounding.
+    LLVector4a term;
+    for (S32 k = 0; k < count; k++)
+    {
+        const S32 i = slots[k];
+        const F32 part_dt = dt - mSkipOffset[i];
+        mSkipOffset[i] = 0.f;
+
+        const F32 cur_time = mAge[i] + part_dt;
+        const F32 frac = cur_time / mMaxAge[i];
+
+        LLVector4a& pos = mPosition[i];
+        LLVector4a& vel = mVelocity[i];
+        const LLVector4a& accel = mAccel[i];
+
+        if (wind)
+        {
+            const F32 wind_frac = 0.1f*part_dt;
+            vel.mul(1.f - wind_frac);
+            term = wind[k];
+            term.mul(wind_frac);
+            vel.add(term);
+        }
+
+        term = vel;
+        term.mul(part_dt);
+        pos.add(term);
+        term = accel;
+        term.mul(0.5f*part_dt*part_dt);
+        pos.add(term);
+        term = accel;
+        term.mul(part_dt);
+        vel.add(term);
+
+        // start and end match when a particle doesn't interpolate
+        mColor[i] = mStartColor[i];
+        mColor[i].mul(1.f - frac);
+        term = mEndColor[i];
+        term.mul(frac);
+        mColor[i].add(term);
+
+        mScale[i] = mStartScale[i];
+        mScale[i].mul(1.f - frac);
+        term = mEndScale[i];
+        term.mul(frac);
+        mScale[i].add(term);
+
+        mGlow[i] = (U8) ll_round(lerp(mStartGlow[i], mEndGlow[i], frac)*255.f);
+        mAge[i] = cur_time;
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ * @file llviewerpartstore.h
+ * @brief Structure of arrays particle state for LLViewerPartGroup.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVIEWERPARTSTORE_H
+#define LL_LLVIEWERPARTSTORE_H
+
+#include "llmath.h"
+#include "v2math.h"
+#include "v3math.h"
+#include "v4color.h"
+#include "llvector4a.h"
+
+class LLPartData;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLViewerPartStore
+//
+// The state a particle group integrates every frame, one array per field,
+// kept slot for slot in step with the group's particle list. Slots are
+// removed by moving the last one into the hole, the same as the list.
+//
+// Particles are sorted into kinds when they are added. Plain and wind
+// driven particles are advanced by update(); anything with a callback,
+// a target, a source to follow or a bounce is left to the caller.
+//
+// Storage comes from a pool of power of two sized blocks shared by all
+// stores, since groups come and go as particles drift around.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLViewerPartStore
+{
+public:
+    enum EKind
+    {
+        KIND_SIMPLE,    // gravity and acceleration only
+        KIND_WIND,      // pushed around by the region's wind
+        KIND_SCALAR,    // updated one at a time by the caller
+    };
+
+    LLViewerPartStore();
+    ~LLViewerPartStore();
+
+    // Release pooled blocks that no store is using.
+    static void cleanupClass();
+
+    S32 size() const                { return mCount; }
+
+    // Append a particle. has_callback forces the scalar path.
+    void add(const LLPartData& data, bool has_callback,
+             const LLVector3& pos, const LLVector3& vel, const LLVector3& accel,
+             const LLColor4& color, const LLVector2& scale, F32 age, F32 skip_offset);
+    // Move the last slot into slot and shrink by one.
+    void remove(S32 slot);
+    void clear();
+
+    void shift(const LLVector4a& offset);
+
+    // Slots of each kind, in slot order.
+    void getSlots(EKind kind, std::vector<S32>& slots) const;
+
+    // Advance the given slots, all of one kind, by dt less each particle's
+    // skip offset. For KIND_WIND, wind holds the wind velocity at each
+    // slot's position, in the same order as slots.
+    void update(F32 dt, const S32* slots, S32 count, const LLVector4a* wind = NULL);
+
+    U8 getKind(S32 slot) const                      { return mKind[slot]; }
+    const LLVector4a& getPosition(S32 slot) const   { return mPosition[slot]; }
+    const LLVector4a& getVelocity(S32 slot) const   { return mVelocity[slot]; }
+    const LLVector4a& getColor(S32 slot) const      { return mColor[slot]; }
+    const LLVector4a& getScale(S32 slot) const      { return mScale[slot]; }
+    F32 getAge(S32 slot) const                      { return mAge[slot]; }
+    U8 getGlow(S32 slot) const                      { return mGlow[slot]; }
+
+private:
+    void reserve(S32 count);
+    void setArrays(U8* block, S32 capacity);
+
+    static U8* allocateBlock(S32 capacity);
+    static void freeBlock(U8* block, S32 capacity);
+
+    S32 mCount;
+    S32 mCapacity;
+    U8* mBlock;
+
+    LLVector4a* mPosition;
+    LLVector4a* mVelocity;
+    LLVector4a* mAccel;
+    LLVector4a* mColor;
+    LLVector4a* mStartColor;
+    LLVector4a* mEndColor;
+    LLVector4a* mScale;
+    LLVector4a* mStartScale;
+    LLVector4a* mEndScale;
+    F32* mAge;
+    F32* mMaxAge;
+    F32* mSkipOffset;
+    F32* mStartGlow;
+    F32* mEndGlow;
+    U8* mGlow;
+    U8* mKind;
+};
+
+#endif // LL_LLVIEWERPARTSTORE_H
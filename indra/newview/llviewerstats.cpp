@@ -139,7 +139,14 @@ LLTrace::CountStatHandle<>  FPS("FPS", "Frames rendered"),
                             KILLED("killed", "Number of times killed"),
                             TEX_BAKES("texbakes", "Number of times avatar textures have been baked"),
                             TEX_REBAKES("texrebakes", "Number of times avatar textures have been forced to rebake"),
-                            NUM_NEW_OBJECTS("numnewobjectsstat", "Number of objects in scene that were not previously in cache");
+                            NUM_NEW_OBJECTS("numnewobjectsstat", "Number of objects in scene that were not previously in cache"),
+                            SKIN_PALETTES_COMPUTED("skinpalettescomputed", "Rigged mesh joint matrix palettes computed"),
+                            SKIN_PALETTES_REUSED("skinpalettesreused", "Rigged mesh joint matrix palettes reused from the avatar's per frame cache"),
+                            AVATAR_MOTIONS_UPDATED("avatarmotionsupdated", "Full motion updates of other avatars"),
+                            AVATAR_MOTIONS_INTERPOLATED("avatarmotionsinterpolated", "Frames other avatars were posed by interpolating towards their last motion update");
+
+LLTrace::CountStatHandle<F64Milliseconds >
+                            AVATAR_MOTION_TIME("avatarmotiontime", "Time spent in full motion updates of other avatars");
 
 LLTrace::CountStatHandle<LLUnit<F64, LLUnits::Kilotriangles> >
                             TRIANGLES_DRAWN("trianglesdrawnstat");
@@ -137,10 +137,16 @@ extern LLTrace::CountStatHandle<>           FPS,
                                             KILLED,
                                             TEX_BAKES,
                                             TEX_REBAKES,
-                                            NUM_NEW_OBJECTS;
+                                            NUM_NEW_OBJECTS,
+                                            SKIN_PALETTES_COMPUTED,
+                                            SKIN_PALETTES_REUSED,
+                                            AVATAR_MOTIONS_UPDATED,
+                                            AVATAR_MOTIONS_INTERPOLATED;
 
 extern LLTrace::CountStatHandle<LLUnit<F64, LLUnits::Kilotriangles> > TRIANGLES_DRAWN;
 
+extern LLTrace::CountStatHandle<F64Milliseconds >  AVATAR_MOTION_TIME;
+
 extern LLTrace::CountStatHandle<F64Kilobytes >  ACTIVE_MESSAGE_DATA_RECEIVED,
                                                                     LAYERS_NETWORK_DATA_RECEIVED,
                                                                     OBJECT_NETWORK_DATA_RECEIVED,
@@ -1946,7 +1946,7 @@ LLViewerWindow::LLViewerWindow(const Params& p)
         mWindowRectScaled.set(0, ll_round((F32)size.mY / mDisplayScale.mV[VY]), ll_round((F32)size.mX / mDisplayScale.mV[VX]), 0);
     }
 
-    LLFontManager::initClass();
+    LLFontManager::initClass(gSavedSettings.getBOOL("FontGlyphThread"));
 
     // fonts use an GL_UNSIGNED_BYTE image format,
     // so they need convertion, init buffers if needed
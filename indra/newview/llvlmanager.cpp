@@ -35,6 +35,9 @@
 #include "llframetimer.h"
 #include "llsurface.h"
 #include "llbitpack.h"
+#include "llviewercontrol.h"
+#include "llworld.h"
+#include "workqueue.h"
 
 const   char    LAND_LAYER_CODE                 = 'L';
 const   char    WIND_LAYER_CODE                 = '7';
@@ -50,6 +53,7 @@ LLVLManager::~LLVLManager()
         delete mPacketData[i];
     }
     mPacketData.clear();
+    mLandDecodes.clear();
 }
 
 void LLVLManager::addLayerData(LLVLData *vl_datap, const S32Bytes mesg_size)
@@ -77,6 +81,9 @@ void LLVLManager::addLayerData(LLVLData *vl_datap, const S32Bytes mesg_size)
 void LLVLManager::unpackData(const S32 num_packets)
 {
     static LLFrameTimer decode_timer;
+    static LLCachedControl<bool> async_decode(gSavedSettings, "TerrainAsyncDecode", true);
+
+    applyLandDecodes();
 
     S32 i;
     for (i = 0; i < mPacketData.size(); i++)
@@ -89,7 +96,16 @@ void LLVLManager::unpackData(const S32 num_packets)
         decode_patch_group_header(bit_pack, &goph);
         if (LAND_LAYER_CODE == datap->mType)
         {
-            datap->mRegionp->getLand().decompressDCTPatch(bit_pack, &goph, false);
+            if (async_decode)
+            {
+                // the decode owns the packet from here on
+                postLandDecode(datap, bit_pack, goph);
+                mPacketData[i] = NULL;
+            }
+            else
+            {
+                datap->mRegionp->getLand().decompressDCTPatch(bit_pack, &goph, false);
+            }
         }
         else if (WIND_LAYER_CODE == datap->mType)
         {
@@ -110,6 +126,55 @@ void LLVLManager::unpackData(const S32 num_packets)
 
 }
 
+void LLVLManager::postLandDecode(LLVLData *datap, LLBitPack &bit_pack, const LLGroupHeader &goph)
+{
+    std::shared_ptr<LandDecode> decode = std::make_shared<LandDecode>();
+    decode->mData.reset(datap);
+    decode->mRegionHandle = datap->mRegionp->getHandle();
+    decode->mPatchSize = goph.patch_size;
+
+    LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+
+    // bit_pack points into datap, which the decode keeps alive
+    bool posted = main_queue && general_queue && main_queue->postTo(
+        general_queue,
+        [decode, bit_pack, goph]() mutable // Work done on general queue
+        {
+            LL_PROFILE_ZONE_NAMED("terrain decode");
+            LLSurface::decodeDCTPatches(bit_pack, goph, decode->mPatches);
+        },
+        [decode]() // Callback to main thread
+        {
+            decode->mDone = true;
+        });
+
+    if (!posted)
+    {
+        // no worker to hand it to, decode it here
+        LLSurface::decodeDCTPatches(bit_pack, goph, decode->mPatches);
+        decode->mDone = true;
+    }
+    mLandDecodes.push_back(decode);
+}
+
+void LLVLManager::applyLandDecodes()
+{
+    // A later packet may carry newer heights for the same patches, so stop
+    // at the first decode that is still running.
+    while (!mLandDecodes.empty() && mLandDecodes.front()->mDone)
+    {
+        std::shared_ptr<LandDecode> decode = mLandDecodes.front();
+        mLandDecodes.pop_front();
+
+        LLViewerRegion *regionp = LLWorld::getInstance()->getRegionFromHandle(decode->mRegionHandle);
+        if (regionp)
+        {
+            regionp->getLand().applyDCTPatches(decode->mPatches, decode->mPatchSize);
+        }
+    }
+}
+
 void LLVLManager::resetBitCounts()
 {
     mLandBits = mWindBits = mCloudBits = (S32Bits)0;
@@ -150,6 +215,16 @@ void LLVLManager::cleanupData(LLViewerRegion *regionp)
             cur++;
         }
     }
+
+    // running decodes hold their own reference, dropping ours just means
+    // the result is never applied
+    const U64 handle = regionp->getHandle();
+    mLandDecodes.erase(std::remove_if(mLandDecodes.begin(), mLandDecodes.end(),
+                                      [handle](const std::shared_ptr<LandDecode>& decode)
+                                      {
+                                          return decode->mRegionHandle == handle;
+                                      }),
+                       mLandDecodes.end());
 }
 
 LLVLData::LLVLData(LLViewerRegion *regionp, const S8 type, U8 *data, const S32 size)
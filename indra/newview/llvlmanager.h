@@ -30,6 +30,10 @@
 // This class manages the data coming in for viewer layers from the network.
 
 #include "stdtypes.h"
+#include "llsurface.h"
+
+#include <deque>
+#include <memory>
 
 class LLVLData;
 class LLViewerRegion;
@@ -53,8 +57,22 @@ public:
 
     void cleanupData(LLViewerRegion *regionp);
 protected:
+    // A land packet being decoded on a worker thread.
+    struct LandDecode
+    {
+        std::unique_ptr<LLVLData> mData;    // owns the bits being decoded
+        U64 mRegionHandle;
+        S32 mPatchSize;
+        LLSurface::decoded_patch_list_t mPatches;
+        bool mDone = false;
+    };
+
+    void postLandDecode(LLVLData *datap, LLBitPack &bit_pack, const LLGroupHeader &goph);
+    // Apply finished decodes in the order their packets arrived.
+    void applyLandDecodes();
 
     std::vector<LLVLData *> mPacketData;
+    std::deque<std::shared_ptr<LandDecode>> mLandDecodes;
     U32Bits mLandBits;
     U32Bits mWindBits;
     U32Bits mCloudBits;
@@ -219,6 +219,21 @@ enum ERenderName
 
 #define JELLYDOLLS_SHOULD_IMPOSTOR
 
+// Time spent in full motion updates of other avatars this frame, checked
+// against AvatarMotionUpdateBudget.
+static U32 sMotionBudgetFrame = 0;
+static F64Seconds sMotionBudgetSpent(0.0);
+
+static F64Seconds& motion_budget_spent()
+{
+    if (sMotionBudgetFrame != gFrameCount)
+    {
+        sMotionBudgetFrame = gFrameCount;
+        sMotionBudgetSpent = F64Seconds(0.0);
+    }
+    return sMotionBudgetSpent;
+}
+
 //-----------------------------------------------------------------------------
 // Callback data
 //-----------------------------------------------------------------------------
@@ -673,6 +688,7 @@ LLVOAvatar::LLVOAvatar(const LLUUID& id,
     mNeedsSkin(false),
     mLastSkinTime(0.f),
     mUpdatePeriod(1),
+    mLastMotionUpdateFrame(0),
     mOverallAppearance(AOA_INVISIBLE),
     mVisualComplexityStale(true),
     mVisuallyMuteSetting(AV_RENDER_NORMALLY),
@@ -4557,6 +4573,64 @@ void LLVOAvatar::updateTimeStep()
     }
 }
 
+//------------------------------------------------------------------------
+// computeMotionUpdatePeriod()
+// Frames between full motion updates, from how much of the screen the
+// avatar covers and how far away it is. Impostors already skip frames of
+// their own, and our own avatar has to animate reliably, so both update
+// every frame they are updated at all.
+//------------------------------------------------------------------------
+S32 LLVOAvatar::computeMotionUpdatePeriod()
+{
+    static LLCachedControl<bool> motion_scheduling(gSavedSettings, "AvatarMotionScheduling", true);
+    if (!motion_scheduling
+        || isSelf()
+        || isUIAvatar()
+        || mSpecialRenderMode != 0
+        || mUpdatePeriod > 1
+        || mDrawable.isNull())
+    {
+        return 1;
+    }
+
+    const F32 distance = mDrawable->mDistanceWRTCamera;
+    if (mPixelArea > 30000.f || distance < 12.f)
+    {
+        return 1;
+    }
+    if (mPixelArea > 5000.f || distance < 32.f)
+    {
+        return 2;
+    }
+    if (mPixelArea > 1000.f)
+    {
+        return 3;
+    }
+    return 4;
+}
+
+//------------------------------------------------------------------------
+// needsMotionUpdate()
+// Whether an avatar scheduled every motion_period frames gets its full
+// motion update this frame. Due avatars wait while the frame's budget is
+// spent, but never past twice their period.
+//------------------------------------------------------------------------
+bool LLVOAvatar::needsMotionUpdate(S32 motion_period)
+{
+    const U32 frames = gFrameCount - mLastMotionUpdateFrame;
+    if (frames < (U32)motion_period)
+    {
+        return false;
+    }
+    if (frames >= (U32)motion_period * 2)
+    {
+        return true;
+    }
+
+    static LLCachedControl<F32> motion_budget(gSavedSettings, "AvatarMotionUpdateBudget", 2.f);
+    return motion_budget_spent() < F64Milliseconds(motion_budget());
+}
+
 void LLVOAvatar::updateRootPositionAndRotation(LLAgent& agent, F32 speed, bool was_sit_ground_constrained)
 {
     if (!(isSitting() && getParent()))
@@ -4866,7 +4940,29 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     else
     {
         // Might be better to do HIDDEN_UPDATE if cloud
-        updateMotions(LLCharacter::NORMAL_UPDATE);
+        S32 motion_period = computeMotionUpdatePeriod();
+        if (motion_period > 1 && !needsMotionUpdate(motion_period))
+        {
+            mMotionController.interpolateMotions();
+            add(LLStatViewer::AVATAR_MOTIONS_INTERPOLATED, 1);
+        }
+        else if (isSelf())
+        {
+            updateMotions(LLCharacter::NORMAL_UPDATE);
+            mLastMotionUpdateFrame = gFrameCount;
+        }
+        else
+        {
+            // scheduled avatars ease into the new pose until their next update
+            F32 interp_time = motion_period > 1 ? motion_period * gFrameIntervalSeconds.value() : 0.f;
+            F64 start_time = LLTimer::getTotalSeconds();
+            updateMotions(LLCharacter::NORMAL_UPDATE, interp_time);
+            F64Seconds update_time(LLTimer::getTotalSeconds() - start_time);
+            motion_budget_spent() += update_time;
+            add(LLStatViewer::AVATAR_MOTION_TIME, update_time);
+            add(LLStatViewer::AVATAR_MOTIONS_UPDATED, 1);
+            mLastMotionUpdateFrame = gFrameCount;
+        }
     }
 
     // Special handling for sitting on ground.
@@ -4892,6 +4988,7 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
 
     // Update child joints as needed.
     mRoot->updateWorldMatrixChildren();
+    mPoseSerialNum++;
 
     if (visible)
     {
@@ -5000,6 +5097,7 @@ void LLVOAvatar::debugBodySize() const
 void LLVOAvatar::postPelvisSetRecalc()
 {
     mRoot->updateWorldMatrixChildren();
+    mPoseSerialNum++;
     computeBodySize();
     dirtyMesh(2);
 }
@@ -7194,7 +7292,16 @@ void LLVOAvatar::updateVisualParams()
         }
     }
 
-    LLCharacter::updateVisualParams();
+    {
+        // a shape change touches dozens of morphs on the same vertices,
+        // renormalize each of them once when all morphs have been added.
+        // Other avatars get their vertices deformed on worker threads, our
+        // own stays synchronous so appearance editing responds immediately.
+        LL_PROFILE_ZONE_NAMED_CATEGORY_AVATAR("apply visual params");
+        static LLCachedControl<bool> async_morphs(gSavedSettings, "AvatarAsyncMorphs", true);
+        LLPolyMesh::MorphBatch morph_batch(async_morphs && !isSelf() && !mIsDummy);
+        LLCharacter::updateVisualParams();
+    }
 
     if (mLastSkeletonSerialNum != mSkeletonSerialNum)
     {
@@ -9961,11 +10068,13 @@ const LLVOAvatar::MatrixPaletteCache& LLVOAvatar::updateSkinInfoMatrixPalette(co
     U64 hash = skin->mHash;
     MatrixPaletteCache& entry = mMatrixPaletteCache[hash];
 
-    if (entry.mFrame != gFrameCount)
+    if (entry.mFrame != gFrameCount || entry.mPoseSerialNum != mPoseSerialNum)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
 
         entry.mFrame = gFrameCount;
+        entry.mPoseSerialNum = mPoseSerialNum;
+        add(LLStatViewer::SKIN_PALETTES_COMPUTED, 1);
 
         //build matrix palette
         U32 count = LLSkinningUtil::getMeshJointCount(skin);
@@ -10000,6 +10109,11 @@ const LLVOAvatar::MatrixPaletteCache& LLVOAvatar::updateSkinInfoMatrixPalette(co
             mp[idx + 11] = m[14];
         }
     }
+    else
+    {
+        // another face rigged with the same joint list already built it
+        add(LLStatViewer::SKIN_PALETTES_REUSED, 1);
+    }
 
     return entry;
 }
@@ -278,6 +278,8 @@ public:
     void            computeUpdatePeriod();
     void            updateOrientation(LLAgent &agent, F32 speed, F32 delta_time);
     void            updateTimeStep();
+    S32             computeMotionUpdatePeriod();
+    bool            needsMotionUpdate(S32 motion_period);
     void            updateRootPositionAndRotation(LLAgent &agent, F32 speed, bool was_sit_ground_constrained);
 
     void            idleUpdateVoiceVisualizer(bool voice_enabled, const LLVector3 &position);
@@ -567,6 +569,7 @@ private:
     F32         mLastSkinTime; //value of gFrameTimeSeconds at last skin update
 
     S32         mUpdatePeriod;
+    U32         mLastMotionUpdateFrame; // gFrameCount at the last full motion update
     S32         mNumInitFaces; //number of faces generated when creating the avatar drawable, does not inculde splitted faces due to long vertex buffer.
 
     // profile handle
@@ -827,6 +830,9 @@ public:
         // Last frame this entry was updated
         U32 mFrame;
 
+        // mPoseSerialNum when this entry was updated
+        U32 mPoseSerialNum = 0;
+
         // List of Matrix4a's for this entry
         LLMeshSkinInfo::matrix_list_t mMatrixPalette;
 
@@ -848,6 +854,11 @@ public:
     typedef std::unordered_map<U64, MatrixPaletteCache> matrix_palette_cache_t;
     matrix_palette_cache_t mMatrixPaletteCache;
 
+    // Bumped whenever the joint world matrices are recomputed, so palettes
+    // built earlier in the frame (e.g. for picking) are not reused after
+    // the skeleton moves
+    U32 mPoseSerialNum = 0;
+
 protected:
     void            releaseMeshData();
     virtual void restoreMeshData();
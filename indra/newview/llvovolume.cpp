@@ -3888,7 +3888,7 @@ void LLVOVolume::updateRiggingInfo()
                 for (S32 f = 0; f < volume->getNumVolumeFaces(); ++f)
                 {
                     LLVolumeFace& vol_face = volume->getVolumeFace(f);
-                    LLSkinningUtil::updateRiggingInfo(skin, avatar, vol_face);
+                    LLSkinningUtil::updateRiggingInfo(skin, avatar, vol_face, f);
                     if (vol_face.mJointRiggingInfoTab.size()>0)
                     {
                         mJointRiggingInfoTab.merge(vol_face.mJointRiggingInfoTab);
@@ -4983,12 +4983,14 @@ void LLRiggedVolume::update(
     }
 
 
-    //build matrix palette
-    static const size_t kMaxJoints = LL_MAX_JOINTS_PER_MESH_OBJECT;
-
-    LLMatrix4a mat[kMaxJoints];
-    U32 maxJoints = LLSkinningUtil::getMeshJointCount(skin);
-    LLSkinningUtil::initSkinningMatrixPalette(mat, maxJoints, skin, avatar);
+    // share the palette with rendering and every other face of this
+    // avatar rigged to the same joint list
+    const LLMeshSkinInfo::matrix_list_t& palette = avatar->updateSkinInfoMatrixPalette(skin).mMatrixPalette;
+    if (palette.empty())
+    {
+        return;
+    }
+    const LLMatrix4a* mat = palette.data();
     const LLMatrix4a bind_shape_matrix = skin->mBindShapeMatrix;
 
     S32 rigged_vert_count = 0;
@@ -5027,7 +5029,8 @@ void LLRiggedVolume::update(
 
             if (pos && dst_face.mExtents)
             {
-                U32 max_joints = LLSkinningUtil::getMaxJointCount();
+                // the palette only holds the joints this skin uses
+                U32 max_joints = (U32)palette.size();
                 rigged_vert_count += dst_face.mNumVertices;
                 rigged_face_count++;
 
@@ -43,6 +43,7 @@
 // viewer
 #include "noise.h"
 #include "v4color.h"
+#include "llvector4a.h"
 #include "llworld.h"
 
 
@@ -199,6 +200,21 @@ LLVector3 LLWind::getVelocityNoisy(const LLVector3 &pos_region, const F32 dim)
 
 
 LLVector3 LLWind::getVelocity(const LLVector3 &pos_region)
+{
+    return getVelocity(pos_region, LLWorld::getInstance()->getRegionWidthInMeters());
+}
+
+void LLWind::getVelocities(const LLVector4a *locations, LLVector4a *velocities, S32 count)
+{
+    F32 region_width_meters = LLWorld::getInstance()->getRegionWidthInMeters();
+    for (S32 i = 0; i < count; i++)
+    {
+        LLVector3 velocity = getVelocity(LLVector3(locations[i].getF32ptr()), region_width_meters);
+        velocities[i].load3(velocity.mV);
+    }
+}
+
+LLVector3 LLWind::getVelocity(const LLVector3 &pos_region, F32 region_width_meters)
 {
     llassert(mSize == 16);
     // Resolves value of wind at a location relative to SW corner of region
@@ -210,8 +226,6 @@ LLVector3 LLWind::getVelocity(const LLVector3 &pos_region)
 
     LLVector3 pos_clamped_region(pos_region);
 
-    F32 region_width_meters = LLWorld::getInstance()->getRegionWidthInMeters();
-
     if (pos_clamped_region.mV[VX] < 0.f)
     {
         pos_clamped_region.mV[VX] = 0.f;
@@ -32,6 +32,7 @@
 #include "v3dmath.h"
 
 class LLVector3;
+class LLVector4a;
 class LLBitPack;
 class LLGroupHeader;
 
@@ -46,6 +47,8 @@ public:
     void renderVectors();
     LLVector3 getVelocity(const LLVector3 &location); // "location" is region-local
     LLVector3 getVelocityNoisy(const LLVector3 &location, const F32 dim);   // "location" is region-local
+    // getVelocity() for count region-local positions at once.
+    void getVelocities(const LLVector4a *locations, LLVector4a *velocities, S32 count);
 
     void decompress(LLBitPack &bitpack, LLGroupHeader *group_headerp);
     LLVector3 getAverage();
@@ -58,6 +61,7 @@ private:
 
     LLVector3d mOriginGlobal;
     void init();
+    LLVector3 getVelocity(const LLVector3 &location, F32 region_width_meters);
 
     LOG_CLASS(LLWind);
 };
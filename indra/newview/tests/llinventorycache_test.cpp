@@ -0,0 +1,281 @@
+/**
+ * @file llinventorycache_test.cpp
+ * @brief Round trip and damage checks for the binary inventory cache.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llviewerinventory.h"
+// Class to test
+#include "../llinventorycache.h"
+
+#include "../test/lltut.h"
+#include "../test/namedtempfile.h"
+
+#include "llfile.h"
+
+// -------------------------------------------------------------------------------------------
+// Stubbing: Declarations required to link and run the class being tested
+// The cache only creates inventory objects and reads their raw fields, so
+// the viewer overrides just hand back what LLInventoryItem holds.
+
+LLViewerInventoryItem::LLViewerInventoryItem() : mIsComplete(false) { }
+LLViewerInventoryItem::~LLViewerInventoryItem() { }
+LLAssetType::EType LLViewerInventoryItem::getType() const { return LLInventoryItem::getType(); }
+const LLUUID& LLViewerInventoryItem::getAssetUUID() const { return LLInventoryItem::getAssetUUID(); }
+const LLUUID& LLViewerInventoryItem::getProtectedAssetUUID() const { return LLInventoryItem::getAssetUUID(); }
+const std::string& LLViewerInventoryItem::getName() const { return LLInventoryItem::getName(); }
+S32 LLViewerInventoryItem::getSortField() const { return -1; }
+void LLViewerInventoryItem::getSLURL() { }
+const LLPermissions& LLViewerInventoryItem::getPermissions() const { return LLInventoryItem::getPermissions(); }
+const bool LLViewerInventoryItem::getIsFullPerm() const { return false; }
+const LLUUID& LLViewerInventoryItem::getCreatorUUID() const { return LLInventoryItem::getCreatorUUID(); }
+const std::string& LLViewerInventoryItem::getDescription() const { return LLInventoryItem::getDescription(); }
+const LLSaleInfo& LLViewerInventoryItem::getSaleInfo() const { return LLInventoryItem::getSaleInfo(); }
+const LLUUID& LLViewerInventoryItem::getThumbnailUUID() const { return LLInventoryItem::getThumbnailUUID(); }
+LLInventoryType::EType LLViewerInventoryItem::getInventoryType() const { return LLInventoryItem::getInventoryType(); }
+bool LLViewerInventoryItem::isWearableType() const { return false; }
+LLWearableType::EType LLViewerInventoryItem::getWearableType() const { return LLWearableType::WT_INVALID; }
+bool LLViewerInventoryItem::isSettingsType() const { return false; }
+LLSettingsType::type_e LLViewerInventoryItem::getSettingsType() const { return LLSettingsType::ST_NONE; }
+U32 LLViewerInventoryItem::getFlags() const { return LLInventoryItem::getFlags(); }
+time_t LLViewerInventoryItem::getCreationDate() const { return LLInventoryItem::getCreationDate(); }
+U32 LLViewerInventoryItem::getCRC32() const { return 0; }
+void LLViewerInventoryItem::copyItem(const LLInventoryItem*) { }
+void LLViewerInventoryItem::updateParentOnServer(bool) const { }
+void LLViewerInventoryItem::updateServer(bool) const { }
+void LLViewerInventoryItem::packMessage(LLMessageSystem*) const { }
+bool LLViewerInventoryItem::unpackMessage(LLMessageSystem*, const char*, S32) { return false; }
+bool LLViewerInventoryItem::unpackMessage(const LLSD&) { return false; }
+bool LLViewerInventoryItem::importLegacyStream(std::istream&) { return false; }
+void LLViewerInventoryItem::setTransactionID(const LLTransactionID&) { }
+
+LLViewerInventoryCategory::LLViewerInventoryCategory(const LLUUID& owner_id) :
+    mOwnerID(owner_id),
+    mVersion(VERSION_UNKNOWN),
+    mDescendentCount(DESCENDENT_COUNT_UNKNOWN),
+    mFetching(FETCH_NONE)
+{
+}
+LLViewerInventoryCategory::~LLViewerInventoryCategory() { }
+S32 LLViewerInventoryCategory::getVersion() const { return mVersion; }
+void LLViewerInventoryCategory::setVersion(S32 version) { mVersion = version; }
+void LLViewerInventoryCategory::updateParentOnServer(bool) const { }
+void LLViewerInventoryCategory::updateServer(bool) const { }
+void LLViewerInventoryCategory::packMessage(LLMessageSystem*) const { }
+void LLViewerInventoryCategory::unpackMessage(LLMessageSystem*, const char*, S32) { }
+bool LLViewerInventoryCategory::unpackMessage(const LLSD&) { return false; }
+
+// End Stubbing
+// -------------------------------------------------------------------------------------------
+
+namespace tut
+{
+    struct inventorycache_test
+    {
+        static const S32 CACHE_VERSION = 3;
+
+        LLInventoryModel::cat_array_t mCategories;
+        LLInventoryModel::item_array_t mItems;
+        NamedTempFile mFile;
+
+        inventorycache_test()
+        :   mFile("llinventorycache", "")
+        {
+            LLUUID owner_id = LLUUID::generateNewID();
+            LLUUID root_id = LLUUID::generateNewID();
+
+            LLPointer<LLViewerInventoryCategory> root = new LLViewerInventoryCategory(owner_id);
+            root->setUUID(root_id);
+            root->setPreferredType(LLFolderType::FT_ROOT_INVENTORY);
+            root->importName("My Inventory");
+            root->setVersion(12);
+            mCategories.push_back(root);
+
+            LLPointer<LLViewerInventoryCategory> padded = new LLViewerInventoryCategory(owner_id);
+            padded->setUUID(LLUUID::generateNewID());
+            padded->setParent(root_id);
+            padded->setPreferredType(LLFolderType::FT_NONE);
+            padded->importName("  padded folder ");
+            padded->setThumbnailUUID(LLUUID::generateNewID());
+            padded->setVersion(4);
+            mCategories.push_back(padded);
+
+            for (S32 i = 0; i < 3; ++i)
+            {
+                LLPermissions perm;
+                perm.init(LLUUID::generateNewID(), owner_id, LLUUID::null, LLUUID::null);
+                perm.initMasks(PERM_ALL, PERM_ALL, PERM_COPY, PERM_NONE, PERM_MOVE | PERM_TRANSFER);
+
+                LLPointer<LLViewerInventoryItem> item = new LLViewerInventoryItem;
+                item->setUUID(LLUUID::generateNewID());
+                item->setParent(i ? padded->getUUID() : root_id);
+                item->setPermissions(perm);
+                item->setAssetUUID(LLUUID::generateNewID());
+                item->setType(LLAssetType::AT_NOTECARD);
+                item->setInventoryType(LLInventoryType::IT_NOTECARD);
+                item->setSaleInfo(LLSaleInfo(LLSaleInfo::FS_COPY, 10 * i));
+                item->setFlags(i);
+                item->setCreationDate(1700000000 + i);
+                item->importName(i == 1 ? " leading space" : (i == 2 ? "trailing space  " : "plain"));
+                item->importDescription(" described ");
+                mItems.push_back(item);
+            }
+        }
+
+        LLInventoryCacheFile::ELoadResult load(LLInventoryModel::cat_array_t& categories,
+                                               LLInventoryModel::item_array_t& items,
+                                               S32 cache_version = CACHE_VERSION)
+        {
+            LLInventoryModel::changed_items_t cats_to_update;
+            return LLInventoryCacheFile::load(mFile.getName(), cache_version, categories, items, cats_to_update);
+        }
+
+        std::string readFile()
+        {
+            llifstream in(mFile.getName().c_str(), std::ios::in | std::ios::binary);
+            std::ostringstream data;
+            data << in.rdbuf();
+            return data.str();
+        }
+
+        void writeFile(const std::string& data)
+        {
+            llofstream out(mFile.getName().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write(data.data(), data.size());
+        }
+    };
+
+    typedef test_group<inventorycache_test> inventorycache_t;
+    typedef inventorycache_t::object inventorycache_object_t;
+    tut::inventorycache_t tut_inventorycache("LLInventoryCacheFile");
+
+    template<> template<>
+    void inventorycache_object_t::test<1>()
+    {
+        set_test_name("round trip keeps every field, names untrimmed");
+        ensure("saved", LLInventoryCacheFile::save(mFile.getName(), CACHE_VERSION, mCategories, mItems));
+
+        LLInventoryModel::cat_array_t categories;
+        LLInventoryModel::item_array_t items;
+        ensure_equals("loaded", load(categories, items), LLInventoryCacheFile::LOAD_OK);
+        ensure_equals("category count", categories.size(), mCategories.size());
+        ensure_equals("item count", items.size(), mItems.size());
+
+        for (size_t i = 0; i < categories.size(); ++i)
+        {
+            const LLViewerInventoryCategory* expected = mCategories[i];
+            const LLViewerInventoryCategory* actual = categories[i];
+            ensure_equals("category id", actual->getUUID(), expected->getUUID());
+            ensure_equals("category parent", actual->getParentUUID(), expected->getParentUUID());
+            ensure_equals("category owner", actual->getOwnerID(), expected->getOwnerID());
+            ensure_equals("category name", actual->getName(), expected->getName());
+            ensure_equals("category type", actual->getPreferredType(), expected->getPreferredType());
+            ensure_equals("category thumbnail", actual->getThumbnailUUID(), expected->getThumbnailUUID());
+            ensure_equals("category version", actual->getVersion(), expected->getVersion());
+        }
+        ensure_equals("leading and trailing spaces kept", categories[1]->getName(), std::string("  padded folder "));
+
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            const LLViewerInventoryItem* expected = mItems[i];
+            const LLViewerInventoryItem* actual = items[i];
+            ensure_equals("item id", actual->getUUID(), expected->getUUID());
+            ensure_equals("item parent", actual->getParentUUID(), expected->getParentUUID());
+            ensure_equals("item asset", actual->getAssetUUID(), expected->getAssetUUID());
+            ensure_equals("item name", actual->getName(), expected->getName());
+            ensure_equals("item description", actual->getDescription(), expected->getDescription());
+            ensure_equals("item type", actual->getType(), expected->getType());
+            ensure_equals("item inventory type", actual->getInventoryType(), expected->getInventoryType());
+            ensure_equals("item flags", actual->getFlags(), expected->getFlags());
+            ensure_equals("item creation date", actual->getCreationDate(), expected->getCreationDate());
+            ensure("item sale info", actual->getSaleInfo() == expected->getSaleInfo());
+            ensure("item permissions", actual->getPermissions() == expected->getPermissions());
+        }
+        ensure_equals("leading space kept", items[1]->getName(), std::string(" leading space"));
+        ensure_equals("trailing space kept", items[2]->getName(), std::string("trailing space  "));
+        ensure_equals("description spaces kept", items[0]->getDescription(), std::string(" described "));
+    }
+
+    template<> template<>
+    void inventorycache_object_t::test<2>()
+    {
+        set_test_name("truncated file is invalid");
+        ensure("saved", LLInventoryCacheFile::save(mFile.getName(), CACHE_VERSION, mCategories, mItems));
+        const std::string data = readFile();
+
+        // inside the header, inside the first chunk, and just short of the
+        // end chunk
+        for (size_t len : { (size_t)4, (size_t)20, data.size() / 2, data.size() - 1 })
+        {
+            writeFile(data.substr(0, len));
+            LLInventoryModel::cat_array_t categories;
+            LLInventoryModel::item_array_t items;
+            ensure_equals(STRINGIZE("cut at " << len), load(categories, items), LLInventoryCacheFile::LOAD_INVALID);
+            ensure("nothing loaded", categories.empty() && items.empty());
+        }
+    }
+
+    template<> template<>
+    void inventorycache_object_t::test<3>()
+    {
+        set_test_name("corrupted chunk is rejected");
+        ensure("saved", LLInventoryCacheFile::save(mFile.getName(), CACHE_VERSION, mCategories, mItems));
+        std::string data = readFile();
+
+        // file header is 16 bytes and each chunk header another 16; flip a
+        // byte in the middle of the first chunk's compressed records
+        data[40] = ~data[40];
+        writeFile(data);
+
+        LLInventoryModel::cat_array_t categories;
+        LLInventoryModel::item_array_t items;
+        ensure_equals("corrupt", load(categories, items), LLInventoryCacheFile::LOAD_INVALID);
+        ensure("nothing loaded", categories.empty() && items.empty());
+    }
+
+    template<> template<>
+    void inventorycache_object_t::test<4>()
+    {
+        set_test_name("other cache or format version is obsolete, other magic is invalid");
+        ensure("saved", LLInventoryCacheFile::save(mFile.getName(), CACHE_VERSION, mCategories, mItems));
+        const std::string data = readFile();
+
+        LLInventoryModel::cat_array_t categories;
+        LLInventoryModel::item_array_t items;
+        ensure_equals("cache version", load(categories, items, CACHE_VERSION + 1), LLInventoryCacheFile::LOAD_OBSOLETE);
+
+        // format version follows the 8 byte magic
+        std::string other_format(data);
+        other_format[8] = other_format[8] + 1;
+        writeFile(other_format);
+        ensure_equals("format version", load(categories, items), LLInventoryCacheFile::LOAD_OBSOLETE);
+
+        std::string other_magic(data);
+        other_magic[0] = 'X';
+        writeFile(other_magic);
+        ensure_equals("magic", load(categories, items), LLInventoryCacheFile::LOAD_INVALID);
+        ensure("nothing loaded", categories.empty() && items.empty());
+    }
+}
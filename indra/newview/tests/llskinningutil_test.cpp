@@ -0,0 +1,277 @@
+/**
+ * @file llskinningutil_test.cpp
+ * @brief Rigged extents per joint against the per vertex loop they replaced.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Dependencies
+#include "linden_common.h"
+#include "llmodel.h"
+#include "llrigginginfo.h"
+#include "llvolume.h"
+#include "../llvoavatar.h"
+// Class to test
+#include "../llskinningutil.h"
+// Tut header
+#include "../test/lltut.h"
+
+// -------------------------------------------------------------------------------------------
+// Stubbing: Declarations required to link and run the class being tested
+// Notes:
+// * Add here stubbed implementation of the few classes and methods used in the class to be tested
+// * Add as little as possible (let the link errors guide you)
+// * Do not make any assumption as to how those classes or methods work (i.e. don't copy/paste code)
+// * A simulator for a class can be implemented here. Please comment and document thoroughly.
+
+LLJoint* LLVOAvatar::getJoint(S32 num) { return NULL; }
+
+// End Stubbing
+// -------------------------------------------------------------------------------------------
+
+namespace tut
+{
+    struct skinningutil_test
+    {
+        skinningutil_test()
+        :   mSeed(12345)
+        {
+        }
+
+        F32 frand(F32 range)
+        {
+            mSeed = mSeed * 1103515245 + 12345;
+            return range * (F32)((mSeed >> 8) & 0xFFFF) / 65536.f;
+        }
+
+        U32 rand(U32 range)
+        {
+            mSeed = mSeed * 1103515245 + 12345;
+            return (mSeed >> 8) % range;
+        }
+
+        // Skin joints mapped to avatar joints the ways real skins are: some
+        // several to one, some to joints the avatar lacks or can't animate,
+        // and the last few without a bind pose
+        void makeSkin(LLMeshSkinInfo& skin, U32 num_joints)
+        {
+            for (U32 j = 0; j < num_joints; j++)
+            {
+                skin.mJointNames.push_back(llformat("joint%d", j));
+                S32 joint_num = j + 5;
+                if (j % 7 == 3)
+                {
+                    joint_num = -1;
+                }
+                else if (j % 7 == 5)
+                {
+                    joint_num = LL_CHARACTER_MAX_ANIMATED_JOINTS + j;
+                }
+                else if (j % 3 == 0)
+                {
+                    joint_num = j / 3;
+                }
+                skin.mJointNums.push_back(joint_num);
+            }
+            skin.mJointNumsInitialized = true;
+
+            for (U32 j = 0; j + 4 < num_joints; j++)
+            {
+                LLMatrix4a mat;
+                mat.mMatrix[0].set(frand(2.f) - 1.f, frand(2.f) - 1.f, frand(2.f) - 1.f, 0.f);
+                mat.mMatrix[1].set(frand(2.f) - 1.f, frand(2.f) - 1.f, frand(2.f) - 1.f, 0.f);
+                mat.mMatrix[2].set(frand(2.f) - 1.f, frand(2.f) - 1.f, frand(2.f) - 1.f, 0.f);
+                mat.mMatrix[3].set(frand(4.f) - 2.f, frand(4.f) - 2.f, frand(4.f) - 2.f, 1.f);
+                skin.mBindPoseMatrix.push_back(mat);
+            }
+        }
+
+        // Weights packed as joint index + fraction, up to max_influences a
+        // vertex, with strays: indices past the skin's joints, past the
+        // avatar's or below zero, and fractions at or under the 0.2 cut off
+        void makeFace(LLVolumeFace& face, S32 num_verts, U32 num_joints, U32 max_influences)
+        {
+            face.resizeVertices(num_verts);
+            face.allocateWeights(num_verts);
+            for (S32 i = 0; i < num_verts; i++)
+            {
+                if (i % 97 == 0)
+                {
+                    face.mPositions[i].clear();
+                }
+                else
+                {
+                    face.mPositions[i].set(frand(2.f) - 1.f, frand(2.f) - 1.f, frand(2.f) - 1.f, 1.f);
+                }
+
+                F32 weights[4] = { 0.f, 0.f, 0.f, 0.f };
+                U32 influences = 1 + rand(max_influences);
+                for (U32 k = 0; k < influences; k++)
+                {
+                    F32 fraction = frand(1.f);
+                    switch (rand(16))
+                    {
+                    case 0: fraction = 0.2f; break;
+                    case 1: fraction = 0.f; break;
+                    default: break;
+                    }
+                    S32 joint_index = rand(num_joints + 2);
+                    F32 weight = (F32)joint_index + fraction;
+                    if (i % 211 == 1)
+                    {
+                        weight = -fraction;
+                    }
+                    else if (i % 211 == 2)
+                    {
+                        weight = (F32)LL_CHARACTER_MAX_ANIMATED_JOINTS + fraction;
+                    }
+                    weights[k] = weight;
+                }
+                face.mWeights[i].loadua(weights);
+            }
+        }
+
+        // What LLSkinningUtil::updateRiggingInfo() did one vertex at a time
+        // before computeRiggedExtents()
+        static void perVertexExtents(const LLMeshSkinInfo* skin, const LLVolumeFace& vol_face, LLJointRiggingInfoTab& rig_info_tab)
+        {
+            S32 num_joints = static_cast<S32>(skin->mJointNames.size());
+            rig_info_tab.resize(LL_CHARACTER_MAX_ANIMATED_JOINTS);
+            for (S32 i=0; i<vol_face.mNumVertices; i++)
+            {
+                LLVector4a& pos = vol_face.mPositions[i];
+                F32 *weights = vol_face.mWeights[i].getF32ptr();
+                LLVector4 wght;
+                S32 idx[4];
+                for (U32 k = 0; k < 4; k++)
+                {
+                    F32 w = weights[k];
+                    idx[k] = llclamp((S32) floorf(w), (S32)0, (S32)LL_CHARACTER_MAX_ANIMATED_JOINTS-1);
+                    wght[k] = w - idx[k];
+                }
+
+                for (U32 k=0; k<4; ++k)
+                {
+                    S32 joint_index = idx[k];
+                    if (wght[k] > 0.2f && num_joints > joint_index)
+                    {
+                        S32 joint_num = skin->mJointNums[joint_index];
+                        if (joint_num >= 0 && joint_num < LL_CHARACTER_MAX_ANIMATED_JOINTS)
+                        {
+                            rig_info_tab[joint_num].setIsRiggedTo(true);
+
+                            size_t bind_poses_size = skin->mBindPoseMatrix.size();
+                            const LLMatrix4a& mat = bind_poses_size > joint_index ? skin->mBindPoseMatrix[joint_index] : LLMatrix4a::identity();
+                            LLVector4a pos_joint_space;
+
+                            mat.affineTransform(pos, pos_joint_space);
+
+                            LLVector4a *extents = rig_info_tab[joint_num].getRiggedExtents();
+                            update_min_max(extents[0], extents[1], pos_joint_space);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Same joints rigged, and the same extents to the bit
+        static void ensureSameExtents(const std::string& msg, const LLJointRiggingInfoTab& expected, const LLJointRiggingInfoTab& actual)
+        {
+            ensure_equals(msg + " joints", actual.size(), expected.size());
+            for (S32 joint_num = 0; joint_num < expected.size(); joint_num++)
+            {
+                std::string joint = llformat("%s joint %d", msg.c_str(), joint_num);
+                ensure_equals(joint + " rigged", actual[joint_num].isRiggedTo(), expected[joint_num].isRiggedTo());
+                ensure(joint + " extents", !memcmp(actual[joint_num].getRiggedExtents(), expected[joint_num].getRiggedExtents(),
+                                                  2 * sizeof(LLVector4a)));
+            }
+        }
+
+        U32 mSeed;
+    };
+
+    typedef test_group<skinningutil_test> skinningutil_t;
+    typedef skinningutil_t::object skinningutil_object_t;
+    tut::skinningutil_t tut_skinningutil("LLSkinningUtil");
+
+    template<> template<>
+    void skinningutil_object_t::test<1>()
+    {
+        set_test_name("rigged extents bit for bit with the per vertex loop");
+        LLMeshSkinInfo skin;
+        makeSkin(skin, 60);
+
+        // vertex counts that leave a part block of four, up to four influences each
+        const S32 sizes[] = { 1, 3, 4, 5, 1001, 40000 };
+        for (S32 num_verts : sizes)
+        {
+            for (U32 max_influences = 1; max_influences <= 4; max_influences++)
+            {
+                LLVolumeFace face;
+                makeFace(face, num_verts, (U32)skin.mJointNames.size(), max_influences);
+
+                LLJointRiggingInfoTab expected;
+                perVertexExtents(&skin, face, expected);
+                LLJointRiggingInfoTab actual;
+                LLSkinningUtil::computeRiggedExtents(&skin, face, actual);
+
+                ensureSameExtents(llformat("%d vertices, %d influences", num_verts, max_influences), expected, actual);
+            }
+        }
+    }
+
+    template<> template<>
+    void skinningutil_object_t::test<2>()
+    {
+        set_test_name("the same face of the same mesh shares its extents");
+        LLMeshSkinInfo skin;
+        skin.mMeshID.generate();
+        makeSkin(skin, 30);
+        skin.updateHash();
+
+        LLVolumeFace face;
+        makeFace(face, 999, (U32)skin.mJointNames.size(), 4);
+        LLJointRiggingInfoTab expected;
+        perVertexExtents(&skin, face, expected);
+
+        face.mJointRiggingInfoTab.setNeedsUpdate(true);
+        LLSkinningUtil::updateRiggingInfo(&skin, NULL, face, 0);
+        ensure("computed", !face.mJointRiggingInfoTab.needsUpdate());
+        ensureSameExtents("computed", expected, face.mJointRiggingInfoTab);
+
+        // Another volume holding the face finds it in the cache: give it
+        // different positions, which it would show if it recomputed them
+        LLVolumeFace other;
+        makeFace(other, 999, (U32)skin.mJointNames.size(), 4);
+        other.mJointRiggingInfoTab.setNeedsUpdate(true);
+        LLSkinningUtil::updateRiggingInfo(&skin, NULL, other, 0);
+        ensureSameExtents("shared", expected, other.mJointRiggingInfoTab);
+
+        // and a different face index is a different face
+        LLJointRiggingInfoTab other_expected;
+        perVertexExtents(&skin, other, other_expected);
+        other.mJointRiggingInfoTab.clear();
+        other.mJointRiggingInfoTab.setNeedsUpdate(true);
+        LLSkinningUtil::updateRiggingInfo(&skin, NULL, other, 1);
+        ensureSameExtents("not shared", other_expected, other.mJointRiggingInfoTab);
+    }
+}
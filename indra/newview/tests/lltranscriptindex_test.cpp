@@ -0,0 +1,264 @@
+/**
+ * @file lltranscriptindex_test.cpp
+ * @brief Transcript indexing, paging and search, and a benchmark against
+ * reading a large transcript line by line (set LL_TRANSCRIPT_BENCHMARK).
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltranscriptindex.h"
+
+#include "../test/lltut.h"
+#include "../test/namedtempfile.h"
+
+#include "lltimer.h"
+
+#include <list>
+
+namespace tut
+{
+    struct LLTranscriptIndexData
+    {
+        // Every message as the old loader put it together: the first line,
+        // then each further line with a newline in front and its space
+        // prefix dropped
+        static std::string joined(const LLTranscriptIndex& transcript, S32 index)
+        {
+            std::string line, more_lines;
+            transcript.getMessage(index, line, more_lines);
+            return line + more_lines;
+        }
+
+        // Chat log lines with made up speakers, one in ten of them running
+        // on to a second line
+        static void writeTranscript(std::ostream& out, S32 messages)
+        {
+            U32 seed = 12345;
+            for (S32 i = 0; i < messages; i++)
+            {
+                seed = seed * 1103515245 + 12345;
+                out << "[20" << 10 + i / 40000 << "/01/01 " << (i / 60) % 24 << ":" << i % 60 << "]  Resident "
+                    << (seed >> 16) % 50 << ": message number " << i << " with some words in it";
+                if ((seed >> 8) % 10 == 0)
+                {
+                    out << "\n and a second line";
+                }
+                out << "\n";
+            }
+        }
+
+        // Old style: read it all a line at a time, one string per message
+        static void readAll(const std::string& filename, std::list<std::string>& messages)
+        {
+            LLFILE* fp = LLFile::fopen(filename, "rb");
+            char buffer[20480];     /*Flawfinder: ignore*/
+            while (fgets(buffer, sizeof(buffer), fp) && !feof(fp))
+            {
+                std::string line(buffer);
+                while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+                {
+                    line.pop_back();
+                }
+                if (line.empty() || line[0] == ' ')
+                {
+                    if (!messages.empty())
+                    {
+                        messages.back() += '\n' + (line.empty() ? line : line.substr(1));
+                    }
+                }
+                else
+                {
+                    messages.push_back(line);
+                }
+            }
+            fclose(fp);
+        }
+    };
+
+    typedef test_group<LLTranscriptIndexData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory lltranscriptindex_test_factory("LLTranscriptIndex");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("messages, continued lines and the tail");
+        NamedTempFile file("transcript",
+                           " orphan continuation\n"
+                           "\xEF\xBB\xBF[2024/01/02 10:00]  Alice Resident: hello\r\n"
+                           "[2024/01/02 10:01]  Bob Resident: two\n"
+                           " lines\n"
+                           "\n"
+                           " and a paragraph\n"
+                           "[2024/01/02 10:02]  Alice Resident: last\n"
+                           "[2024/01/02 10:03]  Bob Resident: still being writ");
+        LLTranscriptIndex transcript;
+        ensure("opened", transcript.open(file.getName()));
+        transcript.buildIndex();
+        ensure_equals("messages", transcript.getMessageCount(), 3);
+
+        std::string line, more_lines;
+        transcript.getMessage(0, line, more_lines);
+        ensure_equals("no BOM or CR", line, std::string("[2024/01/02 10:00]  Alice Resident: hello"));
+        ensure("one line", more_lines.empty());
+        transcript.getMessage(1, line, more_lines);
+        ensure_equals("first line", line, std::string("[2024/01/02 10:01]  Bob Resident: two"));
+        ensure_equals("further lines", more_lines, std::string("\nlines\n\nand a paragraph"));
+        ensure_equals("unfinished line left out", joined(transcript, 2),
+                      std::string("[2024/01/02 10:02]  Alice Resident: last"));
+        ensure_equals("past the end", joined(transcript, 3), std::string());
+
+        ensure_equals("orphan belongs to nothing", transcript.getMessageAt(0), -1);
+        ensure_equals("first message", transcript.getMessageAt(21), 0);
+        ensure_equals("inside a message", transcript.getMessageAt(70), 1);
+        ensure_equals("unfinished line", transcript.getMessageAt(transcript.getSize() - 1), -1);
+
+        // tail starting inside "[2024/01/02 10:02]..." drops that line
+        transcript.buildTailIndex(50);
+        ensure_equals("nothing whole in the tail", transcript.getMessageCount(), 0);
+        transcript.buildTailIndex(110);
+        ensure_equals("one message in the tail", transcript.getMessageCount(), 1);
+        ensure_equals("tail message", joined(transcript, 0), std::string("[2024/01/02 10:02]  Alice Resident: last"));
+        transcript.buildTailIndex(transcript.getSize());
+        ensure_equals("tail is everything", transcript.getMessageCount(), 3);
+
+        NamedTempFile empty("transcript", "");
+        ensure("empty opens", transcript.open(empty.getName()));
+        transcript.buildIndex();
+        ensure_equals("empty", transcript.getMessageCount(), 0);
+        ensure("missing file", !transcript.open(empty.getName() + ".missing"));
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("search the mapped file");
+        NamedTempFile file("transcript",
+                           "[10:00]  Alice Resident: Meet at the SANDBOX\n"
+                           "[10:01]  Bob Resident: which sandbox?\n"
+                           " the sandbox by the sea\n"
+                           "[10:02]  Alice Resident: the one by the sea\n"
+                           "[10:03]  Bob Resident: ok\n");
+        LLTranscriptIndex transcript;
+        ensure("opened", transcript.open(file.getName()));
+        transcript.buildIndex();
+
+        std::vector<S32> matches;
+        transcript.find("sandbox", matches);
+        ensure_equals("once per message, any case", matches.size(), 2);
+        ensure_equals("first", matches[0], 0);
+        ensure_equals("second", matches[1], 1);
+
+        transcript.find("by the sea", matches);
+        ensure_equals("on a further line", matches.size(), 2);
+        ensure_equals("further line", matches[0], 1);
+        ensure_equals("own line", matches[1], 2);
+
+        transcript.find("sea\n[10:03]", matches);
+        ensure("not across messages", matches.empty());
+        transcript.find("", matches);
+        ensure("nothing for nothing", matches.empty());
+        transcript.find("carol", matches);
+        ensure("no match", matches.empty());
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("every message of a long transcript");
+        NamedTempFile file("transcript", [](std::ostream& out) { writeTranscript(out, 2000); });
+
+        std::list<std::string> all;
+        readAll(file.getName(), all);
+        LLTranscriptIndex transcript;
+        ensure("opened", transcript.open(file.getName()));
+        transcript.buildIndex();
+
+        ensure_equals("same messages", (size_t)transcript.getMessageCount(), all.size());
+        S32 index = 0;
+        for (const std::string& message : all)
+        {
+            ensure_equals("same text", joined(transcript, index++), message);
+        }
+
+        std::vector<S32> matches;
+        transcript.find("NUMBER 199", matches);
+        // 199 and 1990..1999
+        ensure_equals("found", matches.size(), 11);
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("open a 400000 message transcript");
+        // a benchmark: some 30MB of transcript, so only when asked for
+        if (!getenv("LL_TRANSCRIPT_BENCHMARK"))
+        {
+            skip("set LL_TRANSCRIPT_BENCHMARK to time a 400000 message transcript");
+        }
+        const S32 MESSAGES = 400000;
+        const S32 PAGE_SIZE = 100;
+
+        NamedTempFile file("transcript", [](std::ostream& out) { writeTranscript(out, MESSAGES); });
+
+        LLTimer timer;
+        std::list<std::string> all;
+        readAll(file.getName(), all);
+        F64 read_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        LLTranscriptIndex transcript;
+        ensure("opened", transcript.open(file.getName()));
+        transcript.buildIndex();
+        F64 index_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        std::vector<std::string> page;
+        S32 last_page = (transcript.getMessageCount() - 1) / PAGE_SIZE;
+        for (S32 i = last_page * PAGE_SIZE; i < transcript.getMessageCount(); i++)
+        {
+            page.push_back(joined(transcript, i));
+        }
+        F64 page_time = timer.getElapsedTimeF64();
+        ensure_equals("same messages", (size_t)transcript.getMessageCount(), all.size());
+
+        timer.reset();
+        std::vector<S32> matches;
+        transcript.find("NUMBER 39999", matches);
+        F64 find_time = timer.getElapsedTimeF64();
+        // 39999 and 399990..399999
+        ensure_equals("found", matches.size(), 11);
+
+        LL_INFOS("ChatHistory") << MESSAGES << " messages, " << transcript.getSize() / 1024 << "KB: read line by line in "
+            << read_time * 1000.0 << "ms, indexed in " << index_time * 1000.0 << "ms, last page in "
+            << page_time * 1000.0 << "ms, searched in " << find_time * 1000.0 << "ms" << LL_ENDL;
+    }
+}
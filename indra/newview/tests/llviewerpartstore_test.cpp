@@ -0,0 +1,366 @@
+/**
+ * @file llviewerpartstore_test.cpp
+ * @brief Tests and benchmark for LLViewerPartStore.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llviewerpartstore.h"
+#include "../test/lltut.h"
+
+#include "llalignedarray.h"
+#include "llpartdata.h"
+#include "llrand.h"
+#include "lltimer.h"
+#include "v4coloru.h"
+
+namespace tut
+{
+    struct LLViewerPartStoreData
+    {
+        // What LLViewerPartGroup::updateParticles() keeps per particle,
+        // heap allocated one at a time like LLViewerPart.
+        struct Part : public LLPartData
+        {
+            LLVector3 mPosAgent;
+            LLVector3 mVelocity;
+            LLVector3 mAccel;
+            LLColor4 mColor;
+            LLVector2 mScale;
+            LLColor4U mGlow;
+            F32 mLastUpdateTime;
+            F32 mSkipOffset;
+        };
+
+        // Stand in for a region's wind lattice.
+        struct Wind
+        {
+            F32 mVelX[16*16];
+            F32 mVelY[16*16];
+
+            Wind()
+            {
+                for (S32 i = 0; i < 16*16; i++)
+                {
+                    mVelX[i] = ll_frand(4.f) - 2.f;
+                    mVelY[i] = ll_frand(4.f) - 2.f;
+                }
+            }
+
+            LLVector3 getVelocity(const LLVector3& pos_region) const
+            {
+                F32 x = llclamp(pos_region.mV[VX], 0.f, 255.f)/16.f;
+                F32 y = llclamp(pos_region.mV[VY], 0.f, 255.f)/16.f;
+                S32 i = llmin((S32)x, 14);
+                S32 j = llmin((S32)y, 14);
+                F32 dx = x - i;
+                F32 dy = y - j;
+                S32 k = i + j*16;
+                return LLVector3(mVelX[k]*(1.f - dx)*(1.f - dy) + mVelX[k + 1]*dx*(1.f - dy)
+                                    + mVelX[k + 16]*dy*(1.f - dx) + mVelX[k + 17]*dx*dy,
+                                 mVelY[k]*(1.f - dx)*(1.f - dy) + mVelY[k + 1]*dx*(1.f - dy)
+                                    + mVelY[k + 16]*dy*(1.f - dx) + mVelY[k + 17]*dx*dy,
+                                 0.f);
+            }
+
+            void getVelocities(const LLVector4a* pos_region, LLVector4a* velocities, S32 count) const
+            {
+                for (S32 i = 0; i < count; i++)
+                {
+                    velocities[i].load3(getVelocity(LLVector3(pos_region[i].getF32ptr())).mV);
+                }
+            }
+        };
+
+        Part* makePart()
+        {
+            static const U32 FLAGS[] = { 0,
+                                         LLPartData::LL_PART_INTERP_COLOR_MASK,
+                                         LLPartData::LL_PART_INTERP_COLOR_MASK | LLPartData::LL_PART_INTERP_SCALE_MASK,
+                                         LLPartData::LL_PART_WIND_MASK | LLPartData::LL_PART_INTERP_COLOR_MASK,
+                                         LLPartData::LL_PART_WIND_MASK | LLPartData::LL_PART_INTERP_SCALE_MASK };
+            Part* part = new Part;
+            part->mFlags = FLAGS[ll_rand(LL_ARRAY_SIZE(FLAGS))];
+            part->mMaxAge = 2.f + ll_frand(8.f);
+            part->mStartColor.set(ll_frand(), ll_frand(), ll_frand(), 1.f);
+            part->mEndColor.set(ll_frand(), ll_frand(), ll_frand(), 0.f);
+            part->mStartScale.set(0.1f + ll_frand(), 0.1f + ll_frand());
+            part->mEndScale.set(ll_frand(), ll_frand());
+            part->mStartGlow = ll_frand();
+            part->mEndGlow = ll_frand();
+            part->mPosAgent.set(ll_frand(256.f), ll_frand(256.f), 20.f + ll_frand(10.f));
+            part->mVelocity.set(ll_frand(2.f) - 1.f, ll_frand(2.f) - 1.f, ll_frand(3.f));
+            part->mAccel.set(0.f, 0.f, -9.8f*ll_frand());
+            part->mColor = part->mStartColor;
+            part->mScale = part->mStartScale;
+            part->mLastUpdateTime = ll_frand(2.f);
+            part->mSkipOffset = ll_frand() < 0.2f ? ll_frand(0.05f) : 0.f;
+            return part;
+        }
+
+        void addToStore(LLViewerPartStore& store, const Part* part)
+        {
+            store.add(*part, false, part->mPosAgent, part->mVelocity, part->mAccel,
+                      part->mColor, part->mScale, part->mLastUpdateTime, part->mSkipOffset);
+        }
+
+        // The per particle update for plain and wind driven particles, as
+        // LLViewerPartGroup::updateParticles() does it.
+        void updatePart(Part* part, F32 lastdt, F32 skipped, const Wind& wind, const LLVector3& origin)
+        {
+            F32 dt = lastdt + skipped - part->mSkipOffset;
+            part->mSkipOffset = 0.f;
+
+            const F32 cur_time = part->mLastUpdateTime + dt;
+            const F32 frac = cur_time / part->mMaxAge;
+
+            if (part->mFlags & LLPartData::LL_PART_WIND_MASK)
+            {
+                part->mVelocity *= 1.f - 0.1f*dt;
+                part->mVelocity += 0.1f*dt*wind.getVelocity(part->mPosAgent - origin);
+            }
+
+            part->mPosAgent += dt*part->mVelocity;
+            part->mPosAgent += 0.5f*dt*dt*part->mAccel;
+            part->mVelocity += part->mAccel*dt;
+
+            if (part->mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK)
+            {
+                part->mColor.setVec(part->mStartColor);
+                part->mColor *= 1.f - frac;
+                part->mColor %= 1.f - frac;
+                part->mColor += frac%(frac*part->mEndColor);
+            }
+
+            if (part->mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK)
+            {
+                part->mScale.setVec(part->mStartScale);
+                part->mScale *= 1.f - frac;
+                part->mScale += frac*part->mEndScale;
+            }
+
+            part->mGlow.mV[3] = (U8) ll_round(lerp(part->mStartGlow, part->mEndGlow, frac)*255.f);
+            part->mLastUpdateTime = cur_time;
+        }
+
+        // Advance the store the way LLViewerPartGroup does.
+        void updateStore(LLViewerPartStore& store, F32 dt, const Wind& wind, const LLVector3& origin)
+        {
+            store.getSlots(LLViewerPartStore::KIND_WIND, mSlots);
+            if (!mSlots.empty())
+            {
+                S32 count = (S32)mSlots.size();
+                mWindPos.resize(count);
+                mWindVel.resize(count);
+                LLVector4a origin4a;
+                origin4a.load3(origin.mV);
+                for (S32 k = 0; k < count; k++)
+                {
+                    mWindPos[k].setSub(store.getPosition(mSlots[k]), origin4a);
+                }
+                wind.getVelocities(&mWindPos[0], &mWindVel[0], count);
+                store.update(dt, &mSlots[0], count, &mWindVel[0]);
+            }
+            store.getSlots(LLViewerPartStore::KIND_SIMPLE, mSlots);
+            if (!mSlots.empty())
+            {
+                store.update(dt, &mSlots[0], (S32)mSlots.size());
+            }
+        }
+
+        void ensureClose(const std::string& what, const F32* expected, const F32* actual, S32 count)
+        {
+            for (S32 i = 0; i < count; i++)
+            {
+                F32 tolerance = 1.e-5f*llmax(1.f, fabsf(expected[i]));
+                if (fabsf(expected[i] - actual[i]) > tolerance)
+                {
+                    fail(what + " differs from the per particle update");
+                }
+            }
+        }
+
+        void ensureSame(const Part* part, const LLViewerPartStore& store, S32 slot)
+        {
+            ensureClose("position", part->mPosAgent.mV, store.getPosition(slot).getF32ptr(), 3);
+            ensureClose("velocity", part->mVelocity.mV, store.getVelocity(slot).getF32ptr(), 3);
+            ensureClose("color", part->mColor.mV, store.getColor(slot).getF32ptr(), 4);
+            ensureClose("scale", part->mScale.mV, store.getScale(slot).getF32ptr(), 2);
+            ensure_approximately_equals("age", store.getAge(slot), part->mLastUpdateTime, 20);
+            ensure("glow", abs((S32)store.getGlow(slot) - (S32)part->mGlow.mV[3]) <= 1);
+        }
+
+        std::vector<S32> mSlots;
+        LLAlignedArray<LLVector4a, 64> mWindPos;
+        LLAlignedArray<LLVector4a, 64> mWindVel;
+    };
+
+    typedef test_group<LLViewerPartStoreData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llviewerpartstore_test_factory("LLViewerPartStore");
+}
+
+namespace tut
+{
+    template<> template<>
+    void object::test<1>()
+    {
+        // kernels match the per particle update, frame after frame
+        Wind wind;
+        LLVector3 origin(0.f, 0.f, 0.f);
+        std::vector<Part*> parts;
+        LLViewerPartStore store;
+        for (S32 i = 0; i < 1000; i++)
+        {
+            parts.push_back(makePart());
+            addToStore(store, parts.back());
+        }
+        ensure_equals("every particle stored", store.size(), 1000);
+
+        for (S32 frame = 0; frame < 30; frame++)
+        {
+            const F32 dt = 1.f/60.f;
+            for (Part* part : parts)
+            {
+                updatePart(part, dt, 0.f, wind, origin);
+            }
+            updateStore(store, dt, wind, origin);
+        }
+        for (S32 i = 0; i < (S32)parts.size(); i++)
+        {
+            ensureSame(parts[i], store, i);
+            delete parts[i];
+        }
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        // kinds, and removal keeping slots in step with a swap and pop list
+        LLViewerPartStore store;
+        std::vector<Part*> parts;
+        for (S32 i = 0; i < 300; i++)
+        {
+            parts.push_back(makePart());
+            if (i % 7 == 0)
+            {
+                parts.back()->mFlags |= LLPartData::LL_PART_FOLLOW_SRC_MASK;
+            }
+            addToStore(store, parts.back());
+        }
+        store.add(*parts[1], true, LLVector3::zero, LLVector3::zero, LLVector3::zero,
+                  LLColor4::white, LLVector2(1.f, 1.f), 0.f, 0.f);
+        ensure_equals("callbacks go the scalar way", store.getKind(300), (U8)LLViewerPartStore::KIND_SCALAR);
+        store.remove(300);
+
+        for (S32 i = 0; i < (S32)parts.size(); i++)
+        {
+            U8 expected = (parts[i]->mFlags & LLPartData::LL_PART_FOLLOW_SRC_MASK) ? LLViewerPartStore::KIND_SCALAR
+                        : (parts[i]->mFlags & LLPartData::LL_PART_WIND_MASK) ? LLViewerPartStore::KIND_WIND
+                        : LLViewerPartStore::KIND_SIMPLE;
+            ensure_equals("kind", store.getKind(i), expected);
+        }
+
+        for (S32 i = 0; i < (S32)parts.size();)
+        {
+            if (ll_rand(3) == 0)
+            {
+                delete parts[i];
+                parts[i] = parts.back();
+                parts.pop_back();
+                store.remove(i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+        ensure_equals("sizes agree", store.size(), (S32)parts.size());
+        for (S32 i = 0; i < (S32)parts.size(); i++)
+        {
+            ensureClose("position after removal", parts[i]->mPosAgent.mV, store.getPosition(i).getF32ptr(), 3);
+            ensure_equals("age after removal", store.getAge(i), parts[i]->mLastUpdateTime);
+            delete parts[i];
+        }
+
+        LLVector4a offset;
+        offset.set(1.f, 2.f, 3.f, 0.f);
+        LLVector4a before = store.getPosition(0);
+        store.shift(offset);
+        ensure_equals("shifted", store.getPosition(0).getF32ptr()[VZ], before.getF32ptr()[VZ] + 3.f);
+
+        store.clear();
+        ensure_equals("cleared", store.size(), 0);
+        LLViewerPartStore::cleanupClass();
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        // headless benchmark: 20k particles a frame
+        const S32 PARTICLES = 20000;
+        const S32 FRAMES = 60;
+        Wind wind;
+        LLVector3 origin(0.f, 0.f, 0.f);
+
+        std::vector<Part*> parts;
+        LLViewerPartStore store;
+        for (S32 i = 0; i < PARTICLES; i++)
+        {
+            parts.push_back(makePart());
+            addToStore(store, parts.back());
+        }
+
+        LLTimer timer;
+        for (S32 frame = 0; frame < FRAMES; frame++)
+        {
+            for (Part* part : parts)
+            {
+                updatePart(part, 1.f/60.f, 0.f, wind, origin);
+            }
+        }
+        F64 part_time = timer.getElapsedTimeF64();
+
+        timer.reset();
+        for (S32 frame = 0; frame < FRAMES; frame++)
+        {
+            updateStore(store, 1.f/60.f, wind, origin);
+        }
+        F64 store_time = timer.getElapsedTimeF64();
+
+        ensureSame(parts[PARTICLES/2], store, PARTICLES/2);
+        for (Part* part : parts)
+        {
+            delete part;
+        }
+
+        LL_INFOS("Particles") << PARTICLES << " particles: per particle update "
+            << part_time * 1000.0 / FRAMES << "ms a frame, store kernels "
+            << store_time * 1000.0 / FRAMES << "ms a frame" << LL_ENDL;
+    }
+}
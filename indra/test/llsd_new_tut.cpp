@@ -31,7 +31,13 @@
 #include "lltut.h"
 
 #include "llsdtraits.h"
+#include "llformat.h"
+#include "llsdserialize.h"
 #include "llstring.h"
+#include "lltimer.h"
+
+#include <map>
+#include <sstream>
 
 using std::fpclassify;
 
@@ -811,6 +817,110 @@ namespace tut
         ensure("type is a string", v.isString());
     }
 
+    template<> template<>
+    void SDTestObject::test<15>()
+        // large maps stay consistent with their hash index
+    {
+        bool was_enabled = LLSD::getMapHashIndexEnabled();
+        LLSD::setMapHashIndexEnabled(true);
+
+        LLSD m = LLSD::emptyMap();
+        std::map<std::string, S32> expected;
+        for (S32 i = 0; i < 5000; ++i)
+        {
+            std::string key = llformat("key%d", (i * 7919) % 300);
+            switch (i % 4)
+            {
+            case 0:
+                m.insert(key, i);
+                expected.emplace(key, i);
+                break;
+            case 1:
+                m[key] = i;
+                expected[key] = i;
+                break;
+            case 2:
+                if (i % 3)
+                {
+                    m.erase(key);
+                    expected.erase(key);
+                }
+                break;
+            default:
+                ensure_equals("has " + key, m.has(key), expected.count(key) != 0);
+                break;
+            }
+        }
+
+        ensure_equals("size", (size_t) m.size(), expected.size());
+        LLSD copy = m;
+        LLSD::map_const_iterator it = copy.beginMap();
+        for (const auto& pair : expected)
+        {
+            ensure_equals("iteration order", it->first, pair.first);
+            ensure_equals("get " + pair.first, m.get(pair.first).asInteger(), pair.second);
+            ensure_equals("copy " + pair.first, copy[pair.first].asInteger(), pair.second);
+            ++it;
+        }
+        ensure("missing key", !m.has("nope") && m.get("nope").isUndefined());
+
+        LLSD::setMapHashIndexEnabled(was_enabled);
+    }
+
+    template<> template<>
+    void SDTestObject::test<16>()
+        // parse and lookup timing for inventory and login shaped maps
+    {
+        bool was_enabled = LLSD::getMapHashIndexEnabled();
+
+        // login response: one wide map of mostly scalar options
+        LLSD login = LLSD::emptyMap();
+        for (S32 i = 0; i < 120; ++i)
+        {
+            login[llformat("login-option-%d", i)] = i;
+        }
+        // inventory fetch: many category maps keyed by item id
+        LLSD inventory = LLSD::emptyMap();
+        for (S32 i = 0; i < 2000; ++i)
+        {
+            LLSD item;
+            item["name"] = llformat("item %d", i);
+            item["type"] = i % 20;
+            inventory[LLUUID::generateNewID().asString()] = item;
+        }
+
+        std::ostringstream login_str, inventory_str;
+        LLSDSerialize::toNotation(login, login_str);
+        LLSDSerialize::toBinary(inventory, inventory_str);
+
+        for (S32 pass = 0; pass < 2; ++pass)
+        {
+            LLSD::setMapHashIndexEnabled(pass == 0);
+            LLTimer timer;
+            S32 found = 0;
+            for (S32 rep = 0; rep < 20; ++rep)
+            {
+                LLSD parsed_login, parsed_inventory;
+                std::istringstream login_in(login_str.str()), inventory_in(inventory_str.str());
+                LLSDSerialize::fromNotation(parsed_login, login_in, login_str.str().size());
+                LLSDSerialize::fromBinary(parsed_inventory, inventory_in, inventory_str.str().size());
+                for (S32 i = 0; i < 120; ++i)
+                {
+                    found += parsed_login.has(llformat("login-option-%d", i)) ? 1 : 0;
+                }
+                for (LLSD::map_const_iterator it = inventory.beginMap(); it != inventory.endMap(); ++it)
+                {
+                    found += parsed_inventory.has(it->first) ? 1 : 0;
+                }
+            }
+            ensure_equals("all keys found", found, 20 * (120 + 2000));
+            LL_INFOS("LLSD") << "LLSD map parse+lookup, hash index " << (pass == 0 ? "on" : "off")
+                             << ": " << timer.getElapsedTimeF64() * 1000.0 << "ms" << LL_ENDL;
+        }
+
+        LLSD::setMapHashIndexEnabled(was_enabled);
+    }
+
     /* TO DO:
         conversion of undefined to UUID, Date, URI and Binary
         conversion of undefined to map and array